@@ -52,6 +52,9 @@ extern void nr_predis_enable(TSRMLS_D);
 extern void nr_zend_http_enable(TSRMLS_D);
 extern void nr_monolog_enable(TSRMLS_D);
 extern void nr_composer_handle_autoload(const char* filename);
+extern void nr_composer_handle_txn_sent(const nrtxn_t* txn);
+extern void nr_composer_handle_txn_queued(const nrtxn_t* txn);
+extern void nr_composer_handle_batch_sent(bool delivered);
 
 /* Vulnerability Management Packages */
 extern void nr_drupal_version(void);
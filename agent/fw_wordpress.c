@@ -267,7 +267,8 @@ static char* nr_wordpress_plugin_from_function(zend_function* func TSRMLS_DC) {
       return plugin;
     }
   } else {
-    NRPRG(wordpress_file_metadata) = nr_hashmap_create(free_wordpress_metadata);
+    NRPRG(wordpress_file_metadata) = nr_hashmap_create_buckets(
+        NR_WORDPRESS_FILE_METADATA_MAX, free_wordpress_metadata);
   }
   nrl_verbosedebug(NRL_FRAMEWORK,
                    "Wordpress: NOT found in cache: "
@@ -323,6 +324,10 @@ cache_and_return:
   /*
    * Even if plugin is NULL, we'll still cache that. Hooks in WordPress's core
    * will be NULL, and we need not re-run the matchers each time.
+   *
+   * The cache is kept across requests: a filename's plugin or theme depends
+   * only on the installation's directory layout, which is stable for as long
+   * as the file is.
    */
   nr_hashmap_set(NRPRG(wordpress_file_metadata), filename, filename_len,
                  plugin);
@@ -443,7 +448,8 @@ static char* nr_wordpress_clean_tag(const zval* tag) {
   }
 
   if (NULL == NRPRG(wordpress_clean_tag_cache)) {
-    NRPRG(wordpress_clean_tag_cache) = nr_hashmap_create(free_tag);
+    NRPRG(wordpress_clean_tag_cache)
+        = nr_hashmap_create_buckets(NR_WORDPRESS_CLEAN_TAG_CACHE_MAX, free_tag);
   }
 
   if (nr_hashmap_get_into(NRPRG(wordpress_clean_tag_cache), Z_STRVAL_P(tag),
@@ -884,3 +890,23 @@ void nr_wordpress_minit(void) {
 void nr_wordpress_mshutdown(void) {
   nr_regex_destroy(&wordpress_hook_regex);
 }
+
+void nr_wordpress_caches_invalidate(void) {
+  NRPRG(wordpress_caches_invalid) = true;
+}
+
+void nr_wordpress_caches_rshutdown(void) {
+  if (NRPRG(wordpress_caches_invalid)
+      || nr_hashmap_count(NRPRG(wordpress_file_metadata))
+             > NR_WORDPRESS_FILE_METADATA_MAX) {
+    nr_hashmap_destroy(&NRPRG(wordpress_file_metadata));
+  }
+
+  if (NRPRG(wordpress_caches_invalid)
+      || nr_hashmap_count(NRPRG(wordpress_clean_tag_cache))
+             > NR_WORDPRESS_CLEAN_TAG_CACHE_MAX) {
+    nr_hashmap_destroy(&NRPRG(wordpress_clean_tag_cache));
+  }
+
+  NRPRG(wordpress_caches_invalid) = false;
+}
@@ -41,4 +41,29 @@ char* nr_php_wordpress_theme_match_matcher(const char* filename);
 extern void nr_wordpress_minit(void);
 extern void nr_wordpress_mshutdown(void);
 
+/*
+ * The maximum number of filenames and hook tags cached across requests.
+ */
+#define NR_WORDPRESS_FILE_METADATA_MAX 8192
+#define NR_WORDPRESS_CLEAN_TAG_CACHE_MAX 8192
+
+/*
+ * Purpose : Mark the WordPress plugin and hook tag caches as invalid, so that
+ *           they are discarded at the end of the current request. This is
+ *           called when opcache is reset, since that is when deployed code is
+ *           expected to change.
+ */
+extern void nr_wordpress_caches_invalidate(void);
+
+/*
+ * Purpose : Discard the WordPress plugin and hook tag caches at the end of a
+ *           request if they have been invalidated or have grown beyond their
+ *           limits. Otherwise they are kept for the next request.
+ *
+ * Notes   : Transient wraprecs hold pointers into the plugin cache, so the
+ *           caches must only be discarded once transient user instrumentation
+ *           has been removed.
+ */
+extern void nr_wordpress_caches_rshutdown(void);
+
 #endif /* FW_WORDPRESS_HDR */
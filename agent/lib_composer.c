@@ -6,11 +6,78 @@
 #include "php_agent.h"
 #include "fw_hooks.h"
 #include "fw_support.h"
+#include "nr_php_packages.h"
 #include "nr_txn.h"
 #include "util_logging.h"
 #include "util_memory.h"
 #include "util_syscalls.h"
 
+/*
+ * The Composer package inventory is gathered by evaluating PHP code through
+ * the Composer runtime API, and sending it costs every transaction a copy of
+ * the whole package list. Since the inventory only changes when packages are
+ * installed or updated, it is cached per process, keyed by the vendor path and
+ * the mtime of vendor/composer/installed.php, and it is only sent to the
+ * daemon once per agent run.
+ */
+static void nr_execute_handle_autoload_composer_add_cached_package(
+    void* value,
+    const char* key NRUNUSED,
+    size_t key_len NRUNUSED,
+    void* user_data) {
+  nr_php_package_t* package = (nr_php_package_t*)value;
+
+  nr_txn_add_php_package_from_source((nrtxn_t*)user_data,
+                                     package->package_name,
+                                     package->package_version,
+                                     NR_PHP_PACKAGE_SOURCE_COMPOSER);
+}
+
+static void nr_execute_handle_autoload_composer_use_cache(void) {
+  nr_php_packages_iterate(
+      NRPRG(composer_packages),
+      nr_execute_handle_autoload_composer_add_cached_package, NRPRG(txn));
+
+  NRPRG(txn)->composer_info.packages_reported
+      = (NULL != NRPRG(composer_packages_run_id)
+         && 0
+                == nr_strcmp(NRPRG(composer_packages_run_id),
+                             NRPRG(txn)->agent_run_id));
+}
+
+static void nr_execute_handle_autoload_composer_reset_cache(
+    const char* vendor_path,
+    time_t installed_mtime) {
+  nr_free(NRPRG(composer_vendor_path));
+  nr_php_packages_destroy(&NRPRG(composer_packages));
+  nr_free(NRPRG(composer_packages_run_id));
+  nr_free(NRPRG(composer_packages_queued_run_id));
+
+  NRPRG(composer_vendor_path) = nr_strdup(vendor_path);
+  NRPRG(composer_installed_mtime) = installed_mtime;
+}
+
+static bool nr_execute_handle_autoload_composer_is_cached(
+    const char* vendor_path,
+    time_t* installed_mtime) {
+  char* installed_file = NULL;
+  struct stat sb;
+  int rv;
+
+  installed_file = nr_formatf("%s/composer/installed.php", vendor_path);
+  rv = nr_stat(installed_file, &sb);
+  nr_free(installed_file);
+  if (0 != rv) {
+    *installed_mtime = 0;
+    return false;
+  }
+
+  *installed_mtime = sb.st_mtime;
+  return NULL != NRPRG(composer_packages)
+         && NRPRG(composer_installed_mtime) == sb.st_mtime
+         && 0 == nr_strcmp(NRPRG(composer_vendor_path), vendor_path);
+}
+
 static bool nr_execute_handle_autoload_composer_is_initialized() {
   zend_class_entry* zce = NULL;
 
@@ -73,6 +140,7 @@ static void nr_execute_handle_autoload_composer_get_packages_information(
   zval retval;  // This is used as a return value for zend_eval_string.
                 // It will only be set if the result of the eval is SUCCESS.
   int result = FAILURE;
+  time_t installed_mtime = 0;
 
   // nrunlikely because this should alredy be ensured by the caller
   if (nrunlikely(!NRINI(vulnerability_management_package_detection_enabled))) {
@@ -87,6 +155,14 @@ static void nr_execute_handle_autoload_composer_get_packages_information(
     return;
   }
 
+  if (nr_execute_handle_autoload_composer_is_cached(vendor_path,
+                                                    &installed_mtime)) {
+    nrl_verbosedebug(NRL_INSTRUMENT, "%s - using cached package information",
+                     __func__);
+    nr_execute_handle_autoload_composer_use_cache();
+    return;
+  }
+
   // clang-format off
   char* getallrawdata
         = ""
@@ -139,6 +215,17 @@ static void nr_execute_handle_autoload_composer_get_packages_information(
   if (IS_ARRAY == Z_TYPE(retval)) {
     zend_string* package_name = NULL;
     zval* package_version = NULL;
+
+    /*
+     * The inventory is only cached when installed.php could be found, as
+     * otherwise there is nothing to tell when it changes.
+     */
+    nr_execute_handle_autoload_composer_reset_cache(vendor_path,
+                                                    installed_mtime);
+    if (0 != installed_mtime) {
+      NRPRG(composer_packages) = nr_php_packages_create();
+    }
+
     ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL(retval), package_name,
                                   package_version) {
       if (NULL == package_name || NULL == package_version) {
@@ -148,6 +235,13 @@ static void nr_execute_handle_autoload_composer_get_packages_information(
         nrl_verbosedebug(NRL_INSTRUMENT, "package %s, version %s",
                          NRSAFESTR(ZSTR_VAL(package_name)),
                          NRSAFESTR(Z_STRVAL_P(package_version)));
+        if (NULL != NRPRG(composer_packages)) {
+          nr_php_packages_add_package(
+              NRPRG(composer_packages),
+              nr_php_package_create_with_source(
+                  ZSTR_VAL(package_name), Z_STRVAL_P(package_version),
+                  NR_PHP_PACKAGE_SOURCE_COMPOSER));
+        }
         nr_txn_add_php_package_from_source(NRPRG(txn), ZSTR_VAL(package_name),
                                            Z_STRVAL_P(package_version),
                                            NR_PHP_PACKAGE_SOURCE_COMPOSER);
@@ -270,3 +364,49 @@ void nr_composer_handle_autoload(const char* filename) {
 leave:
   nr_free(vendor_path);
 }
+
+static bool nr_composer_txn_carries_inventory(const nrtxn_t* txn) {
+  return NULL != txn && txn->composer_info.composer_detected
+         && !txn->composer_info.packages_reported
+         && NULL != NRPRG(composer_packages);
+}
+
+void nr_composer_handle_txn_sent(const nrtxn_t* txn) {
+  if (!nr_composer_txn_carries_inventory(txn)) {
+    return;
+  }
+
+  /*
+   * The cached inventory has now been sent with this agent run, so later
+   * transactions can leave it out until it changes or the agent reconnects.
+   */
+  nr_free(NRPRG(composer_packages_run_id));
+  NRPRG(composer_packages_run_id) = nr_strdup(txn->agent_run_id);
+}
+
+void nr_composer_handle_txn_queued(const nrtxn_t* txn) {
+  if (!nr_composer_txn_carries_inventory(txn)) {
+    return;
+  }
+
+  /*
+   * The inventory only counts as sent once the batch holding this
+   * transaction has been delivered to the daemon.
+   */
+  nr_free(NRPRG(composer_packages_queued_run_id));
+  NRPRG(composer_packages_queued_run_id) = nr_strdup(txn->agent_run_id);
+}
+
+void nr_composer_handle_batch_sent(bool delivered) {
+  if (NULL == NRPRG(composer_packages_queued_run_id)) {
+    return;
+  }
+
+  if (delivered) {
+    nr_free(NRPRG(composer_packages_run_id));
+    NRPRG(composer_packages_run_id) = NRPRG(composer_packages_queued_run_id);
+    NRPRG(composer_packages_queued_run_id) = NULL;
+  } else {
+    nr_free(NRPRG(composer_packages_queued_run_id));
+  }
+}
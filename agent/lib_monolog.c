@@ -128,6 +128,7 @@ static char* nr_monolog_get_level_name(zval* logger,
 static char* nr_monolog_get_message(NR_EXECUTE_PROTO TSRMLS_DC) {
   char* message = NULL;
   zval* message_arg = NULL;
+  size_t max_len = (size_t)NRINI(log_forwarding_max_message_length);
 
   message_arg = nr_php_arg_get(2, NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
   if (NULL == message_arg) {
@@ -141,7 +142,11 @@ static char* nr_monolog_get_message(NR_EXECUTE_PROTO TSRMLS_DC) {
                      __func__, Z_TYPE_P(message_arg));
     message = nr_strdup("");
   } else {
-    message = nr_strdup(Z_STRVAL_P(message_arg));
+    /* Only copy as much of the message as will be forwarded */
+    if (0 == max_len || max_len > NR_MAX_LOG_MESSAGE_LEN) {
+      max_len = NR_MAX_LOG_MESSAGE_LEN;
+    }
+    message = nr_strndup(Z_STRVAL_P(message_arg), max_len);
   }
   nr_php_arg_release(&message_arg);
 
@@ -363,19 +368,26 @@ NR_PHP_WRAPPER(nr_monolog_logger_addrecord) {
   /* Values of $message and $timestamp arguments are needed only if log
    * forwarding is enabled so agent will get them conditionally */
   if (nr_txn_log_forwarding_enabled(NRPRG(txn))) {
-    argc = nr_php_get_user_func_arg_count(NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
-    message = nr_monolog_get_message(NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
+    api = nr_monolog_version(this_var TSRMLS_CC);
 
-    if (nr_txn_log_forwarding_context_data_enabled(NRPRG(txn))) {
-      zval* context_data = nr_monolog_extract_context_data(
-          argc, NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
-      context_attributes
-          = nr_monolog_convert_context_data_to_attributes(context_data);
-      nr_php_arg_release(&context_data);
+    /* Records with an empty message are not forwarded, so the message is
+     * always needed; records that would be dropped by the level filter, the
+     * per-request cap or sampling are counted without the cost of copying
+     * their context data */
+    message = nr_monolog_get_message(NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
+    if (nr_txn_log_forwarding_would_keep(NRPRG(txn), level_name)) {
+      argc = nr_php_get_user_func_arg_count(NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
+
+      if (nr_txn_log_forwarding_context_data_enabled(NRPRG(txn))) {
+        zval* context_data = nr_monolog_extract_context_data(
+            argc, NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
+        context_attributes
+            = nr_monolog_convert_context_data_to_attributes(context_data);
+        nr_php_arg_release(&context_data);
+      }
+      timestamp = nr_monolog_get_timestamp(api, argc,
+                                           NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
     }
-    api = nr_monolog_version(this_var TSRMLS_CC);
-    timestamp
-        = nr_monolog_get_timestamp(api, argc, NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
     char version[MAJOR_VERSION_LENGTH];
     snprintf(version, sizeof(version), "%d", api);
     nr_txn_suggest_package_supportability_metric(NRPRG(txn), PHP_PACKAGE_NAME,
@@ -243,6 +243,13 @@ extern void nr_php_txn_shutdown(TSRMLS_D);
 extern nr_status_t nr_php_txn_end(int ignoretxn,
                                   int in_post_deactivate TSRMLS_DC);
 
+/*
+ * Purpose : Send any transactions of the current request that are still
+ *           waiting in a batch to the daemon, and destroy the batch. This is
+ *           called when the request ends.
+ */
+extern void nr_php_txn_batch_flush(TSRMLS_D);
+
 /*
  * Purpose : Check if the given extension is loaded.
  *
@@ -201,6 +201,75 @@ zval* nr_php_call_user_func_catch(zval* object_ptr,
   return retval;
 }
 
+static const char* nr_php_call_internal_names[NR_PHP_CALL_INTERNAL_COUNT] = {
+    [NR_PHP_CALL_CURL_GETINFO] = "curl_getinfo",
+};
+
+static zend_function* nr_php_call_internal_resolve(
+    nr_php_call_internal_t function TSRMLS_DC) {
+  zend_function* func = NRPRG(internal_functions)[function];
+
+  if (NULL != func) {
+    return func;
+  }
+
+  func = nr_php_find_function(nr_php_call_internal_names[function] TSRMLS_CC);
+  if (NULL == func || ZEND_INTERNAL_FUNCTION != func->type) {
+    return NULL;
+  }
+
+  /*
+   * Functions of extensions loaded with dl() are removed at the end of the
+   * request, so only functions of persistent extensions can be kept.
+   */
+  if (func->internal_function.module
+      && MODULE_PERSISTENT == func->internal_function.module->type) {
+    NRPRG(internal_functions)[function] = func;
+  }
+
+  return func;
+}
+
+zval* nr_php_call_internal_func(nr_php_call_internal_t function,
+                                zend_uint param_count,
+                                zval* params[] TSRMLS_DC) {
+  if (nrunlikely((int)function < 0
+                 || function >= NR_PHP_CALL_INTERNAL_COUNT)) {
+    return NULL;
+  }
+
+#if ZEND_MODULE_API_NO >= ZEND_7_0_X_API_NO /* PHP 7.0+ */
+  {
+    zend_fcall_info fci;
+    zend_fcall_info_cache fcc;
+    zend_function* func = nr_php_call_internal_resolve(function TSRMLS_CC);
+
+    if (NULL == func) {
+      return NULL;
+    }
+
+    nr_memset(&fci, 0, sizeof(fci));
+    nr_memset(&fcc, 0, sizeof(fcc));
+
+    fci.size = sizeof(fci);
+    ZVAL_UNDEF(&fci.function_name);
+    fcc.function_handler = func;
+#if ZEND_MODULE_API_NO < ZEND_7_3_X_API_NO
+    fcc.initialized = 1;
+#endif
+
+    return nr_php_call_fcall_info_zval(fci, fcc, param_count, params);
+  }
+#else
+  if (NULL == nr_php_call_internal_resolve(function TSRMLS_CC)) {
+    return NULL;
+  }
+
+  return nr_php_call_user_func(NULL, nr_php_call_internal_names[function],
+                               param_count, params TSRMLS_CC);
+#endif /* PHP7+ */
+}
+
 zval* nr_php_call_callable_zval(zval* callable,
                                 zend_uint param_count,
                                 zval* params[] TSRMLS_DC) {
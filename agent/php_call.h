@@ -76,6 +76,39 @@ extern zval* nr_php_call_user_func_catch(zval* object_ptr,
                                          zval* params[],
                                          zval** exception TSRMLS_DC);
 
+/*
+ * Purpose : Executes an internal PHP function without looking it up by name.
+ *
+ *           The zend_function is looked up the first time it is called, and
+ *           kept for the lifetime of the process (or thread, on ZTS builds)
+ *           if it belongs to a persistent extension. The function is then
+ *           invoked directly through a prepared fcall info cache, without a
+ *           zval for its name.
+ *
+ * Params  : 1. The function to invoke.
+ *           2. The number of parameters in "params".
+ *           3. An array containing the parameter values.
+ *
+ * Returns : The returned value, or NULL if the function does not exist or
+ *           the invocation failed. This must be destroyed with
+ *           nr_php_zval_free().
+ */
+extern zval* nr_php_call_internal_func(nr_php_call_internal_t function,
+                                       zend_uint param_count,
+                                       zval* params[] TSRMLS_DC);
+
+/*
+ * Purpose : A friendlier wrapper for nr_php_call_internal_func().
+ */
+#define nr_php_call_internal(function, params...)                          \
+  ({                                                                      \
+    zval* call_params[] = {params};                                       \
+    size_t num_call_params = sizeof(call_params) / sizeof(zval*);         \
+    nr_php_call_internal_func(function, num_call_params,                  \
+                              (num_call_params > 0 ? call_params : NULL) \
+                                  TSRMLS_CC);                             \
+  })
+
 extern zval* nr_php_call_callable_zval(zval* callable,
                                        zend_uint param_count,
                                        zval* params[] TSRMLS_DC);
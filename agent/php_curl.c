@@ -558,7 +558,8 @@ static bool nr_php_curl_finished(zval* curlres TSRMLS_DC) {
     return false;
   }
 
-  result = nr_php_call(NULL, "curl_getinfo", curlres, curlinfo_http_code);
+  result = nr_php_call_internal(NR_PHP_CALL_CURL_GETINFO, curlres,
+                                curlinfo_http_code);
   if (nr_php_is_zval_valid_integer(result)) {
     finished = (0 != Z_LVAL_P(result));
   };
@@ -586,7 +587,8 @@ char* nr_php_curl_get_url(zval* curlres TSRMLS_DC) {
     return NULL;
   }
 
-  retval = nr_php_call(NULL, "curl_getinfo", curlres, curlinfo_effective_url);
+  retval = nr_php_call_internal(NR_PHP_CALL_CURL_GETINFO, curlres,
+                                curlinfo_effective_url);
   if (nr_php_is_zval_non_empty_string(retval)) {
     url = nr_strndup(Z_STRVAL_P(retval), Z_STRLEN_P(retval));
   }
@@ -606,7 +608,8 @@ uint64_t nr_php_curl_get_status_code(zval* curlres TSRMLS_DC) {
     return 0;
   }
 
-  retval = nr_php_call(NULL, "curl_getinfo", curlres, curlinfo_http_code);
+  retval = nr_php_call_internal(NR_PHP_CALL_CURL_GETINFO, curlres,
+                                curlinfo_http_code);
   if (nr_php_is_zval_valid_integer(retval)) {
     status = Z_LVAL_P(retval);
   };
@@ -616,31 +619,42 @@ uint64_t nr_php_curl_get_status_code(zval* curlres TSRMLS_DC) {
   return status;
 }
 
-/*
- * Purpose : Get the total time of a request from a curl resource
- *
- * Returns : The total time the request took, in microseconds. 0 if the
- *           total time could not be obtained.
- */
-static nrtime_t nr_php_curl_get_total_time(zval* curlres TSRMLS_DC) {
+void nr_php_curl_get_info(zval* curlres, nr_php_curl_info_t* info TSRMLS_DC) {
   zval* retval = NULL;
-  nrtime_t total_time = 0;
-  zval* curlinfo_total_time = NULL;
+  zval* value = NULL;
 
-  curlinfo_total_time = nr_php_get_constant("CURLINFO_TOTAL_TIME" TSRMLS_CC);
-  if (NULL == curlinfo_total_time) {
-    return 0;
+  if (NULL == info) {
+    return;
+  }
+
+  nr_memset(info, 0, sizeof(*info));
+
+  /*
+   * Without an option, curl_getinfo() returns all the information about the
+   * handle as an array, so that a single call is enough.
+   */
+  retval = nr_php_call_internal(NR_PHP_CALL_CURL_GETINFO, curlres);
+  if (!nr_php_is_zval_valid_array(retval)) {
+    nr_php_zval_free(&retval);
+    return;
   }
 
-  retval = nr_php_call(NULL, "curl_getinfo", curlres, curlinfo_total_time);
-  if (nr_php_is_zval_valid_double(retval)) {
-    total_time = Z_DVAL_P(retval) * NR_TIME_DIVISOR;
+  value = nr_php_zend_hash_find(Z_ARRVAL_P(retval), "url");
+  if (nr_php_is_zval_non_empty_string(value)) {
+    info->url = nr_strndup(Z_STRVAL_P(value), Z_STRLEN_P(value));
   }
 
-  nr_php_zval_free(&retval);
-  nr_php_zval_free(&curlinfo_total_time);
+  value = nr_php_zend_hash_find(Z_ARRVAL_P(retval), "http_code");
+  if (nr_php_is_zval_valid_integer(value)) {
+    info->status = Z_LVAL_P(value);
+  }
+
+  value = nr_php_zend_hash_find(Z_ARRVAL_P(retval), "total_time");
+  if (nr_php_is_zval_valid_double(value)) {
+    info->total_time = Z_DVAL_P(value) * NR_TIME_DIVISOR;
+  }
 
-  return total_time;
+  nr_php_zval_free(&retval);
 }
 
 /*
@@ -681,6 +695,7 @@ void nr_php_curl_exec_pre(zval* curlres,
 
 void nr_php_curl_exec_post(zval* curlres, bool duration_from_handle TSRMLS_DC) {
   nr_segment_external_params_t external_params = {.library = "curl"};
+  nr_php_curl_info_t info;
   nr_segment_t* segment = NULL;
 
   segment = nr_php_curl_md_get_segment(curlres TSRMLS_CC);
@@ -698,14 +713,14 @@ void nr_php_curl_exec_post(zval* curlres, bool duration_from_handle TSRMLS_DC) {
 
   external_params.procedure
       = nr_strdup(nr_php_curl_md_get_method(curlres TSRMLS_CC));
-  external_params.uri = nr_php_curl_get_url(curlres TSRMLS_CC);
-  external_params.status = nr_php_curl_get_status_code(curlres TSRMLS_CC);
+  nr_php_curl_get_info(curlres, &info TSRMLS_CC);
+  external_params.uri = info.url;
+  external_params.status = info.status;
   external_params.encoded_response_header
       = nr_strdup(nr_php_curl_md_get_response_header(curlres TSRMLS_CC));
 
   if (duration_from_handle) {
-    nr_segment_set_timing(segment, segment->start_time,
-                          nr_php_curl_get_total_time(curlres TSRMLS_CC));
+    nr_segment_set_timing(segment, segment->start_time, info.total_time);
   }
 
   nr_segment_external_end(&segment, &external_params);
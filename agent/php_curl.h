@@ -78,6 +78,26 @@ extern char* nr_php_curl_get_url(zval* curlres TSRMLS_DC);
  */
 extern uint64_t nr_php_curl_get_status_code(zval* curlres TSRMLS_DC);
 
+/*
+ * The information about a completed curl request that the agent records.
+ */
+typedef struct _nr_php_curl_info_t {
+  char* url;           /* The effective url, owned by the caller */
+  uint64_t status;     /* The HTTP status code */
+  nrtime_t total_time; /* The total time of the request, in microseconds */
+} nr_php_curl_info_t;
+
+/*
+ * Purpose : Get the url, HTTP status code and total time of a curl resource
+ *           with a single call to curl_getinfo().
+ *
+ * Params  : 1. The curl resource.
+ *           2. The information to fill in. Any field that cannot be obtained
+ *              is set to NULL or 0. The url must be freed by the caller.
+ */
+extern void nr_php_curl_get_info(zval* curlres,
+                                 nr_php_curl_info_t* info TSRMLS_DC);
+
 /*
  * Purpose : Determines whether the url for a curl resource represents a
  *           protocol that should be instrumented by the agent.
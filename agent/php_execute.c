@@ -24,6 +24,7 @@
 #include "util_memory.h"
 #include "util_metrics.h"
 #include "util_number_converter.h"
+#include "util_random.h"
 #include "util_strings.h"
 #include "util_url.h"
 #include "util_url.h"
@@ -1312,8 +1313,8 @@ static inline void nr_php_execute_segment_end(
 
   duration = nr_time_duration(stacked->start_time, stacked->stop_time);
   if (create_metric || (duration >= NR_PHP_PROCESS_GLOBALS(expensive_min))
-      || nr_vector_size(stacked->metrics) || stacked->id || stacked->attributes
-      || stacked->error) {
+      || nr_vector_size(stacked->metrics) || stacked->id[0]
+      || stacked->attributes || stacked->error) {
 
 #if ZEND_MODULE_API_NO >= ZEND_8_0_X_API_NO \
     && !defined OVERWRITE_ZEND_EXECUTE_DATA
@@ -1800,6 +1801,57 @@ end:
 #if ZEND_MODULE_API_NO >= ZEND_8_0_X_API_NO \
     && !defined OVERWRITE_ZEND_EXECUTE_DATA /* PHP8+ and OAPI */
 
+/*
+ * On average, only one in this many function call handlers is timed for the
+ * agent overhead metrics, as reading the clock on every call would add
+ * noticeable overhead of its own. Each timing is scaled by this rate, so that
+ * the Execute metric estimates the time spent in every handler.
+ */
+#define NR_PHP_EXECUTE_OVERHEAD_SAMPLE_RATE 64
+
+/*
+ * The number of handlers until the next one that is timed. Strides are drawn
+ * uniformly from [1, 2 * rate - 1], so that their mean is the sample rate
+ * but which handlers are timed does not follow the call pattern of the
+ * application.
+ */
+static inline int nr_php_execute_overhead_stride(void) {
+  return 1
+         + (int)nr_random_range(NRPRG(txn)->rnd,
+                                2 * NR_PHP_EXECUTE_OVERHEAD_SAMPLE_RATE - 1);
+}
+
+static inline bool nr_php_execute_overhead_sampled(void) {
+  if (!NRPRG(txn)->options.overhead_metrics_enabled) {
+    return false;
+  }
+
+  /* The countdown is zero at the start of each transaction. */
+  if (0 == NRTXNGLOBAL(execute_overhead_countdown)) {
+    NRTXNGLOBAL(execute_overhead_countdown) = nr_php_execute_overhead_stride();
+  }
+
+  NRTXNGLOBAL(execute_overhead_countdown) -= 1;
+  if (NRTXNGLOBAL(execute_overhead_countdown) > 0) {
+    return false;
+  }
+
+  NRTXNGLOBAL(execute_overhead_countdown) = nr_php_execute_overhead_stride();
+  return true;
+}
+
+/*
+ * The transaction may have been ended and/or restarted by the handler being
+ * timed, so it's looked up again before adding the timing.
+ */
+static inline void nr_php_execute_overhead_add(nrtime_t start) {
+  if (nrlikely(NULL != NRPRG(txn))) {
+    nr_overhead_add_sampled(&NRTXN(overhead), NR_OVERHEAD_EXECUTE,
+                            nr_time_duration(start, nr_get_time()),
+                            NR_PHP_EXECUTE_OVERHEAD_SAMPLE_RATE);
+  }
+}
+
 static void nr_php_observer_attempt_call_cufa_handler(NR_EXECUTE_PROTO) {
   NR_UNUSED_FUNC_RETURN_VALUE;
   if (NULL == execute_data->prev_execute_data) {
@@ -2159,7 +2211,15 @@ void nr_php_observer_fcall_begin(zend_execute_data* execute_data) {
   if (nrunlikely(show_executes)) {
     nr_php_show_exec(NR_EXECUTE_ORIG_ARGS);
   }
-  nr_php_instrument_func_begin(NR_EXECUTE_ORIG_ARGS);
+
+  if (nrunlikely(nr_php_execute_overhead_sampled())) {
+    nrtime_t start = nr_get_time();
+
+    nr_php_instrument_func_begin(NR_EXECUTE_ORIG_ARGS);
+    nr_php_execute_overhead_add(start);
+  } else {
+    nr_php_instrument_func_begin(NR_EXECUTE_ORIG_ARGS);
+  }
 
   return;
 }
@@ -2185,7 +2245,14 @@ void nr_php_observer_fcall_end(zend_execute_data* execute_data,
       nr_php_show_exec_return(NR_EXECUTE_ORIG_ARGS TSRMLS_CC);
     }
 
-    nr_php_instrument_func_end(NR_EXECUTE_ORIG_ARGS);
+    if (nrunlikely(nr_php_execute_overhead_sampled())) {
+      nrtime_t start = nr_get_time();
+
+      nr_php_instrument_func_end(NR_EXECUTE_ORIG_ARGS);
+      nr_php_execute_overhead_add(start);
+    } else {
+      nr_php_instrument_func_end(NR_EXECUTE_ORIG_ARGS);
+    }
   }
 
   NRPRG(php_cur_stack_depth) -= 1;
@@ -7,11 +7,13 @@
 #include "php_agent.h"
 #include "php_explain.h"
 #include "php_explain_pdo_mysql.h"
+#include "php_globals.h"
 #include "php_pdo.h"
 #include "nr_segment_datastore.h"
 #include "util_logging.h"
 #include "util_memory.h"
 #include "util_object.h"
+#include "util_sql_cache.h"
 #include "util_strings.h"
 
 nr_status_t nr_php_explain_add_value_to_row(const zval* zv, nrobj_t* row) {
@@ -173,6 +175,28 @@ nr_explain_plan_t* nr_php_explain_pdo_statement(nrtxn_t* txn,
       == nr_strncmp(nr_php_pdo_get_driver(stmt TSRMLS_CC), NR_PSTR("mysql"))) {
     nrtime_t explain_start;
     nrtime_t explain_stop;
+    uint32_t sql_id = 0;
+    bool allowed = true;
+    pdo_stmt_t* pdo_stmt = nr_php_pdo_get_statement_object(stmt TSRMLS_CC);
+
+    if (NULL != pdo_stmt) {
+#if ZEND_MODULE_API_NO >= ZEND_8_1_X_API_NO /* PHP 8.1+ */
+      const char* sql = ZSTR_VAL(pdo_stmt->query_string);
+      size_t sql_len = ZSTR_LEN(pdo_stmt->query_string);
+#else
+      const char* sql = pdo_stmt->query_string;
+      size_t sql_len = pdo_stmt->query_stringlen;
+#endif /* PHP8.1+ */
+
+      if (!nr_php_explain_mysql_query_is_explainable(sql, (int)sql_len)) {
+        return NULL;
+      }
+
+      plan = nr_php_explain_cache_get(txn, sql, sql_len, &sql_id, &allowed);
+      if (NULL != plan || !allowed) {
+        return plan;
+      }
+    }
 
     NRTXNGLOBAL(generating_explain_plan) = 1;
     explain_start = nr_get_time();
@@ -189,6 +213,8 @@ nr_explain_plan_t* nr_php_explain_pdo_statement(nrtxn_t* txn,
     nrm_force_add(txn->unscoped_metrics,
                   "Supportability/DatabaseUtils/Calls/explain_plan",
                   nr_time_duration(explain_start, explain_stop));
+
+    nr_php_explain_cache_put(sql_id, plan);
   }
 
   return plan;
@@ -198,3 +224,65 @@ int nr_php_explain_wanted(const nrtxn_t* txn, nrtime_t duration TSRMLS_DC) {
   return ((0 == NRTXNGLOBAL(generating_explain_plan))
           && nr_segment_potential_explain_plan(txn, duration));
 }
+
+nr_explain_plan_t* nr_php_explain_cache_get(const nrtxn_t* txn,
+                                            const char* sql,
+                                            size_t sql_len,
+                                            uint32_t* sql_id_ptr,
+                                            bool* allowed_ptr) {
+  nr_explain_cache_t* cache = NR_PHP_PROCESS_GLOBALS(explain_cache);
+  nr_explain_plan_t* plan = NULL;
+  nrtime_t now;
+
+  if ((NULL == sql_id_ptr) || (NULL == allowed_ptr)) {
+    return NULL;
+  }
+
+  *sql_id_ptr = 0;
+  *allowed_ptr = true;
+
+  if ((NULL == cache) || (NULL == txn) || (NULL == sql)) {
+    return NULL;
+  }
+
+  now = nr_get_time();
+
+  if (NR_PHP_PROCESS_GLOBALS(explain_cache_ttl) > 0) {
+    char* raw = nr_strndup(sql, sql_len);
+    nr_sql_analysis_t analysis;
+
+    if (nr_sql_analyse(NR_PHP_PROCESS_GLOBALS(sql_cache), raw, 0,
+                       NR_SQL_ANALYSIS_OBFUSCATED, &analysis)) {
+      *sql_id_ptr = analysis.normalized_id;
+      nr_sql_analysis_deinit(&analysis);
+    }
+    nr_free(raw);
+
+    plan = nr_explain_cache_get(cache, *sql_id_ptr, now);
+    if (NULL != plan) {
+      nrm_force_add(txn->unscoped_metrics,
+                    "Supportability/DatabaseUtils/ExplainCache/Hit", 0);
+      return plan;
+    }
+
+    nrm_force_add(txn->unscoped_metrics,
+                  "Supportability/DatabaseUtils/ExplainCache/Miss", 0);
+  }
+
+  if (!nr_explain_cache_allow(cache, now)) {
+    *allowed_ptr = false;
+    nrm_force_add(txn->unscoped_metrics,
+                  "Supportability/DatabaseUtils/ExplainBudget/Exhausted", 0);
+  }
+
+  return NULL;
+}
+
+void nr_php_explain_cache_put(uint32_t sql_id, const nr_explain_plan_t* plan) {
+  if ((0 == sql_id) || (NULL == plan)) {
+    return;
+  }
+
+  nr_explain_cache_put(NR_PHP_PROCESS_GLOBALS(explain_cache), sql_id, plan,
+                       nr_get_time());
+}
@@ -11,6 +11,11 @@
 
 #include "nr_explain.h"
 
+/*
+ * The maximum number of explain plans cached per process.
+ */
+#define NR_PHP_EXPLAIN_CACHE_MAX_PLANS 1000
+
 /*
  * Purpose : Add a value to an explain plan row.
  *
@@ -65,4 +70,33 @@ extern nr_explain_plan_t* nr_php_explain_pdo_statement(nrtxn_t* txn,
 extern int nr_php_explain_wanted(const nrtxn_t* txn,
                                  nrtime_t duration TSRMLS_DC);
 
+/*
+ * Purpose : Look up the per-process explain plan cache before issuing an
+ *           explain query, and check the per-minute explain budget.
+ *
+ * Params  : 1. The transaction.
+ *           2. The query.
+ *           3. The length of the query.
+ *           4. Receives the normalized id of the query, to be passed to
+ *              nr_php_explain_cache_put, or 0 if plans are not cached.
+ *           5. Receives whether an explain query may be issued.
+ *
+ * Returns : A cached explain plan, which the caller owns, or NULL if there is
+ *           none.
+ */
+extern nr_explain_plan_t* nr_php_explain_cache_get(const nrtxn_t* txn,
+                                                   const char* sql,
+                                                   size_t sql_len,
+                                                   uint32_t* sql_id_ptr,
+                                                   bool* allowed_ptr);
+
+/*
+ * Purpose : Add a newly generated explain plan to the per-process cache.
+ *
+ * Params  : 1. The normalized id returned by nr_php_explain_cache_get.
+ *           2. The explain plan. The cache stores a copy.
+ */
+extern void nr_php_explain_cache_put(uint32_t sql_id,
+                                     const nr_explain_plan_t* plan);
+
 #endif /* PHP_EXPLAIN_HDR */
@@ -101,6 +101,8 @@ nr_explain_plan_t* nr_php_explain_mysqli_query(const nrtxn_t* txn,
   nrtime_t duration;
   nr_explain_plan_t* plan = NULL;
   char* query;
+  uint32_t sql_id = 0;
+  bool allowed = true;
 
   if ((NULL == txn) || (NULL == sql)) {
     return NULL;
@@ -119,10 +121,18 @@ nr_explain_plan_t* nr_php_explain_mysqli_query(const nrtxn_t* txn,
     return NULL;
   }
 
+  plan = nr_php_explain_cache_get(txn, sql, (size_t)sql_len, &sql_id,
+                                  &allowed);
+  if (NULL != plan || !allowed) {
+    return plan;
+  }
+
   query = nr_strndup(sql, sql_len);
   plan = nr_php_explain_mysqli_issue(link, 0, query TSRMLS_CC);
   nr_free(query);
 
+  nr_php_explain_cache_put(sql_id, plan);
+
   return plan;
 }
 
@@ -134,6 +144,8 @@ nr_explain_plan_t* nr_php_explain_mysqli_stmt(const nrtxn_t* txn,
   zval* link = NULL;
   nr_explain_plan_t* plan = NULL;
   char* query = NULL;
+  uint32_t sql_id = 0;
+  bool allowed = true;
 
   if ((NULL == txn)) {
     return NULL;
@@ -155,9 +167,18 @@ nr_explain_plan_t* nr_php_explain_mysqli_stmt(const nrtxn_t* txn,
     return NULL;
   }
 
+  plan = nr_php_explain_cache_get(txn, query, nr_strlen(query), &sql_id,
+                                  &allowed);
+  if (NULL != plan || !allowed) {
+    nr_free(query);
+    return plan;
+  }
+
   plan = nr_php_explain_mysqli_issue(link, handle, query TSRMLS_CC);
   nr_free(query);
 
+  nr_php_explain_cache_put(sql_id, plan);
+
   return plan;
 }
 
@@ -42,6 +42,10 @@ static void nr_php_per_process_globals_dispose(void) {
   nr_free(nr_php_per_process_globals.env_labels);
   nr_free(nr_php_per_process_globals.apache_add);
   nr_free(nr_php_per_process_globals.docker_id);
+  nr_slab_page_pool_destroy(&nr_php_per_process_globals.segment_page_pool);
+  nr_explain_cache_destroy(&nr_php_per_process_globals.explain_cache);
+  nr_sql_cache_destroy(&nr_php_per_process_globals.sql_cache);
+  nr_txndata_encoder_destroy(&nr_php_per_process_globals.txndata_encoder);
 
   nr_memset(&nr_php_per_process_globals, 0, sizeof(nr_php_per_process_globals));
 }
@@ -7,6 +7,9 @@
 #ifndef PHP_GLOBALS_HDR
 #define PHP_GLOBALS_HDR
 
+#include "nr_commands.h"
+#include "nr_explain.h"
+
 /*
  * Per-process globals. These are all stored in a single data structure rather
  * that having lots of external variables. This makes the namespace cleaner
@@ -31,6 +34,7 @@ typedef struct _nrphpglobals_t {
   char* daemon_app_timeout; /* Daemon application inactivity timeout */
   nrtime_t
       daemon_app_connect_timeout; /* Daemon application connection timeout */
+  int daemon_shared_app_cache;    /* newrelic.daemon.shared_app_cache */
   char* daemon_start_timeout;     /* Daemon startup timeout */
   char* udspath;      /* Legacy path for daemon, set by newrelic.daemon.port */
   char* address_path; /* Path for daemon, set by newrelic.daemon.address */
@@ -76,6 +80,25 @@ typedef struct _nrphpglobals_t {
   int preload_framework_library_detection; /* Enables preloading framework and
                                               library detection */
   char* docker_id; /* 64 byte hex docker ID parsed from /proc/self/mountinfo */
+  size_t segment_page_pool_size; /* newrelic.transaction_tracer.
+                                    segment_page_pool_size */
+  nr_slab_page_pool_t* segment_page_pool; /* Pool of segment slab pages shared
+                                             by all transactions */
+  nrtime_t explain_cache_ttl; /* newrelic.transaction_tracer.explain_cache_ttl
+                               */
+  uint64_t explain_max_per_minute; /* newrelic.transaction_tracer.
+                                      explain_max_per_minute */
+  nr_explain_cache_t* explain_cache; /* Explain plans shared by all
+                                        transactions */
+  size_t sql_cache_size;     /* newrelic.transaction_tracer.sql_cache_size */
+  nr_sql_cache_t* sql_cache; /* SQL analysis results shared by all
+                                transactions */
+  nr_txndata_encoder_t* txndata_encoder; /* Buffer reused to encode every
+                                           TXNDATA message */
+  size_t txn_batch_size; /* newrelic.transaction_batch.size */
+  nrtime_t txn_batch_flush_interval; /* newrelic.transaction_batch.
+                                        flush_interval */
+  int span_stream_count; /* newrelic.infinite_tracing.span_events.streams */
 
   /* Original PHP callback pointer contents */
   nrphperrfn_t orig_error_cb;
@@ -34,6 +34,7 @@
 #include "util_strings.h"
 #include "util_url.h"
 
+#include "fw_wordpress.h"
 #include "lib_doctrine2.h"
 
 /*
@@ -2985,6 +2986,19 @@ NR_INNER_WRAPPER(dl) {
   }
 }
 
+/*
+ * Handle
+ *   bool opcache_reset ( void )
+ *
+ * Framework caches that are kept across requests are discarded when opcache
+ * is reset, since that usually accompanies a deployment.
+ */
+NR_INNER_WRAPPER(opcache_reset) {
+  nr_wrapper->oldhandler(INTERNAL_FUNCTION_PARAM_PASSTHRU);
+
+  nr_wordpress_caches_invalidate();
+}
+
 static inline int nr_php_should_instrument_exception_handler(
     zval* handler TSRMLS_DC) {
   if (0 == NRINI(ignore_user_exception_handler)) {
@@ -3373,6 +3387,8 @@ NR_OUTER_WRAPPER(soapclient_dorequest)
 
 NR_OUTER_WRAPPER(dl)
 
+NR_OUTER_WRAPPER(opcache_reset)
+
 NR_OUTER_WRAPPER(set_exception_handler)
 NR_OUTER_WRAPPER(restore_exception_handler)
 
@@ -3941,6 +3957,8 @@ void nr_php_generate_internal_wrap_records(void) {
 
   NR_INTERNAL_WRAPREC("dl", dl, dl, 0, 0)
 
+  NR_INTERNAL_WRAPREC("opcache_reset", opcache_reset, opcache_reset, 0, 0)
+
   NR_INTERNAL_WRAPREC("set_exception_handler", set_exception_handler,
                       exception_common, 0, 0)
   NR_INTERNAL_WRAPREC("restore_exception_handler", restore_exception_handler,
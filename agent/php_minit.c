@@ -12,6 +12,7 @@
 #include "php_api_distributed_trace.h"
 #include "php_environment.h"
 #include "php_error.h"
+#include "php_explain.h"
 #include "php_extension.h"
 #include "php_globals.h"
 #include "php_header.h"
@@ -124,6 +125,21 @@ PHP_GSHUTDOWN_FUNCTION(newrelic) {
    * cope with an uninitialised extensions structure.
    */
   nr_php_extension_instrument_destroy(&newrelic_globals->extensions);
+
+  /*
+   * The WordPress caches are also kept across requests, and are created the
+   * first time a WordPress hook is seen.
+   */
+  nr_hashmap_destroy(&newrelic_globals->wordpress_file_metadata);
+  nr_hashmap_destroy(&newrelic_globals->wordpress_clean_tag_cache);
+
+  /*
+   * As is the Composer package inventory.
+   */
+  nr_free(newrelic_globals->composer_vendor_path);
+  nr_php_packages_destroy(&newrelic_globals->composer_packages);
+  nr_free(newrelic_globals->composer_packages_run_id);
+  nr_free(newrelic_globals->composer_packages_queued_run_id);
 }
 
 #if defined(__GNUC__)
@@ -651,6 +667,45 @@ PHP_MINIT_FUNCTION(newrelic) {
   nr_php_check_logging_config(TSRMLS_C);
   nr_php_check_high_security_log_forwarding(TSRMLS_C);
 
+  /*
+   * Segment slab pages are kept for the lifetime of the process and shared by
+   * all transactions, rather than being allocated and freed for each one.
+   */
+  NR_PHP_PROCESS_GLOBALS(segment_page_pool) = nr_slab_page_pool_create(
+      NR_PHP_PROCESS_GLOBALS(segment_page_pool_size));
+
+  /*
+   * Explain plans are cached by normalized SQL for all transactions in the
+   * process, so that slow queries do not need to be explained every time.
+   */
+  NR_PHP_PROCESS_GLOBALS(explain_cache) = nr_explain_cache_create(
+      NR_PHP_EXPLAIN_CACHE_MAX_PLANS,
+      NR_PHP_PROCESS_GLOBALS(explain_cache_ttl),
+      NR_PHP_PROCESS_GLOBALS(explain_max_per_minute));
+
+  /*
+   * The same statements tend to be executed over and over again, so the
+   * results of analysing them are kept for all transactions in the process.
+   */
+  NR_PHP_PROCESS_GLOBALS(sql_cache)
+      = nr_sql_cache_create(NR_PHP_PROCESS_GLOBALS(sql_cache_size));
+
+  /*
+   * Transactions in a process tend to be of similar sizes, so the buffer they
+   * are encoded into is kept from one to the next.
+   */
+  NR_PHP_PROCESS_GLOBALS(txndata_encoder) = nr_txndata_encoder_create();
+
+  /*
+   * Worker processes forked from this one share the applications they
+   * connect, so that new workers can record transactions without first
+   * querying the daemon. This is only useful if the process forks.
+   */
+  if ((0 == NR_PHP_PROCESS_GLOBALS(cli))
+      && NR_PHP_PROCESS_GLOBALS(daemon_shared_app_cache)) {
+    nr_agent_app_cache = nr_app_cache_create();
+  }
+
   /*
    * Save the original PHP hooks and then apply our own hooks. The agent is
    * almost fully operational now. The last remaining initialization that
@@ -55,6 +55,7 @@ PHP_MSHUTDOWN_FUNCTION(newrelic) {
   nr_php_destroy_user_wrap_records();
   nr_php_global_destroy();
   nr_applist_destroy(&nr_agent_applist);
+  nr_app_cache_destroy(&nr_agent_app_cache);
 
   return SUCCESS;
 }
@@ -10,6 +10,7 @@
 #define PHP_NEWRELIC_HDR
 
 #include "nr_banner.h"
+#include "nr_commands.h"
 #include "nr_mysqli_metadata.h"
 #include "nr_segment.h"
 #include "nr_txn.h"
@@ -280,6 +281,15 @@ typedef void (*nr_php_execute_internal_function_t)(
     int return_value_used TSRMLS_DC);
 #endif
 
+/*
+ * Internal PHP functions that the agent calls through
+ * nr_php_call_internal_func(), which caches the resolved zend_function.
+ */
+typedef enum _nr_php_call_internal_t {
+  NR_PHP_CALL_CURL_GETINFO,
+  NR_PHP_CALL_INTERNAL_COUNT /* Must be last */
+} nr_php_call_internal_t;
+
 typedef struct _nr_php_ini_attribute_config_t {
   nrinibool_t enabled;
   nrinistr_t include;
@@ -398,6 +408,8 @@ nriniuint_t
     tt_max_segments_web; /* newrelic.transaction_tracer.max_segments_web */
 nriniuint_t
     tt_max_segments_cli; /* newrelic.transaction_tracer.max_segments_cli */
+nrinibool_t tt_incremental_finalise; /* newrelic.transaction_tracer.
+                                        incremental_finalise */
 nrinibool_t tt_slowsql;  /* newrelic.transaction_tracer.slow_sql */
 zend_bool tt_threshold_is_apdex_f; /* True if threshold is apdex_f */
 nrinitime_t tt_threshold;          /* newrelic.transaction_tracer.threshold */
@@ -470,8 +482,24 @@ nr_matcher_t* wordpress_plugin_matcher; /* Matcher for plugin filenames */
 nr_matcher_t* wordpress_theme_matcher;  /* Matcher for theme filenames */
 nr_matcher_t* wordpress_core_matcher;   /* Matcher for plugin filenames */
 nr_hashmap_t* wordpress_file_metadata;  /* Metadata for plugin and theme names
-                                           given a filename */
-nr_hashmap_t* wordpress_clean_tag_cache; /* Cached clean tags */                                           
+                                           given a filename; kept across
+                                           requests */
+nr_hashmap_t* wordpress_clean_tag_cache; /* Cached clean tags; kept across
+                                            requests */
+bool wordpress_caches_invalid; /* Whether the WordPress caches above must be
+                                  discarded at the end of the request */
+
+char* composer_vendor_path; /* Vendor path of the cached Composer package
+                               inventory; kept across requests */
+time_t composer_installed_mtime; /* mtime of vendor/composer/installed.php
+                                    when the inventory was gathered */
+nr_php_packages_t* composer_packages; /* Cached Composer package inventory;
+                                         kept across requests */
+char* composer_packages_run_id; /* Agent run ID the cached inventory was last
+                                   sent to the daemon with, or NULL */
+char* composer_packages_queued_run_id; /* Agent run ID of a batched, not yet
+                                          sent, transaction that carries the
+                                          cached inventory, or NULL */
 
 char* doctrine_dql; /* The current Doctrine DQL. Only non-NULL while a Doctrine
                        object is on the stack. */
@@ -574,6 +602,12 @@ nrinibool_t
 nriniuint_t
     log_events_max_samples_stored; /* newrelic.application_logging.forwarding.max_samples_stored
                                     */
+nriniuint_t
+    log_forwarding_max_per_request; /* newrelic.application_logging.forwarding.max_per_request
+                                     */
+nriniuint_t
+    log_forwarding_max_message_length; /* newrelic.application_logging.forwarding.max_message_length
+                                        */
 nrinibool_t
     log_metrics_enabled; /* newrelic.application_logging.metrics.enabled */
 
@@ -602,6 +636,20 @@ nrinibool_t
 nrinibool_t
     message_tracer_segment_parameters_enabled; /* newrelic.segment_tracer.segment_parameters.enabled */
 
+/*
+ * Configuration options for measuring the overhead of the agent itself
+ */
+nrinibool_t overhead_metrics_enabled;   /* newrelic.overhead.metrics.enabled */
+nrinibool_t overhead_attribute_enabled; /* newrelic.overhead.attribute.enabled
+                                         */
+
+nr_overhead_t overhead; /* Overhead measured after the last transaction was
+                           sent, reported with the next transaction */
+
+nr_txndata_batch_t* txn_batch; /* Transactions ended in this request that have
+                                  not yet been sent to the daemon */
+int txn_batch_pid;             /* Process that created txn_batch */
+
 #if ZEND_MODULE_API_NO < ZEND_7_4_X_API_NO
 /*
  * pid and user_function_wrappers are used to store user function wrappers.
@@ -612,6 +660,10 @@ uint64_t pid;
 nr_vector_t* user_function_wrappers;
 #endif
 
+zend_function* internal_functions[NR_PHP_CALL_INTERNAL_COUNT]; /* Internal
+                  functions called by the agent, resolved on first use. See
+                  nr_php_call_internal_func(). */
+
 nrapp_t* app; /* The application used in the last attempt to initialize a
                  transaction */
 
@@ -637,6 +689,8 @@ nrcallbackfn_t error_group_user_callback; /* The user defined callback for
  */
 struct {
   int execute_count; /* How many times nr_php_execute_enabled was called */
+  int execute_overhead_countdown; /* Function call handlers until the next
+                                     one timed for the overhead metrics */
   int generating_explain_plan; /* Are we currently working on an explain plan?
                                 */
   nr_hashmap_t* guzzle_objs; /* Guzzle request object storage: requests that are
@@ -13,6 +13,7 @@
 #include "nr_configstrings.h"
 #include "nr_limits.h"
 #include "nr_version.h"
+#include "nr_log_event.h"
 #include "nr_log_level.h"
 #include "util_buffer.h"
 #include "util_json.h"
@@ -759,6 +760,112 @@ static PHP_INI_MH(nr_daemon_app_timeout_mh) {
   return SUCCESS;
 }
 
+static PHP_INI_MH(nr_segment_page_pool_size_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(segment_page_pool_size)
+        = (size_t)strtoul(NEW_VALUE, 0, 0);
+  } else {
+    NR_PHP_PROCESS_GLOBALS(segment_page_pool_size) = 0;
+  }
+
+  return SUCCESS;
+}
+
+static PHP_INI_MH(nr_explain_cache_ttl_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(explain_cache_ttl)
+        = (nrtime_t)strtoul(NEW_VALUE, 0, 0) * NR_TIME_DIVISOR;
+  } else {
+    NR_PHP_PROCESS_GLOBALS(explain_cache_ttl) = 0;
+  }
+
+  return SUCCESS;
+}
+
+static PHP_INI_MH(nr_explain_max_per_minute_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(explain_max_per_minute)
+        = (uint64_t)strtoull(NEW_VALUE, 0, 0);
+  } else {
+    NR_PHP_PROCESS_GLOBALS(explain_max_per_minute) = 0;
+  }
+
+  return SUCCESS;
+}
+
+static PHP_INI_MH(nr_sql_cache_size_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(sql_cache_size) = (size_t)strtoul(NEW_VALUE, 0, 0);
+  } else {
+    NR_PHP_PROCESS_GLOBALS(sql_cache_size) = 0;
+  }
+
+  return SUCCESS;
+}
+
+static PHP_INI_MH(nr_txn_batch_size_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(txn_batch_size) = (size_t)strtoul(NEW_VALUE, 0, 0);
+  } else {
+    NR_PHP_PROCESS_GLOBALS(txn_batch_size) = 0;
+  }
+
+  return SUCCESS;
+}
+
+static PHP_INI_MH(nr_txn_batch_flush_interval_mh) {
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN && '-' != NEW_VALUE[0]) {
+    NR_PHP_PROCESS_GLOBALS(txn_batch_flush_interval)
+        = (nrtime_t)strtoul(NEW_VALUE, 0, 0) * NR_TIME_DIVISOR_MS;
+  } else {
+    NR_PHP_PROCESS_GLOBALS(txn_batch_flush_interval) = 0;
+  }
+
+  return SUCCESS;
+}
+
 static PHP_INI_MH(nr_daemon_app_connect_timeout_mh) {
   (void)entry;
   (void)mh_arg1;
@@ -777,6 +884,28 @@ static PHP_INI_MH(nr_daemon_app_connect_timeout_mh) {
   return SUCCESS;
 }
 
+static PHP_INI_MH(nr_daemon_shared_app_cache_mh) {
+  int val;
+
+  (void)entry;
+  (void)NEW_VALUE_LEN;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  val = nr_bool_from_str(NEW_VALUE);
+
+  if (-1 == val) {
+    return FAILURE;
+  }
+
+  NR_PHP_PROCESS_GLOBALS(daemon_shared_app_cache) = val ? 1 : 0;
+
+  return SUCCESS;
+}
+
 static PHP_INI_MH(nr_daemon_start_timeout_mh) {
   const char* local_new_value = NULL;
   (void)entry;
@@ -1441,6 +1570,25 @@ static PHP_INI_MH(nr_span_queue_size_mh) {
   return SUCCESS;
 }
 
+static PHP_INI_MH(nr_span_stream_count_mh) {
+  int val = 1;
+
+  (void)entry;
+  (void)mh_arg1;
+  (void)mh_arg2;
+  (void)mh_arg3;
+  (void)stage;
+  NR_UNUSED_TSRMLS;
+
+  if (0 != NEW_VALUE_LEN) {
+    val = (int)strtol(NEW_VALUE, 0, 0);
+    check_ini_int_min_max(&val, 1, NR_MAX_8T_SPAN_STREAMS);
+  }
+  NR_PHP_PROCESS_GLOBALS(span_stream_count) = val;
+
+  return SUCCESS;
+}
+
 static PHP_INI_MH(nr_max_nesting_level_mh) {
   nriniuint_t* p;
   int val = 1;
@@ -1808,6 +1956,47 @@ static PHP_INI_MH(nr_log_events_max_samples_stored_mh) {
   return SUCCESS;
 }
 
+static PHP_INI_MH(nr_log_forwarding_max_message_length_mh) {
+  nriniuint_t* p;
+  int val = NR_MAX_LOG_MESSAGE_LEN;
+  nr_status_t parse_status = NR_SUCCESS;
+
+#ifndef ZTS
+  char* base = (char*)mh_arg2;
+#else
+  char* base = (char*)ts_resource(*((int*)mh_arg2));
+#endif
+
+  p = (nriniuint_t*)(base + (size_t)mh_arg1);
+
+  (void)entry;
+  (void)mh_arg3;
+  NR_UNUSED_TSRMLS;
+
+  /*
+   * -- An invalid value or a value < 1 will result in the default value.
+   * -- A value > MAX will result in MAX value
+   */
+
+  p->where = 0;
+
+  if (0 != NEW_VALUE_LEN) {
+    parse_status = nr_strtoi(&val, NEW_VALUE, 0);
+    if (1 > val || NR_FAILURE == parse_status
+        || NR_MAX_LOG_MESSAGE_LEN < val) {
+      val = NR_MAX_LOG_MESSAGE_LEN;
+      nrl_warning(NRL_INIT,
+                  "Invalid application_logging.forwarding.max_message_length "
+                  "value \"%.8s\"; using %d instead",
+                  NEW_VALUE, val);
+    }
+  }
+  p->value = (zend_uint)val;
+  p->where = stage;
+
+  return SUCCESS;
+}
+
 static PHP_INI_MH(nr_log_forwarding_log_level_mh) {
   nriniuint_t* p;
   int log_level = LOG_LEVEL_DEFAULT;
@@ -2028,6 +2217,64 @@ PHP_INI_ENTRY_EX("newrelic.preload_framework_library_detection",
                  nr_preload_framework_library_detection_mh,
                  0)
 
+/*
+ * The maximum number of bytes of segment slab pages retained per process.
+ */
+PHP_INI_ENTRY_EX("newrelic.transaction_tracer.segment_page_pool_size",
+                 "1048576",
+                 NR_PHP_SYSTEM,
+                 nr_segment_page_pool_size_mh,
+                 0)
+
+/*
+ * Explain plan caching and rate limiting, shared by all transactions in the
+ * process.
+ */
+PHP_INI_ENTRY_EX("newrelic.transaction_tracer.explain_cache_ttl",
+                 "0",
+                 NR_PHP_SYSTEM,
+                 nr_explain_cache_ttl_mh,
+                 0)
+PHP_INI_ENTRY_EX("newrelic.transaction_tracer.explain_max_per_minute",
+                 "0",
+                 NR_PHP_SYSTEM,
+                 nr_explain_max_per_minute_mh,
+                 0)
+
+/*
+ * The maximum number of SQL statements whose analysis is cached per process.
+ */
+PHP_INI_ENTRY_EX("newrelic.transaction_tracer.sql_cache_size",
+                 "500",
+                 NR_PHP_SYSTEM,
+                 nr_sql_cache_size_mh,
+                 0)
+
+/*
+ * Transactions ended within a single request, such as those of queue workers,
+ * may be sent to the daemon in batches.
+ */
+PHP_INI_ENTRY_EX("newrelic.transaction_batch.size",
+                 "0",
+                 NR_PHP_SYSTEM,
+                 nr_txn_batch_size_mh,
+                 0)
+PHP_INI_ENTRY_EX("newrelic.transaction_batch.flush_interval",
+                 "1000",
+                 NR_PHP_SYSTEM,
+                 nr_txn_batch_flush_interval_mh,
+                 0)
+
+/*
+ * The daemon opens the Infinite Tracing streams once per application, so like
+ * the daemon settings, the number of streams can't vary by directory.
+ */
+PHP_INI_ENTRY_EX("newrelic.infinite_tracing.span_events.streams",
+                 "1",
+                 NR_PHP_SYSTEM,
+                 nr_span_stream_count_mh,
+                 0)
+
 /*
  * Daemon
  */
@@ -2103,6 +2350,11 @@ PHP_INI_ENTRY_EX("newrelic.daemon.app_connect_timeout",
                  NR_PHP_SYSTEM,
                  nr_daemon_app_connect_timeout_mh,
                  0)
+PHP_INI_ENTRY_EX("newrelic.daemon.shared_app_cache",
+                 "0",
+                 NR_PHP_SYSTEM,
+                 nr_daemon_shared_app_cache_mh,
+                 0)
 PHP_INI_ENTRY_EX("newrelic.daemon.start_timeout",
                  "",
                  NR_PHP_SYSTEM,
@@ -2450,6 +2702,14 @@ STD_PHP_INI_ENTRY_EX("newrelic.transaction_tracer.max_segments_web",
                      zend_newrelic_globals,
                      newrelic_globals,
                      0)
+STD_PHP_INI_ENTRY_EX("newrelic.transaction_tracer.incremental_finalise",
+                     "0",
+                     NR_PHP_REQUEST,
+                     nr_boolean_mh,
+                     tt_incremental_finalise,
+                     zend_newrelic_globals,
+                     newrelic_globals,
+                     nr_enabled_disabled_dh)
 STD_PHP_INI_ENTRY_EX("newrelic.transaction_tracer.slow_sql",
                      "1",
                      NR_PHP_REQUEST,
@@ -3038,6 +3298,23 @@ STD_PHP_INI_ENTRY_EX(
     zend_newrelic_globals,
     newrelic_globals,
     0)
+STD_PHP_INI_ENTRY_EX("newrelic.application_logging.forwarding.max_per_request",
+                     "0",
+                     NR_PHP_REQUEST,
+                     nr_unsigned_int_mh,
+                     log_forwarding_max_per_request,
+                     zend_newrelic_globals,
+                     newrelic_globals,
+                     0)
+STD_PHP_INI_ENTRY_EX(
+    "newrelic.application_logging.forwarding.max_message_length",
+    NR_STR2(NR_MAX_LOG_MESSAGE_LEN),
+    NR_PHP_REQUEST,
+    nr_log_forwarding_max_message_length_mh,
+    log_forwarding_max_message_length,
+    zend_newrelic_globals,
+    newrelic_globals,
+    0)
 STD_PHP_INI_ENTRY_EX("newrelic.application_logging.forwarding.log_level",
                      "WARNING",
                      NR_PHP_REQUEST,
@@ -3111,6 +3388,26 @@ STD_PHP_INI_ENTRY_EX("newrelic.message_tracer.segment_parameters.enabled",
                      zend_newrelic_globals,
                      newrelic_globals,
                      nr_enabled_disabled_dh)
+
+/*
+ * Agent overhead
+ */
+STD_PHP_INI_ENTRY_EX("newrelic.overhead.metrics.enabled",
+                     "1",
+                     NR_PHP_REQUEST,
+                     nr_boolean_mh,
+                     overhead_metrics_enabled,
+                     zend_newrelic_globals,
+                     newrelic_globals,
+                     nr_enabled_disabled_dh)
+STD_PHP_INI_ENTRY_EX("newrelic.overhead.attribute.enabled",
+                     "0",
+                     NR_PHP_REQUEST,
+                     nr_boolean_mh,
+                     overhead_attribute_enabled,
+                     zend_newrelic_globals,
+                     newrelic_globals,
+                     nr_enabled_disabled_dh)
 PHP_INI_END() /* } */
 
 void nr_php_register_ini_entries(int module_number TSRMLS_DC) {
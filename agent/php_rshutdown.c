@@ -12,6 +12,7 @@
 #include "php_globals.h"
 #include "php_user_instrument.h"
 #include "php_wrapper.h"
+#include "fw_wordpress.h"
 #include "util_logging.h"
 #include "lib_guzzle4.h"
 
@@ -77,6 +78,7 @@ PHP_RSHUTDOWN_FUNCTION(newrelic) {
  */
 int nr_php_post_deactivate(void) {
   TSRMLS_FETCH();
+  nrtime_t cleanup_start;
 
   nrl_verbosedebug(NRL_INIT, "post-deactivate processing started");
 
@@ -99,6 +101,9 @@ int nr_php_post_deactivate(void) {
   if (nrlikely(0 != NRPRG(txn))) {
     (void)nr_php_txn_end(0, 1 TSRMLS_CC);
   }
+  nr_php_txn_batch_flush(TSRMLS_C);
+
+  cleanup_start = nr_get_time();
 
   nr_php_remove_transient_user_instrumentation();
 
@@ -107,8 +112,7 @@ int nr_php_post_deactivate(void) {
   nr_matcher_destroy(&NRPRG(wordpress_plugin_matcher));
   nr_matcher_destroy(&NRPRG(wordpress_core_matcher));
   nr_matcher_destroy(&NRPRG(wordpress_theme_matcher));
-  nr_hashmap_destroy(&NRPRG(wordpress_file_metadata));
-  nr_hashmap_destroy(&NRPRG(wordpress_clean_tag_cache));
+  nr_wordpress_caches_rshutdown();
 
   nr_free(NRPRG(mysql_last_conn));
   nr_free(NRPRG(pgsql_last_conn));
@@ -148,6 +152,8 @@ int nr_php_post_deactivate(void) {
   NRPRG(drupal_http_request_segment) = NULL;
 #endif
 
+  nr_overhead_add_since(&NRPRG(overhead), NR_OVERHEAD_RSHUTDOWN, cleanup_start);
+
   nrl_verbosedebug(NRL_INIT, "post-deactivate processing done");
   return SUCCESS;
 }
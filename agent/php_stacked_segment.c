@@ -46,8 +46,6 @@ void nr_php_stacked_segment_deinit(nr_segment_t* stacked TSRMLS_DC) {
   }
   nr_segment_children_reparent(&stacked->children, stacked->parent);
 
-  nr_free(stacked->id);
-
   NR_PHP_CURRENT_STACKED_POP(stacked);
 }
 
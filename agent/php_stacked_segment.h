@@ -55,8 +55,8 @@
  *
  *   - nr_php_stacked_segment_init        - nr_php_stacked_segment_discard
  *     - 3 value changes                    - reparent children (3 if checks)
- *     - get start time                     - 1 if check for segment->id
- *     - init children (2 value changes)    - 1 value change
+ *     - get start time                     - 1 value change
+ *     - init children (2 value changes)
  *
  * This simplified behavior saves us a lot, as especially in real-world
  * applications we are dealing with lots of short running segments that
@@ -82,9 +82,9 @@
  *    the metrics vector is not initialized.
  *  - We avoid lots of sanity if-checks happening throughout the
  *    nr_segment_* call stack.
- *  - Effective destroying due to context. Only segment->id can reasonably be
- *    allocated for segments we're dealing with here. No other nr_free
- *    calls are needed.
+ *  - Effective destroying due to context. The segment id is stored inline
+ *    and nothing else can reasonably be allocated for segments we're dealing
+ *    with here, so no nr_free calls are needed.
  *
  * The workflow of using stacked segments in connection with regular
  * segments is complicated. It's best illustrated by a short ASCII
@@ -24,6 +24,7 @@
 #include "nr_segment_children.h"
 #include "nr_txn.h"
 #include "nr_version.h"
+#include "fw_hooks.h"
 #include "fw_support.h"
 #include "util_labels.h"
 #include "util_logging.h"
@@ -32,6 +33,7 @@
 #include "util_number_converter.h"
 #include "util_sleep.h"
 #include "util_strings.h"
+#include "util_syscalls.h"
 
 static void nr_php_collect_x_request_start(TSRMLS_D) {
   char* x_request_start;
@@ -757,6 +759,56 @@ void nr_php_txn_create_packages_major_metrics(nrtxn_t* txn) {
                           nr_php_txn_php_package_create_major_metric, txn);
 }
 
+static void nr_php_txn_create_segment_page_pool_metrics(nrtxn_t* txn) {
+  nr_slab_page_pool_stats_t stats;
+
+  if (!nr_slab_page_pool_take_stats(txn->options.segment_page_pool, &stats)) {
+    return;
+  }
+
+  nrm_force_add(txn->unscoped_metrics,
+                "Supportability/PHP/SegmentPagePool/Hits", stats.hits);
+  nrm_force_add(txn->unscoped_metrics,
+                "Supportability/PHP/SegmentPagePool/Misses", stats.misses);
+  nrm_force_add(txn->unscoped_metrics,
+                "Supportability/PHP/SegmentPagePool/RetainedBytes",
+                stats.retained_bytes);
+}
+
+static void nr_php_txn_create_sql_cache_metrics(nrtxn_t* txn) {
+  nr_sql_cache_stats_t stats;
+
+  if (!nr_sql_cache_take_stats(txn->options.sql_cache, &stats)) {
+    return;
+  }
+
+  nrm_force_add(txn->unscoped_metrics, "Supportability/PHP/SQLCache/Hits",
+                stats.hits);
+  nrm_force_add(txn->unscoped_metrics, "Supportability/PHP/SQLCache/Misses",
+                stats.misses);
+  nrm_force_add(txn->unscoped_metrics, "Supportability/PHP/SQLCache/Size",
+                stats.size);
+}
+
+/*
+ * The statistics cover the transactions sent since the previous call, so they
+ * describe earlier transactions in the process rather than this one.
+ */
+static void nr_php_txn_create_txndata_encoder_metrics(nrtxn_t* txn) {
+  nr_txndata_encoder_stats_t stats;
+
+  if (!nr_txndata_encoder_take_stats(NR_PHP_PROCESS_GLOBALS(txndata_encoder),
+                                     &stats)
+      || 0 == stats.messages) {
+    return;
+  }
+
+  nrm_force_add(txn->unscoped_metrics,
+                "Supportability/PHP/TxnDataEncoder/Reallocs", stats.reallocs);
+  nrm_force_add(txn->unscoped_metrics,
+                "Supportability/PHP/TxnDataEncoder/Capacity", stats.capacity);
+}
+
 nr_status_t nr_php_txn_begin(const char* appnames,
                              const char* license TSRMLS_DC) {
   nrtxnopt_t opts;
@@ -765,6 +817,7 @@ nr_status_t nr_php_txn_begin(const char* appnames,
   nr_attribute_config_t* attribute_config;
   nr_app_info_t info;
   bool is_cli = (0 != NR_PHP_PROCESS_GLOBALS(cli));
+  nrtime_t begin_start = nr_get_time();
 
   if ((0 == NR_PHP_PROCESS_GLOBALS(enabled)) || (0 == NRINI(enabled))) {
     return NR_FAILURE;
@@ -844,6 +897,7 @@ nr_status_t nr_php_txn_begin(const char* appnames,
   opts.span_events_max_samples_stored = NRINI(span_events_max_samples_stored);
   opts.max_segments
       = is_cli ? NRINI(tt_max_segments_cli) : NRINI(tt_max_segments_web);
+  opts.incremental_finalise = NRINI(tt_incremental_finalise);
   opts.span_queue_batch_size = NRINI(agent_span_queue_size);
   opts.span_queue_batch_timeout = NRINI(agent_span_queue_timeout);
   opts.logging_enabled = NRINI(logging_enabled);
@@ -853,9 +907,16 @@ nr_status_t nr_php_txn_begin(const char* appnames,
       = NRINI(log_context_data_attributes.enabled);
   opts.log_forwarding_log_level = NRINI(log_forwarding_log_level);
   opts.log_events_max_samples_stored = NRINI(log_events_max_samples_stored);
+  opts.log_forwarding_max_per_request = NRINI(log_forwarding_max_per_request);
+  opts.log_forwarding_max_message_length
+      = NRINI(log_forwarding_max_message_length);
   opts.log_metrics_enabled = NRINI(log_metrics_enabled);
   opts.message_tracer_segment_parameters_enabled
       = NRINI(message_tracer_segment_parameters_enabled);
+  opts.overhead_metrics_enabled = NRINI(overhead_metrics_enabled);
+  opts.overhead_attribute_enabled = NRINI(overhead_attribute_enabled);
+  opts.segment_page_pool = NR_PHP_PROCESS_GLOBALS(segment_page_pool);
+  opts.sql_cache = NR_PHP_PROCESS_GLOBALS(sql_cache);
 
   /*
    * Enable the behaviour whereby asynchronous time is discounted from the total
@@ -895,6 +956,7 @@ nr_status_t nr_php_txn_begin(const char* appnames,
   /* observer port setting does not really depend on DT being enabled */
   info.trace_observer_port = NRINI(trace_observer_port);
   info.span_queue_size = NRINI(span_queue_size);
+  info.span_stream_count = NR_PHP_PROCESS_GLOBALS(span_stream_count);
   info.span_events_max_samples_stored = NRINI(span_events_max_samples_stored);
 
   /* Need to initialize custom and log event max samples to value negotiated
@@ -1050,6 +1112,17 @@ nr_status_t nr_php_txn_begin(const char* appnames,
     }
   }
 
+  /*
+   * The overhead of sending the previous transaction and cleaning up after it
+   * could only be measured once it had been sent, so it is reported with this
+   * transaction instead.
+   */
+  if (NRPRG(txn)->options.overhead_metrics_enabled) {
+    nr_overhead_create_metrics(&NRPRG(overhead), NRTXN(unscoped_metrics));
+  }
+  nr_overhead_reset(&NRPRG(overhead));
+  nr_overhead_add_since(&NRTXN(overhead), NR_OVERHEAD_TXN_BEGIN, begin_start);
+
   return NR_SUCCESS;
 }
 
@@ -1152,6 +1225,116 @@ static void nr_php_txn_set_response_header_attributes(nrtxn_t* txn TSRMLS_DC) {
                             content_length);
 }
 
+/*
+ * A process forked with pcntl_fork() inherits a copy of its parent's pending
+ * batch. Only the process that created the batch may send it; otherwise the
+ * transactions in it would be reported by both processes.
+ */
+static void nr_php_txn_batch_discard_if_forked(TSRMLS_D) {
+  if ((NULL == NRPRG(txn_batch)) || (nr_getpid() == NRPRG(txn_batch_pid))) {
+    return;
+  }
+
+  nrl_debug(NRL_TXN,
+            "discarding %zu batched txns inherited from pid=%d by pid=%d",
+            nr_txndata_batch_count(NRPRG(txn_batch)), NRPRG(txn_batch_pid),
+            nr_getpid());
+  nr_txndata_batch_destroy(&NRPRG(txn_batch));
+  nr_composer_handle_batch_sent(false);
+}
+
+/*
+ * Send the request's transaction batch to the daemon. The batch is empty
+ * afterwards, whether or not sending succeeded.
+ */
+static nr_status_t nr_php_txn_batch_send(nr_overhead_t* overhead TSRMLS_DC) {
+  nr_status_t st;
+
+  st = nr_cmd_txndata_batch_tx(nr_get_daemon_fd(), NRPRG(txn_batch), overhead);
+  nr_composer_handle_batch_sent(NR_SUCCESS == st);
+
+  return st;
+}
+
+/*
+ * Send a finished transaction to the daemon on its own.
+ */
+static nr_status_t nr_php_txn_send_one(const nrtxn_t* txn,
+                                       nr_overhead_t* overhead TSRMLS_DC) {
+  nr_status_t st;
+
+  st = nr_cmd_txndata_tx(nr_get_daemon_fd(), txn,
+                         NR_PHP_PROCESS_GLOBALS(txndata_encoder), overhead);
+  if (NR_SUCCESS == st) {
+    nr_composer_handle_txn_sent(txn);
+  }
+
+  return st;
+}
+
+/*
+ * Send a finished transaction to the daemon, either on its own or as part of
+ * the request's transaction batch. Batching only pays off for requests that
+ * end many transactions, so the last transaction of a request is sent on its
+ * own unless a batch is already pending.
+ */
+static nr_status_t nr_php_txn_send(const nrtxn_t* txn,
+                                   int in_post_deactivate TSRMLS_DC) {
+  nr_overhead_t* overhead
+      = txn->options.overhead_metrics_enabled ? &NRPRG(overhead) : NULL;
+  size_t max_txns = NR_PHP_PROCESS_GLOBALS(txn_batch_size);
+  size_t daemon_max_txns = (size_t)nr_agent_get_txn_batch_size();
+  nrtime_t now;
+
+  nr_php_txn_batch_discard_if_forked(TSRMLS_C);
+
+  if (0 == max_txns || 0 == daemon_max_txns
+      || (in_post_deactivate
+          && 0 == nr_txndata_batch_count(NRPRG(txn_batch)))) {
+    return nr_php_txn_send_one(txn, overhead TSRMLS_CC);
+  }
+
+  if (daemon_max_txns < max_txns) {
+    max_txns = daemon_max_txns;
+  }
+
+  if (NULL == NRPRG(txn_batch)) {
+    NRPRG(txn_batch) = nr_txndata_batch_create(
+        NR_PHP_PROCESS_GLOBALS(txn_batch_flush_interval));
+    NRPRG(txn_batch_pid) = nr_getpid();
+  }
+
+  now = nr_get_time();
+  if (!nr_txndata_batch_add(NRPRG(txn_batch), txn, now)) {
+    /* The transaction cannot join the pending batch: send that first. */
+    nr_php_txn_batch_send(overhead TSRMLS_CC);
+    if (!nr_txndata_batch_add(NRPRG(txn_batch), txn, now)) {
+      return nr_php_txn_send_one(txn, overhead TSRMLS_CC);
+    }
+  }
+  nr_composer_handle_txn_queued(txn);
+
+  if (in_post_deactivate
+      || nr_txndata_batch_should_send(NRPRG(txn_batch), max_txns, now)) {
+    return nr_php_txn_batch_send(overhead TSRMLS_CC);
+  }
+
+  return NR_SUCCESS;
+}
+
+void nr_php_txn_batch_flush(TSRMLS_D) {
+  nr_php_txn_batch_discard_if_forked(TSRMLS_C);
+
+  if (NULL == NRPRG(txn_batch)) {
+    return;
+  }
+
+  if (NR_FAILURE == nr_php_txn_batch_send(NULL TSRMLS_CC)) {
+    nrl_debug(NRL_TXN, "failed to send txn batch");
+  }
+  nr_txndata_batch_destroy(&NRPRG(txn_batch));
+}
+
 nr_status_t nr_php_txn_end(int ignoretxn, int in_post_deactivate TSRMLS_DC) {
   nr_status_t ret;
 
@@ -1210,6 +1393,10 @@ nr_status_t nr_php_txn_end(int ignoretxn, int in_post_deactivate TSRMLS_DC) {
                   "Supportability/execute/allocated_segment_count",
                   nr_txn_allocated_segment_count(txn));
 
+    nr_php_txn_create_segment_page_pool_metrics(txn);
+    nr_php_txn_create_sql_cache_metrics(txn);
+    nr_php_txn_create_txndata_encoder_metrics(txn);
+
     /* Agent and PHP version metrics*/
     nr_php_txn_create_agent_php_version_metrics(txn);
 
@@ -1235,7 +1422,7 @@ nr_status_t nr_php_txn_end(int ignoretxn, int in_post_deactivate TSRMLS_DC) {
       /*
        * Check status.ignore again in case it has changed during nr_txn_end.
        */
-      ret = nr_cmd_txndata_tx(nr_get_daemon_fd(), txn);
+      ret = nr_php_txn_send(txn, in_post_deactivate TSRMLS_CC);
       if (NR_FAILURE == ret) {
         nrl_debug(NRL_TXN, "failed to send txn");
       }
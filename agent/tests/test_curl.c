@@ -6,6 +6,7 @@
 #include "tlib_php.h"
 
 #include "php_agent.h"
+#include "php_call.h"
 #include "php_curl.h"
 #include "php_curl_md.h"
 #include "php_hash.h"
@@ -37,6 +38,51 @@ static void test_curl_get_url(TSRMLS_D) {
   tlib_php_request_end();
 }
 
+static void test_curl_get_info(TSRMLS_D) {
+  nr_php_curl_info_t info;
+  zval* ch;
+  zval* zurl;
+  zval* retval;
+
+  tlib_php_request_start();
+
+  zurl = nr_php_zval_alloc();
+  nr_php_zval_str(zurl, "https://newrelic.com");
+  ch = nr_php_call(NULL, "curl_init", zurl);
+
+  /*
+   * Test : Invalid parameters.
+   */
+  nr_php_curl_get_info(ch, NULL TSRMLS_CC);
+  tlib_pass_if_null("invalid internal function",
+                    nr_php_call_internal_func(NR_PHP_CALL_INTERNAL_COUNT, 0,
+                                              NULL TSRMLS_CC));
+
+  /*
+   * Test : The internal function is resolved once and then reused.
+   */
+  retval = nr_php_call_internal(NR_PHP_CALL_CURL_GETINFO, ch);
+  tlib_pass_if_not_null("curl_getinfo", retval);
+  tlib_pass_if_zval_type_is("curl_getinfo", IS_ARRAY, retval);
+  tlib_pass_if_ptr_equal("curl_getinfo resolved",
+                         nr_php_find_function("curl_getinfo" TSRMLS_CC),
+                         NRPRG(internal_functions)[NR_PHP_CALL_CURL_GETINFO]);
+  nr_php_zval_free(&retval);
+
+  /*
+   * Test : Information is read from a handle that has not been executed.
+   */
+  nr_php_curl_get_info(ch, &info TSRMLS_CC);
+  tlib_pass_if_str_equal("url", "https://newrelic.com", info.url);
+  tlib_pass_if_uint64_t_equal("status", 0, info.status);
+  tlib_pass_if_uint64_t_equal("total time", 0, info.total_time);
+  nr_free(info.url);
+
+  nr_php_zval_free(&ch);
+  nr_php_zval_free(&zurl);
+  tlib_php_request_end();
+}
+
 static void test_curl_should_instrument_proto() {
   tlib_pass_if_true(
       "nr_php_curl_should_instrument_proto returns true for various non-local "
@@ -114,6 +160,7 @@ void test_main(void* p NRUNUSED) {
 
   if (tlib_php_require_extension("curl" TSRMLS_CC)) {
     test_curl_get_url(TSRMLS_C);
+    test_curl_get_info(TSRMLS_C);
     test_curl_should_instrument_proto();
     test_curl_exec(TSRMLS_C);
   }
@@ -123,6 +123,51 @@ static void test_wordpress_plugin_matcher() {
   nr_free(plugin);
 }
 
+/*
+ * This tests that the plugin and hook tag caches are kept across requests
+ * unless they are invalidated or grow beyond their limits.
+ */
+static void test_wordpress_caches(TSRMLS_D) {
+  size_t i;
+  char key[32];
+
+  tlib_php_request_start();
+
+  NRPRG(wordpress_file_metadata) = nr_hashmap_create(NULL);
+  NRPRG(wordpress_clean_tag_cache) = nr_hashmap_create(NULL);
+  nr_hashmap_set(NRPRG(wordpress_file_metadata),
+                 NR_PSTR("/wp-content/plugins/a.php"), NULL);
+  nr_hashmap_set(NRPRG(wordpress_clean_tag_cache), NR_PSTR("init"), NULL);
+
+  nr_wordpress_caches_rshutdown();
+  tlib_pass_if_size_t_equal("file metadata is kept", 1,
+                            nr_hashmap_count(NRPRG(wordpress_file_metadata)));
+  tlib_pass_if_size_t_equal(
+      "clean tags are kept", 1,
+      nr_hashmap_count(NRPRG(wordpress_clean_tag_cache)));
+
+  for (i = 0; i < NR_WORDPRESS_CLEAN_TAG_CACHE_MAX; i++) {
+    snprintf(key, sizeof(key), "tag_%zu", i);
+    nr_hashmap_set(NRPRG(wordpress_clean_tag_cache), key, nr_strlen(key),
+                   NULL);
+  }
+  nr_wordpress_caches_rshutdown();
+  tlib_pass_if_not_null("file metadata below its limit is kept",
+                        NRPRG(wordpress_file_metadata));
+  tlib_pass_if_null("clean tags above their limit are discarded",
+                    NRPRG(wordpress_clean_tag_cache));
+
+  nr_wordpress_caches_invalidate();
+  nr_wordpress_caches_rshutdown();
+  tlib_pass_if_null("invalidated file metadata is discarded",
+                    NRPRG(wordpress_file_metadata));
+  tlib_pass_if_false("invalidation is reset", NRPRG(wordpress_caches_invalid),
+                     "wordpress_caches_invalid=%d",
+                     (int)NRPRG(wordpress_caches_invalid));
+
+  tlib_php_request_end();
+}
+
 void test_main(void* p NRUNUSED) {
 #if defined(ZTS) && !defined(PHP7)
   void*** tsrm_ls = NULL;
@@ -130,5 +175,6 @@ void test_main(void* p NRUNUSED) {
   tlib_php_engine_create("" PTSRMLS_CC);
   test_wordpress_plugin_matcher();
   test_wordpress_core_matcher();
+  test_wordpress_caches(TSRMLS_C);
   tlib_php_engine_destroy(TSRMLS_C);
 }
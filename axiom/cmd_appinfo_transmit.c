@@ -13,6 +13,7 @@
 #include <stddef.h>
 
 #include "nr_agent.h"
+#include "nr_app_cache.h"
 #include "nr_commands.h"
 #include "nr_commands_private.h"
 #include "nr_limits.h"
@@ -187,6 +188,8 @@ nr_flatbuffer_t* nr_appinfo_create_query(const char* agent_run_id,
                                     info->log_events_max_samples_stored, 0);
   nr_flatbuffers_object_prepend_u16(fb, APP_TRACE_OBSERVER_PORT,
                                     info->trace_observer_port, 0);
+  nr_flatbuffers_object_prepend_u16(fb, APP_SPAN_STREAM_COUNT,
+                                    info->span_stream_count, 0);
   nr_flatbuffers_object_prepend_uoffset(fb, APP_TRACE_OBSERVER_HOST,
                                         trace_observer_host, 0);
   nr_flatbuffers_object_prepend_uoffset(fb, APP_HOST, host_name, 0);
@@ -277,6 +280,144 @@ void nr_cmd_appinfo_process_harvest_timing(nr_flatbuffers_table_t* reply,
                       harvest_frequency * NR_TIME_DIVISOR, sampling_target);
 }
 
+/*
+ * Purpose : Apply a full connect reply to an application: this sets its agent
+ *           run ID, rules, security policies and event limits, and marks it
+ *           connected. Harvest timing is handled separately.
+ */
+static nr_status_t nr_cmd_appinfo_apply_connect_reply(
+    nrapp_t* app,
+    const char* connect_reply,
+    int connect_reply_len,
+    const char* security_policies,
+    int security_policies_len) {
+  const char* entity_guid;
+
+  if (NULL == app) {
+    return NR_FAILURE;
+  }
+
+  nro_delete(app->connect_reply);
+  app->connect_reply
+      = nro_create_from_json_unterminated(connect_reply, connect_reply_len);
+
+  if (NULL == app->connect_reply) {
+    nrl_error(NRL_ACCT, "APPINFO reply bad connect reply: len=%d json=%p",
+              connect_reply_len, connect_reply);
+    return NR_FAILURE;
+  }
+
+  nr_free(app->agent_run_id);
+  app->agent_run_id = nr_strdup(
+      nro_get_hash_string(app->connect_reply, "agent_run_id", NULL));
+  app->state = NR_APP_OK;
+  nr_rules_destroy(&app->url_rules);
+  app->url_rules = nr_rules_create_from_obj(
+      nro_get_hash_array(app->connect_reply, "url_rules", 0));
+  nr_rules_destroy(&app->txn_rules);
+  app->txn_rules = nr_rules_create_from_obj(
+      nro_get_hash_array(app->connect_reply, "transaction_name_rules", 0));
+  nr_segment_terms_destroy(&app->segment_terms);
+  app->segment_terms = nr_segment_terms_create_from_obj(
+      nro_get_hash_array(app->connect_reply, "transaction_segment_terms", 0));
+  nr_txn_name_cache_clear(app->txn_name_cache);
+
+  nr_free(app->entity_guid);
+  entity_guid = nro_get_hash_string(app->connect_reply, "entity_guid", NULL);
+  if (NULL != entity_guid) {
+    app->entity_guid = nr_strdup(entity_guid);
+  } else {
+    app->entity_guid = NULL;
+  }
+
+  /*
+   * Grab security policies (empty hash when non-LASP).
+   */
+  nro_delete(app->security_policies);
+  app->security_policies = nro_create_from_json_unterminated(
+      security_policies, security_policies_len);
+
+  /*
+   * Disable any event types the backend is uninterested in.
+   */
+  nr_cmd_appinfo_process_event_harvest_config(
+      nro_get_hash_hash(app->connect_reply, "event_harvest_config", NULL),
+      &app->limits, app->info);
+
+  return NR_SUCCESS;
+}
+
+/*
+ * Purpose : Publish a full connect reply to the shared application cache, so
+ *           that processes forked later can use the application without
+ *           querying the daemon.
+ */
+static void nr_cmd_appinfo_publish(const nrapp_t* app,
+                                   const char* connect_reply,
+                                   int connect_reply_len,
+                                   const char* security_policies,
+                                   int security_policies_len) {
+  nr_app_cache_entry_t entry;
+
+  if ((NULL == nr_agent_app_cache) || (NULL == app->agent_run_id)) {
+    return;
+  }
+
+  nr_memset(&entry, 0, sizeof(entry));
+  entry.agent_run_id = app->agent_run_id;
+  entry.connect_reply = connect_reply;
+  entry.connect_reply_len = (size_t)connect_reply_len;
+  entry.security_policies = security_policies;
+  entry.security_policies_len = (size_t)security_policies_len;
+  entry.connect_timestamp = app->harvest.connect_timestamp;
+  entry.harvest_frequency = app->harvest.frequency;
+  entry.sampling_target = (uint16_t)app->harvest.target_transactions_per_cycle;
+
+  nr_app_cache_publish(nr_agent_app_cache, &app->info, &entry, time(0));
+}
+
+/*
+ * Purpose : Connect an application using the shared application cache, if
+ *           another process has already connected it.
+ *
+ * Returns : True if the application was taken from the cache.
+ */
+static bool nr_cmd_appinfo_from_cache(nrapp_t* app) {
+  nr_app_cache_entry_t entry;
+  nr_status_t st;
+
+  if (!nr_app_cache_lookup(nr_agent_app_cache, &app->info, time(0), &entry)) {
+    return false;
+  }
+
+  st = nr_cmd_appinfo_apply_connect_reply(
+      app, entry.connect_reply, (int)entry.connect_reply_len,
+      entry.security_policies, (int)entry.security_policies_len);
+  if (NR_SUCCESS != st) {
+    app->state = NR_APP_UNKNOWN;
+    nr_app_cache_entry_deinit(&entry);
+    return false;
+  }
+
+  nr_app_harvest_init(&app->harvest, entry.connect_timestamp,
+                      entry.harvest_frequency, entry.sampling_target);
+
+  /*
+   * The daemon is next queried when the cached entry is itself due to be
+   * confirmed, as though this process had made the query that last
+   * confirmed it.
+   */
+  app->last_daemon_query = entry.validated;
+
+  nrl_debug(NRL_ACCT,
+            "APPINFO from the shared application cache app=" NRP_FMT
+            " agent_run_id=%s",
+            NRP_APPNAME(app->info.appname), app->agent_run_id);
+
+  nr_app_cache_entry_deinit(&entry);
+  return true;
+}
+
 nr_status_t nr_cmd_appinfo_process_reply(const uint8_t* data,
                                          int len,
                                          nrapp_t* app) {
@@ -286,7 +427,8 @@ nr_status_t nr_cmd_appinfo_process_reply(const uint8_t* data,
   int status;
   int reply_len;
   const char* reply_json;
-  const char* entity_guid;
+  int policies_len;
+  const char* policies_json;
 
   if ((NULL == data) || (0 == len)) {
     return NR_FAILURE;
@@ -312,19 +454,39 @@ nr_status_t nr_cmd_appinfo_process_reply(const uint8_t* data,
   status = nr_flatbuffers_table_read_i8(&reply, APP_REPLY_FIELD_STATUS,
                                         APP_STATUS_UNKNOWN);
 
+  /*
+   * Daemons that understand metric name ids say so in every successful reply.
+   * Older daemons omit the field, which leaves the dictionary disabled.
+   */
+  if (APP_STATUS_CONNECTED == status || APP_STATUS_STILL_VALID == status) {
+    nr_metric_names_enable(
+        nr_agent_get_metric_names(),
+        nr_flatbuffers_table_read_u32(&reply, APP_REPLY_FIELD_METRIC_NAME_IDS,
+                                      0));
+    nr_agent_set_txn_batch_size(
+        nr_flatbuffers_table_read_u32(&reply, APP_REPLY_FIELD_TXN_BATCH_SIZE,
+                                      0));
+  }
+
   switch (status) {
     case APP_STATUS_UNKNOWN:
       app->state = NR_APP_UNKNOWN;
+      nr_app_cache_invalidate(nr_agent_app_cache, &app->info,
+                              app->last_daemon_query);
       nrl_debug(NRL_ACCT, "APPINFO reply unknown app=" NRP_FMT,
                 NRP_APPNAME(app->info.appname));
       return NR_SUCCESS;
     case APP_STATUS_DISCONNECTED:
       app->state = NR_APP_INVALID;
+      nr_app_cache_invalidate(nr_agent_app_cache, &app->info,
+                              app->last_daemon_query);
       nrl_info(NRL_ACCT, "APPINFO reply disconnected app=" NRP_FMT,
                NRP_APPNAME(app->info.appname));
       return NR_SUCCESS;
     case APP_STATUS_INVALID_LICENSE:
       app->state = NR_APP_INVALID;
+      nr_app_cache_invalidate(nr_agent_app_cache, &app->info,
+                              app->last_daemon_query);
       nrl_error(NRL_ACCT,
                 "APPINFO reply invalid license app=" NRP_FMT
                 " please check your license "
@@ -337,6 +499,8 @@ nr_status_t nr_cmd_appinfo_process_reply(const uint8_t* data,
       break;
     case APP_STATUS_STILL_VALID:
       app->state = NR_APP_OK;
+      nr_app_cache_validate(nr_agent_app_cache, &app->info, app->agent_run_id,
+                            time(0));
       nrl_debug(NRL_ACCT, "APPINFO reply agent run id still valid app='%.*s'",
                 NRP_APPNAME(app->info.appname));
       return NR_SUCCESS;
@@ -352,66 +516,28 @@ nr_status_t nr_cmd_appinfo_process_reply(const uint8_t* data,
       &reply, APP_REPLY_FIELD_CONNECT_REPLY);
   reply_json = (const char*)nr_flatbuffers_table_read_bytes(
       &reply, APP_REPLY_FIELD_CONNECT_REPLY);
+  policies_len = (int)nr_flatbuffers_table_read_vector_len(
+      &reply, APP_REPLY_FIELD_SECURITY_POLICIES);
+  policies_json = (const char*)nr_flatbuffers_table_read_bytes(
+      &reply, APP_REPLY_FIELD_SECURITY_POLICIES);
 
-  nro_delete(app->connect_reply);
-  app->connect_reply = nro_create_from_json_unterminated(reply_json, reply_len);
-
-  if (NULL == app->connect_reply) {
-    nrl_error(NRL_ACCT, "APPINFO reply bad connect reply: len=%d json=%p",
-              reply_len, reply_json);
+  if (NR_SUCCESS
+      != nr_cmd_appinfo_apply_connect_reply(app, reply_json, reply_len,
+                                            policies_json, policies_len)) {
     return NR_FAILURE;
   }
 
-  nr_free(app->agent_run_id);
-  app->agent_run_id = nr_strdup(
-      nro_get_hash_string(app->connect_reply, "agent_run_id", NULL));
-  app->state = NR_APP_OK;
-  nr_rules_destroy(&app->url_rules);
-  app->url_rules = nr_rules_create_from_obj(
-      nro_get_hash_array(app->connect_reply, "url_rules", 0));
-  nr_rules_destroy(&app->txn_rules);
-  app->txn_rules = nr_rules_create_from_obj(
-      nro_get_hash_array(app->connect_reply, "transaction_name_rules", 0));
-  nr_segment_terms_destroy(&app->segment_terms);
-  app->segment_terms = nr_segment_terms_create_from_obj(
-      nro_get_hash_array(app->connect_reply, "transaction_segment_terms", 0));
-
-  nr_free(app->entity_guid);
-  entity_guid = nro_get_hash_string(app->connect_reply, "entity_guid", NULL);
-  if (NULL != entity_guid) {
-    app->entity_guid = nr_strdup(entity_guid);
-  } else {
-    app->entity_guid = NULL;
-  }
-
   nrl_debug(NRL_ACCT, "APPINFO reply full app='%.*s' agent_run_id=%s",
             NRP_APPNAME(app->info.appname), app->agent_run_id);
 
-  /*
-   * Grab security policies (empty hash when non-LASP).
-   */
-
-  reply_len = (int)nr_flatbuffers_table_read_vector_len(
-      &reply, APP_REPLY_FIELD_SECURITY_POLICIES);
-  reply_json = (const char*)nr_flatbuffers_table_read_bytes(
-      &reply, APP_REPLY_FIELD_SECURITY_POLICIES);
-
-  nro_delete(app->security_policies);
-  app->security_policies
-      = nro_create_from_json_unterminated(reply_json, reply_len);
-
-  /*
-   * Disable any event types the backend is uninterested in.
-   */
-  nr_cmd_appinfo_process_event_harvest_config(
-      nro_get_hash_hash(app->connect_reply, "event_harvest_config", NULL),
-      &app->limits, app->info);
-
   /*
    * Finally, handle the harvest timing information.
    */
   nr_cmd_appinfo_process_harvest_timing(&reply, app);
 
+  nr_cmd_appinfo_publish(app, reply_json, reply_len, policies_json,
+                         policies_len);
+
   return NR_SUCCESS;
 }
 
@@ -501,6 +627,16 @@ nr_status_t nr_cmd_appinfo_tx(int daemon_fd, nrapp_t* app) {
   if (NULL == app) {
     return NR_FAILURE;
   }
+
+  /*
+   * An application that is not yet connected in this process may already
+   * have been connected by another, in which case the daemon need not be
+   * asked. Connected applications are always refreshed from the daemon.
+   */
+  if ((NR_APP_OK != app->state) && nr_cmd_appinfo_from_cache(app)) {
+    return NR_SUCCESS;
+  }
+
   if (daemon_fd < 0) {
     return NR_FAILURE;
   }
@@ -0,0 +1,372 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains the agent's view of batched transaction data: finished
+ * transactions accumulated by long-running processes and sent to the daemon
+ * as a single message, with their metrics aggregated across the batch.
+ */
+#include "nr_axiom.h"
+
+#include <errno.h>
+
+#include "nr_agent.h"
+#include "nr_commands.h"
+#include "nr_commands_private.h"
+#include "nr_txn.h"
+#include "util_errno.h"
+#include "util_flatbuffers.h"
+#include "util_logging.h"
+#include "util_memory.h"
+#include "util_metrics.h"
+#include "util_network.h"
+#include "util_strings.h"
+#include "util_syscalls.h"
+#include "util_time.h"
+#include "util_vector.h"
+
+/*
+ * The number of bytes of encoded transactions after which a batch is sent,
+ * comfortably below the daemon's 2 MB message limit.
+ */
+#define NR_TXNDATA_BATCH_MAX_BYTES (1024 * 1024)
+
+/*
+ * The maximum number of distinct transaction names in a batch. Each needs
+ * its own table of scoped metrics.
+ */
+#define NR_TXNDATA_BATCH_MAX_SCOPES 8
+
+typedef struct _nr_txndata_batch_scope_t {
+  char* name;
+  nrmtable_t* metrics;
+} nr_txndata_batch_scope_t;
+
+struct _nr_txndata_batch_t {
+  char* agent_run_id;
+  nr_flatbuffer_t* fb; /* Transactions added so far, without their metrics */
+  uint32_t* txns;      /* Offsets of the transactions within fb */
+  size_t txn_count;
+  size_t txn_capacity;
+  nrmtable_t* unscoped_metrics;
+  nr_txndata_batch_scope_t scopes[NR_TXNDATA_BATCH_MAX_SCOPES];
+  size_t scope_count;
+  nrtime_t started; /* When the first transaction was added */
+  nrtime_t max_age;
+};
+
+nr_txndata_batch_t* nr_txndata_batch_create(nrtime_t max_age) {
+  nr_txndata_batch_t* batch;
+
+  batch = (nr_txndata_batch_t*)nr_zalloc(sizeof(nr_txndata_batch_t));
+  batch->unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  batch->max_age = max_age;
+
+  return batch;
+}
+
+void nr_txndata_batch_reset(nr_txndata_batch_t* batch) {
+  size_t i;
+
+  if (NULL == batch) {
+    return;
+  }
+
+  nr_flatbuffers_destroy(&batch->fb);
+  batch->txn_count = 0;
+  batch->started = 0;
+
+  nrm_table_destroy(&batch->unscoped_metrics);
+  batch->unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+
+  for (i = 0; i < batch->scope_count; i++) {
+    nr_free(batch->scopes[i].name);
+    nrm_table_destroy(&batch->scopes[i].metrics);
+  }
+  batch->scope_count = 0;
+}
+
+void nr_txndata_batch_destroy(nr_txndata_batch_t** batch_ptr) {
+  nr_txndata_batch_t* batch;
+
+  if (NULL == batch_ptr || NULL == *batch_ptr) {
+    return;
+  }
+
+  batch = *batch_ptr;
+  nr_txndata_batch_reset(batch);
+  nrm_table_destroy(&batch->unscoped_metrics);
+  nr_free(batch->txns);
+  nr_free(batch->agent_run_id);
+  nr_realfree((void**)batch_ptr);
+}
+
+size_t nr_txndata_batch_count(const nr_txndata_batch_t* batch) {
+  if (NULL == batch) {
+    return 0;
+  }
+  return batch->txn_count;
+}
+
+static nr_txndata_batch_scope_t* nr_txndata_batch_find_scope(
+    nr_txndata_batch_t* batch,
+    const char* name) {
+  size_t i;
+
+  for (i = 0; i < batch->scope_count; i++) {
+    if (0 == nr_strcmp(batch->scopes[i].name, name)) {
+      return &batch->scopes[i];
+    }
+  }
+
+  return NULL;
+}
+
+bool nr_txndata_batch_add(nr_txndata_batch_t* batch,
+                          const nrtxn_t* txn,
+                          nrtime_t now) {
+  nr_txndata_batch_scope_t* scope;
+
+  if (NULL == batch || NULL == txn) {
+    return false;
+  }
+
+  if (batch->txn_count > 0) {
+    if (0 != nr_strcmp(batch->agent_run_id, txn->agent_run_id)) {
+      return false;
+    }
+    if (nr_flatbuffers_len(batch->fb) >= NR_TXNDATA_BATCH_MAX_BYTES) {
+      return false;
+    }
+  }
+
+  scope = nr_txndata_batch_find_scope(batch, txn->name);
+  if (NULL == scope) {
+    if (batch->scope_count >= NR_TXNDATA_BATCH_MAX_SCOPES) {
+      return false;
+    }
+    scope = &batch->scopes[batch->scope_count++];
+    scope->name = nr_strdup(txn->name);
+    scope->metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  }
+
+  if (0 == batch->txn_count) {
+    nr_free(batch->agent_run_id);
+    batch->agent_run_id = nr_strdup(txn->agent_run_id);
+    batch->started = now;
+  }
+
+  if (NULL == batch->fb) {
+    batch->fb = nr_flatbuffers_create(0);
+  }
+
+  if (batch->txn_count == batch->txn_capacity) {
+    batch->txn_capacity = batch->txn_capacity ? 2 * batch->txn_capacity : 16;
+    batch->txns = (uint32_t*)nr_realloc(
+        batch->txns, batch->txn_capacity * sizeof(uint32_t));
+  }
+
+  batch->txns[batch->txn_count++] = nr_txndata_prepend_transaction(
+      batch->fb, txn, (int32_t)nr_getpid(), false, NULL, NULL);
+
+  nrm_table_merge(batch->unscoped_metrics, txn->unscoped_metrics);
+  nrm_table_merge(scope->metrics, txn->scoped_metrics);
+
+  return true;
+}
+
+bool nr_txndata_batch_should_send(const nr_txndata_batch_t* batch,
+                                  size_t max_txns,
+                                  nrtime_t now) {
+  if (NULL == batch || 0 == batch->txn_count) {
+    return false;
+  }
+
+  return batch->txn_count >= max_txns
+         || nr_flatbuffers_len(batch->fb) >= NR_TXNDATA_BATCH_MAX_BYTES
+         || batch->scope_count >= NR_TXNDATA_BATCH_MAX_SCOPES
+         || now >= batch->started + batch->max_age;
+}
+
+static uint32_t nr_txndata_batch_prepend_group(nr_flatbuffer_t* fb,
+                                               const char* scope,
+                                               const nrmtable_t* table,
+                                               int scoped,
+                                               nr_metric_names_t* names,
+                                               nr_vector_t* defined) {
+  int num_metrics = nrm_table_size(table);
+  uint32_t* offsets;
+  uint32_t metrics;
+  uint32_t name = 0;
+  int i;
+
+  offsets = (uint32_t*)nr_calloc(num_metrics, sizeof(uint32_t));
+  for (i = 0; i < num_metrics; i++) {
+    offsets[i] = nr_txndata_prepend_metric(
+        fb, table, nrm_get_metric(table, i), scoped, names, defined);
+  }
+
+  nr_flatbuffers_vector_begin(fb, sizeof(uint32_t), num_metrics,
+                              sizeof(uint32_t));
+  for (i = num_metrics - 1; i >= 0; i--) {
+    nr_flatbuffers_prepend_uoffset(fb, offsets[i]);
+  }
+  metrics = nr_flatbuffers_vector_end(fb, num_metrics);
+  nr_free(offsets);
+
+  if (scope) {
+    name = nr_flatbuffers_prepend_string(fb, scope);
+  }
+
+  nr_flatbuffers_object_begin(fb, METRIC_GROUP_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_uoffset(fb, METRIC_GROUP_FIELD_METRICS,
+                                        metrics, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, METRIC_GROUP_FIELD_SCOPE, name, 0);
+  return nr_flatbuffers_object_end(fb);
+}
+
+nr_flatbuffer_t* nr_txndata_batch_encode(nr_txndata_batch_t* batch,
+                                         nr_metric_names_t* names,
+                                         nr_vector_t* defined) {
+  nr_flatbuffer_t* fb;
+  uint32_t groups[NR_TXNDATA_BATCH_MAX_SCOPES + 1];
+  size_t num_groups = 0;
+  uint32_t group_vector;
+  uint32_t txn_vector;
+  uint32_t txn_batch;
+  uint32_t agent_run_id;
+  uint32_t message;
+  size_t i;
+
+  if (NULL == batch || 0 == batch->txn_count) {
+    return NULL;
+  }
+
+  fb = batch->fb;
+
+  if (nrm_table_size(batch->unscoped_metrics) > 0) {
+    groups[num_groups++] = nr_txndata_batch_prepend_group(
+        fb, NULL, batch->unscoped_metrics, 0, names, defined);
+  }
+  for (i = 0; i < batch->scope_count; i++) {
+    if (nrm_table_size(batch->scopes[i].metrics) > 0) {
+      groups[num_groups++] = nr_txndata_batch_prepend_group(
+          fb, batch->scopes[i].name, batch->scopes[i].metrics, 1, names,
+          defined);
+    }
+  }
+
+  nr_flatbuffers_vector_begin(fb, sizeof(uint32_t), num_groups,
+                              sizeof(uint32_t));
+  for (i = num_groups; i > 0; i--) {
+    nr_flatbuffers_prepend_uoffset(fb, groups[i - 1]);
+  }
+  group_vector = nr_flatbuffers_vector_end(fb, num_groups);
+
+  nr_flatbuffers_vector_begin(fb, sizeof(uint32_t), batch->txn_count,
+                              sizeof(uint32_t));
+  for (i = batch->txn_count; i > 0; i--) {
+    nr_flatbuffers_prepend_uoffset(fb, batch->txns[i - 1]);
+  }
+  txn_vector = nr_flatbuffers_vector_end(fb, batch->txn_count);
+
+  nr_flatbuffers_object_begin(fb, TXN_BATCH_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_uoffset(fb, TXN_BATCH_FIELD_METRICS,
+                                        group_vector, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, TXN_BATCH_FIELD_TRANSACTIONS,
+                                        txn_vector, 0);
+  txn_batch = nr_flatbuffers_object_end(fb);
+
+  agent_run_id = nr_flatbuffers_prepend_string(fb, batch->agent_run_id);
+
+  nr_flatbuffers_object_begin(fb, MESSAGE_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_uoffset(fb, MESSAGE_FIELD_DATA, txn_batch, 0);
+  nr_flatbuffers_object_prepend_u8(fb, MESSAGE_FIELD_DATA_TYPE,
+                                   MESSAGE_BODY_TXN_BATCH, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, MESSAGE_FIELD_AGENT_RUN_ID,
+                                        agent_run_id, 0);
+  message = nr_flatbuffers_object_end(fb);
+
+  nr_flatbuffers_finish(fb, message);
+
+  /* The finished message now belongs to the caller. */
+  batch->fb = NULL;
+  batch->txn_count = 0;
+
+  return fb;
+}
+
+/* See nr_cmd_txndata_tx() for the rationale of this timeout. */
+#define NR_TXNDATA_BATCH_SEND_TIMEOUT_MSEC 500
+
+nr_status_t nr_cmd_txndata_batch_tx(int daemon_fd,
+                                    nr_txndata_batch_t* batch,
+                                    nr_overhead_t* overhead) {
+  nr_flatbuffer_t* msg;
+  nr_metric_names_t* names;
+  nr_vector_t defined;
+  size_t count;
+  size_t msglen;
+  nr_status_t st;
+  nrtime_t start;
+
+  count = nr_txndata_batch_count(batch);
+  if (0 == count) {
+    return NR_SUCCESS;
+  }
+
+  if (daemon_fd < 0) {
+    nr_txndata_batch_reset(batch);
+    return NR_FAILURE;
+  }
+
+  start = nr_get_time();
+  names = nr_agent_get_metric_names();
+  nr_vector_init(&defined, 8, NULL, NULL);
+  msg = nr_txndata_batch_encode(batch, names, &defined);
+  msglen = nr_flatbuffers_len(msg);
+  nr_overhead_add_since(overhead, NR_OVERHEAD_TXNDATA_ENCODE, start);
+
+  nrl_verbosedebug(NRL_DAEMON,
+                   "sending transaction batch message, txns=%zu len=%zu",
+                   count, msglen);
+
+  if (nr_command_is_flatbuffer_invalid(msg, msglen)) {
+    st = NR_FAILURE;
+    goto end;
+  }
+
+  start = nr_get_time();
+  nr_agent_lock_daemon_mutex();
+  {
+    nrtime_t deadline;
+
+    deadline
+        = start + (NR_TXNDATA_BATCH_SEND_TIMEOUT_MSEC * NR_TIME_DIVISOR_MS);
+    st = nr_write_message(daemon_fd, nr_flatbuffers_data(msg), msglen,
+                          deadline);
+  }
+  nr_agent_unlock_daemon_mutex();
+  nr_overhead_add_since(overhead, NR_OVERHEAD_TXNDATA_TX, start);
+
+  if (NR_SUCCESS != st) {
+    nrl_error(NRL_DAEMON, "TXNDATA batch failure: len=%zu errno=%s", msglen,
+              nr_errno(errno));
+    nr_agent_close_daemon_connection();
+    goto end;
+  }
+
+  /*
+   * The defined names point into the batch's metric tables, so they must be
+   * committed before the batch is reset.
+   */
+  nr_metric_names_commit(names, &defined);
+
+end:
+  nr_vector_deinit(&defined);
+  nr_flatbuffers_destroy(&msg);
+  nr_txndata_batch_reset(batch);
+  return st;
+}
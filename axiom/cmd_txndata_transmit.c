@@ -37,6 +37,7 @@
 #include "util_network.h"
 #include "util_strings.h"
 #include "util_syscalls.h"
+#include "util_threads.h"
 
 char* nr_txndata_error_to_json(const nrtxn_t* txn) {
   nrobj_t* agent_attributes;
@@ -333,16 +334,28 @@ static uint32_t nr_txndata_prepend_metric_data(nr_flatbuffer_t* fb,
   return nr_flatbuffers_len(fb);
 }
 
-static uint32_t nr_txndata_prepend_metric(nr_flatbuffer_t* fb,
-                                          const nrmtable_t* table,
-                                          const nrmetric_t* metric,
-                                          int scoped) {
-  uint32_t name;
+uint32_t nr_txndata_prepend_metric(nr_flatbuffer_t* fb,
+                                   const nrmtable_t* table,
+                                   const nrmetric_t* metric,
+                                   int scoped,
+                                   nr_metric_names_t* names,
+                                   nr_vector_t* defined) {
+  const char* metric_name = nrm_get_name(table, metric);
+  bool send_name = true;
+  uint32_t name_id;
+  uint32_t name = 0;
   uint32_t data;
 
-  name = nr_flatbuffers_prepend_string(fb, nrm_get_name(table, metric));
+  name_id = nr_metric_names_lookup(names, metric_name, &send_name);
+  if (send_name) {
+    name = nr_flatbuffers_prepend_string(fb, metric_name);
+    if (name_id) {
+      nr_vector_push_back(defined, (void*)(uintptr_t)metric_name);
+    }
+  }
 
   nr_flatbuffers_object_begin(fb, METRIC_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_u32(fb, METRIC_FIELD_NAME_ID, name_id, 0);
   nr_flatbuffers_object_prepend_uoffset(fb, METRIC_FIELD_NAME, name, 0);
   data = nr_txndata_prepend_metric_data(fb, metric, scoped);
   nr_flatbuffers_object_prepend_struct(fb, METRIC_FIELD_DATA, data, 0);
@@ -350,7 +363,9 @@ static uint32_t nr_txndata_prepend_metric(nr_flatbuffer_t* fb,
 }
 
 static uint32_t nr_txndata_prepend_metrics(nr_flatbuffer_t* fb,
-                                           const nrtxn_t* txn) {
+                                           const nrtxn_t* txn,
+                                           nr_metric_names_t* names,
+                                           nr_vector_t* defined) {
   uint32_t* offsets;
   uint32_t* offset;
   uint32_t metrics;
@@ -374,14 +389,16 @@ static uint32_t nr_txndata_prepend_metrics(nr_flatbuffer_t* fb,
     const nrmetric_t* metric;
 
     metric = nrm_get_metric(txn->unscoped_metrics, i);
-    *offset = nr_txndata_prepend_metric(fb, txn->unscoped_metrics, metric, 0);
+    *offset = nr_txndata_prepend_metric(fb, txn->unscoped_metrics, metric, 0,
+                                        names, defined);
   }
 
   for (i = 0; i < num_scoped; i++, offset++) {
     const nrmetric_t* metric;
 
     metric = nrm_get_metric(txn->scoped_metrics, i);
-    *offset = nr_txndata_prepend_metric(fb, txn->scoped_metrics, metric, 1);
+    *offset = nr_txndata_prepend_metric(fb, txn->scoped_metrics, metric, 1,
+                                        names, defined);
   }
 
   nr_flatbuffers_vector_begin(fb, sizeof(uint32_t), num_metrics,
@@ -576,7 +593,12 @@ static uint32_t nr_txndata_prepend_php_packages(nr_flatbuffer_t* fb,
     return 0;
   }
 
-  json = nr_php_packages_to_json(txn->php_packages);
+  if (txn->composer_info.packages_reported) {
+    json = nr_php_packages_to_json_excluding_source(
+        txn->php_packages, NR_PHP_PACKAGE_SOURCE_COMPOSER);
+  } else {
+    json = nr_php_packages_to_json(txn->php_packages);
+  }
   if (NULL == json) {
     return 0;
   }
@@ -589,13 +611,16 @@ static uint32_t nr_txndata_prepend_php_packages(nr_flatbuffer_t* fb,
   return nr_flatbuffers_object_end(fb);
 }
 
-static uint32_t nr_txndata_prepend_transaction(nr_flatbuffer_t* fb,
-                                               const nrtxn_t* txn,
-                                               int32_t pid) {
+uint32_t nr_txndata_prepend_transaction(nr_flatbuffer_t* fb,
+                                        const nrtxn_t* txn,
+                                        int32_t pid,
+                                        bool with_metrics,
+                                        nr_metric_names_t* names,
+                                        nr_vector_t* defined) {
   uint32_t custom_events;
   uint32_t error_events;
   uint32_t errors;
-  uint32_t metrics;
+  uint32_t metrics = 0;
   uint32_t name;
   uint32_t request_uri;
   uint32_t resource_id;
@@ -615,7 +640,9 @@ static uint32_t nr_txndata_prepend_transaction(nr_flatbuffer_t* fb,
   custom_events = nr_txndata_prepend_custom_events(fb, txn);
   slowsqls = nr_txndata_prepend_slowsqls(fb, txn);
   errors = nr_txndata_prepend_errors(fb, txn);
-  metrics = nr_txndata_prepend_metrics(fb, txn);
+  if (with_metrics) {
+    metrics = nr_txndata_prepend_metrics(fb, txn, names, defined);
+  }
   php_packages = nr_txndata_prepend_php_packages(fb, txn);
   txn_event = nr_txndata_prepend_txn_event(fb, txn);
   resource_id = nr_txndata_prepend_synthetics_resource_id(fb, txn);
@@ -657,13 +684,19 @@ static uint32_t nr_txndata_prepend_transaction(nr_flatbuffer_t* fb,
 }
 
 nr_flatbuffer_t* nr_txndata_encode(const nrtxn_t* txn) {
-  nr_flatbuffer_t* fb;
+  return nr_txndata_encode_metric_names(txn, NULL, NULL);
+}
+
+static void nr_txndata_encode_into(nr_flatbuffer_t* fb,
+                                   const nrtxn_t* txn,
+                                   nr_metric_names_t* names,
+                                   nr_vector_t* defined) {
   uint32_t message;
   uint32_t agent_run_id;
   uint32_t transaction;
 
-  fb = nr_flatbuffers_create(0);
-  transaction = nr_txndata_prepend_transaction(fb, txn, (int32_t)nr_getpid());
+  transaction = nr_txndata_prepend_transaction(fb, txn, (int32_t)nr_getpid(),
+                                               true, names, defined);
   agent_run_id = nr_flatbuffers_prepend_string(fb, txn->agent_run_id);
 
   nr_flatbuffers_object_begin(fb, MESSAGE_NUM_FIELDS);
@@ -675,10 +708,136 @@ nr_flatbuffer_t* nr_txndata_encode(const nrtxn_t* txn) {
   message = nr_flatbuffers_object_end(fb);
 
   nr_flatbuffers_finish(fb, message);
+}
+
+nr_flatbuffer_t* nr_txndata_encode_metric_names(const nrtxn_t* txn,
+                                                nr_metric_names_t* names,
+                                                nr_vector_t* defined) {
+  nr_flatbuffer_t* fb = nr_flatbuffers_create(0);
+
+  nr_txndata_encode_into(fb, txn, names, defined);
 
   return fb;
 }
 
+/*
+ * The smallest buffer an encoder allocates, and the size below which it never
+ * gives memory back.
+ */
+#define NR_TXNDATA_ENCODER_MIN_SIZE (16 * 1024)
+
+struct _nr_txndata_encoder_t {
+  nrthread_mutex_t lock;
+  nr_flatbuffer_t* fb;
+  size_t high_water; /* Decaying maximum of recent message sizes */
+  uint64_t messages;
+  uint64_t reallocs;
+};
+
+nr_txndata_encoder_t* nr_txndata_encoder_create(void) {
+  nr_txndata_encoder_t* encoder;
+
+  encoder = (nr_txndata_encoder_t*)nr_zalloc(sizeof(nr_txndata_encoder_t));
+  nrt_mutex_init(&encoder->lock, 0);
+
+  return encoder;
+}
+
+void nr_txndata_encoder_destroy(nr_txndata_encoder_t** encoder_ptr) {
+  if (NULL == encoder_ptr || NULL == *encoder_ptr) {
+    return;
+  }
+
+  nr_flatbuffers_destroy(&(*encoder_ptr)->fb);
+  nrt_mutex_destroy(&(*encoder_ptr)->lock);
+  nr_realfree((void**)encoder_ptr);
+}
+
+bool nr_txndata_encoder_take_stats(nr_txndata_encoder_t* encoder,
+                                   nr_txndata_encoder_stats_t* stats) {
+  if (NULL == encoder || NULL == stats) {
+    return false;
+  }
+
+  nrt_mutex_lock(&encoder->lock);
+  stats->messages = encoder->messages;
+  stats->reallocs = encoder->reallocs;
+  stats->capacity = nr_flatbuffers_capacity(encoder->fb);
+  encoder->messages = 0;
+  encoder->reallocs = 0;
+  nrt_mutex_unlock(&encoder->lock);
+
+  return true;
+}
+
+/*
+ * Takes the encoder's buffer, ready to encode a message into, so that the
+ * encoder need not stay locked while the message is encoded and sent. If
+ * another thread has the buffer, a new one is allocated at the size recent
+ * messages need.
+ */
+static nr_flatbuffer_t* nr_txndata_encoder_take(
+    nr_txndata_encoder_t* encoder) {
+  nr_flatbuffer_t* fb;
+  size_t want;
+  size_t size = NR_TXNDATA_ENCODER_MIN_SIZE;
+
+  nrt_mutex_lock(&encoder->lock);
+  fb = encoder->fb;
+  encoder->fb = NULL;
+  want = encoder->high_water + encoder->high_water / 2;
+  nrt_mutex_unlock(&encoder->lock);
+
+  if (fb) {
+    nr_flatbuffers_reset(fb);
+    return fb;
+  }
+
+  /*
+   * Flatbuffers align their contents relative to the end of the buffer's
+   * memory, so the size must be a power of two, as the buffer's own growth
+   * ensures.
+   */
+  while (size < want) {
+    size *= 2;
+  }
+
+  return nr_flatbuffers_create(size);
+}
+
+/*
+ * Records the size of the message just encoded, and gives the buffer back to
+ * the encoder. The buffer is freed instead if the encoder already got another
+ * one back, or if it has become much larger than recent messages need, so
+ * that it is allocated at the right size next time.
+ */
+static void nr_txndata_encoder_give(nr_txndata_encoder_t* encoder,
+                                    nr_flatbuffer_t** fb_ptr) {
+  size_t len = nr_flatbuffers_len(*fb_ptr);
+  size_t capacity = nr_flatbuffers_capacity(*fb_ptr);
+  size_t grows = nr_flatbuffers_grows(*fb_ptr);
+
+  nrt_mutex_lock(&encoder->lock);
+  encoder->messages++;
+  encoder->reallocs += grows;
+
+  /* Each message takes an eighth off the mark, unless it sets a new one. */
+  encoder->high_water -= encoder->high_water / 8;
+  if (len > encoder->high_water) {
+    encoder->high_water = len;
+  }
+
+  if (NULL == encoder->fb
+      && (capacity <= NR_TXNDATA_ENCODER_MIN_SIZE
+          || capacity <= 4 * encoder->high_water)) {
+    encoder->fb = *fb_ptr;
+    *fb_ptr = NULL;
+  }
+  nrt_mutex_unlock(&encoder->lock);
+
+  nr_flatbuffers_destroy(fb_ptr);
+}
+
 /* Hook for stubbing TXNDATA messages during testing. */
 nr_status_t (*nr_cmd_txndata_hook)(int daemon_fd, const nrtxn_t* txn) = NULL;
 
@@ -690,10 +849,16 @@ nr_status_t (*nr_cmd_txndata_hook)(int daemon_fd, const nrtxn_t* txn) = NULL;
  */
 #define NR_TXNDATA_SEND_TIMEOUT_MSEC 500
 
-nr_status_t nr_cmd_txndata_tx(int daemon_fd, const nrtxn_t* txn) {
+nr_status_t nr_cmd_txndata_tx(int daemon_fd,
+                              const nrtxn_t* txn,
+                              nr_txndata_encoder_t* encoder,
+                              nr_overhead_t* overhead) {
   nr_flatbuffer_t* msg;
+  nr_metric_names_t* names;
+  nr_vector_t defined;
   size_t msglen;
   nr_status_t st;
+  nrtime_t start;
 
   if (nr_cmd_txndata_hook) {
     return nr_cmd_txndata_hook(daemon_fd, txn);
@@ -713,34 +878,56 @@ nr_status_t nr_cmd_txndata_tx(int daemon_fd, const nrtxn_t* txn) {
       nr_txn_duration(txn), txn->options.tt_threshold,
       (double)nr_distributed_trace_get_priority(txn->distributed_trace));
 
-  msg = nr_txndata_encode(txn);
+  start = nr_get_time();
+  names = nr_agent_get_metric_names();
+  nr_vector_init(&defined, 8, NULL, NULL);
+  if (encoder) {
+    msg = nr_txndata_encoder_take(encoder);
+  } else {
+    msg = nr_flatbuffers_create(0);
+  }
+  nr_txndata_encode_into(msg, txn, names, &defined);
   msglen = nr_flatbuffers_len(msg);
+  nr_overhead_add_since(overhead, NR_OVERHEAD_TXNDATA_ENCODE, start);
 
   nrl_verbosedebug(NRL_DAEMON, "sending transaction message, len=%zu", msglen);
 
   if (nr_command_is_flatbuffer_invalid(msg, msglen)) {
-    nr_flatbuffers_destroy(&msg);
-    return NR_FAILURE;
+    st = NR_FAILURE;
+    goto end;
   }
 
+  start = nr_get_time();
   nr_agent_lock_daemon_mutex();
   {
     nrtime_t deadline;
 
-    deadline
-        = nr_get_time() + (NR_TXNDATA_SEND_TIMEOUT_MSEC * NR_TIME_DIVISOR_MS);
+    deadline = start + (NR_TXNDATA_SEND_TIMEOUT_MSEC * NR_TIME_DIVISOR_MS);
     st = nr_write_message(daemon_fd, nr_flatbuffers_data(msg), msglen,
                           deadline);
   }
   nr_agent_unlock_daemon_mutex();
-  nr_flatbuffers_destroy(&msg);
+  nr_overhead_add_since(overhead, NR_OVERHEAD_TXNDATA_TX, start);
 
   if (NR_SUCCESS != st) {
     nrl_error(NRL_DAEMON, "TXNDATA failure: len=%zu errno=%s", msglen,
               nr_errno(errno));
     nr_agent_close_daemon_connection();
-    return NR_FAILURE;
+    goto end;
   }
 
-  return NR_SUCCESS;
+  /*
+   * The daemon now knows the ids defined by this message, so later messages
+   * may refer to these metrics by id alone.
+   */
+  nr_metric_names_commit(names, &defined);
+
+end:
+  if (encoder) {
+    nr_txndata_encoder_give(encoder, &msg);
+  }
+  nr_flatbuffers_destroy(&msg);
+  nr_vector_deinit(&defined);
+
+  return st;
 }
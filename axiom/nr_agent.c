@@ -33,11 +33,20 @@ typedef enum _nr_socket_type_t {
 } nr_socket_type_t;
 
 nrapplist_t* nr_agent_applist = 0;
+nr_app_cache_t* nr_agent_app_cache = NULL;
 
 static nrthread_mutex_t nr_agent_daemon_mutex = NRTHREAD_MUTEX_INITIALIZER;
 
 static int nr_agent_daemon_fd = -1;
 
+static nr_metric_names_t nr_agent_metric_names = NR_METRIC_NAMES_INITIALIZER;
+
+/*
+ * The maximum number of transactions the daemon accepts in a single batch,
+ * or 0 if it does not support batches. Protected by nr_agent_daemon_mutex.
+ */
+static uint32_t nr_agent_txn_batch_size = 0;
+
 static struct sockaddr_in nr_agent_daemon_inaddr;
 static struct sockaddr_in6 nr_agent_daemon_inaddr6;
 static struct sockaddr_un nr_agent_daemon_unaddr;
@@ -636,6 +645,7 @@ void nr_set_daemon_fd(int fd) {
   }
 
   nr_agent_daemon_fd = fd;
+  nr_agent_txn_batch_size = 0;
   nr_agent_last_cant_connect_warning = 0;
   nr_agent_connection_state = NR_AGENT_CONNECTION_STATE_START;
 
@@ -644,6 +654,29 @@ void nr_set_daemon_fd(int fd) {
   }
 
   nrt_mutex_unlock(&nr_agent_daemon_mutex);
+
+  /* Metric name ids are only valid on the connection they were sent on. */
+  nr_metric_names_reset(&nr_agent_metric_names);
+}
+
+nr_metric_names_t* nr_agent_get_metric_names(void) {
+  return &nr_agent_metric_names;
+}
+
+void nr_agent_set_txn_batch_size(uint32_t size) {
+  nrt_mutex_lock(&nr_agent_daemon_mutex);
+  nr_agent_txn_batch_size = size;
+  nrt_mutex_unlock(&nr_agent_daemon_mutex);
+}
+
+uint32_t nr_agent_get_txn_batch_size(void) {
+  uint32_t size;
+
+  nrt_mutex_lock(&nr_agent_daemon_mutex);
+  size = nr_agent_txn_batch_size;
+  nrt_mutex_unlock(&nr_agent_daemon_mutex);
+
+  return size;
 }
 
 void nr_agent_close_daemon_connection(void) {
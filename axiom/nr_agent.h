@@ -11,6 +11,8 @@
 
 #include "nr_axiom.h"
 #include "nr_app.h"
+#include "nr_app_cache.h"
+#include "nr_metric_names.h"
 
 #define NR_PHP_AGENT_EXT_DOCS_URL "https://docs.newrelic.com/docs/apm/agents/php-agent/"
 
@@ -86,6 +88,16 @@ void nr_conn_params_free(nr_conn_params_t* params);
  */
 extern nrapplist_t* nr_agent_applist;
 
+/*
+ * Purpose : This is the agent's shared application cache, or NULL if there is
+ *           none. See nr_app_cache.h.
+ *
+ * Note    : It must be created before the processes that share it are forked,
+ *           and like the application list, before multiple threads have
+ *           access to it.
+ */
+extern nr_app_cache_t* nr_agent_app_cache;
+
 /*
  * Purpose : Using a configuration value representing the daemon location
  *           derive the intended communication connection for the agent
@@ -183,6 +195,22 @@ extern void nr_set_daemon_fd(int fd);
  */
 extern void nr_agent_close_daemon_connection(void);
 
+/*
+ * Purpose : Return the metric name dictionary for the current daemon
+ *           connection. It is reset whenever the connection is closed or
+ *           replaced.
+ */
+extern nr_metric_names_t* nr_agent_get_metric_names(void);
+
+/*
+ * Purpose : Set or get the maximum number of transactions the daemon accepts
+ *           in a single TXNDATA batch, as advertised in its APPINFO reply. 0
+ *           means the daemon does not support batches. This is reset whenever
+ *           the daemon connection is closed or replaced.
+ */
+extern void nr_agent_set_txn_batch_size(uint32_t size);
+extern uint32_t nr_agent_get_txn_batch_size(void);
+
 /*
  * Purpose : Determine if a connection to the daemon is possible by creating
  *           one.  This differs from nr_get_daemon_fd in two ways: If the
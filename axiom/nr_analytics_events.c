@@ -10,32 +10,99 @@
 
 #include "nr_analytics_events.h"
 #include "nr_analytics_events_private.h"
+#include "util_buffer.h"
 #include "util_memory.h"
+#include "util_strings.h"
 
 /*
- * The transaction analytics event is represented as a JSON string
- * for simplicity.  This is done using a structure (rather than
- * 'typedef char analytics_event_t') for the structure type safety.
+ * The transaction analytics event is represented as a JSON string in the
+ * format expected by New Relic's backend.
  *
- * This JSON format matches the format expected by New Relic's backend.
+ * Events created with nr_analytics_event_create_deferred() instead hold their
+ * fields until the JSON is first needed, so that events which are dropped
+ * from an event pool before they are sent are never serialised.
  */
 struct _nr_analytics_event_t {
-  char json[1];
+  char* json; /* The serialised event, or NULL until a deferred event is
+                 serialised */
+
+  /*
+   * The hashes of a deferred event, which are released once the event has
+   * been serialised.
+   */
+  nrobj_t* builtin_fields;
+  nrobj_t* user_attributes;
+  nrobj_t* agent_attributes;
 };
 
 /*
  * Convenience function provided for testing.
  */
 nr_analytics_event_t* nr_analytics_event_create_from_string(const char* str) {
-  return (nr_analytics_event_t*)nr_strdup(str);
+  nr_analytics_event_t* event;
+
+  event = (nr_analytics_event_t*)nr_zalloc(sizeof(nr_analytics_event_t));
+  event->json = nr_strdup(str);
+
+  return event;
 }
 
 static nr_analytics_event_t* nr_analytics_event_duplicate(
     const nr_analytics_event_t* event) {
+  nr_analytics_event_t* dup;
+
   if (0 == event) {
     return 0;
   }
-  return (nr_analytics_event_t*)nr_strdup(event->json);
+
+  dup = (nr_analytics_event_t*)nr_zalloc(sizeof(nr_analytics_event_t));
+  if (NULL != event->json) {
+    dup->json = nr_strdup(event->json);
+  }
+  dup->builtin_fields = nro_copy(event->builtin_fields);
+  dup->user_attributes = nro_copy(event->user_attributes);
+  dup->agent_attributes = nro_copy(event->agent_attributes);
+
+  return dup;
+}
+
+static void nr_analytics_event_fields_to_json_buffer(const nrobj_t* fields,
+                                                     nrbuf_t* buf) {
+  if (NULL == fields) {
+    nr_buffer_add(buf, NR_PSTR("{}"));
+  } else {
+    nro_to_json_buffer(fields, buf);
+  }
+}
+
+/*
+ * Serialise a deferred event, releasing its fields.  This writes the same
+ * JSON as nr_analytics_event_create(), without first copying the fields into
+ * an array.
+ */
+static void nr_analytics_event_serialize(nr_analytics_event_t* event) {
+  nrbuf_t* buf;
+
+  if (NULL == event || NULL != event->json) {
+    return;
+  }
+
+  buf = nr_buffer_create(0, 0);
+  nr_buffer_add(buf, NR_PSTR("["));
+  nr_analytics_event_fields_to_json_buffer(event->builtin_fields, buf);
+  nr_buffer_add(buf, NR_PSTR(","));
+  nr_analytics_event_fields_to_json_buffer(event->user_attributes, buf);
+  nr_buffer_add(buf, NR_PSTR(","));
+  nr_analytics_event_fields_to_json_buffer(event->agent_attributes, buf);
+  nr_buffer_add(buf, NR_PSTR("]"));
+  nr_buffer_add(buf, NR_PSTR("\0"));
+
+  event->json = nr_strdup(nr_buffer_cptr(buf));
+  nr_buffer_destroy(&buf);
+
+  nro_delete(event->builtin_fields);
+  nro_delete(event->user_attributes);
+  nro_delete(event->agent_attributes);
 }
 
 const char* nr_analytics_event_json(const nr_analytics_event_t* event) {
@@ -45,6 +112,21 @@ const char* nr_analytics_event_json(const nr_analytics_event_t* event) {
   return event->json;
 }
 
+static bool nr_analytics_event_fields_valid(const nrobj_t* builtin_fields,
+                                            const nrobj_t* agent_attributes,
+                                            const nrobj_t* user_attributes) {
+  if (builtin_fields && (NR_OBJECT_HASH != nro_type(builtin_fields))) {
+    return false;
+  }
+  if (agent_attributes && (NR_OBJECT_HASH != nro_type(agent_attributes))) {
+    return false;
+  }
+  if (user_attributes && (NR_OBJECT_HASH != nro_type(user_attributes))) {
+    return false;
+  }
+  return true;
+}
+
 nr_analytics_event_t* nr_analytics_event_create(
     const nrobj_t* builtin_fields,
     const nrobj_t* agent_attributes,
@@ -54,13 +136,8 @@ nr_analytics_event_t* nr_analytics_event_create(
   char* json;
   nrobj_t* empty_hash;
 
-  if (builtin_fields && (NR_OBJECT_HASH != nro_type(builtin_fields))) {
-    return 0;
-  }
-  if (agent_attributes && (NR_OBJECT_HASH != nro_type(agent_attributes))) {
-    return 0;
-  }
-  if (user_attributes && (NR_OBJECT_HASH != nro_type(user_attributes))) {
+  if (!nr_analytics_event_fields_valid(builtin_fields, agent_attributes,
+                                       user_attributes)) {
     return 0;
   }
 
@@ -88,7 +165,51 @@ nr_analytics_event_t* nr_analytics_event_create(
   return event;
 }
 
+nr_analytics_event_t* nr_analytics_event_create_deferred(
+    nrobj_t** builtin_fields_ptr,
+    nrobj_t** agent_attributes_ptr,
+    nrobj_t** user_attributes_ptr) {
+  nr_analytics_event_t* event;
+  nrobj_t* builtin_fields = builtin_fields_ptr ? *builtin_fields_ptr : NULL;
+  nrobj_t* agent_attributes
+      = agent_attributes_ptr ? *agent_attributes_ptr : NULL;
+  nrobj_t* user_attributes = user_attributes_ptr ? *user_attributes_ptr : NULL;
+
+  if (!nr_analytics_event_fields_valid(builtin_fields, agent_attributes,
+                                       user_attributes)) {
+    return 0;
+  }
+
+  event = (nr_analytics_event_t*)nr_zalloc(sizeof(nr_analytics_event_t));
+  event->builtin_fields = builtin_fields;
+  event->agent_attributes = agent_attributes;
+  event->user_attributes = user_attributes;
+
+  if (builtin_fields_ptr) {
+    *builtin_fields_ptr = NULL;
+  }
+  if (agent_attributes_ptr) {
+    *agent_attributes_ptr = NULL;
+  }
+  if (user_attributes_ptr) {
+    *user_attributes_ptr = NULL;
+  }
+
+  return event;
+}
+
 void nr_analytics_event_destroy(nr_analytics_event_t** event_ptr) {
+  nr_analytics_event_t* event;
+
+  if (0 == event_ptr || 0 == *event_ptr) {
+    return;
+  }
+  event = *event_ptr;
+
+  nr_free(event->json);
+  nro_delete(event->builtin_fields);
+  nro_delete(event->user_attributes);
+  nro_delete(event->agent_attributes);
   nr_realfree((void**)event_ptr);
 }
 
@@ -172,10 +293,55 @@ void nr_analytics_events_destroy(nr_analytics_events_t** events_ptr) {
   nr_realfree((void**)events_ptr);
 }
 
+/*
+ * Count an event as seen and decide where it would be stored.
+ *
+ * Returns the index of the slot the event should be stored in, or -1 if the
+ * event is to be dropped.  Slots at events_used are free; others hold an event
+ * which the new one replaces.
+ */
+static int nr_analytics_events_sample(nr_analytics_events_t* events,
+                                      nr_random_t* rnd) {
+  int replace_idx;
+
+  events->events_seen++;
+
+  if (!nr_analytics_events_is_sampling(events)) {
+    return events->events_used;
+  }
+
+  /*
+   * If the reservoir is full, we sample using the following sampling
+   * algorithm: http://xlinux.nist.gov/dads/HTML/reservoirSampling.html
+   */
+  replace_idx = nr_random_range(rnd, events->events_seen);
+
+  if ((replace_idx >= 0) && (replace_idx < events->events_allocated)) {
+    return replace_idx;
+  }
+  return -1;
+}
+
+/*
+ * Store an event in a slot returned by nr_analytics_events_sample(), taking
+ * ownership of it.
+ */
+static void nr_analytics_events_store(nr_analytics_events_t* events,
+                                      int idx,
+                                      nr_analytics_event_t* event) {
+  if (idx == events->events_used) {
+    events->events[idx] = event;
+    events->events_used++;
+  } else {
+    nr_analytics_event_destroy(&events->events[idx]);
+    events->events[idx] = event;
+  }
+}
+
 void nr_analytics_events_add_event(nr_analytics_events_t* events,
                                    const nr_analytics_event_t* event,
                                    nr_random_t* rnd) {
-  int replace_idx;
+  int idx;
 
   if (0 == events) {
     return;
@@ -184,23 +350,36 @@ void nr_analytics_events_add_event(nr_analytics_events_t* events,
     return;
   }
 
-  events->events_seen++;
+  idx = nr_analytics_events_sample(events, rnd);
+  if (idx < 0) {
+    return;
+  }
 
-  if (!nr_analytics_events_is_sampling(events)) {
-    events->events[events->events_used] = nr_analytics_event_duplicate(event);
-    events->events_used++;
-  } else {
-    /*
-     * If the reservoir is full, we sample using the following sampling
-     * algorithm: http://xlinux.nist.gov/dads/HTML/reservoirSampling.html
-     */
-    replace_idx = nr_random_range(rnd, events->events_seen);
+  nr_analytics_events_store(events, idx, nr_analytics_event_duplicate(event));
+}
+
+void nr_analytics_events_add_event_built(nr_analytics_events_t* events,
+                                         nr_analytics_event_builder_t builder,
+                                         void* userdata,
+                                         nr_random_t* rnd) {
+  int idx;
+  nr_analytics_event_t* event;
+
+  if (NULL == events || NULL == builder) {
+    return;
+  }
+
+  idx = nr_analytics_events_sample(events, rnd);
+  if (idx < 0) {
+    return;
+  }
 
-    if ((replace_idx >= 0) && (replace_idx < events->events_allocated)) {
-      nr_analytics_event_destroy(&events->events[replace_idx]);
-      events->events[replace_idx] = nr_analytics_event_duplicate(event);
-    }
+  event = builder(userdata);
+  if (NULL == event) {
+    return;
   }
+
+  nr_analytics_events_store(events, idx, event);
 }
 
 const char* nr_analytics_events_get_event_json(nr_analytics_events_t* events,
@@ -215,6 +394,7 @@ const char* nr_analytics_events_get_event_json(nr_analytics_events_t* events,
     return NULL;
   }
 
+  nr_analytics_event_serialize(events->events[i]);
   return nr_analytics_event_json(events->events[i]);
 }
 
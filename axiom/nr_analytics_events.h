@@ -41,6 +41,24 @@ nr_analytics_event_t* nr_analytics_event_create(const nrobj_t* builtin_fields,
                                                 const nrobj_t* agent_attributes,
                                                 const nrobj_t* user_attributes);
 
+/*
+ * Purpose : Create a new analytics event which is only serialised to JSON
+ *           when it is first read from an event pool with
+ *           nr_analytics_events_get_event_json().
+ *
+ * Params  : As for nr_analytics_event_create(), except that the hashes are
+ *           passed by reference and owned by the event, and are set to NULL.
+ *           Each may be NULL.  If any of them is not a hash, no event is
+ *           created and ownership is not taken.
+ *
+ * Notes   : nr_analytics_event_json() returns NULL for a deferred event that
+ *           has not been serialised yet.
+ */
+extern nr_analytics_event_t* nr_analytics_event_create_deferred(
+    nrobj_t** builtin_fields_ptr,
+    nrobj_t** agent_attributes_ptr,
+    nrobj_t** user_attributes_ptr);
+
 /*
  * Purpose : Destroy an analytics event, releasing all of its memory.
  *
@@ -111,7 +129,33 @@ extern void nr_analytics_events_add_event(nr_analytics_events_t* events,
                                           nr_random_t* rnd);
 
 /*
- * Purpose : Get event JSON from an event pool.
+ * Purpose : Build an event to be added to an event pool.
+ *
+ * Returns : A newly allocated event, which is owned by the event pool, or
+ *           NULL if no event could be built.
+ */
+typedef nr_analytics_event_t* (*nr_analytics_event_builder_t)(void* userdata);
+
+/*
+ * Purpose : Add an event to an event pool, building it only if the sampling
+ *           algorithm keeps it.
+ *
+ * Params  : 1. The event pool.
+ *           2. The function that builds the event.
+ *           3. Data passed to the builder.
+ *           4. The random number generator used for sampling.
+ *
+ * Notes   : The event is counted as seen whether or not it is built.  Events
+ *           that would not be kept cost no more than a random draw.
+ */
+extern void nr_analytics_events_add_event_built(
+    nr_analytics_events_t* events,
+    nr_analytics_event_builder_t builder,
+    void* userdata,
+    nr_random_t* rnd);
+
+/*
+ * Purpose : Get event JSON from an event pool, serialising deferred events.
  */
 extern const char* nr_analytics_events_get_event_json(
     nr_analytics_events_t* events,
@@ -11,6 +11,7 @@
 #include "nr_agent.h"
 #include "nr_app_private.h"
 #include "nr_commands.h"
+#include "util_hash.h"
 #include "util_logging.h"
 #include "util_memory.h"
 #include "util_sleep.h"
@@ -55,7 +56,8 @@ bool nr_app_consider_appinfo(nrapp_t* app, time_t now) {
  *
  * Returns : NR_SUCCESS if the app is a match, and NR_FAILURE otherwise.
  *
- * Locking : Assumes the application is locked.
+ * Locking : The compared fields never change once the application has been
+ *           created, so the application need not be locked.
  */
 nr_status_t nr_app_match(const nrapp_t* app, const nr_app_info_t* info) {
   if ((0 == app) || (NULL == info) || (0 == info->license)
@@ -124,6 +126,7 @@ void nr_app_destroy(nrapp_t** app_ptr) {
   nr_rules_destroy(&app->url_rules);
   nr_rules_destroy(&app->txn_rules);
   nr_segment_terms_destroy(&app->segment_terms);
+  nr_txn_name_cache_destroy(&app->txn_name_cache);
   nro_delete(app->connect_reply);
   nro_delete(app->security_policies);
   nr_random_destroy(&app->rnd);
@@ -139,13 +142,15 @@ nrapplist_t* nr_applist_create(void) {
   nr_status_t rv;
   nrapplist_t* applist = (nrapplist_t*)nr_zalloc(sizeof(nrapplist_t));
 
-  rv = nrt_mutex_init(&applist->applist_lock, 0);
+  rv = nrt_rwlock_init(&applist->applist_lock);
   if (NR_SUCCESS != rv) {
     return 0;
   }
 
   applist->num_apps = 0;
   applist->apps = (nrapp_t**)nr_calloc(NR_APP_LIMIT, sizeof(nrapp_t*));
+  applist->index = (nr_applist_index_entry_t*)nr_calloc(
+      NR_APPLIST_INDEX_SIZE, sizeof(nr_applist_index_entry_t));
 
   return applist;
 }
@@ -162,7 +167,7 @@ void nr_applist_destroy(nrapplist_t** applist_ptr) {
     return;
   }
 
-  nrt_mutex_lock(&applist->applist_lock);
+  nrt_rwlock_wrlock(&applist->applist_lock);
   {
     if (applist->apps) {
       for (i = 0; i < NR_APP_LIMIT; i++) {
@@ -174,10 +179,11 @@ void nr_applist_destroy(nrapplist_t** applist_ptr) {
       }
       nr_free(applist->apps);
     }
+    nr_free(applist->index);
   }
-  nrt_mutex_unlock(&applist->applist_lock);
+  nrt_rwlock_unlock(&applist->applist_lock);
 
-  nrt_mutex_destroy(&applist->applist_lock);
+  nrt_rwlock_destroy(&applist->applist_lock);
   nr_memset(applist, 0, sizeof(nrapplist_t));
   nr_realfree((void**)applist_ptr);
 }
@@ -194,7 +200,7 @@ nrapp_t* nr_app_verify_id(nrapplist_t* applist, const char* agent_run_id) {
     return NULL;
   }
 
-  nrt_mutex_lock(&applist->applist_lock);
+  nrt_rwlock_rdlock(&applist->applist_lock);
   {
     for (i = 0; i < applist->num_apps; i++) {
       app = applist->apps[i];
@@ -207,14 +213,14 @@ nrapp_t* nr_app_verify_id(nrapplist_t* applist, const char* agent_run_id) {
       {
         if ((NR_APP_OK == app->state)
             && (0 == nr_strcmp(agent_run_id, app->agent_run_id))) {
-          nrt_mutex_unlock(&applist->applist_lock);
+          nrt_rwlock_unlock(&applist->applist_lock);
           return app;
         }
       }
       nrt_mutex_unlock(&app->app_lock);
     }
   }
-  nrt_mutex_unlock(&applist->applist_lock);
+  nrt_rwlock_unlock(&applist->applist_lock);
 
   return NULL;
 }
@@ -275,6 +281,7 @@ static nrapp_t* create_new_app(const nr_app_info_t* info) {
   app->info.trace_observer_host = nr_strdup(info->trace_observer_host);
   app->info.trace_observer_port = info->trace_observer_port;
   app->info.span_queue_size = info->span_queue_size;
+  app->info.span_stream_count = info->span_stream_count;
   app->info.span_events_max_samples_stored
       = info->span_events_max_samples_stored;
   app->info.log_events_max_samples_stored = info->log_events_max_samples_stored;
@@ -283,6 +290,7 @@ static nrapp_t* create_new_app(const nr_app_info_t* info) {
   app->info.docker_id = nr_strdup(info->docker_id);
   app->rnd = nr_random_create();
   nr_random_seed_from_time(app->rnd);
+  app->txn_name_cache = nr_txn_name_cache_create(NR_APP_TXN_NAME_CACHE_SIZE);
 
   nrt_mutex_init(&app->app_lock, 0);
   nrt_mutex_lock(&app->app_lock);
@@ -339,9 +347,71 @@ static int nr_app_info_valid(const nr_app_info_t* info) {
   return 1;
 }
 
+/*
+ * Purpose : Hash the fields of an application's info that identify it, as
+ *           compared by nr_app_match().
+ */
+static uint32_t nr_app_info_hash(const nr_app_info_t* info) {
+  uint32_t hash;
+
+  hash = nr_mkhash(info->license, NULL);
+  hash = (hash * 31) ^ nr_mkhash(info->appname, NULL);
+  if (info->trace_observer_host) {
+    hash = (hash * 31) ^ nr_mkhash(info->trace_observer_host, NULL);
+  }
+  hash = (hash * 31) ^ info->trace_observer_port;
+
+  return hash;
+}
+
+/*
+ * Purpose : Find an application in the list's index.
+ *
+ * Returns : The unlocked application, or NULL if there is no match.
+ *
+ * Locking : Assumes the application list is locked for reading or writing.
+ */
+static nrapp_t* nr_applist_find(const nrapplist_t* applist,
+                                const nr_app_info_t* info,
+                                uint32_t hash) {
+  const uint32_t mask = NR_APPLIST_INDEX_SIZE - 1;
+  uint32_t i;
+
+  for (i = hash & mask; applist->index[i].app; i = (i + 1) & mask) {
+    if (hash == applist->index[i].hash
+        && NR_SUCCESS == nr_app_match(applist->index[i].app, info)) {
+      return applist->index[i].app;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Purpose : Add an application to the list.
+ *
+ * Locking : Assumes the application list is locked for writing.
+ */
+static void nr_applist_add(nrapplist_t* applist, nrapp_t* app, uint32_t hash) {
+  const uint32_t mask = NR_APPLIST_INDEX_SIZE - 1;
+  uint32_t i;
+
+  applist->apps[applist->num_apps] = app;
+  applist->num_apps += 1;
+
+  /* The index cannot fill up, since it is larger than NR_APP_LIMIT. */
+  i = hash & mask;
+  while (applist->index[i].app) {
+    i = (i + 1) & mask;
+  }
+  applist->index[i].hash = hash;
+  applist->index[i].app = app;
+}
+
 nrapp_t* nr_app_find_or_add_app(nrapplist_t* applist,
                                 const nr_app_info_t* info) {
-  nrapp_t* app = 0;
+  nrapp_t* app;
+  uint32_t hash;
 
   if (0 == nr_app_info_valid(info)) {
     return 0;
@@ -350,61 +420,50 @@ nrapp_t* nr_app_find_or_add_app(nrapplist_t* applist,
     return 0;
   }
 
-  nrt_mutex_lock(&applist->applist_lock);
-  {
-    int i;
-    int num_apps = applist->num_apps;
+  hash = nr_app_info_hash(info);
+
+  /*
+   * The common case is a known application, which only needs the list locked
+   * for reading. The application is locked before the list is released, and
+   * is returned locked.
+   */
+  nrt_rwlock_rdlock(&applist->applist_lock);
+  app = nr_applist_find(applist, info, hash);
+  if (app) {
+    nrt_mutex_lock(&app->app_lock);
+  }
+  nrt_rwlock_unlock(&applist->applist_lock);
 
+  if (NULL == app) {
     /*
-     * Search for the application.
+     * The app was not found and must be added if the app list is not full.
+     * Another thread may have added it since the search above.
      */
-    app = 0;
-    for (i = 0; i < num_apps; i++) {
-      nrapp_t* test_app = applist->apps[i];
-
-      if (0 != test_app) {
-        nrt_mutex_lock(&test_app->app_lock);
-        {
-          if (NR_SUCCESS == nr_app_match(test_app, info)) {
-            /*
-             * The app is returned locked.
-             */
-            app = test_app;
-            break;
-          }
-        }
-        nrt_mutex_unlock(&test_app->app_lock);
-      }
-    }
-
+    nrt_rwlock_wrlock(&applist->applist_lock);
+    app = nr_applist_find(applist, info, hash);
     if (app) {
-      /*
-       * A matching application was found in the loop above.
-       * Check that high security is set correctly.
-       * Note that it is impossible to have two applications with the same
-       * name and license but different high_security values:  New Relic's
-       * backend would reject one of the connections, since the account is
-       * either set to high security or not.
-       */
-      if (info->high_security != app->info.high_security) {
-        nr_app_log_high_security_mismatch(info->appname);
-        nrt_mutex_unlock(&app->app_lock);
-        app = 0;
-      }
+      nrt_mutex_lock(&app->app_lock);
+    } else if (applist->num_apps >= NR_APP_LIMIT) {
+      log_app_limit_hard(info->appname);
     } else {
-      /*
-       * The app was not found and must be added if the app list is not full.
-       */
-      if (num_apps >= NR_APP_LIMIT) {
-        log_app_limit_hard(info->appname);
-      } else {
-        app = create_new_app(info);
-        applist->apps[num_apps] = app;
-        applist->num_apps += 1;
-      }
+      app = create_new_app(info);
+      nr_applist_add(applist, app, hash);
     }
+    nrt_rwlock_unlock(&applist->applist_lock);
+  }
+
+  /*
+   * Check that high security is set correctly.
+   * Note that it is impossible to have two applications with the same
+   * name and license but different high_security values:  New Relic's
+   * backend would reject one of the connections, since the account is
+   * either set to high security or not.
+   */
+  if (app && info->high_security != app->info.high_security) {
+    nr_app_log_high_security_mismatch(info->appname);
+    nrt_mutex_unlock(&app->app_lock);
+    app = 0;
   }
-  nrt_mutex_unlock(&applist->applist_lock);
 
   return app;
 }
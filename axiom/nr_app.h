@@ -21,6 +21,7 @@
 #include "nr_app_harvest.h"
 #include "nr_rules.h"
 #include "nr_segment_terms.h"
+#include "nr_txn_name_cache.h"
 #include "util_random.h"
 #include "util_threads.h"
 
@@ -51,6 +52,12 @@
  */
 #define NR_APP_LIMIT 250
 
+/*
+ * The number of distinct transaction paths whose final names each
+ * application remembers. See nr_txn_name_cache.h.
+ */
+#define NR_APP_TXN_NAME_CACHE_SIZE 1024
+
 /*
  * The fields in nr_app_info_t come from local configuration.  This is the
  * information which is sent up to the collector during the connect command.
@@ -75,6 +82,8 @@ typedef struct _nr_app_info_t {
   char* trace_observer_host;       /* 8T trace observer host */
   uint16_t trace_observer_port;    /* 8T trace observer port */
   uint64_t span_queue_size;        /* 8T span queue size (for the daemon) */
+  uint16_t span_stream_count;      /* 8T number of gRPC streams (for the
+                                      daemon) */
   uint64_t span_events_max_samples_stored; /* maximum number of spans per min (for the
                                               daemon) */
   uint64_t log_events_max_samples_stored;  /* maximum number of log events per min (for
@@ -116,6 +125,10 @@ typedef struct _nrapp_t {
   nr_segment_terms_t*
       segment_terms; /* From New Relic backend - rules for transaction segment
                         terms. Only used by agent. */
+  nr_txn_name_cache_t* txn_name_cache; /* Results of applying the rules
+                                          above to recent paths. Must be
+                                          cleared when they change. Only used
+                                          by agent. */
   nrobj_t*
       connect_reply; /* From New Relic backend - Full connect command reply */
   nrobj_t* security_policies; /* from Daemon - full security policies map
@@ -137,10 +150,28 @@ typedef enum _nrapptype_t {
   NR_APP_OK = 1        /* The app is connected and valid */
 } nrapptype_t;
 
+/*
+ * The number of slots in the application list's hash index. This must be a
+ * power of two, and at least twice NR_APP_LIMIT to keep probe sequences short.
+ */
+#define NR_APPLIST_INDEX_SIZE 512
+
+typedef struct _nr_applist_index_entry_t {
+  uint32_t hash; /* Hash of the identifying fields; see nr_app_match() */
+  nrapp_t* app;  /* NULL for an empty slot */
+} nr_applist_index_entry_t;
+
+/*
+ * Applications are only ever added to the list, and are destroyed together
+ * with it. The fields compared by nr_app_match() are never changed once an
+ * application has been created, so the list may be searched while holding
+ * its lock for reading, without locking each application.
+ */
 typedef struct _nrapplist_t {
   int num_apps;
   nrapp_t** apps;
-  nrthread_mutex_t applist_lock;
+  nr_applist_index_entry_t* index; /* Open addressing, linear probing */
+  nrthread_rwlock_t applist_lock;
 } nrapplist_t;
 
 /*
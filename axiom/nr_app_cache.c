@@ -0,0 +1,498 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include <sys/mman.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "nr_app_cache.h"
+#include "util_errno.h"
+#include "util_hash.h"
+#include "util_logging.h"
+#include "util_memory.h"
+#include "util_strings.h"
+
+/*
+ * A slot in shared memory. The data holds the digest of the application's
+ * key, its agent run ID, connect reply and security policies, each followed
+ * by a NUL.
+ *
+ * Apart from sequence and validated, which are accessed atomically, the fields
+ * may only be trusted once the sequence has been checked after reading them.
+ *
+ * Slots are only used by processes running as the user that published them,
+ * so that a PHP-FPM pool cannot supply the connect reply, rules or security
+ * policies that another pool adopts.
+ */
+typedef struct _nr_app_cache_slot_t {
+  uint32_t sequence; /* 0 if the slot is empty, odd while it is written */
+  uint32_t hash;     /* Hash of the key */
+  uint32_t euid;     /* Effective user ID of the publisher */
+  int64_t validated; /* When the run ID was last confirmed; 0 if invalid */
+  uint64_t connect_timestamp;
+  uint64_t harvest_frequency;
+  uint32_t sampling_target;
+  uint32_t key_len;
+  uint32_t agent_run_id_len;
+  uint32_t connect_reply_len;
+  uint32_t security_policies_len;
+  char data[NR_APP_CACHE_SLOT_DATA_SIZE];
+} nr_app_cache_slot_t;
+
+struct _nr_app_cache_t {
+  nr_app_cache_slot_t* slots; /* NR_APP_CACHE_SLOTS slots of shared memory */
+  size_t size;                /* The size of the mapping */
+};
+
+nr_app_cache_t* nr_app_cache_create(void) {
+  nr_app_cache_t* cache;
+  size_t size = NR_APP_CACHE_SLOTS * sizeof(nr_app_cache_slot_t);
+  void* slots;
+
+  slots = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1,
+               0);
+  if (MAP_FAILED == slots) {
+    nrl_warning(NRL_INIT, "unable to map the shared application cache: %s",
+                nr_errno(errno));
+    return NULL;
+  }
+
+  cache = (nr_app_cache_t*)nr_zalloc(sizeof(nr_app_cache_t));
+  cache->slots = (nr_app_cache_slot_t*)slots;
+  cache->size = size;
+
+  return cache;
+}
+
+void nr_app_cache_destroy(nr_app_cache_t** cache_ptr) {
+  if ((NULL == cache_ptr) || (NULL == *cache_ptr)) {
+    return;
+  }
+
+  munmap((*cache_ptr)->slots, (*cache_ptr)->size);
+  nr_realfree((void**)cache_ptr);
+}
+
+/*
+ * Purpose : Build the key identifying an application: the fields compared by
+ *           nr_app_match(), together with the settings that the daemon uses
+ *           to tell applications apart and that change the connect reply.
+ *
+ * Returns : The hex encoded MD5 digest of those fields, so that the license
+ *           key and application name are not stored in the shared memory.
+ */
+static char* nr_app_cache_key(const nr_app_info_t* info) {
+  char* fields;
+  char* key;
+  unsigned char digest[16];
+  nr_status_t st;
+  size_t i;
+
+  if ((NULL == info) || (NULL == info->license) || (NULL == info->appname)) {
+    return NULL;
+  }
+
+  fields = nr_formatf(
+      "%s\n%s\n%s:%u\n%d\n%s", info->license, info->appname,
+      info->trace_observer_host ? info->trace_observer_host : "",
+      (unsigned)info->trace_observer_port, info->high_security,
+      info->security_policies_token ? info->security_policies_token : "");
+  st = nr_hash_md5(digest, fields, nr_strlen(fields));
+  nr_free(fields);
+  if (NR_SUCCESS != st) {
+    return NULL;
+  }
+
+  key = (char*)nr_malloc(sizeof(digest) * 2 + 1);
+  for (i = 0; i < sizeof(digest); i++) {
+    snprintf(key + (i * 2), 3, "%02x", (unsigned)digest[i]);
+  }
+
+  return key;
+}
+
+static uint32_t nr_app_cache_read_begin(const nr_app_cache_slot_t* slot) {
+  return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Returns : True if the slot was not written since nr_app_cache_read_begin()
+ *           returned the given sequence.
+ */
+static bool nr_app_cache_read_end(const nr_app_cache_slot_t* slot,
+                                  uint32_t sequence) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return sequence == __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+}
+
+static bool nr_app_cache_slot_stable(uint32_t sequence) {
+  return (0 != sequence) && (0 == (sequence & 1));
+}
+
+static bool nr_app_cache_slot_matches(const nr_app_cache_slot_t* slot,
+                                      const char* key,
+                                      uint32_t key_len,
+                                      uint32_t hash,
+                                      uint32_t euid) {
+  return (hash == slot->hash) && (euid == slot->euid)
+         && (key_len == slot->key_len)
+         && (0 == nr_memcmp(slot->data, key, key_len));
+}
+
+static bool nr_app_cache_is_fresh(time_t validated, time_t now) {
+  if (0 == validated) {
+    return false;
+  }
+  if (validated > now) {
+    return (validated - now) <= NR_APP_CACHE_MAX_AGE_SECONDS;
+  }
+  return (now - validated) <= NR_APP_CACHE_MAX_AGE_SECONDS;
+}
+
+/*
+ * Purpose : Choose the slot to publish a key in: the slot already holding it,
+ *           an empty slot, or the slot confirmed least recently, in that
+ *           order of preference.
+ */
+static nr_app_cache_slot_t* nr_app_cache_choose_slot(nr_app_cache_t* cache,
+                                                     const char* key,
+                                                     uint32_t key_len,
+                                                     uint32_t hash,
+                                                     uint32_t euid) {
+  nr_app_cache_slot_t* empty = NULL;
+  nr_app_cache_slot_t* oldest = NULL;
+  int64_t oldest_validated = 0;
+  size_t i;
+
+  for (i = 0; i < NR_APP_CACHE_SLOTS; i++) {
+    nr_app_cache_slot_t* slot = &cache->slots[i];
+    uint32_t sequence = nr_app_cache_read_begin(slot);
+    int64_t validated;
+
+    if (0 == sequence) {
+      if (NULL == empty) {
+        empty = slot;
+      }
+      continue;
+    }
+    if (sequence & 1) {
+      continue;
+    }
+
+    if (nr_app_cache_slot_matches(slot, key, key_len, hash, euid)
+        && nr_app_cache_read_end(slot, sequence)) {
+      return slot;
+    }
+
+    validated = __atomic_load_n(&slot->validated, __ATOMIC_RELAXED);
+    if ((NULL == oldest) || (validated < oldest_validated)) {
+      oldest = slot;
+      oldest_validated = validated;
+    }
+  }
+
+  return empty ? empty : oldest;
+}
+
+bool nr_app_cache_publish(nr_app_cache_t* cache,
+                          const nr_app_info_t* info,
+                          const nr_app_cache_entry_t* entry,
+                          time_t now) {
+  nr_app_cache_slot_t* slot;
+  char* key;
+  const char* security_policies;
+  size_t key_len;
+  size_t agent_run_id_len;
+  size_t security_policies_len;
+  size_t total;
+  uint32_t hash;
+  uint32_t euid;
+  uint32_t sequence;
+  char* data;
+
+  if ((NULL == cache) || (NULL == entry) || (NULL == entry->agent_run_id)
+      || (NULL == entry->connect_reply)) {
+    return false;
+  }
+
+  key = nr_app_cache_key(info);
+  if (NULL == key) {
+    return false;
+  }
+
+  security_policies = entry->security_policies ? entry->security_policies : "";
+  security_policies_len
+      = entry->security_policies ? entry->security_policies_len : 0;
+  key_len = nr_strlen(key);
+  agent_run_id_len = nr_strlen(entry->agent_run_id);
+  total = key_len + agent_run_id_len + entry->connect_reply_len
+          + security_policies_len + 4;
+  if (total > NR_APP_CACHE_SLOT_DATA_SIZE) {
+    nrl_debug(NRL_ACCT,
+              "connect reply too large for the shared application cache: "
+              "len=%zu",
+              entry->connect_reply_len);
+    nr_free(key);
+    return false;
+  }
+
+  hash = nr_mkhash(key, NULL);
+  euid = (uint32_t)geteuid();
+  slot = nr_app_cache_choose_slot(cache, key, (uint32_t)key_len, hash, euid);
+  if (NULL == slot) {
+    nr_free(key);
+    return false;
+  }
+
+  /*
+   * Claim the slot by making its sequence odd. If another process got there
+   * first, its entry is at least as recent as this one.
+   */
+  sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+  if ((sequence & 1)
+      || !__atomic_compare_exchange_n(&slot->sequence, &sequence,
+                                      sequence + 1, false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED)) {
+    nr_free(key);
+    return false;
+  }
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  slot->hash = hash;
+  slot->euid = euid;
+  slot->key_len = (uint32_t)key_len;
+  slot->agent_run_id_len = (uint32_t)agent_run_id_len;
+  slot->connect_reply_len = (uint32_t)entry->connect_reply_len;
+  slot->security_policies_len = (uint32_t)security_policies_len;
+  slot->connect_timestamp = entry->connect_timestamp;
+  slot->harvest_frequency = entry->harvest_frequency;
+  slot->sampling_target = entry->sampling_target;
+
+  data = slot->data;
+  nr_memcpy(data, key, key_len + 1);
+  data += key_len + 1;
+  nr_memcpy(data, entry->agent_run_id, agent_run_id_len + 1);
+  data += agent_run_id_len + 1;
+  nr_memcpy(data, entry->connect_reply, entry->connect_reply_len);
+  data[entry->connect_reply_len] = '\0';
+  data += entry->connect_reply_len + 1;
+  nr_memcpy(data, security_policies, security_policies_len);
+  data[security_policies_len] = '\0';
+
+  __atomic_store_n(&slot->validated, (int64_t)now, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+  nrl_debug(NRL_ACCT,
+            "published app=" NRP_FMT
+            " agent_run_id=%s to the shared application cache",
+            NRP_APPNAME(info->appname), entry->agent_run_id);
+
+  nr_free(key);
+  return true;
+}
+
+/*
+ * Purpose : Copy a slot into an entry.
+ *
+ * Returns : True if the slot was copied without being written to meanwhile.
+ */
+static bool nr_app_cache_slot_copy(const nr_app_cache_slot_t* slot,
+                                   uint32_t sequence,
+                                   nr_app_cache_entry_t* entry) {
+  size_t key_len = slot->key_len;
+  size_t agent_run_id_len = slot->agent_run_id_len;
+  size_t connect_reply_len = slot->connect_reply_len;
+  size_t security_policies_len = slot->security_policies_len;
+  size_t total = key_len + agent_run_id_len + connect_reply_len
+                 + security_policies_len + 4;
+  char* buffer;
+
+  if (total > NR_APP_CACHE_SLOT_DATA_SIZE) {
+    return false;
+  }
+
+  buffer = (char*)nr_malloc(total);
+  nr_memcpy(buffer, slot->data, total);
+  entry->connect_timestamp = slot->connect_timestamp;
+  entry->harvest_frequency = slot->harvest_frequency;
+  entry->sampling_target = (uint16_t)slot->sampling_target;
+  entry->validated
+      = (time_t)__atomic_load_n(&slot->validated, __ATOMIC_RELAXED);
+
+  if (!nr_app_cache_read_end(slot, sequence)) {
+    nr_free(buffer);
+    return false;
+  }
+
+  entry->buffer = buffer;
+  entry->agent_run_id = buffer + key_len + 1;
+  entry->connect_reply = entry->agent_run_id + agent_run_id_len + 1;
+  entry->connect_reply_len = connect_reply_len;
+  entry->security_policies = entry->connect_reply + connect_reply_len + 1;
+  entry->security_policies_len = security_policies_len;
+
+  return true;
+}
+
+bool nr_app_cache_lookup(nr_app_cache_t* cache,
+                         const nr_app_info_t* info,
+                         time_t now,
+                         nr_app_cache_entry_t* entry) {
+  char* key;
+  uint32_t key_len;
+  uint32_t hash;
+  uint32_t euid;
+  size_t i;
+
+  if (NULL == entry) {
+    return false;
+  }
+  nr_memset(entry, 0, sizeof(*entry));
+
+  if (NULL == cache) {
+    return false;
+  }
+
+  key = nr_app_cache_key(info);
+  if (NULL == key) {
+    return false;
+  }
+  key_len = (uint32_t)nr_strlen(key);
+  hash = nr_mkhash(key, NULL);
+  euid = (uint32_t)geteuid();
+
+  /*
+   * More than one slot may hold the same application if processes published
+   * it concurrently, in which case the most recently confirmed one is used.
+   */
+  for (i = 0; i < NR_APP_CACHE_SLOTS; i++) {
+    const nr_app_cache_slot_t* slot = &cache->slots[i];
+    uint32_t sequence = nr_app_cache_read_begin(slot);
+    nr_app_cache_entry_t candidate;
+    time_t validated;
+
+    if (!nr_app_cache_slot_stable(sequence)
+        || !nr_app_cache_slot_matches(slot, key, key_len, hash, euid)) {
+      continue;
+    }
+
+    validated = (time_t)__atomic_load_n(&slot->validated, __ATOMIC_RELAXED);
+    if (!nr_app_cache_is_fresh(validated, now)
+        || (entry->buffer && (validated <= entry->validated))) {
+      continue;
+    }
+
+    nr_memset(&candidate, 0, sizeof(candidate));
+    if (nr_app_cache_slot_copy(slot, sequence, &candidate)) {
+      nr_app_cache_entry_deinit(entry);
+      *entry = candidate;
+    }
+  }
+
+  nr_free(key);
+  return NULL != entry->buffer;
+}
+
+void nr_app_cache_validate(nr_app_cache_t* cache,
+                           const nr_app_info_t* info,
+                           const char* agent_run_id,
+                           time_t now) {
+  char* key;
+  uint32_t key_len;
+  uint32_t agent_run_id_len;
+  uint32_t hash;
+  uint32_t euid;
+  size_t i;
+
+  if ((NULL == cache) || (NULL == agent_run_id)) {
+    return;
+  }
+
+  key = nr_app_cache_key(info);
+  if (NULL == key) {
+    return;
+  }
+  key_len = (uint32_t)nr_strlen(key);
+  agent_run_id_len = (uint32_t)nr_strlen(agent_run_id);
+  hash = nr_mkhash(key, NULL);
+  euid = (uint32_t)geteuid();
+
+  for (i = 0; i < NR_APP_CACHE_SLOTS; i++) {
+    nr_app_cache_slot_t* slot = &cache->slots[i];
+    uint32_t sequence = nr_app_cache_read_begin(slot);
+
+    if (!nr_app_cache_slot_stable(sequence)
+        || !nr_app_cache_slot_matches(slot, key, key_len, hash, euid)
+        || (agent_run_id_len != slot->agent_run_id_len)
+        || (key_len + agent_run_id_len + 2 > NR_APP_CACHE_SLOT_DATA_SIZE)
+        || (0
+            != nr_memcmp(slot->data + key_len + 1, agent_run_id,
+                         agent_run_id_len))
+        || !nr_app_cache_read_end(slot, sequence)) {
+      continue;
+    }
+
+    __atomic_store_n(&slot->validated, (int64_t)now, __ATOMIC_RELAXED);
+  }
+
+  nr_free(key);
+}
+
+void nr_app_cache_invalidate(nr_app_cache_t* cache,
+                             const nr_app_info_t* info,
+                             time_t queried) {
+  char* key;
+  uint32_t key_len;
+  uint32_t hash;
+  uint32_t euid;
+  size_t i;
+
+  if (NULL == cache) {
+    return;
+  }
+
+  key = nr_app_cache_key(info);
+  if (NULL == key) {
+    return;
+  }
+  key_len = (uint32_t)nr_strlen(key);
+  hash = nr_mkhash(key, NULL);
+  euid = (uint32_t)geteuid();
+
+  for (i = 0; i < NR_APP_CACHE_SLOTS; i++) {
+    nr_app_cache_slot_t* slot = &cache->slots[i];
+    uint32_t sequence = nr_app_cache_read_begin(slot);
+    int64_t validated;
+
+    if (!nr_app_cache_slot_stable(sequence)
+        || !nr_app_cache_slot_matches(slot, key, key_len, hash, euid)
+        || !nr_app_cache_read_end(slot, sequence)) {
+      continue;
+    }
+
+    validated = __atomic_load_n(&slot->validated, __ATOMIC_RELAXED);
+    while ((0 != validated) && (validated < (int64_t)queried)) {
+      if (__atomic_compare_exchange_n(&slot->validated, &validated, 0, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    }
+  }
+
+  nr_free(key);
+}
+
+void nr_app_cache_entry_deinit(nr_app_cache_entry_t* entry) {
+  if (NULL == entry) {
+    return;
+  }
+
+  nr_free(entry->buffer);
+  nr_memset(entry, 0, sizeof(*entry));
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains a cache of connected applications that is shared by all
+ * of the processes forked from the one that created it.
+ *
+ * Web servers such as PHP-FPM and Apache fork worker processes, and recycle
+ * them regularly. Every new worker starts with an empty application list, and
+ * would otherwise have to send an APPINFO query to the daemon and parse the
+ * full connect reply before it could record its first transaction. Instead,
+ * the worker that receives a connect reply publishes it here, and workers
+ * forked later pick it up without querying the daemon.
+ *
+ * The cache lives in anonymous shared memory, so it must be created before the
+ * worker processes are forked. Each slot is protected by a sequence counter:
+ * the counter is odd while a writer updates the slot, and readers copy the
+ * slot out and then check that the counter did not change while they did so.
+ * Neither readers nor writers ever wait for one another.
+ *
+ * Every process forked from the creator can read and write the whole cache,
+ * even after switching to another user as PHP-FPM pools do. Applications are
+ * identified by a digest, so license keys and application names are not
+ * stored, but the agent run IDs and connect replies of every application are.
+ * Each entry records the effective user ID of the process that published it,
+ * and is only used by processes running as that user, so one pool's entries
+ * are never adopted by another. This separates pools that run as different
+ * users; it does not protect them from code that writes to the mapping
+ * directly.
+ */
+#ifndef NR_APP_CACHE_HDR
+#define NR_APP_CACHE_HDR
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "nr_app.h"
+#include "util_time.h"
+
+/*
+ * The number of applications that can be cached. Most hosts report to a
+ * single application, or a handful; when the cache is full, the application
+ * confirmed least recently is replaced.
+ */
+#define NR_APP_CACHE_SLOTS 8
+
+/*
+ * The space in each slot for the application's identity, agent run ID,
+ * connect reply and security policies. Larger connect replies are not cached.
+ * Pages of the shared memory are only allocated as slots are first written.
+ */
+#define NR_APP_CACHE_SLOT_DATA_SIZE (256 * 1024)
+
+/*
+ * Cached applications are only used if the daemon confirmed their agent run
+ * ID within this many seconds. Every process confirms its applications with
+ * the daemon periodically, and refreshes the cache when it does so.
+ */
+#define NR_APP_CACHE_MAX_AGE_SECONDS 60
+
+typedef struct _nr_app_cache_t nr_app_cache_t;
+
+/*
+ * A connected application. The strings are NUL terminated.
+ *
+ * When filled in by nr_app_cache_lookup(), the strings point into buffer,
+ * which is owned by the entry and freed by nr_app_cache_entry_deinit().
+ */
+typedef struct _nr_app_cache_entry_t {
+  const char* agent_run_id;
+  const char* connect_reply;     /* JSON */
+  size_t connect_reply_len;
+  const char* security_policies; /* JSON */
+  size_t security_policies_len;
+  nrtime_t connect_timestamp; /* See nr_app_harvest_t */
+  nrtime_t harvest_frequency;
+  uint16_t sampling_target;
+  time_t validated; /* When the daemon last confirmed the agent run ID */
+  char* buffer;
+} nr_app_cache_entry_t;
+
+/*
+ * Purpose : Create a shared application cache.
+ *
+ * Returns : A newly allocated cache, or NULL if the shared memory could not be
+ *           mapped.
+ *
+ * Notes   : Only processes forked after the cache is created share it.
+ */
+extern nr_app_cache_t* nr_app_cache_create(void);
+
+/*
+ * Purpose : Destroy a shared application cache, unmapping it from this
+ *           process. Other processes sharing it are not affected.
+ */
+extern void nr_app_cache_destroy(nr_app_cache_t** cache_ptr);
+
+/*
+ * Purpose : Publish a connected application.
+ *
+ * Params  : 1. The cache.
+ *           2. The application's local configuration, which identifies it.
+ *           3. The application's connect reply and harvest timing. The
+ *              validated field is ignored.
+ *           4. The current time.
+ *
+ * Returns : True if the application was published. This fails if the entry
+ *           is too large, or if another process is writing every slot it
+ *           could be stored in.
+ */
+extern bool nr_app_cache_publish(nr_app_cache_t* cache,
+                                 const nr_app_info_t* info,
+                                 const nr_app_cache_entry_t* entry,
+                                 time_t now);
+
+/*
+ * Purpose : Look up a connected application.
+ *
+ * Params  : 1. The cache.
+ *           2. The application's local configuration.
+ *           3. The current time. Entries confirmed more than
+ *              NR_APP_CACHE_MAX_AGE_SECONDS ago are ignored.
+ *           4. The entry to fill in. If the lookup succeeds, it must be
+ *              deinitialised with nr_app_cache_entry_deinit().
+ *
+ * Returns : True if a fresh entry published by a process with the same
+ *           effective user ID was found.
+ */
+extern bool nr_app_cache_lookup(nr_app_cache_t* cache,
+                                const nr_app_info_t* info,
+                                time_t now,
+                                nr_app_cache_entry_t* entry);
+
+/*
+ * Purpose : Record that the daemon has confirmed an application's agent run
+ *           ID. Cached entries with a different agent run ID are not changed.
+ */
+extern void nr_app_cache_validate(nr_app_cache_t* cache,
+                                  const nr_app_info_t* info,
+                                  const char* agent_run_id,
+                                  time_t now);
+
+/*
+ * Purpose : Stop other processes from using an application that the daemon no
+ *           longer considers connected.
+ *
+ * Params  : 1. The cache.
+ *           2. The application's local configuration.
+ *           3. The time the daemon was queried. Entries confirmed at or after
+ *              this time, which another process may have published while the
+ *              query was in flight, are kept.
+ */
+extern void nr_app_cache_invalidate(nr_app_cache_t* cache,
+                                    const nr_app_info_t* info,
+                                    time_t queried);
+
+/*
+ * Purpose : Free the buffer of an entry filled in by nr_app_cache_lookup().
+ */
+extern void nr_app_cache_entry_deinit(nr_app_cache_entry_t* entry);
+
+#endif /* NR_APP_CACHE_HDR */
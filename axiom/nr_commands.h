@@ -22,6 +22,10 @@
  *           immediately, otherwise the daemon will wake the connector thread
  *           in order to query RPM about the app.
  *
+ *           An application that is not yet connected is first looked up in
+ *           the shared application cache, nr_agent_app_cache; if another
+ *           process has already connected it, the daemon is not queried.
+ *
  * Params  : 1. Daemon file descriptor to send cmd to.
  *           2. The partially populated application.
  *
@@ -53,6 +57,41 @@ extern nr_status_t nr_cmd_span_batch_tx(
     const char* agent_run_id,
     const nr_span_encoding_result_t* encoded_batch);
 
+/*
+ * A TXNDATA encoder owns a flatbuffer that is reused for every transaction
+ * sent through it. The buffer is sized from a high-water mark of recent
+ * message sizes that decays over time, so that most transactions are encoded
+ * without reallocating, while a single large transaction doesn't pin a large
+ * buffer for the life of the process.
+ *
+ * Encoders may be shared by threads. A thread takes the buffer while it
+ * encodes and sends a message, without holding the encoder's lock; other
+ * threads sending meanwhile allocate buffers of their own.
+ */
+typedef struct _nr_txndata_encoder_t nr_txndata_encoder_t;
+
+typedef struct _nr_txndata_encoder_stats_t {
+  uint64_t messages; /* Messages encoded */
+  uint64_t reallocs; /* Times the buffer grew while encoding a message */
+  size_t capacity;   /* Bytes allocated for the buffer, if not in use */
+} nr_txndata_encoder_stats_t;
+
+extern nr_txndata_encoder_t* nr_txndata_encoder_create(void);
+
+extern void nr_txndata_encoder_destroy(nr_txndata_encoder_t** encoder_ptr);
+
+/*
+ * Purpose : Get the statistics of a TXNDATA encoder.
+ *
+ * Params  : 1. The encoder.
+ *           2. The statistics to fill in. The message and realloc counts are
+ *              those since the previous call to this function, and are reset.
+ *
+ * Returns : True if the statistics were filled in; false otherwise.
+ */
+extern bool nr_txndata_encoder_take_stats(nr_txndata_encoder_t* encoder,
+                                          nr_txndata_encoder_stats_t* stats);
+
 /*
  * Purpose : Given a transaction that is complete, send it to the daemon. All
  *           metrics that are not synthesised in the daemon must be present,
@@ -64,6 +103,10 @@ extern nr_status_t nr_cmd_span_batch_tx(
  *
  * Params  : 1. Daemon file descriptor to send cmd to.
  *           2. The transaction to send.
+ *           3. Optional encoder whose buffer is used to encode the message.
+ *              If NULL, a buffer is allocated for this message alone.
+ *           4. Optional overhead timers. If not NULL, the time spent
+ *              encoding and sending the message is recorded here.
  *
  * Returns : NR_SUCCESS or NR_FAILURE.
  *
@@ -71,7 +114,87 @@ extern nr_status_t nr_cmd_span_batch_tx(
  *           as only one thread in an agent can be dealing with a transaction
  *           at a time. Therefore, the transaction structure has no locking.
  */
-extern nr_status_t nr_cmd_txndata_tx(int daemon_fd, const nrtxn_t* txn);
+extern nr_status_t nr_cmd_txndata_tx(int daemon_fd,
+                                     const nrtxn_t* txn,
+                                     nr_txndata_encoder_t* encoder,
+                                     nr_overhead_t* overhead);
+
+/*
+ * A batch of finished transactions that are sent to the daemon in a single
+ * TXNDATA message. Long-running processes such as queue workers end many
+ * short transactions in quick succession; batching them amortises the
+ * daemon round trip and lets their metrics be aggregated before sending.
+ *
+ * Transactions are encoded as they are added, so a batch does not keep
+ * references to them.
+ */
+typedef struct _nr_txndata_batch_t nr_txndata_batch_t;
+
+/*
+ * Purpose : Create a transaction batch.
+ *
+ * Params  : 1. The maximum time a transaction may wait in the batch before
+ *              nr_txndata_batch_should_send() asks for the batch to be sent.
+ */
+extern nr_txndata_batch_t* nr_txndata_batch_create(nrtime_t max_age);
+
+extern void nr_txndata_batch_destroy(nr_txndata_batch_t** batch_ptr);
+
+/*
+ * Purpose : Discard all transactions in a batch.
+ */
+extern void nr_txndata_batch_reset(nr_txndata_batch_t* batch);
+
+/*
+ * Purpose : Add a finished transaction to a batch.
+ *
+ * Params  : 1. The batch.
+ *           2. The transaction.
+ *           3. The current time.
+ *
+ * Returns : true if the transaction was added. false if it cannot join the
+ *           batch, because it belongs to a different agent run or the batch
+ *           is full; the caller should send the batch and try again.
+ */
+extern bool nr_txndata_batch_add(nr_txndata_batch_t* batch,
+                                 const nrtxn_t* txn,
+                                 nrtime_t now);
+
+/*
+ * Purpose : Return the number of transactions in a batch.
+ */
+extern size_t nr_txndata_batch_count(const nr_txndata_batch_t* batch);
+
+/*
+ * Purpose : Determine whether a batch should be sent now.
+ *
+ * Params  : 1. The batch.
+ *           2. The maximum number of transactions in a batch.
+ *           3. The current time.
+ *
+ * Returns : true if the batch is not empty and has reached its maximum
+ *           number of transactions, size or age.
+ */
+extern bool nr_txndata_batch_should_send(const nr_txndata_batch_t* batch,
+                                         size_t max_txns,
+                                         nrtime_t now);
+
+/*
+ * Purpose : Send all transactions in a batch to the daemon.
+ *
+ * Params  : 1. Daemon file descriptor to send cmd to.
+ *           2. The batch. It is empty on return, whether or not sending
+ *              succeeded.
+ *           3. Optional overhead timers.
+ *
+ * Returns : NR_SUCCESS or NR_FAILURE.
+ *
+ * Notes   : Only daemons that advertise a transaction batch size in their
+ *           APPINFO reply understand this message.
+ */
+extern nr_status_t nr_cmd_txndata_batch_tx(int daemon_fd,
+                                           nr_txndata_batch_t* batch,
+                                           nr_overhead_t* overhead);
 
 /* Hook for stubbing APPINFO messages during testing. */
 extern nr_status_t (*nr_cmd_appinfo_hook)(int daemon_fd, nrapp_t* app);
@@ -9,6 +9,10 @@
 #ifndef NR_COMMANDS_PRIVATE_HDR
 #define NR_COMMANDS_PRIVATE_HDR
 
+#include <stdbool.h>
+
+#include "nr_commands.h"
+#include "nr_metric_names.h"
 #include "util_flatbuffers.h"
 
 /*
@@ -42,6 +46,7 @@ enum {
   MESSAGE_BODY_APP_REPLY = 2,
   MESSAGE_BODY_TXN = 3,
   MESSAGE_BODY_SPAN_BATCH = 4,
+  MESSAGE_BODY_TXN_BATCH = 5,
 };
 
 /* Generated from: table Message */
@@ -84,7 +89,8 @@ enum {
   APP_LOG_EVENTS_MAX_SAMPLES_STORED = 18,
   APP_CUSTOM_EVENTS_MAX_SAMPLES_STORED = 19,
   APP_DOCKER_ID = 20,
-  APP_NUM_FIELDS = 21,
+  APP_SPAN_STREAM_COUNT = 21,
+  APP_NUM_FIELDS = 22,
 };
 
 /* Generated from: table AppReply */
@@ -95,7 +101,9 @@ enum {
   APP_REPLY_FIELD_CONNECT_TIMESTAMP = 3,
   APP_REPLY_FIELD_HARVEST_FREQUENCY = 4,
   APP_REPLY_FIELD_SAMPLING_TARGET = 5,
-  APP_REPLY_NUM_FIELDS = 6,
+  APP_REPLY_FIELD_METRIC_NAME_IDS = 6,
+  APP_REPLY_FIELD_TXN_BATCH_SIZE = 7,
+  APP_REPLY_NUM_FIELDS = 8,
 };
 
 /* Generated from: table Transaction */
@@ -135,7 +143,8 @@ enum {
 enum {
   METRIC_FIELD_NAME = 0,
   METRIC_FIELD_DATA = 1,
-  METRIC_NUM_FIELDS = 2,
+  METRIC_FIELD_NAME_ID = 2,
+  METRIC_NUM_FIELDS = 3,
 };
 
 /* Generated from: struct MetricData */
@@ -180,6 +189,20 @@ enum {
   SPAN_BATCH_NUM_FIELDS = 2,
 };
 
+/* Generated from: table MetricGroup */
+enum {
+  METRIC_GROUP_FIELD_SCOPE = 0,
+  METRIC_GROUP_FIELD_METRICS = 1,
+  METRIC_GROUP_NUM_FIELDS = 2,
+};
+
+/* Generated from: table TransactionBatch */
+enum {
+  TXN_BATCH_FIELD_TRANSACTIONS = 0,
+  TXN_BATCH_FIELD_METRICS = 1,
+  TXN_BATCH_NUM_FIELDS = 2,
+};
+
 extern nr_flatbuffer_t* nr_appinfo_create_query(const char* agent_run_id,
                                                 const char* system_host_name,
                                                 const nr_app_info_t* info);
@@ -220,6 +243,79 @@ extern uint32_t nr_txndata_prepend_span_events(nr_flatbuffer_t* fb,
                                                nr_vector_t* span_events,
                                                size_t span_event_limit);
 
+/*
+ * Purpose : Encode a metric into the given flatbuffer.
+ *
+ * Params  : 1. The destination flatbuffer.
+ *           2. The table holding the metric.
+ *           3. The metric.
+ *           4. Whether the metric is scoped.
+ *           5. The metric name dictionary, or NULL to always send names.
+ *           6. A vector that names sent together with a new id are appended
+ *              to.
+ *
+ * Returns : The offset of the metric table in the flatbuffer.
+ */
+extern uint32_t nr_txndata_prepend_metric(nr_flatbuffer_t* fb,
+                                          const nrmtable_t* table,
+                                          const nrmetric_t* metric,
+                                          int scoped,
+                                          nr_metric_names_t* names,
+                                          nr_vector_t* defined);
+
+/*
+ * Purpose : Encode a transaction into the given flatbuffer.
+ *
+ * Params  : 1. The destination flatbuffer.
+ *           2. The transaction.
+ *           3. The process id to report.
+ *           4. Whether to encode the metrics of the transaction. Batched
+ *              transactions send their metrics separately.
+ *           5. The metric name dictionary, or NULL to always send names.
+ *           6. A vector that names sent together with a new id are appended
+ *              to.
+ *
+ * Returns : The offset of the transaction table in the flatbuffer.
+ */
+extern uint32_t nr_txndata_prepend_transaction(nr_flatbuffer_t* fb,
+                                               const nrtxn_t* txn,
+                                               int32_t pid,
+                                               bool with_metrics,
+                                               nr_metric_names_t* names,
+                                               nr_vector_t* defined);
+
 extern nr_flatbuffer_t* nr_txndata_encode(const nrtxn_t* txn);
 
+/*
+ * Purpose : Encode a transaction, sending metric names by id where the
+ *           daemon already knows them.
+ *
+ * Params  : 1. The transaction.
+ *           2. The metric name dictionary, or NULL to always send names.
+ *           3. A vector that names sent together with a new id are appended
+ *              to. These must be passed to nr_metric_names_commit() once the
+ *              message has been written.
+ */
+extern nr_flatbuffer_t* nr_txndata_encode_metric_names(
+    const nrtxn_t* txn,
+    nr_metric_names_t* names,
+    nr_vector_t* defined);
+
+/*
+ * Purpose : Finish the TXNDATA message for a transaction batch.
+ *
+ * Params  : 1. The batch.
+ *           2. The metric name dictionary, or NULL to always send names.
+ *           3. A vector that names sent together with a new id are appended
+ *              to. The names belong to the batch, so they must be committed
+ *              before the batch is reset.
+ *
+ * Returns : The message, which the caller must destroy, or NULL if the batch
+ *           is empty. The batch holds no transactions afterwards, but keeps
+ *           its metrics until it is reset.
+ */
+extern nr_flatbuffer_t* nr_txndata_batch_encode(nr_txndata_batch_t* batch,
+                                                nr_metric_names_t* names,
+                                                nr_vector_t* defined);
+
 #endif /* NR_COMMANDS_PRIVATE_HDR */
@@ -51,42 +51,61 @@ static int nr_custom_events_valid_event_type(const char* type) {
   return 1;
 }
 
-void nr_custom_events_add_event(nr_analytics_events_t* custom_events,
-                                const char* type,
-                                const nrobj_t* params,
-                                nrtime_t now,
-                                nr_random_t* rnd) {
+typedef struct _nr_custom_event_args_t {
+  const char* type;
+  const nrobj_t* params;
+  nrtime_t now;
+} nr_custom_event_args_t;
+
+/*
+ * Builds a custom event.  This is only called for events that the sampling
+ * algorithm keeps, and the event is only serialised if it survives until the
+ * transaction is sent.
+ */
+static nr_analytics_event_t* nr_custom_events_build(void* userdata) {
+  const nr_custom_event_args_t* args = (const nr_custom_event_args_t*)userdata;
   nrobj_t* intrinsics;
   nr_analytics_event_t* event;
   nrobj_t* validated;
   nr_attributes_t* atts;
 
-  if (NULL == params) {
-    return;
-  }
-  if (0 == nr_custom_events_valid_event_type(type)) {
-    return;
-  }
-
   intrinsics = nro_new_hash();
-  nro_set_hash_string(intrinsics, "type", type);
+  nro_set_hash_string(intrinsics, "type", args->type);
   nro_set_hash_double(intrinsics, "timestamp",
-                      ((double)now) / NR_TIME_DIVISOR_D);
+                      ((double)args->now) / NR_TIME_DIVISOR_D);
 
   /*
    * Custom events are not affected by attribute configuration.  However, we
    * use the attributes system here to validate/truncate the parameters.
    */
   atts = nr_attributes_create(NULL);
-  nro_iteratehash(params, nr_custom_events_iter, atts);
+  nro_iteratehash(args->params, nr_custom_events_iter, atts);
   validated
       = nr_attributes_user_to_obj(atts, NR_ATTRIBUTE_DESTINATION_TXN_EVENT);
 
-  event = nr_analytics_event_create(intrinsics, NULL, validated);
-  nr_analytics_events_add_event(custom_events, event, rnd);
+  event = nr_analytics_event_create_deferred(&intrinsics, NULL, &validated);
 
   nr_attributes_destroy(&atts);
-  nr_analytics_event_destroy(&event);
   nro_delete(intrinsics);
   nro_delete(validated);
+
+  return event;
+}
+
+void nr_custom_events_add_event(nr_analytics_events_t* custom_events,
+                                const char* type,
+                                const nrobj_t* params,
+                                nrtime_t now,
+                                nr_random_t* rnd) {
+  nr_custom_event_args_t args = {type, params, now};
+
+  if (NULL == params) {
+    return;
+  }
+  if (0 == nr_custom_events_valid_event_type(type)) {
+    return;
+  }
+
+  nr_analytics_events_add_event_built(custom_events, nr_custom_events_build,
+                                      &args, rnd);
 }
@@ -5,6 +5,7 @@
 
 #include "nr_axiom.h"
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -12,6 +13,7 @@
 
 #include "nr_distributed_trace.h"
 #include "nr_distributed_trace_private.h"
+#include "util_json_reader.h"
 #include "util_memory.h"
 #include "util_object.h"
 #include "util_regex.h"
@@ -70,14 +72,35 @@ nr_distributed_trace_t* nr_distributed_trace_create(void) {
   return dt;
 }
 
+/*
+ * Purpose : Move a string into a field, as set_dt_field() copies one: the
+ *           field is left NULL if the value is NULL or empty.
+ */
+static inline void take_dt_field(char** field, char** value) {
+  nr_free(*field);
+
+  if (!nr_strempty(*value)) {
+    *field = *value;
+    *value = NULL;
+  } else {
+    nr_free(*value);
+  }
+}
+
+static char* dup_hash_string(const nrobj_t* obj, const char* key) {
+  const char* value = nro_get_hash_string(obj, key, NULL);
+
+  return value ? nr_strdup(value) : NULL;
+}
+
 bool nr_distributed_trace_accept_inbound_payload(nr_distributed_trace_t* dt,
                                                  const nrobj_t* obj_payload,
                                                  const char* transport_type,
                                                  const char** error) {
+  nr_distributed_trace_inbound_payload_t inbound = {0};
   const nrobj_t* obj_payload_data;
   nr_status_t errp = NR_FAILURE;
-  nr_sampling_priority_t priority;
-  bool sampled;
+  bool rv;
 
   if (NULL != *error) {
     return false;
@@ -95,43 +118,74 @@ bool nr_distributed_trace_accept_inbound_payload(nr_distributed_trace_t* dt,
 
   obj_payload_data = nro_get_hash_hash(obj_payload, "d", NULL);
 
-  set_dt_field(&dt->inbound.type,
-               nro_get_hash_string(obj_payload_data, "ty", NULL));
-  set_dt_field(&dt->inbound.account_id,
-               nro_get_hash_string(obj_payload_data, "ac", NULL));
-  set_dt_field(&dt->inbound.app_id,
-               nro_get_hash_string(obj_payload_data, "ap", NULL));
-  set_dt_field(&dt->inbound.guid,
-               nro_get_hash_string(obj_payload_data, "id", NULL));
-  set_dt_field(&dt->inbound.txn_id,
-               nro_get_hash_string(obj_payload_data, "tx", NULL));
-  set_dt_field(&dt->trace_id,
-               nro_get_hash_string(obj_payload_data, "tr", NULL));
+  inbound.type = dup_hash_string(obj_payload_data, "ty");
+  inbound.account_id = dup_hash_string(obj_payload_data, "ac");
+  inbound.app_id = dup_hash_string(obj_payload_data, "ap");
+  inbound.guid = dup_hash_string(obj_payload_data, "id");
+  inbound.txn_id = dup_hash_string(obj_payload_data, "tx");
+  inbound.trace_id = dup_hash_string(obj_payload_data, "tr");
+  inbound.trusted_key = dup_hash_string(obj_payload_data, "tk");
+
+  inbound.priority = (nr_sampling_priority_t)nro_get_hash_double(
+      obj_payload_data, "pr", &errp);
+  inbound.has_priority = (NR_SUCCESS == errp);
+
+  inbound.sampled = nro_get_hash_boolean(obj_payload_data, "sa", &errp);
+  inbound.has_sampled = (NR_SUCCESS == errp);
+
+  inbound.timestamp = nro_get_hash_long(obj_payload_data, "ti", NULL);
+
+  rv = nr_distributed_trace_accept_parsed_inbound_payload(
+      dt, &inbound, transport_type, error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+
+  return rv;
+}
+
+bool nr_distributed_trace_accept_parsed_inbound_payload(
+    nr_distributed_trace_t* dt,
+    nr_distributed_trace_inbound_payload_t* inbound,
+    const char* transport_type,
+    const char** error) {
+  if (NULL != *error) {
+    return false;
+  }
+
+  if (NULL == dt) {
+    *error = NR_DISTRIBUTED_TRACE_ACCEPT_EXCEPTION;
+    return false;
+  }
+
+  if (NULL == inbound) {
+    *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
+    return false;
+  }
+
+  take_dt_field(&dt->inbound.type, &inbound->type);
+  take_dt_field(&dt->inbound.account_id, &inbound->account_id);
+  take_dt_field(&dt->inbound.app_id, &inbound->app_id);
+  take_dt_field(&dt->inbound.guid, &inbound->guid);
+  take_dt_field(&dt->inbound.txn_id, &inbound->txn_id);
+  take_dt_field(&dt->trace_id, &inbound->trace_id);
 
   /*
    * Keep the current priority if the priority in the inbound payload is
    * missing or invalid.
    */
-  priority = (nr_sampling_priority_t)nro_get_hash_double(obj_payload_data, "pr",
-                                                         &errp);
-  if (NR_SUCCESS == errp) {
-    dt->priority = priority;
+  if (inbound->has_priority) {
+    dt->priority = inbound->priority;
   }
 
   /*
    * Keep the current sampled flag if the sampled flag in the inbound payload is
    * missing or invalid.
    */
-  sampled = nro_get_hash_boolean(obj_payload_data, "sa", &errp);
-
-  if (NR_SUCCESS == errp) {
-    dt->sampled = sampled;
+  if (inbound->has_sampled) {
+    dt->sampled = inbound->sampled;
   }
 
   // Convert payload timestamp from MS to US.
-  dt->inbound.timestamp
-      = ((nrtime_t)nro_get_hash_long(obj_payload_data, "ti", NULL))
-        * NR_TIME_DIVISOR_MS;
+  dt->inbound.timestamp = ((nrtime_t)inbound->timestamp) * NR_TIME_DIVISOR_MS;
 
   nr_distributed_trace_inbound_set_transport_type(dt, transport_type);
   dt->inbound.set = true;
@@ -139,92 +193,297 @@ bool nr_distributed_trace_accept_inbound_payload(nr_distributed_trace_t* dt,
   return true;
 }
 
-nrobj_t* nr_distributed_trace_convert_payload_to_object(const char* payload,
-                                                        const char** error) {
-  nrobj_t* obj_payload;
-  const nrobj_t* obj_payload_version;
-  const nrobj_t* obj_payload_data;
-  const char* required_data_fields[] = {"ty", "ac", "ap", "tr", "ti"};
-  nr_status_t err;
-  nr_status_t tx_err;
-  size_t i = 0;
+/*
+ * The fields of the "d" object that must be present, as either a string or an
+ * integer, for a payload to be valid. At least one of "id" and "tx" must also
+ * be present as a string.
+ */
+#define NR_DT_FIELD_TY (1 << 0)
+#define NR_DT_FIELD_AC (1 << 1)
+#define NR_DT_FIELD_AP (1 << 2)
+#define NR_DT_FIELD_TR (1 << 3)
+#define NR_DT_FIELD_TI (1 << 4)
+
+static const struct {
+  const char* key;
+  size_t offset;
+  unsigned field;
+} nr_distributed_trace_payload_strings[] = {
+    {"ty", offsetof(nr_distributed_trace_inbound_payload_t, type),
+     NR_DT_FIELD_TY},
+    {"ac", offsetof(nr_distributed_trace_inbound_payload_t, account_id),
+     NR_DT_FIELD_AC},
+    {"ap", offsetof(nr_distributed_trace_inbound_payload_t, app_id),
+     NR_DT_FIELD_AP},
+    {"id", offsetof(nr_distributed_trace_inbound_payload_t, guid), 0},
+    {"tx", offsetof(nr_distributed_trace_inbound_payload_t, txn_id), 0},
+    {"tr", offsetof(nr_distributed_trace_inbound_payload_t, trace_id),
+     NR_DT_FIELD_TR},
+    {"tk", offsetof(nr_distributed_trace_inbound_payload_t, trusted_key), 0},
+};
+
+/*
+ * Read the "d" object of a payload. As with an nrobj, a later "d" replaces an
+ * earlier one, and a later field replaces an earlier field with the same key.
+ */
+static void nr_distributed_trace_parse_payload_data(
+    nr_json_reader_t* reader,
+    nr_distributed_trace_inbound_payload_t* inbound,
+    unsigned* present) {
+  nr_json_string_t key;
+  nr_json_number_t num;
+  size_t i;
+
+  nr_distributed_trace_inbound_payload_deinit(inbound);
+  *present = 0;
+
+  if (NR_JSON_OBJECT != nr_json_reader_peek(reader)) {
+    nr_json_reader_skip(reader);
+    return;
+  }
+
+  nr_json_reader_begin_object(reader);
+  while (nr_json_reader_next_member(reader, &key)) {
+    nr_json_type_t type = nr_json_reader_peek(reader);
+
+    for (i = 0; i < sizeof(nr_distributed_trace_payload_strings)
+                        / sizeof(nr_distributed_trace_payload_strings[0]);
+         i++) {
+      if (nr_json_string_equals(&key,
+                                nr_distributed_trace_payload_strings[i].key)) {
+        break;
+      }
+    }
+
+    if (i < sizeof(nr_distributed_trace_payload_strings)
+                / sizeof(nr_distributed_trace_payload_strings[0])) {
+      char** field
+          = (char**)((char*)inbound
+                     + nr_distributed_trace_payload_strings[i].offset);
+      unsigned bit = nr_distributed_trace_payload_strings[i].field;
+      nr_json_string_t str;
+
+      nr_free(*field);
+      *present &= ~bit;
+      if (NR_JSON_STRING == type) {
+        if (nr_json_reader_read_string(reader, &str)) {
+          *field = nr_json_string_dup(&str);
+          *present |= bit;
+        }
+      } else if (NR_JSON_NUMBER == type) {
+        if (nr_json_reader_read_number(reader, &num) && !num.is_double) {
+          *present |= bit;
+        }
+      } else {
+        nr_json_reader_skip(reader);
+      }
+    } else if (nr_json_string_equals(&key, "pr")) {
+      inbound->has_priority = false;
+      if (NR_JSON_NUMBER != type) {
+        nr_json_reader_skip(reader);
+      } else if (nr_json_reader_read_number(reader, &num) && num.is_double) {
+        inbound->priority = (nr_sampling_priority_t)num.dval;
+        inbound->has_priority = true;
+      }
+    } else if (nr_json_string_equals(&key, "sa")) {
+      inbound->has_sampled = false;
+      if (NR_JSON_BOOLEAN == type) {
+        inbound->has_sampled
+            = nr_json_reader_read_boolean(reader, &inbound->sampled);
+      } else {
+        nr_json_reader_skip(reader);
+      }
+    } else if (nr_json_string_equals(&key, "ti")) {
+      inbound->timestamp = -1;
+      *present &= ~NR_DT_FIELD_TI;
+      if (NR_JSON_NUMBER == type) {
+        if (nr_json_reader_read_number(reader, &num) && !num.is_double) {
+          inbound->timestamp = num.lval;
+          *present |= NR_DT_FIELD_TI;
+        }
+      } else {
+        if (NR_JSON_STRING == type) {
+          *present |= NR_DT_FIELD_TI;
+        }
+        nr_json_reader_skip(reader);
+      }
+    } else {
+      nr_json_reader_skip(reader);
+    }
+  }
+}
+
+/*
+ * Read the "v" array of a payload, returning the major version, or -1 if the
+ * major version is not an int.
+ */
+static int nr_distributed_trace_parse_payload_version(
+    nr_json_reader_t* reader) {
+  nr_json_number_t num;
+  int major = -1;
+  bool first = true;
+
+  nr_json_reader_begin_array(reader);
+  while (nr_json_reader_next_element(reader)) {
+    if (first && (NR_JSON_NUMBER == nr_json_reader_peek(reader))) {
+      if (nr_json_reader_read_number(reader, &num) && !num.is_double
+          && (num.lval > INT_MIN) && (num.lval < INT_MAX)) {
+        major = (int)num.lval;
+      }
+    } else {
+      nr_json_reader_skip(reader);
+    }
+    first = false;
+  }
+
+  return major;
+}
+
+bool nr_distributed_trace_parse_inbound_payload(
+    const char* payload,
+    nr_distributed_trace_inbound_payload_t* inbound,
+    const char** error) {
+  nr_json_reader_t reader;
+  nr_json_string_t key;
+  bool has_version = false;
+  int major = -1;
+  unsigned present = 0;
+  size_t i;
+
+  if (NULL == inbound) {
+    return false;
+  }
+  nr_memset(inbound, 0, sizeof(*inbound));
+  inbound->timestamp = -1;
 
   if (NULL != *error) {
-    return NULL;
+    return false;
   }
 
   if (nr_strempty(payload)) {
     *error = NR_DISTRIBUTED_TRACE_ACCEPT_NULL;
-    return NULL;
+    return false;
   }
 
-  obj_payload = nro_create_from_json(payload);
+  nr_json_reader_init(&reader, payload);
+  if (NR_JSON_OBJECT == nr_json_reader_peek(&reader)) {
+    nr_json_reader_begin_object(&reader);
+    while (nr_json_reader_next_member(&reader, &key)) {
+      if (nr_json_string_equals(&key, "v")) {
+        has_version = (NR_JSON_ARRAY == nr_json_reader_peek(&reader));
+        if (has_version) {
+          major = nr_distributed_trace_parse_payload_version(&reader);
+        } else {
+          nr_json_reader_skip(&reader);
+        }
+      } else if (nr_json_string_equals(&key, "d")) {
+        nr_distributed_trace_parse_payload_data(&reader, inbound, &present);
+      } else {
+        nr_json_reader_skip(&reader);
+      }
+    }
+  } else {
+    nr_json_reader_skip(&reader);
+  }
 
-  if (NULL == obj_payload) {
+  if (!nr_json_reader_end(&reader)) {
     *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
-    return NULL;
+    goto failure;
   }
 
-  obj_payload_version = nro_get_hash_array(obj_payload, "v", NULL);
-
   // Version missing
-  if (NULL == obj_payload_version) {
+  if (!has_version) {
     nrl_debug(NRL_CAT,
               "Inbound distributed tracing payload invalid. Missing version.");
-    nro_delete(obj_payload);
     *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
-    return NULL;
+    goto failure;
   }
 
   // Compare version major
-  if (nro_get_array_int(obj_payload_version, 1, NULL)
-      > NR_DISTRIBUTED_TRACE_VERSION_MAJOR) {
+  if (major > NR_DISTRIBUTED_TRACE_VERSION_MAJOR) {
     nrl_debug(
         NRL_CAT,
         "Inbound distributed tracing payload invalid. Unexpected version: the "
         "maximum version supported is %d, but the payload has version %d.",
-        NR_DISTRIBUTED_TRACE_VERSION_MAJOR,
-        nro_get_array_int(obj_payload_version, 1, NULL));
-    nro_delete(obj_payload);
+        NR_DISTRIBUTED_TRACE_VERSION_MAJOR, major);
     *error = NR_DISTRIBUTED_TRACE_ACCEPT_MAJOR_VERSION;
-    return NULL;
+    goto failure;
   }
 
-  obj_payload_data = nro_get_hash_hash(obj_payload, "d", NULL);
-
   // Check that at least one of guid or transactionId are present
-  nro_get_hash_string(obj_payload_data, "tx", &tx_err);
-  nro_get_hash_string(obj_payload_data, "id", &err);
-  if (NR_FAILURE == err && NR_FAILURE == tx_err) {
+  if (NULL == inbound->guid && NULL == inbound->txn_id) {
     nrl_debug(
         NRL_CAT,
         "Inbound distributed tracing payload format invalid. Missing both "
         "guid (d.id) and transactionId (d.tx).");
     *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
-    nro_delete(obj_payload);
-    return NULL;
+    goto failure;
   }
 
   // Check required fields for their key presence
-  for (i = 0;
-       i < sizeof(required_data_fields) / sizeof(required_data_fields[0]);
+  for (i = 0; i < sizeof(nr_distributed_trace_payload_strings)
+                      / sizeof(nr_distributed_trace_payload_strings[0]);
        i++) {
-    nro_get_hash_string(obj_payload_data, required_data_fields[i], &err);
-    if (NR_FAILURE == err) {
-      nro_get_hash_long(obj_payload_data, required_data_fields[i], &err);
-      if (NR_FAILURE == err) {
-        nrl_debug(NRL_CAT,
-                  "Inbound distributed tracing payload format invalid. "
-                  "Missing field '%s'",
-                  required_data_fields[i]);
-        *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
-        nro_delete(obj_payload);
-        return NULL;
-      }
+    unsigned bit = nr_distributed_trace_payload_strings[i].field;
+
+    if (bit && !(present & bit)) {
+      nrl_debug(NRL_CAT,
+                "Inbound distributed tracing payload format invalid. "
+                "Missing field '%s'",
+                nr_distributed_trace_payload_strings[i].key);
+      *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
+      goto failure;
     }
   }
+  if (!(present & NR_DT_FIELD_TI)) {
+    nrl_debug(NRL_CAT,
+              "Inbound distributed tracing payload format invalid. "
+              "Missing field '%s'",
+              "ti");
+    *error = NR_DISTRIBUTED_TRACE_ACCEPT_PARSE_EXCEPTION;
+    goto failure;
+  }
+
+  return true;
+
+failure:
+  nr_distributed_trace_inbound_payload_deinit(inbound);
+  return false;
+}
+
+void nr_distributed_trace_inbound_payload_deinit(
+    nr_distributed_trace_inbound_payload_t* inbound) {
+  if (NULL == inbound) {
+    return;
+  }
+
+  nr_free(inbound->type);
+  nr_free(inbound->account_id);
+  nr_free(inbound->app_id);
+  nr_free(inbound->guid);
+  nr_free(inbound->txn_id);
+  nr_free(inbound->trace_id);
+  nr_free(inbound->trusted_key);
+  nr_memset(inbound, 0, sizeof(*inbound));
+  inbound->timestamp = -1;
+}
+
+nrobj_t* nr_distributed_trace_convert_payload_to_object(const char* payload,
+                                                        const char** error) {
+  nr_distributed_trace_inbound_payload_t inbound;
+  bool valid;
+
+  /*
+   * Validate with the pull parser, so that both forms of the payload accept
+   * exactly the same input.
+   */
+  valid = nr_distributed_trace_parse_inbound_payload(payload, &inbound, error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+  if (!valid) {
+    return NULL;
+  }
 
-  return obj_payload;
+  return nro_create_from_json(payload);
 }
 
 void nr_distributed_trace_destroy(nr_distributed_trace_t** ptr) {
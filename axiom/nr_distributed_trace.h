@@ -7,6 +7,7 @@
 #define NR_DISTRIBUTED_TRACE_HDR
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "util_sampling.h"
 #include "util_time.h"
@@ -60,6 +61,27 @@ static const char NR_DISTRIBUTED_TRACE_W3C_TRACECONTEXT_ACCEPT_EXCEPTION[]
 typedef struct _nr_distributed_trace_t nr_distributed_trace_t;
 typedef struct _nr_distributed_trace_payload_t nr_distributed_trace_payload_t;
 
+/*
+ * Purpose : The fields of an inbound newrelic distributed trace payload, as
+ *           extracted by nr_distributed_trace_parse_inbound_payload(). String
+ *           fields are owned by the struct, and are NULL if the field is
+ *           missing or is not a string.
+ */
+typedef struct _nr_distributed_trace_inbound_payload_t {
+  char* type;        /* d.ty */
+  char* account_id;  /* d.ac */
+  char* app_id;      /* d.ap */
+  char* guid;        /* d.id */
+  char* txn_id;      /* d.tx */
+  char* trace_id;    /* d.tr */
+  char* trusted_key; /* d.tk */
+  nr_sampling_priority_t priority; /* d.pr, if has_priority is set */
+  bool has_priority;
+  bool sampled; /* d.sa, if has_sampled is set */
+  bool has_sampled;
+  int64_t timestamp; /* d.ti in milliseconds, or -1 if it is not an integer */
+} nr_distributed_trace_inbound_payload_t;
+
 /*
  * Purpose : Creates/allocates a new distributed tracing metadata struct
  *           instance.  It's the responsibility of the caller to
@@ -94,6 +116,53 @@ bool nr_distributed_trace_accept_inbound_payload(nr_distributed_trace_t* dt,
                                                  const char* transport_type,
                                                  const char** error);
 
+/*
+ * Purpose : Accepts an inbound distributed trace from a payload parsed by
+ *           nr_distributed_trace_parse_inbound_payload(). The string fields of
+ *           the payload are moved into the distributed trace; the caller must
+ *           still deinitialise the payload.
+ *
+ * Params  : 1. A properly allocated distributed trace
+ *           2. The parsed payload
+ *           3. The transport type of the payload, as for
+ *              nr_distributed_trace_accept_inbound_payload().
+ *           4. An error string to be populated if an error occurs
+ *
+ * Returns : True on success, otherwise return false with a populated error
+ *           string detailing the supportability metric name to report by the
+ *           caller.
+ */
+extern bool nr_distributed_trace_accept_parsed_inbound_payload(
+    nr_distributed_trace_t* dt,
+    nr_distributed_trace_inbound_payload_t* inbound,
+    const char* transport_type,
+    const char** error);
+
+/*
+ * Purpose : Accepts a JSON payload, and validates the payload and format as
+ *           nr_distributed_trace_convert_payload_to_object() does, but reads
+ *           the fields directly into a struct rather than building an nrobj.
+ *
+ * Params  : 1. A JSON payload
+ *           2. The struct to populate. It is always initialised, and must be
+ *              deinitialised with nr_distributed_trace_inbound_payload_deinit()
+ *              whether or not parsing succeeds.
+ *           3. An error string to be populated if an error occurs
+ *
+ * Returns : True on success, otherwise false with a populated error string
+ *           detailing the supportability metric name to report by the caller.
+ */
+extern bool nr_distributed_trace_parse_inbound_payload(
+    const char* payload,
+    nr_distributed_trace_inbound_payload_t* inbound,
+    const char** error);
+
+/*
+ * Purpose : Free the fields of a parsed inbound payload.
+ */
+extern void nr_distributed_trace_inbound_payload_deinit(
+    nr_distributed_trace_inbound_payload_t* inbound);
+
 /*
  * Purpose : Accepts a JSON payload, validates the payload and format, and
  *           returns an nrobj version of that payload.
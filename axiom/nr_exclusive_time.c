@@ -124,6 +124,65 @@ bool nr_exclusive_time_add_child(nr_exclusive_time_t* parent_et,
   return true;
 }
 
+bool nr_exclusive_time_append_child(nr_exclusive_time_t** et_ptr,
+                                    nrtime_t start_time,
+                                    nrtime_t stop_time) {
+  nr_exclusive_time_t* et;
+
+  if (NULL == et_ptr) {
+    return false;
+  }
+
+  if (NULL == *et_ptr) {
+    (*et_ptr) = nr_exclusive_time_create(1, 0, 0);
+  }
+
+  et = *et_ptr;
+
+  /*
+   * Roughly double the capacity when the structure is full, by asking for
+   * room for one more child than currently fits.
+   */
+  if ((et->transitions.used + 2) > et->transitions.capacity) {
+    size_t child_segments = (et->transitions.capacity / 2) + 1;
+
+    if (!nr_exclusive_time_ensure(et_ptr, child_segments, et->start_time,
+                                  et->stop_time)) {
+      return false;
+    }
+  }
+
+  return nr_exclusive_time_add_child(*et_ptr, start_time, stop_time);
+}
+
+bool nr_exclusive_time_add_children(nr_exclusive_time_t** et_ptr,
+                                    const nr_exclusive_time_t* src) {
+  nr_exclusive_time_t* et;
+  size_t used;
+
+  if (NULL == et_ptr || NULL == *et_ptr) {
+    return false;
+  }
+
+  if (NULL == src) {
+    return true;
+  }
+
+  used = src->transitions.used;
+  if (!nr_exclusive_time_ensure(et_ptr, used / 2, (*et_ptr)->start_time,
+                                (*et_ptr)->stop_time)) {
+    return false;
+  }
+
+  et = *et_ptr;
+  nr_memcpy(&et->transitions.transitions[et->transitions.used],
+            src->transitions.transitions,
+            sizeof(nr_exclusive_time_transition_t) * used);
+  et->transitions.used += used;
+
+  return true;
+}
+
 int nr_exclusive_time_transition_compare(
     const nr_exclusive_time_transition_t* a,
     const nr_exclusive_time_transition_t* b,
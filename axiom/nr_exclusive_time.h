@@ -93,4 +93,39 @@ extern bool nr_exclusive_time_ensure(nr_exclusive_time_t** et_ptr,
                                      nrtime_t start_time,
                                      nrtime_t stop_time);
 
+/*
+ * Purpose : Add a child period to an exclusive time structure, growing the
+ *           structure if it is full.
+ *
+ *           Unlike nr_exclusive_time_add_child(), this does not require the
+ *           number of children to be known up front. The capacity is doubled
+ *           whenever it runs out, so adding many children one at a time stays
+ *           cheap.
+ *
+ * Params  : 1. The address of an exclusive time structure. If this is NULL, a
+ *              new exclusive time structure with start and stop times of 0
+ *              will be allocated; use nr_exclusive_time_ensure() to set them
+ *              before calculating.
+ *           2. The start time of the child segment.
+ *           3. The stop time of the child segment.
+ *
+ * Returns : True on success; false otherwise.
+ */
+extern bool nr_exclusive_time_append_child(nr_exclusive_time_t** et_ptr,
+                                           nrtime_t start_time,
+                                           nrtime_t stop_time);
+
+/*
+ * Purpose : Add every child period of one exclusive time structure to another.
+ *
+ * Params  : 1. The address of the exclusive time structure to add to. It is
+ *              resized if needed.
+ *           2. The exclusive time structure to copy child periods from. Its
+ *              start and stop times are ignored.
+ *
+ * Returns : True on success; false otherwise.
+ */
+extern bool nr_exclusive_time_add_children(nr_exclusive_time_t** et_ptr,
+                                           const nr_exclusive_time_t* src);
+
 #endif /* NR_EXCLUSIVE_TIME_HDR */
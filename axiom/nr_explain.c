@@ -14,6 +14,9 @@
 #include "nr_explain_private.h"
 #include "util_memory.h"
 #include "util_object.h"
+#include "util_vector.h"
+
+#define NR_EXPLAIN_CACHE_BUDGET_WINDOW (60 * NR_TIME_DIVISOR)
 
 nr_explain_plan_t* nr_explain_plan_create(void) {
   nr_explain_plan_t* plan = NULL;
@@ -44,6 +47,20 @@ void nr_explain_plan_destroy(nr_explain_plan_t** plan_ptr) {
   nr_realfree((void**)plan_ptr);
 }
 
+nr_explain_plan_t* nr_explain_plan_duplicate(const nr_explain_plan_t* plan) {
+  nr_explain_plan_t* dup;
+
+  if (NULL == plan) {
+    return NULL;
+  }
+
+  dup = (nr_explain_plan_t*)nr_zalloc(sizeof(nr_explain_plan_t));
+  dup->columns = nro_copy(plan->columns);
+  dup->rows = nro_copy(plan->rows);
+
+  return dup;
+}
+
 int nr_explain_plan_column_count(const nr_explain_plan_t* plan) {
   if (NULL == plan) {
     return 0;
@@ -105,3 +122,193 @@ nrobj_t* nr_explain_plan_to_object(const nr_explain_plan_t* plan) {
 
   return obj;
 }
+
+static void nr_explain_cache_entry_destroy(void* value) {
+  nr_explain_cache_entry_t* entry = (nr_explain_cache_entry_t*)value;
+
+  if (NULL == entry) {
+    return;
+  }
+
+  nr_explain_plan_destroy(&entry->plan);
+  nr_free(entry);
+}
+
+nr_explain_cache_t* nr_explain_cache_create(size_t max_plans,
+                                            nrtime_t ttl,
+                                            uint64_t max_explains_per_minute) {
+  nr_explain_cache_t* cache;
+
+  if (0 == max_plans) {
+    ttl = 0;
+  }
+
+  if (0 == ttl && 0 == max_explains_per_minute) {
+    return NULL;
+  }
+
+  cache = (nr_explain_cache_t*)nr_zalloc(sizeof(nr_explain_cache_t));
+  nrt_mutex_init(&cache->lock, 0);
+  cache->entries = nr_hashmap_create(nr_explain_cache_entry_destroy);
+  cache->max_plans = max_plans;
+  cache->ttl = ttl;
+  cache->max_explains_per_minute = max_explains_per_minute;
+
+  return cache;
+}
+
+void nr_explain_cache_destroy(nr_explain_cache_t** cache_ptr) {
+  nr_explain_cache_t* cache;
+
+  if (NULL == cache_ptr || NULL == *cache_ptr) {
+    return;
+  }
+
+  cache = *cache_ptr;
+  nr_hashmap_destroy(&cache->entries);
+  nrt_mutex_destroy(&cache->lock);
+  nr_realfree((void**)cache_ptr);
+}
+
+nr_explain_plan_t* nr_explain_cache_get(nr_explain_cache_t* cache,
+                                        uint32_t sql_id,
+                                        nrtime_t now) {
+  nr_explain_cache_entry_t* entry;
+  nr_explain_plan_t* plan = NULL;
+
+  if (NULL == cache || 0 == cache->ttl) {
+    return NULL;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  entry = (nr_explain_cache_entry_t*)nr_hashmap_index_get(cache->entries,
+                                                          sql_id);
+  if (NULL != entry) {
+    if (now < entry->expires) {
+      plan = nr_explain_plan_duplicate(entry->plan);
+    } else {
+      nr_hashmap_index_delete(cache->entries, sql_id);
+    }
+  }
+  nrt_mutex_unlock(&cache->lock);
+
+  return plan;
+}
+
+bool nr_explain_cache_allow(nr_explain_cache_t* cache, nrtime_t now) {
+  bool allowed = true;
+
+  if (NULL == cache || 0 == cache->max_explains_per_minute) {
+    return true;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  if (now < cache->window_start
+      || now - cache->window_start >= NR_EXPLAIN_CACHE_BUDGET_WINDOW) {
+    cache->window_start = now;
+    cache->window_explains = 0;
+  }
+
+  if (cache->window_explains < cache->max_explains_per_minute) {
+    cache->window_explains += 1;
+  } else {
+    allowed = false;
+  }
+  nrt_mutex_unlock(&cache->lock);
+
+  return allowed;
+}
+
+typedef struct _nr_explain_cache_expire_t {
+  nrtime_t now;
+  nr_vector_t expired;
+} nr_explain_cache_expire_t;
+
+static void nr_explain_cache_find_expired(void* value,
+                                          const char* key NRUNUSED,
+                                          size_t key_len NRUNUSED,
+                                          void* user_data) {
+  const nr_explain_cache_entry_t* entry
+      = (const nr_explain_cache_entry_t*)value;
+  nr_explain_cache_expire_t* expire = (nr_explain_cache_expire_t*)user_data;
+
+  if (expire->now >= entry->expires) {
+    nr_vector_push_back(&expire->expired, value);
+  }
+}
+
+/*
+ * Remove all expired plans. The cache lock must be held.
+ */
+static void nr_explain_cache_remove_expired(nr_explain_cache_t* cache,
+                                            nrtime_t now) {
+  nr_explain_cache_expire_t expire = {.now = now};
+  size_t count;
+  size_t i;
+
+  nr_vector_init(&expire.expired, 8, NULL, NULL);
+  nr_hashmap_apply(cache->entries, nr_explain_cache_find_expired, &expire);
+
+  count = nr_vector_size(&expire.expired);
+  for (i = 0; i < count; i++) {
+    const nr_explain_cache_entry_t* entry
+        = (const nr_explain_cache_entry_t*)nr_vector_get(&expire.expired, i);
+
+    nr_hashmap_index_delete(cache->entries, entry->sql_id);
+  }
+
+  nr_vector_deinit(&expire.expired);
+}
+
+void nr_explain_cache_put(nr_explain_cache_t* cache,
+                          uint32_t sql_id,
+                          const nr_explain_plan_t* plan,
+                          nrtime_t now) {
+  nr_explain_cache_entry_t* entry;
+
+  if (NULL == cache || NULL == plan || 0 == cache->ttl) {
+    return;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+
+  entry = (nr_explain_cache_entry_t*)nr_hashmap_index_get(cache->entries,
+                                                          sql_id);
+  if (NULL != entry) {
+    nr_explain_plan_destroy(&entry->plan);
+    entry->plan = nr_explain_plan_duplicate(plan);
+    entry->expires = now + cache->ttl;
+    goto end;
+  }
+
+  if (nr_hashmap_count(cache->entries) >= cache->max_plans) {
+    nr_explain_cache_remove_expired(cache, now);
+    if (nr_hashmap_count(cache->entries) >= cache->max_plans) {
+      goto end;
+    }
+  }
+
+  entry = (nr_explain_cache_entry_t*)nr_zalloc(
+      sizeof(nr_explain_cache_entry_t));
+  entry->sql_id = sql_id;
+  entry->plan = nr_explain_plan_duplicate(plan);
+  entry->expires = now + cache->ttl;
+  nr_hashmap_index_set(cache->entries, sql_id, entry);
+
+end:
+  nrt_mutex_unlock(&cache->lock);
+}
+
+size_t nr_explain_cache_size(nr_explain_cache_t* cache) {
+  size_t size;
+
+  if (NULL == cache) {
+    return 0;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  size = nr_hashmap_count(cache->entries);
+  nrt_mutex_unlock(&cache->lock);
+
+  return size;
+}
@@ -9,12 +9,18 @@
 #ifndef NR_EXPLAIN_HDR
 #define NR_EXPLAIN_HDR
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "util_object.h"
+#include "util_time.h"
 
 /*
  * Forward declarations of the opaque structure used for explain plans.
  */
 typedef struct _nr_explain_plan_t nr_explain_plan_t;
+typedef struct _nr_explain_cache_t nr_explain_cache_t;
 
 /*
  * Purpose : Creates a new explain plan structure, which is effectively a fancy
@@ -33,6 +39,18 @@ extern nr_explain_plan_t* nr_explain_plan_create(void);
  */
 extern void nr_explain_plan_destroy(nr_explain_plan_t** plan_ptr);
 
+/*
+ * Purpose : Duplicates an explain plan.
+ *
+ * Params  : 1. The explain plan.
+ *
+ * Returns : A new explain plan, which will need to be destroyed with
+ *           nr_explain_plan_destroy when no longer needed, or NULL if the
+ *           plan is NULL.
+ */
+extern nr_explain_plan_t* nr_explain_plan_duplicate(
+    const nr_explain_plan_t* plan);
+
 /*
  * Purpose : Returns the number of columns defined in the explain plan.
  *
@@ -74,4 +92,80 @@ extern void nr_explain_plan_add_row(nr_explain_plan_t* plan,
  */
 extern char* nr_explain_plan_to_json(const nr_explain_plan_t* plan);
 
+/*
+ * Purpose : Creates a cache of explain plans, keyed by the normalized id of
+ *           the SQL they were generated for, and a budget limiting how many
+ *           explain queries may be issued per minute.
+ *
+ *           The cache is intended to be shared by all transactions within a
+ *           process, and is therefore protected by a mutex.
+ *
+ * Params  : 1. The maximum number of plans to keep.
+ *           2. How long a plan may be reused for. If this is 0, no plans are
+ *              cached.
+ *           3. The maximum number of explain queries to issue per minute. If
+ *              this is 0, the number is not limited.
+ *
+ * Returns : A newly allocated cache, which will need to be destroyed with
+ *           nr_explain_cache_destroy, or NULL if neither caching nor the
+ *           budget are enabled.
+ */
+extern nr_explain_cache_t* nr_explain_cache_create(
+    size_t max_plans,
+    nrtime_t ttl,
+    uint64_t max_explains_per_minute);
+
+/*
+ * Purpose : Destroys an explain plan cache.
+ */
+extern void nr_explain_cache_destroy(nr_explain_cache_t** cache_ptr);
+
+/*
+ * Purpose : Looks up a cached explain plan.
+ *
+ * Params  : 1. The cache.
+ *           2. The normalized SQL id, as returned by nr_sql_normalized_id.
+ *           3. The current time.
+ *
+ * Returns : A copy of the cached plan, which the caller owns, or NULL if no
+ *           unexpired plan is cached for the id.
+ */
+extern nr_explain_plan_t* nr_explain_cache_get(nr_explain_cache_t* cache,
+                                               uint32_t sql_id,
+                                               nrtime_t now);
+
+/*
+ * Purpose : Checks the per-minute budget before issuing an explain query, and
+ *           consumes one unit of it if the query may be issued.
+ *
+ * Params  : 1. The cache.
+ *           2. The current time.
+ *
+ * Returns : true if the explain query may be issued, false if the budget for
+ *           the current minute has been used up.
+ */
+extern bool nr_explain_cache_allow(nr_explain_cache_t* cache, nrtime_t now);
+
+/*
+ * Purpose : Adds an explain plan to the cache.
+ *
+ * Params  : 1. The cache.
+ *           2. The normalized SQL id.
+ *           3. The plan. The cache stores a copy.
+ *           4. The current time.
+ *
+ * Notes   : If the cache is full once expired plans have been removed, the
+ *           plan is not added.
+ */
+extern void nr_explain_cache_put(nr_explain_cache_t* cache,
+                                 uint32_t sql_id,
+                                 const nr_explain_plan_t* plan,
+                                 nrtime_t now);
+
+/*
+ * Purpose : Returns the number of plans currently cached, including expired
+ *           plans that have not yet been removed.
+ */
+extern size_t nr_explain_cache_size(nr_explain_cache_t* cache);
+
 #endif /* NR_EXPLAIN_HDR */
@@ -10,7 +10,9 @@
 #define NR_EXPLAIN_PRIVATE_HDR
 
 #include "nr_explain.h"
+#include "util_hashmap.h"
 #include "util_object.h"
+#include "util_threads.h"
 
 /*
  * An explain plan, which is represented as a result set of rows with column
@@ -21,6 +23,29 @@ struct _nr_explain_plan_t {
   nrobj_t* rows;
 };
 
+/*
+ * A cached explain plan.
+ */
+typedef struct _nr_explain_cache_entry_t {
+  uint32_t sql_id;
+  nr_explain_plan_t* plan;
+  nrtime_t expires;
+} nr_explain_cache_entry_t;
+
+/*
+ * A per-process cache of explain plans, together with the per-minute budget
+ * of explain queries.
+ */
+struct _nr_explain_cache_t {
+  nrthread_mutex_t lock;
+  nr_hashmap_t* entries; /* Normalized SQL id -> nr_explain_cache_entry_t */
+  size_t max_plans;
+  nrtime_t ttl;
+  uint64_t max_explains_per_minute; /* 0 means unlimited */
+  nrtime_t window_start;            /* Start of the current budget minute */
+  uint64_t window_explains; /* Explain queries issued in the current minute */
+};
+
 /*
  * Purpose : Exports an explain plan into an abstract object.
  *
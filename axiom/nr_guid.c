@@ -7,17 +7,51 @@
 
 #include "util_memory.h"
 
-static const char* hex_digits = "0123456789abcdef";
+/*
+ * The two lowercase hex digits of every byte value, so that a GUID is
+ * encoded one byte at a time rather than one nibble at a time.
+ */
+static const char nr_guid_hex_pairs[512 + 1] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
 
-char* nr_guid_create(nr_random_t* rnd) {
-  char* guid = nr_zalloc(NR_GUID_SIZE + 1);
+void nr_guid_fill(nr_random_t* rnd, char guid[NR_GUID_SIZE + 1]) {
+  uint64_t r;
   size_t i;
 
-  for (i = 0; i < NR_GUID_SIZE; i++) {
-    unsigned long r = nr_random_range(rnd, 0xf);
+  if (NULL == guid) {
+    return;
+  }
+
+  r = nr_random_u64(rnd);
+  for (i = 0; i < NR_GUID_SIZE; i += 2) {
+    const char* pair = &nr_guid_hex_pairs[(r >> 56) * 2];
 
-    guid[i] = hex_digits[r];
+    guid[i] = pair[0];
+    guid[i + 1] = pair[1];
+    r <<= 8;
   }
+  guid[NR_GUID_SIZE] = '\0';
+}
+
+char* nr_guid_create(nr_random_t* rnd) {
+  char* guid = nr_malloc(NR_GUID_SIZE + 1);
+
+  nr_guid_fill(rnd, guid);
 
   return guid;
 }
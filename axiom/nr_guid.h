@@ -25,4 +25,14 @@
  */
 extern char* nr_guid_create(nr_random_t* rnd);
 
+/*
+ * Purpose : Write a new GUID into a caller provided buffer, avoiding the heap
+ *           allocation made by nr_guid_create().
+ *
+ * Params  : 1. The random number generator to use.
+ *           2. The buffer to write into, which must hold at least
+ *              NR_GUID_SIZE + 1 bytes. It is always null terminated.
+ */
+extern void nr_guid_fill(nr_random_t* rnd, char guid[NR_GUID_SIZE + 1]);
+
 #endif /* NR_GUID_HDR */
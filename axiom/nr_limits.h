@@ -52,6 +52,12 @@
  */
 #define NR_MAX_8T_SPAN_BATCH_SIZE 1000
 
+/*
+ * The maximum number of concurrent gRPC streams the daemon opens to an
+ * Infinite Tracing trace observer.
+ */
+#define NR_MAX_8T_SPAN_STREAMS 16
+
 /*
  * The default maximum number of log events in a transaction.
  */
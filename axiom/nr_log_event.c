@@ -154,6 +154,12 @@ bool nr_log_event_to_json_buffer(const nr_log_event_t* event, nrbuf_t* buf) {
 }
 
 void nr_log_event_set_message(nr_log_event_t* event, const char* message) {
+  nr_log_event_set_message_truncated(event, message, NR_MAX_LOG_MESSAGE_LEN);
+}
+
+void nr_log_event_set_message_truncated(nr_log_event_t* event,
+                                        const char* message,
+                                        size_t max_len) {
   if (NULL == event || NULL == message) {
     return;
   }
@@ -162,7 +168,10 @@ void nr_log_event_set_message(nr_log_event_t* event, const char* message) {
   }
 
   // spec says to truncate messages over max limit
-  event->message = nr_strndup(message, NR_MAX_LOG_MESSAGE_LEN);
+  if (0 == max_len || max_len > NR_MAX_LOG_MESSAGE_LEN) {
+    max_len = NR_MAX_LOG_MESSAGE_LEN;
+  }
+  event->message = nr_strndup(message, max_len);
 }
 
 void nr_log_event_set_log_level(nr_log_event_t* event, const char* log_level) {
@@ -103,4 +103,13 @@ extern void nr_log_event_set_priority(nr_log_event_t* event, int priority);
 extern void nr_log_event_set_context_attributes(
     nr_log_event_t* event,
     nr_attributes_t* context_attributes);
+
+/*
+ * Purpose : Set the message of a log event, truncating it to at most max_len
+ *           bytes.  A max_len of 0 or greater than NR_MAX_LOG_MESSAGE_LEN
+ *           truncates to NR_MAX_LOG_MESSAGE_LEN.
+ */
+extern void nr_log_event_set_message_truncated(nr_log_event_t* event,
+                                               const char* message,
+                                               size_t max_len);
 #endif /* NR_LOG_EVENT_HDR */
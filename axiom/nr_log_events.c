@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "nr_limits.h"
+#include "nr_log_event_private.h"
 #include "nr_log_events.h"
 #include "util_memory.h"
 #include "util_minmax_heap.h"
@@ -146,6 +147,34 @@ bool nr_log_events_add_event(nr_log_events_t* events, nr_log_event_t* event) {
   return events_sampled;
 }
 
+bool nr_log_events_would_keep(const nr_log_events_t* events, int priority) {
+  const nr_log_event_t* min;
+
+  if (NULL == events || NULL == events->events
+      || 0 == events->events_allocated) {
+    return false;
+  }
+
+  if (events->events_used < events->events_allocated) {
+    return true;
+  }
+
+  min = (const nr_log_event_t*)nr_minmax_heap_peek_min(events->events);
+  if (NULL == min) {
+    return true;
+  }
+
+  return priority >= min->priority;
+}
+
+void nr_log_events_add_dropped(nr_log_events_t* events) {
+  if (NULL == events) {
+    return;
+  }
+
+  events->events_seen++;
+}
+
 /*
  * Purpose : Place an nr_log_event_t pointer in a heap into a nr_vector_t,
  *             or "heap to vector".
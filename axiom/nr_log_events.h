@@ -37,6 +37,31 @@ typedef struct _nr_log_events_t nr_log_events_t;
 extern bool nr_log_events_add_event(nr_log_events_t* events,
                                     nr_log_event_t* event);
 
+/*
+ * Purpose : Determine whether a log event with the given priority would be
+ *           kept by a log event pool, without building the event.
+ *
+ * Params  : 1. Log event pool
+ *           2. Priority of the prospective log event
+ *
+ * Returns : true if the pool has room, or if the priority is at least that of
+ *           the lowest priority event currently held; false otherwise.
+ *
+ * Notes   : This is a conservative check: an event for which this returns
+ *           true may still lose to an existing event of equal priority once
+ *           timestamps are compared by nr_log_events_add_event().
+ */
+extern bool nr_log_events_would_keep(const nr_log_events_t* events,
+                                     int priority);
+
+/*
+ * Purpose : Record that a log event was seen but dropped before it was built,
+ *           for instance because nr_log_events_would_keep() returned false.
+ *
+ * Params  : 1. Log event pool
+ */
+extern void nr_log_events_add_dropped(nr_log_events_t* events);
+
 /*
  * Purpose : Create a log event pool of specified size.
  *           An event pool allocated using this function must be
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "nr_metric_names.h"
+#include "util_strings.h"
+
+/*
+ * Each hashmap value packs the id and whether the id has been committed, so
+ * that no allocation is needed per name beyond the key itself.
+ */
+#define NR_METRIC_NAMES_COMMITTED ((uintptr_t)1)
+
+static inline void* nr_metric_names_pack(uint32_t id, bool committed) {
+  return (void*)(((uintptr_t)id << 1)
+                 | (committed ? NR_METRIC_NAMES_COMMITTED : 0));
+}
+
+void nr_metric_names_enable(nr_metric_names_t* names, uint32_t capacity) {
+  if (NULL == names || 0 == capacity) {
+    return;
+  }
+
+  nrt_mutex_lock(&names->lock);
+  if (0 == names->capacity) {
+    names->capacity = capacity;
+    names->next_id = 1;
+    if (NULL == names->ids) {
+      names->ids = nr_hashmap_create(NULL);
+    }
+  }
+  nrt_mutex_unlock(&names->lock);
+}
+
+void nr_metric_names_reset(nr_metric_names_t* names) {
+  if (NULL == names) {
+    return;
+  }
+
+  nrt_mutex_lock(&names->lock);
+  nr_hashmap_destroy(&names->ids);
+  names->capacity = 0;
+  names->next_id = 1;
+  nrt_mutex_unlock(&names->lock);
+}
+
+uint32_t nr_metric_names_lookup(nr_metric_names_t* names,
+                                const char* name,
+                                bool* send_name) {
+  void* packed = NULL;
+  uint32_t id = 0;
+  size_t len;
+
+  if (NULL != send_name) {
+    *send_name = true;
+  }
+
+  if (NULL == names || NULL == name || NULL == send_name) {
+    return 0;
+  }
+
+  /* Checked without the lock: a disabled dictionary is the common case. */
+  if (0 == names->capacity) {
+    return 0;
+  }
+
+  len = nr_strlen(name);
+
+  nrt_mutex_lock(&names->lock);
+  if (NULL == names->ids) {
+    /* The dictionary was reset since the check above. */
+  } else if (nr_hashmap_get_into(names->ids, name, len, &packed)) {
+    id = (uint32_t)((uintptr_t)packed >> 1);
+    *send_name = !((uintptr_t)packed & NR_METRIC_NAMES_COMMITTED);
+  } else if (names->next_id <= names->capacity) {
+    id = names->next_id++;
+    nr_hashmap_set(names->ids, name, len, nr_metric_names_pack(id, false));
+  }
+  nrt_mutex_unlock(&names->lock);
+
+  return id;
+}
+
+void nr_metric_names_commit(nr_metric_names_t* names, nr_vector_t* defined) {
+  size_t count = nr_vector_size(defined);
+  size_t i;
+
+  if (NULL == names || 0 == count) {
+    return;
+  }
+
+  nrt_mutex_lock(&names->lock);
+  for (i = 0; i < count && NULL != names->ids; i++) {
+    const char* name = (const char*)nr_vector_get(defined, i);
+    size_t len = nr_strlen(name);
+    void* packed = NULL;
+
+    if (nr_hashmap_get_into(names->ids, name, len, &packed)) {
+      nr_hashmap_update(
+          names->ids, name, len,
+          nr_metric_names_pack((uint32_t)((uintptr_t)packed >> 1), true));
+    }
+  }
+  nrt_mutex_unlock(&names->lock);
+}
+
+uint32_t nr_metric_names_size(nr_metric_names_t* names) {
+  uint32_t size;
+
+  if (NULL == names) {
+    return 0;
+  }
+
+  nrt_mutex_lock(&names->lock);
+  size = names->next_id - 1;
+  nrt_mutex_unlock(&names->lock);
+
+  return size;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains the metric name dictionary shared with the daemon.
+ *
+ * The first time a metric name is sent over a daemon connection it is sent
+ * together with a small integer id. Once the message that defined the id has
+ * been written, later transactions send only the id. The daemon keeps the
+ * matching dictionary for each connection, so the dictionary must be reset
+ * whenever the connection changes.
+ */
+#ifndef NR_METRIC_NAMES_HDR
+#define NR_METRIC_NAMES_HDR
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "util_hashmap.h"
+#include "util_threads.h"
+#include "util_vector.h"
+
+typedef struct _nr_metric_names_t {
+  nrthread_mutex_t lock;
+  nr_hashmap_t* ids; /* Metric name -> id and whether it has been committed */
+  uint32_t capacity; /* Maximum number of ids, as advertised by the daemon. 0
+                        disables the dictionary. */
+  uint32_t next_id;  /* The next id to be assigned; ids start at 1 */
+} nr_metric_names_t;
+
+#define NR_METRIC_NAMES_INITIALIZER \
+  { .lock = NRTHREAD_MUTEX_INITIALIZER, .ids = NULL, .capacity = 0, .next_id = 1 }
+
+/*
+ * Purpose : Enable the dictionary for the current daemon connection.
+ *
+ * Params  : 1. The dictionary.
+ *           2. The maximum number of ids the daemon accepts. If this is 0,
+ *              nothing is changed.
+ *
+ * Notes   : Enabling an already enabled dictionary keeps its contents.
+ */
+extern void nr_metric_names_enable(nr_metric_names_t* names, uint32_t capacity);
+
+/*
+ * Purpose : Forget all ids and disable the dictionary. This must be called
+ *           whenever the daemon connection is closed or replaced.
+ */
+extern void nr_metric_names_reset(nr_metric_names_t* names);
+
+/*
+ * Purpose : Look up the id to send for a metric name.
+ *
+ * Params  : 1. The dictionary.
+ *           2. The metric name.
+ *           3. Set to true if the name must be sent together with the id,
+ *              false if the id alone is sufficient.
+ *
+ * Returns : The id, or 0 if the name must be sent without an id, because the
+ *           dictionary is disabled or full.
+ *
+ * Notes   : A newly assigned id is only sent on its own once it has been
+ *           committed with nr_metric_names_commit().
+ */
+extern uint32_t nr_metric_names_lookup(nr_metric_names_t* names,
+                                       const char* name,
+                                       bool* send_name);
+
+/*
+ * Purpose : Mark the ids of the given names as known to the daemon, once the
+ *           message defining them has been written.
+ *
+ * Params  : 1. The dictionary.
+ *           2. A vector of metric names (const char*) that were sent together
+ *              with their ids.
+ */
+extern void nr_metric_names_commit(nr_metric_names_t* names,
+                                   nr_vector_t* defined);
+
+/*
+ * Purpose : Return the number of ids assigned so far.
+ */
+extern uint32_t nr_metric_names_size(nr_metric_names_t* names);
+
+#endif /* NR_METRIC_NAMES_HDR */
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include <stdio.h>
+
+#include "nr_overhead.h"
+#include "util_memory.h"
+
+const char* nr_overhead_phase_name(nr_overhead_phase_t phase) {
+  switch (phase) {
+    case NR_OVERHEAD_TXN_BEGIN:
+      return "TxnBegin";
+    case NR_OVERHEAD_EXECUTE:
+      return "Execute";
+    case NR_OVERHEAD_SEGMENT_FINALISE:
+      return "SegmentTreeFinalise";
+    case NR_OVERHEAD_TXNDATA_ENCODE:
+      return "TxnDataEncode";
+    case NR_OVERHEAD_TXNDATA_TX:
+      return "TxnDataTx";
+    case NR_OVERHEAD_RSHUTDOWN:
+      return "RequestShutdown";
+    case NR_OVERHEAD_PHASE_COUNT:
+    default:
+      return NULL;
+  }
+}
+
+void nr_overhead_add(nr_overhead_t* overhead,
+                     nr_overhead_phase_t phase,
+                     nrtime_t duration) {
+  nr_overhead_add_sampled(overhead, phase, duration, 1);
+}
+
+void nr_overhead_add_sampled(nr_overhead_t* overhead,
+                             nr_overhead_phase_t phase,
+                             nrtime_t duration,
+                             uint64_t weight) {
+  nr_overhead_timer_t* timer;
+
+  if (nrunlikely(NULL == overhead || (int)phase < 0
+                 || phase >= NR_OVERHEAD_PHASE_COUNT || 0 == weight)) {
+    return;
+  }
+
+  timer = &overhead->timers[phase];
+
+  if (0 == timer->count || duration < timer->min) {
+    timer->min = duration;
+  }
+  if (duration > timer->max) {
+    timer->max = duration;
+  }
+
+  timer->count += weight;
+  timer->total += duration * weight;
+  timer->sum_of_squares += duration * duration * weight;
+}
+
+nrtime_t nr_overhead_total(const nr_overhead_t* overhead) {
+  nrtime_t total = 0;
+  int i;
+
+  if (NULL == overhead) {
+    return 0;
+  }
+
+  for (i = 0; i < NR_OVERHEAD_PHASE_COUNT; i++) {
+    total += overhead->timers[i].total;
+  }
+
+  return total;
+}
+
+void nr_overhead_create_metrics(const nr_overhead_t* overhead,
+                                nrmtable_t* metrics) {
+  char name[128];
+  int i;
+
+  if (NULL == overhead || NULL == metrics) {
+    return;
+  }
+
+  for (i = 0; i < NR_OVERHEAD_PHASE_COUNT; i++) {
+    const nr_overhead_timer_t* timer = &overhead->timers[i];
+
+    if (0 == timer->count) {
+      continue;
+    }
+
+    snprintf(name, sizeof(name), NR_OVERHEAD_METRIC_PREFIX "%s",
+             nr_overhead_phase_name((nr_overhead_phase_t)i));
+    nrm_add_internal(1, metrics, name, timer->count, timer->total,
+                     timer->total, timer->min, timer->max,
+                     timer->sum_of_squares);
+  }
+}
+
+void nr_overhead_reset(nr_overhead_t* overhead) {
+  if (NULL == overhead) {
+    return;
+  }
+
+  nr_memset(overhead, 0, sizeof(*overhead));
+}
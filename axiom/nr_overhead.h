@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains timers used to measure the overhead of the agent itself.
+ *
+ * Each phase of the agent's work is timed separately and reported as a
+ * Supportability/PHP/Overhead/<phase> metric with count, total and max.
+ */
+#ifndef NR_OVERHEAD_HDR
+#define NR_OVERHEAD_HDR
+
+#include <stdint.h>
+
+#include "util_metrics.h"
+#include "util_time.h"
+
+#define NR_OVERHEAD_METRIC_PREFIX "Supportability/PHP/Overhead/"
+
+/*
+ * Members of this enumeration are used as an index into an array.
+ */
+typedef enum _nr_overhead_phase_t {
+  NR_OVERHEAD_TXN_BEGIN = 0,        /* Transaction start */
+  NR_OVERHEAD_EXECUTE = 1,          /* Function call hooks, sampled */
+  NR_OVERHEAD_SEGMENT_FINALISE = 2, /* Segment tree finalisation */
+  NR_OVERHEAD_TXNDATA_ENCODE = 3,   /* Encoding the TXNDATA message */
+  NR_OVERHEAD_TXNDATA_TX = 4,       /* Sending the TXNDATA message */
+  NR_OVERHEAD_RSHUTDOWN = 5,        /* Request shutdown cleanup */
+  NR_OVERHEAD_PHASE_COUNT = 6
+} nr_overhead_phase_t;
+
+typedef struct _nr_overhead_timer_t {
+  uint64_t count;
+  nrtime_t total;
+  nrtime_t min;
+  nrtime_t max;
+  nrtime_t sum_of_squares;
+} nr_overhead_timer_t;
+
+typedef struct _nr_overhead_t {
+  nr_overhead_timer_t timers[NR_OVERHEAD_PHASE_COUNT];
+} nr_overhead_t;
+
+/*
+ * Purpose : Return the metric name suffix of an overhead phase.
+ *
+ * Returns : A static string, or NULL if the phase is invalid.
+ */
+extern const char* nr_overhead_phase_name(nr_overhead_phase_t phase);
+
+/*
+ * Purpose : Record a single timing of an overhead phase.
+ *
+ * Params  : 1. The overhead timers.
+ *           2. The phase.
+ *           3. The duration of the phase.
+ */
+extern void nr_overhead_add(nr_overhead_t* overhead,
+                            nr_overhead_phase_t phase,
+                            nrtime_t duration);
+
+/*
+ * Purpose : Record a timing of an overhead phase that was sampled from many
+ *           occurrences, so that the phase's count and total estimate those of
+ *           every occurrence.
+ *
+ * Params  : 1. The overhead timers.
+ *           2. The phase.
+ *           3. The duration of the sampled occurrence.
+ *           4. The number of occurrences the sample stands for. The min and
+ *              max are those of the samples.
+ */
+extern void nr_overhead_add_sampled(nr_overhead_t* overhead,
+                                    nr_overhead_phase_t phase,
+                                    nrtime_t duration,
+                                    uint64_t weight);
+
+/*
+ * Purpose : Record the time elapsed since start for an overhead phase.
+ *
+ * Params  : 1. The overhead timers.
+ *           2. The phase.
+ *           3. The start time, as returned by nr_get_time().
+ */
+static inline void nr_overhead_add_since(nr_overhead_t* overhead,
+                                         nr_overhead_phase_t phase,
+                                         nrtime_t start) {
+  nr_overhead_add(overhead, phase, nr_time_duration(start, nr_get_time()));
+}
+
+/*
+ * Purpose : Return the summed duration of all phases.
+ */
+extern nrtime_t nr_overhead_total(const nr_overhead_t* overhead);
+
+/*
+ * Purpose : Add a metric for each phase that has been timed at least once.
+ *
+ * Params  : 1. The overhead timers.
+ *           2. The metric table to add the metrics to.
+ */
+extern void nr_overhead_create_metrics(const nr_overhead_t* overhead,
+                                       nrmtable_t* metrics);
+
+/*
+ * Purpose : Reset all timers to zero.
+ */
+extern void nr_overhead_reset(nr_overhead_t* overhead);
+
+#endif /* NR_OVERHEAD_HDR */
@@ -21,6 +21,8 @@
 typedef struct {
   nrbuf_t* buf;
   bool package_added;
+  bool exclude;
+  nr_php_package_source_priority_t excluded_source;
 } nr_php_package_json_builder_t;
 
 static inline const char* nr_php_package_source_priority_to_string(const nr_php_package_source_priority_t source_priority) {
@@ -165,6 +167,12 @@ static void apply_package_to_json_conversion(void* value,
   (void)key;
   (void)key_len;
 
+  if (json_builder->exclude
+      && json_builder->excluded_source
+             == ((nr_php_package_t*)value)->source_priority) {
+    return;
+  }
+
   package_json = nr_php_package_to_json((nr_php_package_t*)value);
   if (package_json) {
     if (json_builder->package_added) {
@@ -178,7 +186,8 @@ static void apply_package_to_json_conversion(void* value,
 }
 
 bool nr_php_packages_to_json_buffer(nr_php_packages_t* h, nrbuf_t* buf) {
-  nr_php_package_json_builder_t json_builder = {buf, false};
+  nr_php_package_json_builder_t json_builder
+      = {buf, false, false, NR_PHP_PACKAGE_SOURCE_SUGGESTION};
 
   if (NULL == h || NULL == h->data || NULL == buf) {
     return false;
@@ -206,3 +215,30 @@ end:
   nr_buffer_destroy(&buf);
   return json;
 }
+
+char* nr_php_packages_to_json_excluding_source(
+    nr_php_packages_t* h,
+    nr_php_package_source_priority_t source) {
+  nrbuf_t* buf = NULL;
+  char* json = NULL;
+  nr_php_package_json_builder_t json_builder = {NULL, false, true, source};
+
+  if (NULL == h || NULL == h->data) {
+    return NULL;
+  }
+
+  buf = nr_buffer_create(0, 0);
+  json_builder.buf = buf;
+
+  nr_buffer_add(buf, NR_PSTR("["));
+  nr_hashmap_apply(h->data, apply_package_to_json_conversion, &json_builder);
+  nr_buffer_add(buf, NR_PSTR("]"));
+
+  if (json_builder.package_added) {
+    nr_buffer_add(buf, NR_PSTR("\0"));
+    json = nr_strdup(nr_buffer_cptr(buf));
+  }
+
+  nr_buffer_destroy(&buf);
+  return json;
+}
@@ -217,4 +217,19 @@ extern bool nr_php_packages_to_json_buffer(nr_php_packages_t* hashmap,
  */
 extern char* nr_php_packages_to_json(nr_php_packages_t* h);
 
+/*
+ * Purpose : Returns the packages in the collection that were not added from
+ *           the given source as a JSON
+ *
+ * Params  : 1. A pointer to nr_php_packages_t
+ *           2. The package source to leave out
+ *
+ * Returns : An allocated string containing the JSON representation of the
+ *           remaining packages, or NULL if no packages remain. Caller takes
+ *           ownership of this string.
+ */
+extern char* nr_php_packages_to_json_excluding_source(
+    nr_php_packages_t* h,
+    nr_php_package_source_priority_t source);
+
 #endif /* nr_php_packages_HDR */
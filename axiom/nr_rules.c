@@ -11,6 +11,7 @@
 
 #include "nr_rules.h"
 #include "nr_rules_private.h"
+#include "util_buffer.h"
 #include "util_logging.h"
 #include "util_memory.h"
 #include "util_reply.h"
@@ -46,6 +47,7 @@ void nr_rules_destroy(nrrules_t** rules_p) {
     nr_free(rules->rules[i].replacement);
   }
   nr_free(rules->rules);
+  nr_regex_destroy(&rules->prefilter);
   rules->nrules = 0;
   rules->nalloc = 0;
   nr_realfree((void**)rules_p);
@@ -83,6 +85,11 @@ nr_status_t nr_rules_add(nrrules_t* rules,
     return NR_FAILURE;
   }
 
+  /*
+   * The prefilter no longer covers every rule; nr_rules_sort() rebuilds it.
+   */
+  nr_regex_destroy(&rules->prefilter);
+
   if (rules->nalloc == rules->nrules) {
     rules->nalloc += 8;
     rules->rules
@@ -124,6 +131,93 @@ void nr_rules_sort(nrrules_t* rules) {
 
   qsort((void*)rules->rules, rules->nrules, sizeof(nrrule_t),
         qsort_comparator_for_rules);
+
+  nr_rules_build_prefilter(rules);
+}
+
+/*
+ * Whether a rule is matched against the whole string, rather than against
+ * each URL segment. This mirrors the branches in nr_rule_apply().
+ */
+static int nr_rule_is_whole_string(const nrrule_t* rule) {
+  return (rule->rflags & NR_RULE_IGNORE)
+         || (0 == (rule->rflags & NR_RULE_EACH_SEGMENT));
+}
+
+/*
+ * Whether a pattern means the same thing when wrapped in a non-capturing group
+ * and placed alongside other patterns. Group numbering changes, so anything
+ * referring to groups by number or name is rejected, as are constructs that
+ * can escape the group or stop other alternatives from being tried.
+ */
+static int nr_rules_pattern_is_combinable(const char* pattern) {
+  const char* p;
+
+  for (p = pattern; *p; p++) {
+    if ('\\' == p[0]) {
+      if (('\0' == p[1]) || nr_strchr("123456789gkQ", p[1])) {
+        return 0;
+      }
+      p++;
+    } else if (('(' == p[0]) && ('*' == p[1])) {
+      return 0;
+    } else if (('(' == p[0]) && ('?' == p[1])) {
+      if (('<' == p[2]) && ('=' != p[3]) && ('!' != p[3])) {
+        return 0;
+      }
+      if (('\0' != p[2]) && nr_strchr("P'|R0123456789+-&", p[2])) {
+        return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+void nr_rules_build_prefilter(nrrules_t* rules) {
+  nrbuf_t* buf;
+  int count = 0;
+  int i;
+
+  if (nrunlikely(NULL == rules)) {
+    return;
+  }
+
+  nr_regex_destroy(&rules->prefilter);
+
+  for (i = 0; i < rules->nrules; i++) {
+    if (nr_rule_is_whole_string(&rules->rules[i])) {
+      if (!nr_rules_pattern_is_combinable(rules->rules[i].match)) {
+        return;
+      }
+      count++;
+    }
+  }
+
+  /*
+   * With a single rule the prefilter would only repeat its match.
+   */
+  if (count < 2) {
+    return;
+  }
+
+  buf = nr_buffer_create(0, 0);
+  for (i = 0; i < rules->nrules; i++) {
+    if (nr_rule_is_whole_string(&rules->rules[i])) {
+      if (nr_buffer_len(buf)) {
+        nr_buffer_add(buf, "|", 1);
+      }
+      nr_buffer_add(buf, "(?:", 3);
+      nr_buffer_add(buf, rules->rules[i].match,
+                    nr_strlen(rules->rules[i].match));
+      nr_buffer_add(buf, ")", 1);
+    }
+  }
+  nr_buffer_add(buf, "", 1);
+
+  rules->prefilter = nr_regex_create((const char*)nr_buffer_cptr(buf),
+                                     nr_rules_regex_options, 1);
+  nr_buffer_destroy(&buf);
 }
 
 void nr_rule_replace_string(const char* repl,
@@ -390,6 +484,7 @@ nr_rules_result_t nr_rules_apply(const nrrules_t* rules,
                                  char** new_name) {
   int i;
   int changed = 0;
+  int skip_whole_string = 0;
   char* str;
   char* repl;
   char* work;
@@ -408,17 +503,44 @@ nr_rules_result_t nr_rules_apply(const nrrules_t* rules,
 
   nr_strlcpy(str, name, NRULE_BUF_SIZE);
 
+  /*
+   * Most names are not touched by most rules. A single match against the
+   * prefilter shows whether any whole string rule can match the name; if
+   * none can, those rules are skipped for as long as the name is unchanged.
+   */
+  if (rules->prefilter
+      && (NR_SUCCESS
+          != nr_regex_match(rules->prefilter, str, nr_strlen(str)))) {
+    skip_whole_string = 1;
+  }
+
   for (i = 0; i < rules->nrules; i++) {
     const nrrule_t* rule = &rules->rules[i];
-    int rv = nr_rule_apply(str, work, repl, NRULE_BUF_SIZE, rule);
+    char first = str[0];
+    int rv;
+
+    if (skip_whole_string && nr_rule_is_whole_string(rule)) {
+      continue;
+    }
+
+    rv = nr_rule_apply(str, work, repl, NRULE_BUF_SIZE, rule);
 
     if (NR_RULES_RESULT_IGNORE == rv) {
       nr_free(str);
       return NR_RULES_RESULT_IGNORE;
     }
 
+    /*
+     * A per segment rule that matches nothing still rewrites the leading
+     * character as a '/', so the prefilter result no longer applies.
+     */
+    if (first != str[0]) {
+      skip_whole_string = 0;
+    }
+
     if (NR_RULES_RESULT_CHANGED == rv) {
       changed++;
+      skip_whole_string = 0;
       if (rule->rflags & NR_RULE_TERMINATE) {
         break;
       }
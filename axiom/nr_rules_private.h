@@ -27,8 +27,20 @@ struct _nrrules_t {
   int nrules;      /* How many rules in the list */
   int nalloc;      /* Number of rules allocated */
   nrrule_t* rules; /* Actual list of rules */
+  nr_regex_t* prefilter; /* Alternation of every whole string rule, built by
+                            nr_rules_sort(). If it does not match a name, none
+                            of those rules can. NULL if it could not be built
+                            safely or would not help. */
 };
 
+/*
+ * Purpose : Build the prefilter for a sorted rules table.
+ *
+ * Notes   : Called by nr_rules_sort(). The prefilter is discarded whenever a
+ *           rule is added.
+ */
+extern void nr_rules_build_prefilter(nrrules_t* rules);
+
 extern void nr_rules_process_rule(nrrules_t* rules, const nrobj_t* rule);
 
 extern void nr_rule_replace_string(const char* repl,
@@ -7,6 +7,7 @@
 
 #include "nr_distributed_trace.h"
 #include "nr_guid.h"
+#include "nr_limits.h"
 #include "nr_segment_private.h"
 #include "nr_segment.h"
 #include "nr_segment_traces.h"
@@ -30,6 +31,328 @@ struct _nr_span_event_and_counter_t {
 
 typedef struct _nr_span_event_and_counter_t nr_span_event_and_counter_t;
 
+/*
+ * Purpose : Return whether folded segments are kept out of the first pass of
+ *           nr_segment_tree_finalise().
+ *
+ *           This is the case when incremental finalising is enabled and no
+ *           segment limit is set. A folded segment is then placed in the
+ *           transaction's folded reservoirs as it folds. With a segment limit
+ *           the tree is already bounded, and segments evicted from the
+ *           segment heap would have to be taken out of those reservoirs
+ *           again.
+ *
+ * Params  : 1. The transaction.
+ */
+static bool nr_segment_txn_prunes_folded(const nrtxn_t* txn) {
+  return txn && txn->options.incremental_finalise && NULL == txn->segment_heap;
+}
+
+/*
+ * Purpose : Record that a segment that is not folded has been added below a
+ *           folded segment, so that the first pass of
+ *           nr_segment_tree_finalise() still visits it.
+ *
+ * Params  : 1. The new parent of the segment.
+ */
+static void nr_segment_mark_unfolded_descendants(nr_segment_t* ancestor) {
+  while (ancestor && ancestor->folded && !ancestor->unfolded_descendants) {
+    ancestor->unfolded_descendants = true;
+    ancestor = ancestor->parent;
+  }
+}
+
+/*
+ * The folded reservoirs that may hold a folded segment.
+ */
+#define NR_SEGMENT_FOLDED_TRACE (1 << 0)
+#define NR_SEGMENT_FOLDED_SPAN (1 << 1)
+
+/*
+ * Purpose : Handle a folded segment leaving one of the folded reservoirs of
+ *           its transaction, either because it was evicted by a segment with
+ *           a higher priority or because it was never admitted.
+ *
+ *           Once a folded segment is in neither reservoir, it can't end up in
+ *           the transaction trace or the span events: the reservoirs have the
+ *           same bounds as the ones built by nr_segment_tree_finalise(), and
+ *           the segments that pushed it out outrank it there as well. Its
+ *           metrics have been merged, so it is discarded to give its memory
+ *           back to the segment slab.
+ *
+ * Params  : 1. The folded segment.
+ *           2. The reservoir it left.
+ */
+static void nr_segment_leave_folded_reservoir(nr_segment_t* segment,
+                                              int reservoir) {
+  segment->folded_reservoirs &= ~reservoir;
+
+  if (0 == segment->folded_reservoirs) {
+    nr_segment_discard(&segment);
+  }
+}
+
+static void nr_segment_folded_trace_dtor(nr_segment_t* segment,
+                                         void* userdata NRUNUSED) {
+  nr_segment_leave_folded_reservoir(segment, NR_SEGMENT_FOLDED_TRACE);
+}
+
+static void nr_segment_folded_span_dtor(nr_segment_t* segment,
+                                        void* userdata NRUNUSED) {
+  nr_segment_leave_folded_reservoir(segment, NR_SEGMENT_FOLDED_SPAN);
+}
+
+/*
+ * Purpose : Place a folded segment in the folded reservoirs of its
+ *           transaction, so that the first pass of nr_segment_tree_finalise()
+ *           does not need to visit it.
+ *
+ * Params  : 1. A folded segment.
+ *
+ * Note    : The segment may be discarded by this function.
+ */
+static void nr_segment_fold_into_reservoirs(nr_segment_t* segment) {
+  nrtxn_t* txn = segment->txn;
+
+  if (NULL == txn->folded_trace_heap) {
+    txn->folded_trace_heap = nr_minmax_heap_create(
+        NR_MAX_SEGMENTS, nr_segment_wrapped_duration_comparator, NULL,
+        (nr_minmax_heap_dtor_t)nr_segment_folded_trace_dtor, NULL);
+  }
+  if (NULL == txn->folded_span_heap) {
+    txn->folded_span_heap = nr_minmax_heap_create(
+        nr_txn_span_events_limit(txn),
+        nr_segment_wrapped_span_priority_comparator, NULL,
+        (nr_minmax_heap_dtor_t)nr_segment_folded_span_dtor, NULL);
+  }
+
+  /*
+   * Keep the bookkeeping for the discount_main_context_blocking option, which
+   * needs the periods of all asynchronous segments.
+   */
+  if (segment->async_context && txn->options.discount_main_context_blocking) {
+    nr_exclusive_time_append_child(&txn->folded_main_context,
+                                   segment->start_time, segment->stop_time);
+  }
+
+  segment->folded_reservoirs = NR_SEGMENT_FOLDED_TRACE | NR_SEGMENT_FOLDED_SPAN;
+  nr_minmax_heap_insert(txn->folded_trace_heap, segment);
+  nr_minmax_heap_insert(txn->folded_span_heap, segment);
+}
+
+/*
+ * Purpose : Fold an ended segment into its transaction: calculate the
+ *           exclusive time of the segment from its children, merge its metrics
+ *           into the transaction metric tables and add its exclusive time to
+ *           the transaction total time.
+ *
+ *           A segment is only folded once every child in its own context has
+ *           been folded, as those children are needed for its exclusive time.
+ *           Children in other contexts don't affect the exclusive time; if
+ *           any of them are still open, the segment is marked so that the
+ *           first pass of nr_segment_tree_finalise() still visits them.
+ *
+ *           A child that is added to a segment after it was folded is not
+ *           taken off the exclusive time of the segment.
+ *
+ * Params  : 1. An ended, non-root segment.
+ *
+ * Returns : true if the segment has been folded, false if it has to wait for
+ *           children to be folded first. A folded segment may have been
+ *           discarded right away, see nr_segment_leave_folded_reservoir().
+ */
+static bool nr_segment_fold(nr_segment_t* segment) {
+  nrtime_t duration;
+  nrtime_t exclusive_time;
+  size_t metric_count;
+  size_t num_children;
+  bool unfolded_descendants = false;
+
+  if (nrunlikely(segment->folded)) {
+    return true;
+  }
+
+  if (nrunlikely(segment->stop_time < segment->start_time)) {
+    return false;
+  }
+
+  num_children = nr_segment_children_size(&segment->children);
+  for (size_t i = 0; i < num_children; i++) {
+    nr_segment_t* child = nr_segment_children_get(&segment->children, i);
+
+    if (NULL == child) {
+      continue;
+    }
+
+    if (!child->folded) {
+      if (child->async_context == segment->async_context) {
+        return false;
+      }
+      unfolded_descendants = true;
+    } else if (child->unfolded_descendants) {
+      unfolded_descendants = true;
+    }
+  }
+
+  duration = nr_time_duration(segment->start_time, segment->stop_time);
+
+  /*
+   * An exclusive time structure may already exist if children with metrics
+   * were discarded before this segment ended.
+   */
+  if (num_children || segment->exclusive_time) {
+    nr_exclusive_time_ensure(&segment->exclusive_time, num_children,
+                             segment->start_time, segment->stop_time);
+
+    for (size_t i = 0; i < num_children; i++) {
+      nr_segment_t* child = nr_segment_children_get(&segment->children, i);
+
+      if (child && child->async_context == segment->async_context) {
+        nr_exclusive_time_add_child(segment->exclusive_time, child->start_time,
+                                    child->stop_time);
+      }
+    }
+
+    exclusive_time = nr_exclusive_time_calculate(segment->exclusive_time);
+    nr_exclusive_time_destroy(&segment->exclusive_time);
+  } else {
+    exclusive_time = duration;
+  }
+
+  metric_count = nr_vector_size(segment->metrics);
+  for (size_t i = 0; i < metric_count; i++) {
+    nr_segment_metric_t* sm
+        = (nr_segment_metric_t*)nr_vector_get(segment->metrics, i);
+
+    nrm_add_ex(sm->scoped ? segment->txn->scoped_metrics
+                          : segment->txn->unscoped_metrics,
+               sm->name, duration, exclusive_time);
+  }
+  nr_vector_destroy(&segment->metrics);
+
+  segment->txn->folded_total_time += exclusive_time;
+  segment->folded = true;
+  segment->unfolded_descendants = unfolded_descendants;
+
+  /* This has to come last, as the segment may be discarded. */
+  if (nr_segment_txn_prunes_folded(segment->txn)) {
+    nr_segment_fold_into_reservoirs(segment);
+  }
+
+  return true;
+}
+
+/*
+ * Purpose : Fold a segment if it is ready to be folded, and then each of its
+ *           ancestors that was only waiting for it.
+ *
+ * Params  : 1. The segment to start from.
+ */
+static void nr_segment_fold_ended(nr_segment_t* segment) {
+  while (segment && segment->parent && segment->ended && !segment->folded) {
+    nr_segment_t* parent = segment->parent;
+
+    if (!nr_segment_fold(segment)) {
+      return;
+    }
+    segment = parent;
+  }
+}
+
+typedef struct _nr_segment_hrm_metadata_t {
+  nr_minmax_heap_t* heap;
+  const nr_segment_t* removed;
+} nr_segment_hrm_metadata_t;
+
+/*
+ * Purpose : Place a segment from one heap into another unless it is the
+ *             segment being removed, or "heap remove".
+ */
+static bool nr_segment_hrm_iterator_callback(void* value, void* userdata) {
+  nr_segment_hrm_metadata_t* metadata = (nr_segment_hrm_metadata_t*)userdata;
+
+  if (value != metadata->removed) {
+    nr_minmax_heap_insert(metadata->heap, value);
+  }
+
+  return true;
+}
+
+/*
+ * Purpose : Remove a segment from a heap of segments.
+ *
+ * Params  : 1. The address of the heap.
+ *           2. The segment to remove.
+ *           3. The comparator of the heap.
+ *           4. The destructor of the heap.
+ *
+ * Note    : The heap has no way to remove a single element, so the heap is
+ *           rebuilt without it. This is only needed when a folded segment is
+ *           discarded, which is rare.
+ */
+static void nr_segment_heap_remove(nr_minmax_heap_t** heap_ptr,
+                                   const nr_segment_t* segment,
+                                   nr_minmax_heap_cmp_t comparator,
+                                   nr_minmax_heap_dtor_t dtor) {
+  nr_segment_hrm_metadata_t metadata;
+
+  if (NULL == *heap_ptr) {
+    return;
+  }
+
+  metadata.heap = nr_minmax_heap_create(nr_minmax_heap_bound(*heap_ptr),
+                                        comparator, NULL, dtor, NULL);
+  metadata.removed = segment;
+
+  nr_minmax_heap_iterate(
+      *heap_ptr, (nr_minmax_heap_iter_t)nr_segment_hrm_iterator_callback,
+      &metadata);
+  nr_minmax_heap_set_destructor(*heap_ptr, NULL, NULL);
+  nr_minmax_heap_destroy(heap_ptr);
+  (*heap_ptr) = metadata.heap;
+}
+
+/*
+ * Purpose : Handle the discarding of a folded segment. Its metrics have
+ *           already been merged, but its parent has to account for it in its
+ *           exclusive time if the parent hasn't been folded yet, and it has to
+ *           be taken out of the folded reservoirs.
+ *
+ * Params  : 1. A folded segment that is discarded.
+ */
+static void nr_segment_discard_folded(nr_segment_t* segment) {
+  nrtxn_t* txn = segment->txn;
+  nr_segment_t* parent = segment->parent;
+
+  if (segment->folded_reservoirs & NR_SEGMENT_FOLDED_TRACE) {
+    nr_segment_heap_remove(
+        &txn->folded_trace_heap, segment,
+        nr_segment_wrapped_duration_comparator,
+        (nr_minmax_heap_dtor_t)nr_segment_folded_trace_dtor);
+  }
+  if (segment->folded_reservoirs & NR_SEGMENT_FOLDED_SPAN) {
+    nr_segment_heap_remove(
+        &txn->folded_span_heap, segment,
+        nr_segment_wrapped_span_priority_comparator,
+        (nr_minmax_heap_dtor_t)nr_segment_folded_span_dtor);
+  }
+  segment->folded_reservoirs = 0;
+
+  /*
+   * This is needed even when a segment limit is set: the metrics of the
+   * discarded segment are gone, so the parent would otherwise count its time
+   * as its own.
+   */
+  if (!parent->folded && parent->async_context == segment->async_context) {
+    nr_exclusive_time_ensure(&parent->exclusive_time,
+                             nr_segment_children_size(&parent->children),
+                             parent->start_time, parent->stop_time);
+
+    nr_exclusive_time_add_child(parent->exclusive_time, segment->start_time,
+                                segment->stop_time);
+  }
+}
+
 /*
  * Purpose: Merges metrics from a discarded segment into transaction
  *          metrics.
@@ -140,7 +463,8 @@ static void nr_segment_discard_merge_metrics(nr_segment_t* segment) {
    * added to the exclusive time data structure of the parent. The
    * exclusive time on the parent is initialized if necessary.
    */
-  if (segment->parent->async_context == segment->async_context) {
+  if (segment->parent->async_context == segment->async_context
+      && !parent->folded) {
     nr_exclusive_time_ensure(&parent->exclusive_time,
                              nr_segment_children_size(&parent->children),
                              parent->start_time, parent->stop_time);
@@ -218,6 +542,7 @@ bool nr_segment_init(nr_segment_t* segment,
   if (parent) {
     segment->parent = parent;
     nr_segment_children_add(&parent->children, segment);
+    nr_segment_mark_unfolded_descendants(parent);
   } /* Otherwise, the parent of this new segment is the current segment on the
        transaction */
   else {
@@ -237,6 +562,7 @@ bool nr_segment_init(nr_segment_t* segment,
 
     if (NULL != current_segment) {
       nr_segment_children_add(&current_segment->children, segment);
+      nr_segment_mark_unfolded_descendants(current_segment);
     }
     nr_txn_set_current_segment(txn, segment);
   }
@@ -449,8 +775,8 @@ nr_span_event_t* nr_segment_to_span_event(nr_segment_t* segment) {
       event, nr_distributed_trace_is_sampled(segment->txn->distributed_trace));
 
   if (segment->parent) {
-    nr_segment_ensure_id(segment->parent, segment->txn);
-    nr_span_event_set_parent_id(event, segment->parent->id);
+    nr_span_event_set_parent_id(
+        event, nr_segment_ensure_id(segment->parent, segment->txn));
     nr_span_event_set_entry_point(event, false);
   } else {
     nr_span_event_set_entry_point(event, true);
@@ -712,6 +1038,7 @@ bool nr_segment_set_name(nr_segment_t* segment, const char* name) {
 
 bool nr_segment_set_parent(nr_segment_t* segment, nr_segment_t* parent) {
   nr_segment_t* ancestor = NULL;
+  nr_segment_t* old_parent = NULL;
 
   if (NULL == segment) {
     return false;
@@ -742,13 +1069,26 @@ bool nr_segment_set_parent(nr_segment_t* segment, nr_segment_t* parent) {
     ancestor = ancestor->parent;
   }
 
-  if (segment->parent) {
-    nr_segment_children_remove(&segment->parent->children, segment);
+  old_parent = segment->parent;
+  if (old_parent) {
+    nr_segment_children_remove(&old_parent->children, segment);
   }
 
   nr_segment_children_add(&parent->children, segment);
   segment->parent = parent;
 
+  if (!segment->folded || segment->unfolded_descendants) {
+    nr_segment_mark_unfolded_descendants(parent);
+  }
+
+  /*
+   * The previous parent may only have been waiting for this segment to be
+   * folded.
+   */
+  if (segment->txn && segment->txn->options.incremental_finalise) {
+    nr_segment_fold_ended(old_parent);
+  }
+
   return true;
 }
 
@@ -786,9 +1126,18 @@ bool nr_segment_end(nr_segment_t** segment_ptr) {
         = nr_time_duration(nr_txn_start_time(txn), nr_get_time());
   }
 
+  segment->ended = true;
   txn->segment_count += 1;
   nr_txn_retire_current_segment(txn, segment);
 
+  /*
+   * Folding may discard the segment when it doesn't make it into the folded
+   * reservoirs. There is no segment heap in that case.
+   */
+  if (txn->options.incremental_finalise) {
+    nr_segment_fold_ended(segment);
+  }
+
   nr_minmax_heap_insert(txn->segment_heap, segment);
 
   (*segment_ptr) = NULL;
@@ -914,6 +1263,7 @@ void nr_segment_destroy_tree(nr_segment_t* root) {
 
 bool nr_segment_discard(nr_segment_t** segment_ptr) {
   nr_segment_t* segment = NULL;
+  nr_segment_t* parent = NULL;
   nrtxn_t* txn = NULL;
 
   if (NULL == segment_ptr || NULL == *segment_ptr
@@ -942,13 +1292,22 @@ bool nr_segment_discard(nr_segment_t** segment_ptr) {
     nr_segment_discard_merge_metrics(segment);
   }
 
+  if (segment->folded) {
+    nr_segment_discard_folded(segment);
+  }
+
   /* Unhook the segment from its parent. */
-  if (!nr_segment_children_remove(&segment->parent->children, segment)) {
+  parent = segment->parent;
+  if (!nr_segment_children_remove(&parent->children, segment)) {
     return false;
   }
 
   /* Reparent all children. */
-  nr_segment_children_reparent(&segment->children, segment->parent);
+  nr_segment_children_reparent(&segment->children, parent);
+  if (nr_segment_children_size(&segment->children)
+      && (!segment->folded || segment->unfolded_descendants)) {
+    nr_segment_mark_unfolded_descendants(parent);
+  }
 
   nr_segment_children_deinit(&segment->children);
 
@@ -957,6 +1316,13 @@ bool nr_segment_discard(nr_segment_t** segment_ptr) {
   nr_slab_release(txn->segment_slab, segment);
   (*segment_ptr) = NULL;
 
+  /*
+   * The parent may only have been waiting for this segment to be folded.
+   */
+  if (txn->options.incremental_finalise) {
+    nr_segment_fold_ended(parent);
+  }
+
   return true;
 }
 
@@ -1034,6 +1400,11 @@ static void nr_segment_stoh_post_iterator_callback(
     return;
   }
 
+  // Folded segments were already accounted for when they ended.
+  if (segment->folded) {
+    return;
+  }
+
   // Calculate the exclusive time.
   exclusive_time = nr_exclusive_time_calculate(segment->exclusive_time);
 
@@ -1086,17 +1457,26 @@ static nr_segment_iter_return_t nr_segment_stoh_iterator_callback(
   }
 
   /* Set up the exclusive time so that children can adjust it as necessary. */
-  nr_exclusive_time_ensure(&segment->exclusive_time,
-                           nr_segment_children_size(&segment->children),
-                           segment->start_time, segment->stop_time);
+  if (!segment->folded) {
+    nr_exclusive_time_ensure(&segment->exclusive_time,
+                             nr_segment_children_size(&segment->children),
+                             segment->start_time, segment->stop_time);
+  }
 
   /* Adjust the parent's exclusive time. */
-  if (segment->parent
+  if (segment->parent && !segment->parent->folded
       && segment->parent->async_context == segment->async_context) {
     nr_exclusive_time_add_child(segment->parent->exclusive_time,
                                 segment->start_time, segment->stop_time);
   }
 
+  /*
+   * A folded segment has already been placed in the folded reservoirs.
+   */
+  if (segment->folded && nr_segment_txn_prunes_folded(segment->txn)) {
+    return NR_SEGMENT_NO_POST_ITERATION_CALLBACK;
+  }
+
   /*
    * Adjust the main context exclusive time if necessary.
    *
@@ -1131,11 +1511,63 @@ static nr_segment_iter_return_t nr_segment_stoh_iterator_callback(
   // clang-format on
 }
 
+/*
+ * Purpose : Convert a tree of segments to heaps, skipping the subtrees of
+ *           folded segments. Folded segments are already in the folded
+ *           reservoirs of the transaction.
+ *
+ * Params  : 1. The segment to start from.
+ *           2. The metadata for nr_segment_stoh_iterator_callback().
+ *
+ * Note    : Unlike nr_segment_iterate(), this does not color the segments it
+ *           visits: the skipped subtrees would otherwise be left in a
+ *           different color than the rest of the tree, and be skipped by
+ *           later traversals. nr_segment_set_parent() refuses to create
+ *           cycles, so this terminates.
+ */
+static void nr_segment_tree_to_heap_unfolded(
+    nr_segment_t* segment,
+    nr_segment_tree_to_heap_metadata_t* metadata) {
+  nr_segment_iter_return_t cb_return;
+  size_t n_children;
+
+  if (NULL == segment) {
+    return;
+  }
+
+  /*
+   * A folded segment is still passed to the callback, as an unfolded parent
+   * needs it for its exclusive time, but its subtree is only visited if
+   * something in it has not been folded.
+   */
+  cb_return = nr_segment_stoh_iterator_callback(segment, metadata);
+
+  if (segment->folded && !segment->unfolded_descendants) {
+    return;
+  }
+
+  n_children = nr_segment_children_size(&segment->children);
+  for (size_t i = 0; i < n_children; i++) {
+    nr_segment_tree_to_heap_unfolded(
+        nr_segment_children_get(&segment->children, i), metadata);
+  }
+
+  if (cb_return.post_callback) {
+    (cb_return.post_callback)(segment, cb_return.userdata);
+  }
+}
+
 void nr_segment_tree_to_heap(nr_segment_t* root,
                              nr_segment_tree_to_heap_metadata_t* metadata) {
   if (NULL == root || NULL == metadata) {
     return;
   }
+
+  if (nr_segment_txn_prunes_folded(root->txn)) {
+    nr_segment_tree_to_heap_unfolded(root, metadata);
+    return;
+  }
+
   /* Convert the tree to two minmax heap.  The bound, or
    * size, of the heaps, and the comparison functions installed
    * by the nr_segment_heap_create() calls will assure that the
@@ -1183,8 +1615,11 @@ char* nr_segment_ensure_id(nr_segment_t* segment, const nrtxn_t* txn) {
   }
 
   // Create a segment id if it doesn't exist.
-  if ((NULL == segment->id) && (nr_txn_should_create_span_events(txn))) {
-    segment->id = nr_guid_create(txn->rnd);
+  if ('\0' == segment->id[0]) {
+    if (!nr_txn_should_create_span_events(txn)) {
+      return NULL;
+    }
+    nr_guid_fill(txn->rnd, segment->id);
   }
 
   return segment->id;
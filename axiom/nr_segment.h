@@ -22,6 +22,7 @@ typedef struct _nrtxn_t nrtxn_t;
 
 #include "nr_datastore_instance.h"
 #include "nr_exclusive_time.h"
+#include "nr_guid.h"
 #include "nr_segment_children.h"
 #include "nr_span_event.h"
 #include "nr_txn.h"
@@ -214,23 +215,37 @@ typedef struct _nr_segment_t {
 
   int name;             /* Node name (pooled string index) */
   int async_context;    /* Execution context (pooled string index) */
-  char* id;             /* Node id.
-            
-                           If this is NULL, a new id will be created when a
-                           span event is created from this trace node.
-            
-                           If this is not NULL, this id will be used for
-                           creating a span event from this trace node. This
-                           id set indicates that the node represents an
-                           external segment and the id of the segment was
-                           use as current span id in an outgoing DT payload.
-                          */
+  char id[NR_GUID_SIZE + 1]; /* Node id, stored inline.
+
+                                If this is empty, a new id will be created
+                                when a span event is created from this trace
+                                node.
+
+                                If this is not empty, this id will be used for
+                                creating a span event from this trace node.
+                                This id set indicates that the node represents
+                                an external segment and the id of the segment
+                                was use as current span id in an outgoing DT
+                                payload.
+                              */
   nr_vector_t* metrics; /* Metrics to be created by this segment. */
   nr_exclusive_time_t* exclusive_time; /* Exclusive time.
                                        This is only calculated after the
                                        transaction has ended; before then, this
                                        will be NULL. */
   nr_attributes_t* attributes;         /* User attributes */
+  bool ended;  /* Whether nr_segment_end() has been called */
+  bool folded; /* Whether the exclusive time and metrics of this segment have
+                  already been merged into the transaction. A segment is folded
+                  once it has ended and every child in its own context has
+                  been folded. See the incremental_finalise transaction
+                  option. */
+  int folded_reservoirs; /* Which of the folded reservoirs of the transaction
+                            hold this folded segment */
+  bool unfolded_descendants; /* Whether this folded segment may still have
+                                descendants that are not folded, so that the
+                                first pass of finalising must not skip its
+                                subtree */
   nr_attributes_t*
       attributes_txn_event; /* Transaction event custom user attributes */
   int priority; /* Used to determine which segments are preferred for span event
@@ -615,6 +630,10 @@ extern nr_segment_iter_return_t nr_segment_stot_iterator_callback(
  *
  * Params  : 1. A pointer to the root segment.
  *           2. A pointer to the metadata for this pass.
+ *
+ * Note    : When folded segments are kept in the folded reservoirs of the
+ *           transaction, their subtrees are skipped; the caller is expected to
+ *           add those reservoirs to the heaps.
  */
 extern void nr_segment_tree_to_heap(
     nr_segment_t* root,
@@ -667,7 +686,8 @@ extern bool nr_segment_discard(nr_segment_t** segment);
  * Params  : 1. A pointer to a segment.
  *           2. The transaction.
  *
- * Returns : The ID of the segment or NULL.
+ * Returns : The ID of the segment or NULL. The ID is stored inside the
+ *           segment and is valid for as long as the segment is.
  */
 extern char* nr_segment_ensure_id(nr_segment_t* segment, const nrtxn_t* txn);
 
@@ -10,6 +10,7 @@
 #include "nr_txn.h"
 #include "util_strings.h"
 #include "util_sql.h"
+#include "util_sql_cache.h"
 #include "util_logging.h"
 
 static char* create_metrics(nr_segment_t* segment,
@@ -75,6 +76,29 @@ static char* create_metrics(nr_segment_t* segment,
   return scoped_metric;
 }
 
+/*
+ * Analyse the given parts of the SQL using the transaction's SQL cache, the
+ * first time they are needed. The parts already in the analysis are kept.
+ * Returns false if there is no cache, in which case the caller analyses the
+ * parts of the SQL it needs itself.
+ */
+static bool nr_segment_datastore_analyse_sql(const nrtxn_t* txn,
+                                             const char* sql,
+                                             int parts,
+                                             nr_sql_analysis_t* analysis) {
+  if (NULL == txn->options.sql_cache) {
+    return false;
+  }
+  if (parts == (parts & analysis->parts)) {
+    return true;
+  }
+
+  parts |= analysis->parts;
+  nr_sql_analysis_deinit(analysis);
+  return nr_sql_analyse(txn->options.sql_cache, sql,
+                        txn->special_flags.show_sql_parsing, parts, analysis);
+}
+
 bool nr_segment_datastore_end(nr_segment_t** segment_ptr,
                               nr_segment_datastore_params_t* params) {
   nrtxn_t* txn = NULL;
@@ -89,6 +113,7 @@ bool nr_segment_datastore_end(nr_segment_t** segment_ptr,
   nr_slowsqls_labelled_query_t input_query_allocated = {NULL, NULL};
   char* input_query_query = NULL;
   nr_segment_datastore_t datastore = {0};
+  nr_sql_analysis_t analysis = {0};
   nr_segment_t* segment = NULL;
   bool rv = false;
 
@@ -129,9 +154,23 @@ bool nr_segment_datastore_end(nr_segment_t** segment_ptr,
     datastore_string = nr_datastore_as_string(params->datastore.type);
 
     if ((NULL == params->collection) || (NULL == params->operation)) {
-      collection_from_sql = nr_segment_sql_get_operation_and_table(
-          txn, &operation, params->sql.sql,
-          params->callbacks.modify_table_name);
+      if (txn->special_flags.no_sql_parsing) {
+        /* Neither the operation nor the table are parsed from the SQL. */
+      } else if (nr_segment_datastore_analyse_sql(txn, params->sql.sql,
+                                                  NR_SQL_ANALYSIS_OPERATION,
+                                                  &analysis)) {
+        operation = analysis.operation;
+        if (analysis.table) {
+          collection_from_sql = nr_strdup(analysis.table);
+          if (params->callbacks.modify_table_name) {
+            params->callbacks.modify_table_name(collection_from_sql);
+          }
+        }
+      } else {
+        collection_from_sql = nr_segment_sql_get_operation_and_table(
+            txn, &operation, params->sql.sql,
+            params->callbacks.modify_table_name);
+      }
       collection = collection_from_sql;
     }
   } else {
@@ -237,7 +276,14 @@ bool nr_segment_datastore_end(nr_segment_t** segment_ptr,
         break;
 
       case NR_SQL_OBFUSCATED:
-        datastore.sql_obfuscated = nr_sql_obfuscate(params->sql.sql);
+        if (nr_segment_datastore_analyse_sql(txn, params->sql.sql,
+                                             NR_SQL_ANALYSIS_OBFUSCATED,
+                                             &analysis)) {
+          datastore.sql_obfuscated = analysis.obfuscated;
+          analysis.obfuscated = NULL;
+        } else {
+          datastore.sql_obfuscated = nr_sql_obfuscate(params->sql.sql);
+        }
 
         /*
          * If it's set, we have to replace input_query with the obfuscated
@@ -284,6 +330,12 @@ bool nr_segment_datastore_end(nr_segment_t** segment_ptr,
         = txn->options.database_name_reporting_enabled,
     };
 
+    if (nr_segment_datastore_analyse_sql(txn, params->sql.sql,
+                                         NR_SQL_ANALYSIS_OBFUSCATED,
+                                         &analysis)) {
+      slowsqls_params.sql_id = analysis.normalized_id;
+    }
+
     nr_slowsqls_add(txn->slowsqls, &slowsqls_params);
   }
 
@@ -302,6 +354,7 @@ end:
   nr_free(datastore.instance.host);
   nr_free(datastore.instance.database_name);
   nr_free(datastore.sql_obfuscated);
+  nr_sql_analysis_deinit(&analysis);
 
   return rv;
 }
@@ -80,7 +80,7 @@ void nr_segment_destroy_fields(nr_segment_t* segment) {
     return;
   }
 
-  nr_free(segment->id);
+  segment->id[0] = '\0';
   nr_vector_destroy(&segment->metrics);
   nr_exclusive_time_destroy(&segment->exclusive_time);
   nr_attributes_destroy(&segment->attributes);
@@ -372,7 +372,8 @@ static void nr_segment_iteration_pass_span(nr_segment_t* segment,
   // We have to add the GUID to the span path regardless of whether the span
   // event conversion above succeeded or failed, since the post-callback will
   // pop it from the stack.
-  nr_stack_push(&spandata->parent_ids, (void*)segment->id);
+  nr_stack_push(&spandata->parent_ids,
+                segment->id[0] ? (void*)segment->id : NULL);
 }
 
 nr_segment_iter_return_t nr_segment_traces_stot_iterator_callback(
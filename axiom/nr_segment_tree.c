@@ -6,6 +6,17 @@
 #include "nr_segment_traces.h"
 #include "nr_segment_tree.h"
 
+/*
+ * Purpose : Place a segment from the folded reservoirs of a transaction into a
+ *           heap.
+ */
+static bool nr_segment_tree_folded_iterator_callback(void* value,
+                                                     void* userdata) {
+  nr_minmax_heap_insert((nr_minmax_heap_t*)userdata, value);
+
+  return true;
+}
+
 nrtxnfinal_t nr_segment_tree_finalise(nrtxn_t* txn,
                                       const size_t trace_limit,
                                       const size_t span_limit,
@@ -36,6 +47,12 @@ nrtxnfinal_t nr_segment_tree_finalise(nrtxn_t* txn,
 
   duration = nr_txn_duration(txn);
 
+  /*
+   * Segments folded into the transaction as they ended have already
+   * contributed their exclusive time.
+   */
+  first_pass_metadata.total_time = txn->folded_total_time;
+
   should_save_trace
       = (trace_limit > 0) && nr_txn_should_save_trace(txn, duration);
   should_sample_trace = txn->segment_count > trace_limit;
@@ -53,6 +70,23 @@ nrtxnfinal_t nr_segment_tree_finalise(nrtxn_t* txn,
         trace_limit, nr_segment_wrapped_duration_comparator);
   }
 
+  /*
+   * Folded segments were placed in reservoirs as they were folded, and are not
+   * visited again by the first pass.
+   */
+  if (first_pass_metadata.span_heap) {
+    nr_minmax_heap_iterate(
+        txn->folded_span_heap,
+        (nr_minmax_heap_iter_t)nr_segment_tree_folded_iterator_callback,
+        first_pass_metadata.span_heap);
+  }
+  if (first_pass_metadata.trace_heap) {
+    nr_minmax_heap_iterate(
+        txn->folded_trace_heap,
+        (nr_minmax_heap_iter_t)nr_segment_tree_folded_iterator_callback,
+        first_pass_metadata.trace_heap);
+  }
+
   /*
    * We'll use an exclusive time structure to calculate how long the main
    * context was blocked, if that was requested for this transaction.
@@ -60,6 +94,8 @@ nrtxnfinal_t nr_segment_tree_finalise(nrtxn_t* txn,
   if (txn->options.discount_main_context_blocking) {
     first_pass_metadata.main_context
         = nr_exclusive_time_create(txn->segment_count, 0, duration);
+    nr_exclusive_time_add_children(&first_pass_metadata.main_context,
+                                   txn->folded_main_context);
   }
 
   /*
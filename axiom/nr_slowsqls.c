@@ -325,7 +325,7 @@ void nr_slowsqls_add(nr_slowsqls_t* slowsqls,
     return;
   }
 
-  slow.sql_id = nr_sql_id(params->sql);
+  slow.sql_id = params->sql_id ? params->sql_id : nr_sql_id(params->sql);
   if (0 == slow.sql_id) {
     return;
   }
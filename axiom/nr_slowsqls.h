@@ -76,6 +76,8 @@ typedef struct _nr_slowsqls_params_t {
       instance; /* Any instance information that was collected */
   int instance_reporting_enabled;
   int database_name_reporting_enabled;
+  uint32_t sql_id; /* Optional normalized id of the SQL, as returned by
+                      nr_sql_normalized_id(). If 0, it is computed. */
 } nr_slowsqls_params_t;
 
 extern void nr_slowsqls_add(nr_slowsqls_t* slowsqls,
@@ -10,6 +10,7 @@
 #include "nr_span_event_private.h"
 #include "util_logging.h"
 #include "util_memory.h"
+#include "util_strings.h"
 #include "v1.pb-c.h"
 
 static inline void pack_batch(const Com__Newrelic__Trace__V1__SpanBatch* batch,
@@ -98,8 +99,310 @@ end:
 
 void nr_span_encoding_result_deinit(nr_span_encoding_result_t* result) {
   if (result) {
-    nr_free(result->data);
+    if (result->borrowed) {
+      result->data = NULL;
+      result->borrowed = false;
+    } else {
+      nr_free(result->data);
+    }
+  }
+}
+
+/*
+ * The direct wire format encoder. This writes exactly what protobuf-c would
+ * pack for the messages built by nr_span_encoding_encode_span_v1(), in field
+ * number order:
+ *
+ *   SpanBatch      1: Span (repeated)
+ *   Span           1: trace_id, 2: intrinsics, 3: user_attributes,
+ *                  4: agent_attributes (maps, as repeated entries)
+ *   map entry      1: key, 2: AttributeValue
+ *   AttributeValue 1: string, 2: bool, 3: int64, 4: double (one of)
+ *
+ * Each span is sized before it is written, so that every length prefix can be
+ * written in place.
+ */
+struct _nr_span_encoder_t {
+  uint8_t* data;
+  size_t capacity;
+  size_t* span_sizes; /* Scratch space for the size of each span */
+  size_t span_sizes_capacity;
+};
+
+#define NR_PB_WIRE_VARINT 0
+#define NR_PB_WIRE_I64 1
+#define NR_PB_WIRE_LEN 2
+#define NR_PB_TAG(FIELD, WIRE) ((uint8_t)(((FIELD) << 3) | (WIRE)))
+
+static inline size_t nr_pb_varint_size(uint64_t value) {
+  size_t size = 1;
+
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+
+  return size;
+}
+
+static inline uint8_t* nr_pb_write_varint(uint8_t* p, uint64_t value) {
+  while (value >= 0x80) {
+    *p++ = (uint8_t)(value | 0x80);
+    value >>= 7;
   }
+  *p++ = (uint8_t)value;
+
+  return p;
+}
+
+static inline size_t nr_pb_len_field_size(size_t len) {
+  return 1 + nr_pb_varint_size(len) + len;
+}
+
+static inline uint8_t* nr_pb_write_bytes(uint8_t* p,
+                                         uint8_t tag,
+                                         const char* str,
+                                         size_t len) {
+  *p++ = tag;
+  p = nr_pb_write_varint(p, len);
+  nr_memcpy(p, str, len);
+
+  return p + len;
+}
+
+/*
+ * Returns the size of the AttributeValue message for an object. Values that
+ * cannot be represented are encoded as an empty message, as in
+ * nr_span_encoding_encode_attribute_value_v1().
+ */
+static size_t nr_span_encoder_value_size(const nrobj_t* obj) {
+  switch (nro_type(obj)) {
+    case NR_OBJECT_INT:
+    case NR_OBJECT_LONG:
+      return 1 + nr_pb_varint_size((uint64_t)nro_get_long(obj, NULL));
+
+    case NR_OBJECT_ULONG:
+      return 1 + nr_pb_varint_size(nro_get_ulong(obj, NULL));
+
+    case NR_OBJECT_DOUBLE:
+      return 1 + sizeof(double);
+
+    case NR_OBJECT_BOOLEAN:
+      return 2;
+
+    case NR_OBJECT_STRING: {
+      const char* str = nro_get_string(obj, NULL);
+
+      return str ? nr_pb_len_field_size(nr_strlen(str)) : 0;
+    }
+
+    case NR_OBJECT_INVALID:
+    case NR_OBJECT_HASH:
+    case NR_OBJECT_ARRAY:
+    case NR_OBJECT_NONE:
+    case NR_OBJECT_JSTRING:
+    default:
+      return 0;
+  }
+}
+
+static uint8_t* nr_span_encoder_write_value(uint8_t* p, const nrobj_t* obj) {
+  switch (nro_type(obj)) {
+    case NR_OBJECT_INT:
+    case NR_OBJECT_LONG:
+      *p++ = NR_PB_TAG(3, NR_PB_WIRE_VARINT);
+      return nr_pb_write_varint(p, (uint64_t)nro_get_long(obj, NULL));
+
+    case NR_OBJECT_ULONG:
+      *p++ = NR_PB_TAG(3, NR_PB_WIRE_VARINT);
+      return nr_pb_write_varint(p, nro_get_ulong(obj, NULL));
+
+    case NR_OBJECT_DOUBLE: {
+      double value = nro_get_double(obj, NULL);
+      uint64_t bits;
+      size_t i;
+
+      nr_memcpy(&bits, &value, sizeof(bits));
+      *p++ = NR_PB_TAG(4, NR_PB_WIRE_I64);
+      for (i = 0; i < sizeof(bits); i++) {
+        *p++ = (uint8_t)(bits >> (8 * i));
+      }
+      return p;
+    }
+
+    case NR_OBJECT_BOOLEAN:
+      *p++ = NR_PB_TAG(2, NR_PB_WIRE_VARINT);
+      *p++ = nro_get_boolean(obj, NULL) ? 1 : 0;
+      return p;
+
+    case NR_OBJECT_STRING: {
+      const char* str = nro_get_string(obj, NULL);
+
+      if (str) {
+        p = nr_pb_write_bytes(p, NR_PB_TAG(1, NR_PB_WIRE_LEN), str,
+                              nr_strlen(str));
+      }
+      return p;
+    }
+
+    case NR_OBJECT_INVALID:
+    case NR_OBJECT_HASH:
+    case NR_OBJECT_ARRAY:
+    case NR_OBJECT_NONE:
+    case NR_OBJECT_JSTRING:
+    default:
+      return p;
+  }
+}
+
+static size_t nr_span_encoder_entry_size(const char* key, size_t value_size) {
+  size_t size = nr_pb_len_field_size(value_size);
+
+  if (key) {
+    size += nr_pb_len_field_size(nr_strlen(key));
+  }
+
+  return size;
+}
+
+/*
+ * Returns the size of all entries of an attribute map, or false if the map
+ * cannot be encoded.
+ */
+static bool nr_span_encoder_map_size(const nrobj_t* hash, size_t* size) {
+  int len = nro_getsize(hash);
+  int i;
+
+  for (i = 1; i <= len; i++) {
+    const char* key = NULL;
+    const nrobj_t* value = nro_get_hash_value_by_index(hash, i, NULL, &key);
+
+    if (NULL == value) {
+      return false;
+    }
+    *size += nr_pb_len_field_size(
+        nr_span_encoder_entry_size(key, nr_span_encoder_value_size(value)));
+  }
+
+  return true;
+}
+
+static uint8_t* nr_span_encoder_write_map(uint8_t* p,
+                                          uint32_t field,
+                                          const nrobj_t* hash) {
+  int len = nro_getsize(hash);
+  int i;
+
+  for (i = 1; i <= len; i++) {
+    const char* key = NULL;
+    const nrobj_t* value = nro_get_hash_value_by_index(hash, i, NULL, &key);
+    size_t value_size = nr_span_encoder_value_size(value);
+
+    *p++ = NR_PB_TAG(field, NR_PB_WIRE_LEN);
+    p = nr_pb_write_varint(p, nr_span_encoder_entry_size(key, value_size));
+    if (key) {
+      p = nr_pb_write_bytes(p, NR_PB_TAG(1, NR_PB_WIRE_LEN), key,
+                            nr_strlen(key));
+    }
+    *p++ = NR_PB_TAG(2, NR_PB_WIRE_LEN);
+    p = nr_pb_write_varint(p, value_size);
+    p = nr_span_encoder_write_value(p, value);
+  }
+
+  return p;
+}
+
+static bool nr_span_encoder_span_size(const nr_span_event_t* event,
+                                      size_t* size) {
+  *size = 0;
+
+  if (nrunlikely(NULL == event)) {
+    return false;
+  }
+
+  if (event->trace_id) {
+    *size += nr_pb_len_field_size(nr_strlen(event->trace_id));
+  }
+
+  return nr_span_encoder_map_size(event->intrinsics, size)
+         && nr_span_encoder_map_size(event->user_attributes, size)
+         && nr_span_encoder_map_size(event->agent_attributes, size);
+}
+
+static uint8_t* nr_span_encoder_write_span(uint8_t* p,
+                                           const nr_span_event_t* event) {
+  if (event->trace_id) {
+    p = nr_pb_write_bytes(p, NR_PB_TAG(1, NR_PB_WIRE_LEN), event->trace_id,
+                          nr_strlen(event->trace_id));
+  }
+  p = nr_span_encoder_write_map(p, 2, event->intrinsics);
+  p = nr_span_encoder_write_map(p, 3, event->user_attributes);
+  p = nr_span_encoder_write_map(p, 4, event->agent_attributes);
+
+  return p;
+}
+
+nr_span_encoder_t* nr_span_encoder_create(void) {
+  return (nr_span_encoder_t*)nr_zalloc(sizeof(nr_span_encoder_t));
+}
+
+void nr_span_encoder_destroy(nr_span_encoder_t** encoder_ptr) {
+  if (NULL == encoder_ptr || NULL == *encoder_ptr) {
+    return;
+  }
+
+  nr_free((*encoder_ptr)->data);
+  nr_free((*encoder_ptr)->span_sizes);
+  nr_realfree((void**)encoder_ptr);
+}
+
+bool nr_span_encoder_batch_v1(nr_span_encoder_t* encoder,
+                              const nr_span_event_t** events,
+                              size_t len,
+                              nr_span_encoding_result_t* result) {
+  size_t total = 0;
+  uint8_t* p;
+  size_t i;
+
+  if (NULL == encoder || NULL == events || NULL == result) {
+    return false;
+  }
+
+  if (len > encoder->span_sizes_capacity) {
+    encoder->span_sizes = (size_t*)nr_realloc(encoder->span_sizes,
+                                              len * sizeof(size_t));
+    encoder->span_sizes_capacity = len;
+  }
+
+  for (i = 0; i < len; i++) {
+    if (!nr_span_encoder_span_size(events[i], &encoder->span_sizes[i])) {
+      nrl_warning(NRL_AGENT, "%s: error encoding span event %zu", __func__, i);
+      return false;
+    }
+    total += nr_pb_len_field_size(encoder->span_sizes[i]);
+  }
+
+  /* The buffer only ever grows, so steady state batches need no allocation. */
+  if (total > encoder->capacity) {
+    encoder->capacity = total > 2 * encoder->capacity ? total
+                                                      : 2 * encoder->capacity;
+    nr_free(encoder->data);
+    encoder->data = (uint8_t*)nr_malloc(encoder->capacity);
+  }
+
+  p = encoder->data;
+  for (i = 0; i < len; i++) {
+    *p++ = NR_PB_TAG(1, NR_PB_WIRE_LEN);
+    p = nr_pb_write_varint(p, encoder->span_sizes[i]);
+    p = nr_span_encoder_write_span(p, events[i]);
+  }
+
+  result->data = encoder->data;
+  result->len = total;
+  result->span_count = len;
+  result->borrowed = true;
+
+  return true;
 }
 
 bool nr_span_encoding_encode_attribute_value_v1(
@@ -16,6 +16,8 @@ typedef struct _nr_span_encoding_result_t {
   uint8_t* data;
   size_t len;
   size_t span_count;
+  bool borrowed; /* data belongs to an nr_span_encoder_t, and is only valid
+                    until that encoder is next used */
 } nr_span_encoding_result_t;
 
 // A convenience constant to initialise a result.
@@ -23,8 +25,39 @@ static const nr_span_encoding_result_t NR_SPAN_ENCODING_RESULT_INIT = {
     .data = NULL,
     .len = 0,
     .span_count = 0,
+    .borrowed = false,
 };
 
+/*
+ * A span encoder writes the protobuf wire format directly into a buffer that
+ * is reused from one batch to the next, without building protobuf-c messages.
+ */
+typedef struct _nr_span_encoder_t nr_span_encoder_t;
+
+extern nr_span_encoder_t* nr_span_encoder_create(void);
+
+extern void nr_span_encoder_destroy(nr_span_encoder_t** encoder_ptr);
+
+/*
+ * Purpose : Encode an array of span events into a v1 8T span batch, using a
+ *           span encoder.
+ *
+ * Params  : 1. The encoder.
+ *           2. The span events to encode.
+ *           3. The number of span events.
+ *           4. A pointer to the result structure.
+ *
+ * Returns : True on success; false otherwise.
+ *
+ * Notes   : The output is identical to nr_span_encoding_batch_v1(), but the
+ *           result borrows the encoder's buffer: it is only valid until the
+ *           encoder is next used or destroyed.
+ */
+extern bool nr_span_encoder_batch_v1(nr_span_encoder_t* encoder,
+                                     const nr_span_event_t** events,
+                                     size_t len,
+                                     nr_span_encoding_result_t* result);
+
 /*
  * Purpose : Encode an array of span events into a v1 8T span batch.
  *
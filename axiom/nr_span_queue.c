@@ -55,6 +55,7 @@ nr_span_queue_t* nr_span_queue_create(
   queue->batch_handler = batch_handler;
   queue->batch_handler_userdata = batch_handler_userdata;
   queue->current_batch = nr_span_batch_create(batch_size);
+  queue->encoder = nr_span_encoder_create();
 
   return queue;
 }
@@ -65,6 +66,7 @@ void nr_span_queue_destroy(nr_span_queue_t** queue_ptr) {
   }
 
   nr_span_batch_destroy(&(*queue_ptr)->current_batch);
+  nr_span_encoder_destroy(&(*queue_ptr)->encoder);
   nr_realfree((void**)queue_ptr);
 }
 
@@ -92,8 +94,9 @@ bool nr_span_queue_flush(nr_span_queue_t* queue) {
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-qual"
-  if (!nr_span_encoding_batch_v1((const nr_span_event_t**)batch->spans,
-                                 batch->used, &encoded)) {
+  if (!nr_span_encoder_batch_v1(queue->encoder,
+                                (const nr_span_event_t**)batch->spans,
+                                batch->used, &encoded)) {
     nrl_warning(NRL_AGENT, "cannot encode span batch with %zu span(s)",
                 batch->used);
     rv = false;
@@ -101,8 +104,8 @@ bool nr_span_queue_flush(nr_span_queue_t* queue) {
   }
 #pragma GCC diagnostic pop
 
-  // Since the encoded result won't ever be touched again, this could be moved
-  // to a separate thread, either here or in the handler.
+  // The encoded result borrows the queue's encoder buffer, so the handler
+  // must be done with it before the next flush.
   rv = (queue->batch_handler)(&encoded, queue->batch_handler_userdata);
 
 end:
@@ -24,7 +24,9 @@ typedef struct _nr_span_queue_t nr_span_queue_t;
  * along with whatever userdata is registered.
  *
  * Note that ownership of encoded passes to the handler, and therefore the
- * handler is responsible for invoking nr_span_encoding_result_deinit().
+ * handler is responsible for invoking nr_span_encoding_result_deinit(). The
+ * encoded data is held in a buffer that the queue reuses for later batches,
+ * so it is only valid until the handler returns.
  */
 typedef bool (*nr_span_queue_batch_handler_t)(
     nr_span_encoding_result_t* encoded,
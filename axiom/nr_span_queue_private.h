@@ -6,6 +6,7 @@
 #ifndef NR_SPAN_QUEUE_PRIVATE_HDR
 #define NR_SPAN_QUEUE_PRIVATE_HDR
 
+#include "nr_span_encoding.h"
 #include "nr_span_queue.h"
 
 typedef struct _nr_span_batch_t {
@@ -21,6 +22,7 @@ struct _nr_span_queue_t {
   nr_span_queue_batch_handler_t batch_handler;
   void* batch_handler_userdata;
   nr_span_batch_t* current_batch;
+  nr_span_encoder_t* encoder; /* Reused across batches */
 };
 
 #endif /* NR_SPAN_QUEUE_PRIVATE_HDR */
@@ -108,6 +108,10 @@ NR_TXN_ATTR(nr_txn_http_statuscode,
 NR_TXN_ATTR(nr_txn_request_user_agent,
             "request.headers.userAgent",
             NR_TXN_ATTRIBUTE_TRACE_ERROR);
+NR_TXN_ATTR(nr_txn_agent_overhead,
+            "agent.overheadMicros",
+            NR_ATTRIBUTE_DESTINATION_TXN_TRACE
+                | NR_ATTRIBUTE_DESTINATION_TXN_EVENT);
 
 /*
  * Deprecated per December 2019
@@ -447,7 +451,7 @@ nrtxn_t* nr_txn_begin(nrapp_t* app,
                       const nrtxnopt_t* opts,
                       const nr_attribute_config_t* attribute_config) {
   nrtxn_t* nt;
-  char* guid;
+  char guid[NR_GUID_SIZE + 1];
   nr_status_t err = 0;
   nr_sampling_priority_t priority;
   nr_slab_t* segment_slab;
@@ -468,8 +472,9 @@ nrtxn_t* nr_txn_begin(nrapp_t* app,
    * Set up the slab allocator for segments. We'll do this early so we can bail
    * easily if there's an error.
    */
-  segment_slab
-      = nr_slab_create(sizeof(nr_segment_t), sizeof(nr_segment_t) * 100);
+  segment_slab = nr_slab_create_pooled(sizeof(nr_segment_t),
+                                      sizeof(nr_segment_t) * 100,
+                                      opts->segment_page_pool);
   if (nrunlikely(NULL == segment_slab)) {
     return NULL;
   }
@@ -632,7 +637,7 @@ nrtxn_t* nr_txn_begin(nrapp_t* app,
    * The trace id will be overwritten by accepting an inbound DT
    * payload.
    */
-  guid = nr_guid_create(app->rnd);
+  nr_guid_fill(app->rnd, guid);
   nr_distributed_trace_set_txn_id(nt->distributed_trace, guid);
   nr_distributed_trace_set_trace_id(nt->distributed_trace, guid,
                                     opts->distributed_tracing_pad_trace_id);
@@ -655,8 +660,6 @@ nrtxn_t* nr_txn_begin(nrapp_t* app,
   }
   nr_distributed_trace_set_priority(nt->distributed_trace, priority);
 
-  nr_free(guid);
-
   return nt;
 }
 
@@ -785,6 +788,62 @@ static int nr_txn_should_do_url_rules(int path_type, int is_background) {
   }
 }
 
+/*
+ * Purpose : Build the key under which the result of naming a transaction is
+ *           cached. Besides the application's rules, the result depends only
+ *           on the path, its type and whether the transaction is a
+ *           background task.
+ *
+ * Returns : The length of the key, or 0 if the key does not fit.
+ */
+static size_t nr_txn_build_name_cache_key(const nrtxn_t* txn,
+                                          char* key,
+                                          size_t key_size) {
+  int len = snprintf(key, key_size, "%d:%d:%c%s", (int)txn->status.path_type,
+                     txn->status.background ? 1 : 0, txn->path ? 'p' : 'n',
+                     txn->path ? txn->path : "");
+
+  if ((len < 0) || ((size_t)len >= key_size)) {
+    return 0;
+  }
+
+  return (size_t)len;
+}
+
+/*
+ * Purpose : Name the transaction from the application's cache, if it has seen
+ *           the same inputs since its rules last changed.
+ *
+ * Returns : True if the transaction was named from the cache.
+ */
+static bool nr_txn_freeze_name_from_cache(nrtxn_t* txn,
+                                          nrapp_t* app,
+                                          const char* key,
+                                          size_t key_len) {
+  const char* path = NULL;
+  const char* name = NULL;
+  bool ignore = false;
+
+  if ((0 == key_len)
+      || !nr_txn_name_cache_get(app->txn_name_cache, key, key_len, &path,
+                                &name, &ignore)) {
+    return false;
+  }
+
+  nr_free(txn->path);
+  txn->path = path ? nr_strdup(path) : NULL;
+  nr_free(txn->name);
+  txn->name = name ? nr_strdup(name) : NULL;
+  if (ignore) {
+    txn->status.ignore = 1;
+  }
+
+  nrl_verbosedebug(NRL_RULES, "txn naming cached: ignore=%d name=" NRP_FMT,
+                   (int)ignore, NRP_TXNNAME(txn->name));
+
+  return true;
+}
+
 static void nr_txn_update_apdex_if_key_txn(nrtxn_t* txn) {
   double db = 0.0;
   const nrobj_t* key_txns;
@@ -822,6 +881,8 @@ nr_status_t nr_txn_freeze_name_update_apdex(nrtxn_t* txn) {
   nrapp_t* app = 0;
   const char* name = 0;   /* Txn name, used for metric and scope */
   const char* prefix = 0; /* Txn name prefix */
+  char cache_key[NR_TXN_NAME_CACHE_MAX_KEY_LEN + 1];
+  size_t cache_key_len = 0;
 
   if (nrunlikely((0 == txn) || (0 != txn->status.ignore))) {
     return NR_FAILURE;
@@ -903,6 +964,23 @@ nr_status_t nr_txn_freeze_name_update_apdex(nrtxn_t* txn) {
     return NR_FAILURE;
   }
 
+  /*
+   * Most transactions share their path with an earlier one, in which case
+   * the rules below have already been applied to it.
+   */
+  if (app->txn_name_cache) {
+    cache_key_len
+        = nr_txn_build_name_cache_key(txn, cache_key, sizeof(cache_key));
+    if (nr_txn_freeze_name_from_cache(txn, app, cache_key, cache_key_len)) {
+      nrt_mutex_unlock(&app->app_lock);
+      if (txn->status.ignore) {
+        return NR_FAILURE;
+      }
+      nr_txn_update_apdex_if_key_txn(txn);
+      return NR_SUCCESS;
+    }
+  }
+
   /*
    * If there is a path, apply the url_rules (for non-background CUSTOM and URI)
    * and get the result.
@@ -952,6 +1030,11 @@ nr_status_t nr_txn_freeze_name_update_apdex(nrtxn_t* txn) {
    */
   nr_txn_apply_segment_terms(txn, app->segment_terms);
 
+  if (cache_key_len) {
+    nr_txn_name_cache_set(app->txn_name_cache, cache_key, cache_key_len,
+                          txn->path, txn->name, false);
+  }
+
   nrt_mutex_unlock(&app->app_lock);
   app = 0;
 
@@ -961,6 +1044,10 @@ nr_status_t nr_txn_freeze_name_update_apdex(nrtxn_t* txn) {
 
 ignore:
   if (app) {
+    if (cache_key_len) {
+      nr_txn_name_cache_set(app->txn_name_cache, cache_key, cache_key_len,
+                            txn->path, txn->name, true);
+    }
     nrt_mutex_unlock(&app->app_lock);
   }
   return NR_FAILURE;
@@ -1256,6 +1343,11 @@ void nr_txn_destroy_fields(nrtxn_t* txn) {
   nr_slab_destroy(&txn->segment_slab);
   nr_minmax_heap_set_destructor(txn->segment_heap, NULL, NULL);
   nr_minmax_heap_destroy(&txn->segment_heap);
+  nr_minmax_heap_set_destructor(txn->folded_trace_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn->folded_trace_heap);
+  nr_minmax_heap_set_destructor(txn->folded_span_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn->folded_span_heap);
+  nr_exclusive_time_destroy(&txn->folded_main_context);
   nr_span_queue_destroy(&txn->span_queue);
 
   nrm_table_destroy(&txn->unscoped_metrics);
@@ -1411,6 +1503,7 @@ void nr_txn_handle_total_time(nrtxn_t* txn,
 
 void nr_txn_end(nrtxn_t* txn) {
   nr_segment_t* root;
+  nrtime_t finalise_start;
 
   if (0 == txn) {
     return;
@@ -1454,14 +1547,24 @@ void nr_txn_end(nrtxn_t* txn) {
   /*
    * Finalise the segment tree.
    */
+  finalise_start = nr_get_time();
   txn->final_data = nr_segment_tree_finalise(
-      txn, NR_MAX_SEGMENTS,
-      ((0 < txn->options.span_events_max_samples_stored)
-       && (NR_MAX_SPAN_EVENTS_MAX_SAMPLES_STORED
-           >= txn->options.span_events_max_samples_stored))
-          ? txn->options.span_events_max_samples_stored
-          : NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED,
+      txn, NR_MAX_SEGMENTS, nr_txn_span_events_limit(txn),
       nr_txn_handle_total_time, NULL);
+  nr_overhead_add_since(&txn->overhead, NR_OVERHEAD_SEGMENT_FINALISE,
+                        finalise_start);
+
+  /*
+   * The overhead of sending the transaction is only known once it has been
+   * sent, so it is reported by the caller with a later transaction.
+   */
+  if (txn->options.overhead_metrics_enabled) {
+    nr_overhead_create_metrics(&txn->overhead, txn->unscoped_metrics);
+  }
+  if (txn->options.overhead_attribute_enabled) {
+    nr_txn_set_long_attribute(txn, nr_txn_agent_overhead,
+                              (long)nr_overhead_total(&txn->overhead));
+  }
 }
 
 bool nr_txn_set_timing(nrtxn_t* txn, nrtime_t start, nrtime_t duration) {
@@ -2744,9 +2847,24 @@ bool nr_txn_should_create_span_events(const nrtxn_t* txn) {
          && txn->options.span_events_enabled;
 }
 
+size_t nr_txn_span_events_limit(const nrtxn_t* txn) {
+  if (nrunlikely(NULL == txn)) {
+    return NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED;
+  }
+
+  if ((0 < txn->options.span_events_max_samples_stored)
+      && (NR_MAX_SPAN_EVENTS_MAX_SAMPLES_STORED
+          >= txn->options.span_events_max_samples_stored)) {
+    return txn->options.span_events_max_samples_stored;
+  }
+
+  return NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED;
+}
+
 char* nr_txn_create_w3c_traceparent_header(nrtxn_t* txn,
                                            nr_segment_t* segment) {
   char* span_id = NULL;
+  char random_id[NR_GUID_SIZE + 1];
   const char* trace_id;
   char* header = NULL;
 
@@ -2768,16 +2886,12 @@ char* nr_txn_create_w3c_traceparent_header(nrtxn_t* txn,
 
   // If spans are off we must send a random guid.
   if (NULL == span_id) {
-    span_id = nr_guid_create(txn->rnd);
-    header = nr_distributed_trace_create_w3c_traceparent_header(
-        trace_id, span_id,
-        nr_distributed_trace_is_sampled(txn->distributed_trace));
-    nr_free(span_id);
-  } else {
-    header = nr_distributed_trace_create_w3c_traceparent_header(
-        trace_id, span_id,
-        nr_distributed_trace_is_sampled(txn->distributed_trace));
+    nr_guid_fill(txn->rnd, random_id);
+    span_id = random_id;
   }
+  header = nr_distributed_trace_create_w3c_traceparent_header(
+      trace_id, span_id,
+      nr_distributed_trace_is_sampled(txn->distributed_trace));
 
 end:
   if (header) {
@@ -2882,26 +2996,26 @@ static bool nr_txn_accept_new_relic_header(nrtxn_t* txn,
                                            const char* transport_type) {
   const char* error = NULL;
   const char* trusted_key = NULL;
-  nrobj_t* obj_payload;
+  nr_distributed_trace_inbound_payload_t inbound;
+  bool accepted;
 
   if (NULL == txn || NULL == txn->distributed_trace) {
     return false;
   }
 
-  obj_payload
-      = nr_distributed_trace_convert_payload_to_object(nr_header, &error);
-
   // Check if payload was invalid
-  if (NULL == obj_payload) {
+  if (!nr_distributed_trace_parse_inbound_payload(nr_header, &inbound,
+                                                  &error)) {
     nrl_info(NRL_CAT, "cannot accept an invalid distributed tracing payload");
     nr_txn_force_single_count(txn, error);
+    nr_distributed_trace_inbound_payload_deinit(&inbound);
     return false;
   }
 
   // Make sure the payload is trusted.
-  trusted_key = nr_distributed_trace_object_get_trusted_key(obj_payload);
+  trusted_key = inbound.trusted_key;
   if (!trusted_key) {
-    trusted_key = nr_distributed_trace_object_get_account_id(obj_payload);
+    trusted_key = inbound.account_id;
   }
   if (0 == nr_txn_is_account_trusted_dt(txn, trusted_key)) {
     nrl_info(NRL_CAT,
@@ -2909,20 +3023,20 @@ static bool nr_txn_accept_new_relic_header(nrtxn_t* txn,
              "account");
     nr_txn_force_single_count(txn,
                               NR_DISTRIBUTED_TRACE_ACCEPT_UNTRUSTED_ACCOUNT);
-    nro_delete(obj_payload);
+    nr_distributed_trace_inbound_payload_deinit(&inbound);
     return false;
   }
 
   // attempt to accept payload
-  if (!nr_distributed_trace_accept_inbound_payload(
-          txn->distributed_trace, obj_payload, transport_type, &error)) {
+  accepted = nr_distributed_trace_accept_parsed_inbound_payload(
+      txn->distributed_trace, &inbound, transport_type, &error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+  if (!accepted) {
     nrl_info(NRL_CAT, "error accepting distributed tracing payload: %s", error);
     nr_txn_force_single_count(txn, error);
-    nro_delete(obj_payload);
     return false;
   }
 
-  nro_delete(obj_payload);
   return true;
 }
 
@@ -3372,6 +3486,26 @@ bool nr_txn_log_decorating_enabled(nrtxn_t* txn) {
 #define ENSURE_LOG_LEVEL_NAME(level_name) \
   (nr_strempty(level_name) ? "UNKNOWN" : level_name)
 
+/*
+ * The priority a log event created now would have: that of the current
+ * segment once it has been flagged as having a log, or the lowest value when
+ * there is no current segment.
+ */
+static int log_event_priority(nrtxn_t* txn) {
+  nr_segment_t* segment = NULL;
+
+  if (nrunlikely(NULL == txn)) {
+    return 0;
+  }
+
+  segment = nr_txn_get_current_segment(txn, NULL);
+  if (NULL == segment) {
+    return 0;
+  }
+
+  return nr_segment_get_priority_flag(segment) | NR_SEGMENT_PRIORITY_LOG;
+}
+
 static void log_event_set_linking_metadata(nr_log_event_t* e,
                                            nrtxn_t* txn,
                                            nrapp_t* app) {
@@ -3425,7 +3559,8 @@ static nr_log_event_t* log_event_create(const char* log_level_name,
     return e;
   }
   nr_log_event_set_log_level(e, ENSURE_LOG_LEVEL_NAME(log_level_name));
-  nr_log_event_set_message(e, log_message);
+  nr_log_event_set_message_truncated(
+      e, log_message, txn ? txn->options.log_forwarding_max_message_length : 0);
   nr_log_event_set_timestamp(e, timestamp);
   nr_log_event_set_context_attributes(e, context_attributes);
 
@@ -3434,6 +3569,32 @@ static nr_log_event_t* log_event_create(const char* log_level_name,
   return e;
 }
 
+/*
+ * Whether the per-request log forwarding cap, if any, has been reached.
+ */
+static bool log_forwarding_cap_reached(const nrtxn_t* txn) {
+  size_t cap = txn->options.log_forwarding_max_per_request;
+
+  return 0 != cap && nr_log_events_number_seen(txn->log_events) >= cap;
+}
+
+bool nr_txn_log_forwarding_would_keep(nrtxn_t* txn,
+                                      const char* log_level_name) {
+  if (!nr_txn_log_forwarding_enabled(txn)) {
+    return false;
+  }
+
+  if (!nr_txn_log_forwarding_log_level_verify(txn, log_level_name)) {
+    return false;
+  }
+
+  if (log_forwarding_cap_reached(txn)) {
+    return false;
+  }
+
+  return nr_log_events_would_keep(txn->log_events, log_event_priority(txn));
+}
+
 static void nr_txn_add_log_event(nrtxn_t* txn,
                                  const char* log_level_name,
                                  const char* log_message,
@@ -3443,21 +3604,35 @@ static void nr_txn_add_log_event(nrtxn_t* txn,
   nr_log_event_t* e = NULL;
   bool event_dropped = false;
 
-  if (nrunlikely(NULL == txn)) {
-    return;
-  }
-
   if (!nr_txn_log_forwarding_enabled(txn)) {
+    nr_attributes_destroy(&context_attributes);
     return;
   }
 
   if (nr_strempty(log_message)) {
+    nr_attributes_destroy(&context_attributes);
     return;
   }
 
   /* log events filtered out by log level will go into the Dropped metric */
   if (!nr_txn_log_forwarding_log_level_verify(txn, log_level_name)) {
     event_dropped = true;
+  } else if (log_forwarding_cap_reached(txn)
+             || !nr_log_events_would_keep(txn->log_events,
+                                          log_event_priority(txn))) {
+    nr_segment_t* segment = nr_txn_get_current_segment(txn, NULL);
+
+    /*
+     * The event would be discarded by the cap or the sampling reservoir, so
+     * count it as seen without paying to build it. The segment is still
+     * flagged as having a log, as it would have been had the event been
+     * built.
+     */
+    if (NULL != segment) {
+      nr_segment_set_priority_flag(segment, NR_SEGMENT_PRIORITY_LOG);
+    }
+    nr_log_events_add_dropped(txn->log_events);
+    event_dropped = true;
   } else {
     /* event passed log level filter so add it */
     e = log_event_create(log_level_name, log_message, timestamp,
@@ -3466,11 +3641,14 @@ static void nr_txn_add_log_event(nrtxn_t* txn,
       nrl_debug(NRL_TXN, "%s: failed to create log event", __func__);
       event_dropped = true;
     } else {
+      /* the context attributes are now owned by the event */
+      context_attributes = NULL;
       event_dropped = nr_log_events_add_event(txn->log_events, e);
     }
   }
 
   if (event_dropped) {
+    nr_attributes_destroy(&context_attributes);
     nrm_force_add(txn->unscoped_metrics, "Logging/Forwarding/Dropped", 0);
   }
 }
@@ -3501,6 +3679,7 @@ void nr_txn_record_log_event(nrtxn_t* txn,
                              nr_attributes_t* context_attributes,
                              nrapp_t* app) {
   if (nrunlikely(NULL == txn)) {
+    nr_attributes_destroy(&context_attributes);
     return;
   }
 
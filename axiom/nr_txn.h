@@ -24,6 +24,7 @@
 #include "nr_file_naming.h"
 #include "nr_log_events.h"
 #include "nr_log_level.h"
+#include "nr_overhead.h"
 #include "nr_segment.h"
 #include "nr_slowsqls.h"
 #include "nr_span_queue.h"
@@ -38,6 +39,7 @@
 #include "util_minmax_heap.h"
 #include "util_sampling.h"
 #include "util_slab.h"
+#include "util_sql_cache.h"
 #include "util_stack.h"
 #include "util_string_pool.h"
 
@@ -110,6 +112,12 @@ typedef struct _nrtxnopt_t {
   size_t max_segments; /* The maximum number of segments that are kept in the
                           segment tree at a time. When set to 0 or 1, no maximum
                           is applied. */
+  bool incremental_finalise; /* If enabled, the exclusive time and metrics
+                                of each segment are merged into the
+                                transaction once the segment and its
+                                children in the same context have ended,
+                                rather than when the segment tree is
+                                finalised. */
   bool discount_main_context_blocking; /* If enabled, the main context is
                                           assumed to be blocked when
                                           asynchronous contexts are executing,
@@ -131,9 +139,22 @@ typedef struct _nrtxnopt_t {
                                  */
   size_t log_events_max_samples_stored; /* The maximum number of log events per
                                            transaction */
+  size_t log_forwarding_max_per_request; /* The maximum number of log events
+                                            captured per transaction, or 0 for
+                                            no limit */
+  size_t log_forwarding_max_message_length; /* Log messages are truncated to
+                                               this many bytes at capture */
   bool log_metrics_enabled;             /* Whether log metrics are enabled */
   bool message_tracer_segment_parameters_enabled; /* Determines whether to add
                                                      message attr */
+  bool overhead_metrics_enabled;   /* Whether agent overhead supportability
+                                      metrics are created */
+  bool overhead_attribute_enabled; /* Whether the measured agent overhead is
+                                      added as a transaction attribute */
+  nr_slab_page_pool_t* segment_page_pool; /* Process-wide pool of pages for the
+                                             segment slab allocator, or NULL */
+  nr_sql_cache_t* sql_cache; /* Process-wide cache of SQL analysis results, or
+                                NULL */
 } nrtxnopt_t;
 
 typedef enum _nrtxnstatus_cross_process_t {
@@ -208,6 +229,10 @@ typedef enum _nr_cpu_usage_t {
 typedef struct _nr_composer_info_t {
   bool autoload_detected;
   bool composer_detected;
+  bool packages_reported; /* Whether the Composer package inventory has
+                             already been sent for this agent run, in which
+                             case Composer packages are left out of the
+                             transaction data */
 } nr_composer_info_t;
 
 /*
@@ -261,6 +286,18 @@ typedef struct _nrtxn_t {
   nr_minmax_heap_t*
       segment_heap; /* The heap used to track segments when a limit has been
                        applied via the max_segments transaction option. */
+  nrtime_t folded_total_time; /* The summed exclusive time of segments that
+                                 were folded into the transaction when they
+                                 ended */
+  nr_minmax_heap_t*
+      folded_trace_heap; /* The longest folded segments, kept as they fold so
+                            that finalising does not have to revisit them */
+  nr_minmax_heap_t* folded_span_heap; /* The folded segments with the highest
+                                         span event priority */
+  nr_exclusive_time_t*
+      folded_main_context; /* The periods of folded asynchronous segments,
+                              used when discount_main_context_blocking is
+                              enabled */
   nr_slab_t* segment_slab;    /* The slab allocator used to allocate segments */
   nr_segment_t* segment_root; /* The root pointer to the tree of segments */
   nrtime_t abs_start_time; /* The absolute start timestamp for this transaction;
@@ -332,6 +369,11 @@ typedef struct _nrtxn_t {
     uint8_t debug_dt;         /* extra logging for DT */
   } special_flags;
 
+  /*
+   * Timers measuring the overhead of the agent during this transaction.
+   */
+  nr_overhead_t overhead;
+
   /*
    * Data products created in nr_txn_end() that are used when transmitting the
    * transaction.
@@ -604,6 +646,7 @@ extern const nr_txn_attribute_t* nr_txn_request_user_agent;
 extern const nr_txn_attribute_t* nr_txn_server_name;
 extern const nr_txn_attribute_t* nr_txn_response_content_type;
 extern const nr_txn_attribute_t* nr_txn_response_content_length;
+extern const nr_txn_attribute_t* nr_txn_agent_overhead;
 extern void nr_txn_set_string_attribute(nrtxn_t* txn,
                                         const nr_txn_attribute_t* attribute,
                                         const char* value);
@@ -659,6 +702,26 @@ extern bool nr_txn_log_forwarding_context_data_enabled(nrtxn_t* txn);
 extern bool nr_txn_log_forwarding_log_level_verify(nrtxn_t* txn,
                                                    const char* log_level_name);
 
+/*
+ * Purpose : Check whether a log event at the given level would be kept if it
+ *           were recorded now, so that callers can avoid gathering the
+ *           context data for events that would be dropped.
+ *
+ * Params  : 1. The transaction.
+ *           2. Log record level name
+ *
+ * Returns : true if forwarding is enabled, the level passes the filter, the
+ *           per-request cap has not been reached, and the event would not lose
+ *           to the events already sampled; false otherwise.
+ *
+ * Notes   : Events for which this returns false should still be passed to
+ *           nr_txn_record_log_event() with their message, so that they are
+ *           counted as dropped and included in the logging metrics. Events
+ *           with an empty message are never counted.
+ */
+extern bool nr_txn_log_forwarding_would_keep(nrtxn_t* txn,
+                                             const char* log_level_name);
+
 /*
  * Purpose : Check logging metrics configuration
  */
@@ -679,6 +742,9 @@ extern bool nr_txn_log_decorating_enabled(nrtxn_t* txn);
  *           5. Attribute data for Monolog context data (can be NULL)
  *           6. The application (to get linking meta data)
  *
+ * Notes   : The context attributes are owned by the transaction once this is
+ *           called.  The message is truncated to the configured maximum
+ *           message length.
  */
 extern void nr_txn_record_log_event(nrtxn_t* txn,
                                     const char* level_name,
@@ -1025,6 +1091,16 @@ char* nr_txn_create_w3c_tracestate_header(const nrtxn_t* txn,
  */
 extern bool nr_txn_should_create_span_events(const nrtxn_t* txn);
 
+/*
+ * Purpose : Return the maximum number of span events kept for a transaction.
+ *
+ * Params  : 1. The transaction.
+ *
+ * Returns : The span_events_max_samples_stored option if it is within the
+ *           allowed range, and the default otherwise.
+ */
+extern size_t nr_txn_span_events_limit(const nrtxn_t* txn);
+
 /*
  * Purpose : Get a pointer to the currently-executing segment for a given
  *           async context.
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "nr_txn_name_cache.h"
+#include "util_hashmap.h"
+#include "util_memory.h"
+#include "util_strings.h"
+
+typedef struct _nr_txn_name_cache_entry_t {
+  struct _nr_txn_name_cache_entry_t* prev; /* More recently used */
+  struct _nr_txn_name_cache_entry_t* next; /* Less recently used */
+  char* key;
+  size_t key_len;
+  char* path;
+  char* name;
+  bool ignore;
+} nr_txn_name_cache_entry_t;
+
+struct _nr_txn_name_cache_t {
+  nr_hashmap_t* entries;           /* Key -> nr_txn_name_cache_entry_t */
+  nr_txn_name_cache_entry_t* head; /* Most recently used entry */
+  nr_txn_name_cache_entry_t* tail; /* Least recently used entry */
+  size_t max_entries;
+};
+
+static void nr_txn_name_cache_entry_destroy(nr_txn_name_cache_entry_t* entry) {
+  nr_free(entry->key);
+  nr_free(entry->path);
+  nr_free(entry->name);
+  nr_free(entry);
+}
+
+static void nr_txn_name_cache_unlink(nr_txn_name_cache_t* cache,
+                                     nr_txn_name_cache_entry_t* entry) {
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->head = entry->next;
+  }
+
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->tail = entry->prev;
+  }
+
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+static void nr_txn_name_cache_push_front(nr_txn_name_cache_t* cache,
+                                         nr_txn_name_cache_entry_t* entry) {
+  entry->prev = NULL;
+  entry->next = cache->head;
+
+  if (cache->head) {
+    cache->head->prev = entry;
+  } else {
+    cache->tail = entry;
+  }
+  cache->head = entry;
+}
+
+nr_txn_name_cache_t* nr_txn_name_cache_create(size_t max_entries) {
+  nr_txn_name_cache_t* cache;
+
+  if (0 == max_entries) {
+    return NULL;
+  }
+
+  cache = (nr_txn_name_cache_t*)nr_zalloc(sizeof(nr_txn_name_cache_t));
+  cache->entries = nr_hashmap_create(NULL);
+  cache->max_entries = max_entries;
+
+  return cache;
+}
+
+void nr_txn_name_cache_destroy(nr_txn_name_cache_t** cache_ptr) {
+  if (NULL == cache_ptr || NULL == *cache_ptr) {
+    return;
+  }
+
+  nr_txn_name_cache_clear(*cache_ptr);
+  nr_hashmap_destroy(&(*cache_ptr)->entries);
+  nr_realfree((void**)cache_ptr);
+}
+
+void nr_txn_name_cache_clear(nr_txn_name_cache_t* cache) {
+  nr_txn_name_cache_entry_t* entry;
+
+  if (NULL == cache) {
+    return;
+  }
+
+  entry = cache->head;
+  while (entry) {
+    nr_txn_name_cache_entry_t* next = entry->next;
+
+    nr_hashmap_delete(cache->entries, entry->key, entry->key_len);
+    nr_txn_name_cache_entry_destroy(entry);
+    entry = next;
+  }
+
+  cache->head = NULL;
+  cache->tail = NULL;
+}
+
+bool nr_txn_name_cache_get(nr_txn_name_cache_t* cache,
+                           const char* key,
+                           size_t key_len,
+                           const char** path,
+                           const char** name,
+                           bool* ignore) {
+  nr_txn_name_cache_entry_t* entry;
+  void* value = NULL;
+
+  if (NULL == cache || NULL == key || NULL == path || NULL == name
+      || NULL == ignore) {
+    return false;
+  }
+
+  if (!nr_hashmap_get_into(cache->entries, key, key_len, &value)) {
+    return false;
+  }
+
+  entry = (nr_txn_name_cache_entry_t*)value;
+  nr_txn_name_cache_unlink(cache, entry);
+  nr_txn_name_cache_push_front(cache, entry);
+
+  *path = entry->path;
+  *name = entry->name;
+  *ignore = entry->ignore;
+
+  return true;
+}
+
+void nr_txn_name_cache_set(nr_txn_name_cache_t* cache,
+                           const char* key,
+                           size_t key_len,
+                           const char* path,
+                           const char* name,
+                           bool ignore) {
+  nr_txn_name_cache_entry_t* entry;
+  void* value = NULL;
+
+  if (NULL == cache || NULL == key || key_len > NR_TXN_NAME_CACHE_MAX_KEY_LEN) {
+    return;
+  }
+
+  if (nr_hashmap_get_into(cache->entries, key, key_len, &value)) {
+    entry = (nr_txn_name_cache_entry_t*)value;
+    nr_txn_name_cache_unlink(cache, entry);
+    nr_hashmap_delete(cache->entries, entry->key, entry->key_len);
+    nr_txn_name_cache_entry_destroy(entry);
+  } else if (nr_hashmap_count(cache->entries) >= cache->max_entries) {
+    nr_txn_name_cache_entry_t* lru = cache->tail;
+
+    nr_txn_name_cache_unlink(cache, lru);
+    nr_hashmap_delete(cache->entries, lru->key, lru->key_len);
+    nr_txn_name_cache_entry_destroy(lru);
+  }
+
+  entry = (nr_txn_name_cache_entry_t*)nr_zalloc(
+      sizeof(nr_txn_name_cache_entry_t));
+  entry->key = nr_strndup(key, key_len);
+  entry->key_len = key_len;
+  entry->path = path ? nr_strdup(path) : NULL;
+  entry->name = name ? nr_strdup(name) : NULL;
+  entry->ignore = ignore;
+
+  nr_hashmap_set(cache->entries, entry->key, entry->key_len, entry);
+  nr_txn_name_cache_push_front(cache, entry);
+}
+
+size_t nr_txn_name_cache_size(const nr_txn_name_cache_t* cache) {
+  if (NULL == cache) {
+    return 0;
+  }
+
+  return nr_hashmap_count(cache->entries);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains a cache of transaction naming results.
+ *
+ * Freezing a transaction name applies the application's URL rules,
+ * transaction name rules and segment terms to the transaction's path, which
+ * costs several regular expression matches and allocations. Most traffic
+ * is spread over a small set of paths, so the application remembers the final
+ * path and name for recently frozen paths. The cache belongs to an application
+ * and must be cleared whenever the application's rules change.
+ *
+ * The cache has no lock of its own: callers must hold the application lock.
+ */
+#ifndef NR_TXN_NAME_CACHE_HDR
+#define NR_TXN_NAME_CACHE_HDR
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Keys longer than this are not cached.
+ */
+#define NR_TXN_NAME_CACHE_MAX_KEY_LEN 1024
+
+typedef struct _nr_txn_name_cache_t nr_txn_name_cache_t;
+
+/*
+ * Purpose : Create a transaction naming cache.
+ *
+ * Params  : 1. The maximum number of names to cache. When the cache is full,
+ *              the least recently used name is evicted.
+ *
+ * Returns : A cache, or NULL if the maximum number of names is 0.
+ */
+extern nr_txn_name_cache_t* nr_txn_name_cache_create(size_t max_entries);
+
+/*
+ * Purpose : Destroy a transaction naming cache.
+ *
+ * Params  : 1. A pointer to the cache to destroy.
+ */
+extern void nr_txn_name_cache_destroy(nr_txn_name_cache_t** cache_ptr);
+
+/*
+ * Purpose : Remove every name from the cache.
+ */
+extern void nr_txn_name_cache_clear(nr_txn_name_cache_t* cache);
+
+/*
+ * Purpose : Look up the result of naming a transaction.
+ *
+ * Params  : 1. The cache.
+ *           2. The key, which must describe every input to the naming.
+ *           3. The length of the key.
+ *           4. Return value for the final path, which may be NULL.
+ *           5. Return value for the final name, which may be NULL.
+ *           6. Return value for whether the transaction is ignored.
+ *
+ * Returns : True if the key was found. The returned strings are owned by the
+ *           cache and are only valid until it is next changed.
+ */
+extern bool nr_txn_name_cache_get(nr_txn_name_cache_t* cache,
+                                  const char* key,
+                                  size_t key_len,
+                                  const char** path,
+                                  const char** name,
+                                  bool* ignore);
+
+/*
+ * Purpose : Remember the result of naming a transaction.
+ *
+ * Params  : 1. The cache.
+ *           2. The key, which must describe every input to the naming.
+ *           3. The length of the key. Longer than
+ *              NR_TXN_NAME_CACHE_MAX_KEY_LEN and nothing is cached.
+ *           4. The final path, which may be NULL.
+ *           5. The final name, which may be NULL.
+ *           6. Whether the transaction is ignored.
+ */
+extern void nr_txn_name_cache_set(nr_txn_name_cache_t* cache,
+                                  const char* key,
+                                  size_t key_len,
+                                  const char* path,
+                                  const char* name,
+                                  bool ignore);
+
+/*
+ * Purpose : Return the number of names in the cache.
+ */
+extern size_t nr_txn_name_cache_size(const nr_txn_name_cache_t* cache);
+
+#endif /* NR_TXN_NAME_CACHE_HDR */
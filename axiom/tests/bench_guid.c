@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Compares the original per-nibble GUID generator with nr_guid_create() and
+ * the allocation free nr_guid_fill().
+ *
+ * Usage: bench_guid [iterations]
+ */
+#include "nr_axiom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nr_guid.h"
+#include "util_memory.h"
+#include "util_random.h"
+#include "util_time.h"
+
+/*
+ * The generator nr_guid_create() used before nr_guid_fill() existed: one
+ * rand48 draw, with rejection sampling, per hex digit.
+ */
+static char* bench_guid_create_nibbles(nr_random_t* rnd) {
+  static const char* hex_digits = "0123456789abcdef";
+  char* guid = nr_zalloc(NR_GUID_SIZE + 1);
+  size_t i;
+
+  for (i = 0; i < NR_GUID_SIZE; i++) {
+    guid[i] = hex_digits[nr_random_range(rnd, 0xf)];
+  }
+
+  return guid;
+}
+
+static void bench_nibbles(nr_random_t* rnd, size_t iterations, char* last) {
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    char* guid = bench_guid_create_nibbles(rnd);
+
+    last[0] = guid[0];
+    nr_free(guid);
+  }
+}
+
+static void bench_create(nr_random_t* rnd, size_t iterations, char* last) {
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    char* guid = nr_guid_create(rnd);
+
+    last[0] = guid[0];
+    nr_free(guid);
+  }
+}
+
+static void bench_fill(nr_random_t* rnd, size_t iterations, char* last) {
+  char guid[NR_GUID_SIZE + 1];
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    nr_guid_fill(rnd, guid);
+    last[0] = guid[0];
+  }
+}
+
+static void bench_report(const char* name,
+                         void (*func)(nr_random_t*, size_t, char*),
+                         size_t iterations) {
+  nr_random_t* rnd = nr_random_create_from_seed(345345);
+  char last[2] = {0};
+  nrtime_t start;
+  nrtime_t duration;
+
+  start = nr_get_time();
+  func(rnd, iterations, last);
+  duration = nr_time_duration(start, nr_get_time());
+  if (0 == duration) {
+    duration = 1;
+  }
+
+  /* Print the last digit so that the work cannot be optimised away. */
+  printf("%-26s %10zu ids %8.1f ns/id %12.0f ids/sec (%s)\n", name,
+         iterations, (double)duration * 1000.0 / (double)iterations,
+         (double)iterations * 1000000.0 / (double)duration, last);
+
+  nr_random_destroy(&rnd);
+}
+
+int main(int argc, char** argv) {
+  size_t iterations = 5000000;
+
+  if (argc > 1) {
+    iterations = (size_t)strtoul(argv[1], NULL, 10);
+  }
+  if (0 == iterations) {
+    fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  bench_report("nr_random_range per digit", bench_nibbles, iterations);
+  bench_report("nr_guid_create", bench_create, iterations);
+  bench_report("nr_guid_fill", bench_fill, iterations);
+
+  return 0;
+}
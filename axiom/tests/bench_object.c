@@ -0,0 +1,192 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measures the generic object JSON round trip: nro_to_json and
+ * nro_create_from_json over transaction-event-shaped hashes, and key lookups
+ * in a hash the size of a connect reply.
+ *
+ * Usage: bench_object [iterations [batch size]]
+ */
+#include "nr_axiom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util_memory.h"
+#include "util_object.h"
+#include "util_strings.h"
+#include "util_time.h"
+
+static nrobj_t* bench_event_create(size_t i) {
+  nrobj_t* event = nro_new_array();
+  nrobj_t* intrinsics = nro_new_hash();
+  nrobj_t* user = nro_new_hash();
+  nrobj_t* agent = nro_new_hash();
+  char* guid = nr_formatf("%016zx", i + 1);
+
+  /* Roughly the intrinsics of a web transaction event. */
+  nro_set_hash_string(intrinsics, "type", "Transaction");
+  nro_set_hash_string(intrinsics, "name", "WebTransaction/Action/index");
+  nro_set_hash_double(intrinsics, "timestamp", 1700000000.123 + (double)i);
+  nro_set_hash_double(intrinsics, "duration", 0.0123);
+  nro_set_hash_double(intrinsics, "totalTime", 0.0234);
+  nro_set_hash_string(intrinsics, "nr.apdexPerfZone", "S");
+  nro_set_hash_string(intrinsics, "guid", guid);
+  nro_set_hash_string(intrinsics, "traceId",
+                      "0af7651916cd43dd8448eb211c80319c");
+  nro_set_hash_double(intrinsics, "priority", 1.234567);
+  nro_set_hash_boolean(intrinsics, "sampled", 1);
+  nro_set_hash_boolean(intrinsics, "error", 0);
+  nro_set_hash_double(intrinsics, "databaseDuration", 0.0045);
+  nro_set_hash_int(intrinsics, "databaseCallCount", 3);
+
+  nro_set_hash_long(user, "user.id", 42 + (int64_t)i);
+  nro_set_hash_string(user, "plan", "enterprise");
+
+  nro_set_hash_string(agent, "request.method", "GET");
+  nro_set_hash_string(agent, "request.uri", "/index.php");
+  nro_set_hash_int(agent, "response.statusCode", 200);
+  nro_set_hash_string(agent, "request.headers.host", "www.example.com");
+  nro_set_hash_string(agent, "request.headers.userAgent",
+                      "Mozilla/5.0 (X11; Linux x86_64)");
+
+  nro_set_array(event, 0, intrinsics);
+  nro_set_array(event, 0, user);
+  nro_set_array(event, 0, agent);
+
+  nro_delete(intrinsics);
+  nro_delete(user);
+  nro_delete(agent);
+  nr_free(guid);
+  return event;
+}
+
+static nrobj_t* bench_reply_create(size_t keys) {
+  nrobj_t* reply = nro_new_hash();
+  size_t i;
+
+  for (i = 0; i < keys; i++) {
+    char* key = nr_formatf("collector.setting_%zu", i);
+
+    nro_set_hash_long(reply, key, (int64_t)i);
+    nr_free(key);
+  }
+
+  return reply;
+}
+
+static void bench_report(const char* name,
+                         const char* unit,
+                         nrtime_t duration,
+                         size_t count,
+                         size_t bytes) {
+  printf("%-26s %8zu %-6s %10zu bytes %10.1f ns/%s\n", name, count, unit,
+         bytes, (double)duration * 1000.0 / (double)count, unit);
+}
+
+int main(int argc, char** argv) {
+  size_t iterations = 200;
+  size_t len = 1000;
+  size_t reply_keys = 64;
+  nrobj_t** events;
+  char** json;
+  nrobj_t* reply;
+  char** reply_keynames;
+  char* str;
+  size_t bytes = 0;
+  size_t found = 0;
+  nrtime_t start;
+  nrtime_t duration;
+  size_t i;
+  size_t j;
+
+  if (argc > 1) {
+    iterations = (size_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    len = (size_t)strtoul(argv[2], NULL, 10);
+  }
+  if (0 == iterations || 0 == len) {
+    fprintf(stderr, "usage: %s [iterations [batch size]]\n", argv[0]);
+    return 1;
+  }
+
+  events = (nrobj_t**)nr_calloc(len, sizeof(nrobj_t*));
+  json = (char**)nr_calloc(len, sizeof(char*));
+  for (i = 0; i < len; i++) {
+    events[i] = bench_event_create(i);
+    json[i] = nro_to_json(events[i]);
+    bytes += nr_strlen(json[i]);
+  }
+
+  start = nr_get_time();
+  for (i = 0; i < iterations; i++) {
+    for (j = 0; j < len; j++) {
+      str = nro_to_json(events[j]);
+      nr_free(str);
+    }
+  }
+  duration = nr_time_duration(start, nr_get_time());
+  bench_report("nro_to_json", "event", duration, iterations * len, bytes);
+
+  start = nr_get_time();
+  for (i = 0; i < iterations; i++) {
+    for (j = 0; j < len; j++) {
+      nrobj_t* obj = nro_create_from_json(json[j]);
+
+      nro_delete(obj);
+    }
+  }
+  duration = nr_time_duration(start, nr_get_time());
+  bench_report("nro_create_from_json", "event", duration, iterations * len,
+               bytes);
+
+  start = nr_get_time();
+  for (i = 0; i < iterations; i++) {
+    for (j = 0; j < len; j++) {
+      nrobj_t* obj = nro_copy(events[j]);
+
+      nro_delete(obj);
+    }
+  }
+  duration = nr_time_duration(start, nr_get_time());
+  bench_report("nro_copy", "event", duration, iterations * len, bytes);
+
+  reply = bench_reply_create(reply_keys);
+  str = nro_to_json(reply);
+  bytes = nr_strlen(str);
+  nr_free(str);
+  reply_keynames = (char**)nr_calloc(reply_keys, sizeof(char*));
+  for (i = 0; i < reply_keys; i++) {
+    reply_keynames[i] = nr_formatf("collector.setting_%zu", i);
+  }
+
+  start = nr_get_time();
+  for (i = 0; i < iterations * 100; i++) {
+    for (j = 0; j < reply_keys; j++) {
+      if (nro_get_hash_value(reply, reply_keynames[j], NULL)) {
+        found++;
+      }
+    }
+  }
+  duration = nr_time_duration(start, nr_get_time());
+  bench_report("nro_get_hash_value", "lookup", duration, found, bytes);
+
+  for (i = 0; i < reply_keys; i++) {
+    nr_free(reply_keynames[i]);
+  }
+  nr_free(reply_keynames);
+  nro_delete(reply);
+
+  for (i = 0; i < len; i++) {
+    nro_delete(events[i]);
+    nr_free(json[i]);
+  }
+  nr_free(events);
+  nr_free(json);
+
+  return 0;
+}
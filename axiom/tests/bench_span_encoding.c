@@ -0,0 +1,147 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Compares the protobuf-c span batch encoder with the direct wire format
+ * encoder used by span queues.
+ *
+ * Usage: bench_span_encoding [iterations [batch size]]
+ */
+#include "nr_axiom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nr_span_encoding.h"
+#include "nr_span_event.h"
+#include "nr_span_event_private.h"
+#include "util_memory.h"
+#include "util_strings.h"
+#include "util_time.h"
+
+static nr_span_event_t* bench_span_create(size_t i) {
+  nr_span_event_t* span = nr_span_event_create();
+  char* guid = nr_formatf("%016zx", i + 1);
+  nrobj_t* user_id = nro_new_long(42);
+
+  /* Roughly the attributes of a datastore span. */
+  nr_span_event_set_trace_id(span, "0af7651916cd43dd8448eb211c80319c");
+  nr_span_event_set_guid(span, guid);
+  nr_span_event_set_parent_id(span, "b7ad6b7169203331");
+  nr_span_event_set_transaction_id(span, "00f067aa0ba902b7");
+  nr_span_event_set_name(span, "Datastore/statement/MySQL/users/select");
+  nr_span_event_set_category(span, NR_SPAN_DATASTORE);
+  nr_span_event_set_priority(span, 1.234567);
+  nr_span_event_set_sampled(span, true);
+  nr_span_event_set_timestamp(span, 1700000000000000 + i);
+  nr_span_event_set_duration(span, 1234 + i);
+  nr_span_event_set_datastore(span, NR_SPAN_DATASTORE_COMPONENT, "MySQL");
+  nr_span_event_set_datastore(span, NR_SPAN_DATASTORE_DB_STATEMENT,
+                              "SELECT * FROM users WHERE id = ?");
+  nr_span_event_set_datastore(span, NR_SPAN_DATASTORE_DB_INSTANCE, "app");
+  nr_span_event_set_datastore(span, NR_SPAN_DATASTORE_PEER_ADDRESS,
+                              "db.example.com:3306");
+  nr_span_event_set_datastore(span, NR_SPAN_DATASTORE_PEER_HOSTNAME,
+                              "db.example.com");
+  nr_span_event_set_attribute_user(span, "user.id", user_id);
+
+  nro_delete(user_id);
+  nr_free(guid);
+  return span;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+static void bench_protobuf_c(const nr_span_event_t** spans,
+                             size_t len,
+                             size_t iterations,
+                             size_t* bytes) {
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    nr_span_encoding_result_t result = NR_SPAN_ENCODING_RESULT_INIT;
+
+    nr_span_encoding_batch_v1(spans, len, &result);
+    *bytes = result.len;
+    nr_span_encoding_result_deinit(&result);
+  }
+}
+
+static void bench_encoder(const nr_span_event_t** spans,
+                          size_t len,
+                          size_t iterations,
+                          size_t* bytes) {
+  nr_span_encoder_t* encoder = nr_span_encoder_create();
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    nr_span_encoding_result_t result = NR_SPAN_ENCODING_RESULT_INIT;
+
+    nr_span_encoder_batch_v1(encoder, spans, len, &result);
+    *bytes = result.len;
+    nr_span_encoding_result_deinit(&result);
+  }
+
+  nr_span_encoder_destroy(&encoder);
+}
+
+static void bench_report(const char* name,
+                         void (*func)(const nr_span_event_t**,
+                                      size_t,
+                                      size_t,
+                                      size_t*),
+                         nr_span_event_t** spans,
+                         size_t len,
+                         size_t iterations) {
+  size_t bytes = 0;
+  nrtime_t start;
+  nrtime_t duration;
+
+  /* Warm up, so that the encoder buffer has reached its high-water mark. */
+  func((const nr_span_event_t**)spans, len, 1, &bytes);
+
+  start = nr_get_time();
+  func((const nr_span_event_t**)spans, len, iterations, &bytes);
+  duration = nr_time_duration(start, nr_get_time());
+
+  printf("%-26s %8zu spans %10zu bytes %10.1f ns/span\n", name, len, bytes,
+         (double)duration * 1000.0 / (double)(iterations * len));
+}
+#pragma GCC diagnostic pop
+
+int main(int argc, char** argv) {
+  size_t iterations = 2000;
+  size_t len = 1000;
+  nr_span_event_t** spans;
+  size_t i;
+
+  if (argc > 1) {
+    iterations = (size_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    len = (size_t)strtoul(argv[2], NULL, 10);
+  }
+  if (0 == iterations || 0 == len) {
+    fprintf(stderr, "usage: %s [iterations [batch size]]\n", argv[0]);
+    return 1;
+  }
+
+  spans = (nr_span_event_t**)nr_calloc(len, sizeof(nr_span_event_t*));
+  for (i = 0; i < len; i++) {
+    spans[i] = bench_span_create(i);
+  }
+
+  bench_report("nr_span_encoding_batch_v1", bench_protobuf_c, spans, len,
+               iterations);
+  bench_report("nr_span_encoder_batch_v1", bench_encoder, spans, len,
+               iterations);
+
+  for (i = 0; i < len; i++) {
+    nr_span_event_destroy(&spans[i]);
+  }
+  nr_free(spans);
+
+  return 0;
+}
@@ -10,9 +10,20 @@
 /* This is defined only to satisfy link requirements, and is not shared amongst
  * threads. */
 nrapplist_t* nr_agent_applist = 0;
+nr_app_cache_t* nr_agent_app_cache = NULL;
 
 void nr_agent_close_daemon_connection(void) {}
 
+nr_metric_names_t* nr_agent_get_metric_names(void) {
+  return NULL;
+}
+
+void nr_agent_set_txn_batch_size(uint32_t size NRUNUSED) {}
+
+uint32_t nr_agent_get_txn_batch_size(void) {
+  return 0;
+}
+
 nr_status_t nr_agent_lock_daemon_mutex(void) {
   return NR_SUCCESS;
 }
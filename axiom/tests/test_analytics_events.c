@@ -95,7 +95,7 @@ static void test_event_create(void) {
                                     user_attributes);
   tlib_pass_if_true("event created",
                     0
-                        == nr_strcmp((const char*)event,
+                        == nr_strcmp(nr_analytics_event_json(event),
                                      "["
                                      "{"
                                      "\"type\":\"Transaction\","
@@ -116,31 +116,31 @@ static void test_event_create(void) {
                                      "\"agent_long\":1"
                                      "}"
                                      "]"),
-                    "event=%s", (char*)event);
+                    "event=%s", nr_analytics_event_json(event));
   nr_analytics_event_destroy(&event);
 
   event = nr_analytics_event_create(empty_hash, empty_hash, empty_hash);
   tlib_pass_if_true("empty attributes",
                     0
-                        == nr_strcmp((const char*)event,
+                        == nr_strcmp(nr_analytics_event_json(event),
                                      "["
                                      "{},"
                                      "{},"
                                      "{}"
                                      "]"),
-                    "event=%s", (char*)event);
+                    "event=%s", nr_analytics_event_json(event));
   nr_analytics_event_destroy(&event);
 
   event = nr_analytics_event_create(0, 0, 0);
   tlib_pass_if_true("null attributes",
                     0
-                        == nr_strcmp((const char*)event,
+                        == nr_strcmp(nr_analytics_event_json(event),
                                      "["
                                      "{},"
                                      "{},"
                                      "{}"
                                      "]"),
-                    "event=%s", (char*)event);
+                    "event=%s", nr_analytics_event_json(event));
   nr_analytics_event_destroy(&event);
 
   nro_delete(empty_hash);
@@ -392,6 +392,117 @@ static void test_reservoir_replacement(void) {
   nr_random_destroy(&rnd);
 }
 
+static void test_event_create_deferred(void) {
+  nr_analytics_events_t* events = nr_analytics_events_create(1);
+  nr_analytics_event_t* event;
+  nrobj_t* builtin_fields = nro_new_hash();
+  nrobj_t* user_attributes = nro_new_hash();
+  nrobj_t* array = nro_new_array();
+
+  nro_set_hash_string(builtin_fields, "type", "Custom");
+  nro_set_hash_long(user_attributes, "alpha", 1);
+
+  /*
+   * Invalid fields are not owned by the event.
+   */
+  event = nr_analytics_event_create_deferred(&array, NULL, NULL);
+  tlib_pass_if_null("array fields", event);
+  tlib_pass_if_not_null("array fields not owned", array);
+  nro_delete(array);
+
+  /*
+   * Valid fields are owned by the event, which is not serialised until it is
+   * read from an event pool.
+   */
+  event = nr_analytics_event_create_deferred(&builtin_fields, NULL,
+                                             &user_attributes);
+  tlib_pass_if_not_null("deferred event", event);
+  tlib_pass_if_null("builtin fields owned", builtin_fields);
+  tlib_pass_if_null("user attributes owned", user_attributes);
+  tlib_pass_if_null("deferred event not serialised",
+                    nr_analytics_event_json(event));
+
+  nr_analytics_events_add_event(events, event, NULL);
+  nr_analytics_event_destroy(&event);
+  tlib_pass_if_str_equal("deferred event serialised",
+                         "[{\"type\":\"Custom\"},{\"alpha\":1},{}]",
+                         nr_analytics_events_get_event_json(events, 0));
+
+  nr_analytics_events_destroy(&events);
+}
+
+typedef struct {
+  int built;
+  const char* json;
+} test_event_builder_t;
+
+static nr_analytics_event_t* test_event_build(void* userdata) {
+  test_event_builder_t* builder = (test_event_builder_t*)userdata;
+
+  builder->built++;
+  if (NULL == builder->json) {
+    return NULL;
+  }
+  return nr_analytics_event_create_from_string(builder->json);
+}
+
+static void test_events_add_event_built(void) {
+  int i;
+  int max = 10;
+  nr_analytics_events_t* events = nr_analytics_events_create(max);
+  nr_random_t* rnd = nr_random_create_from_seed(12345);
+  test_event_builder_t builder = {0, "[{\"X\":1},{},{}]"};
+
+  /*
+   * Bad parameters.
+   */
+  nr_analytics_events_add_event_built(NULL, test_event_build, &builder, rnd);
+  nr_analytics_events_add_event_built(events, NULL, &builder, rnd);
+  tlib_pass_if_int_equal("bad params not built", 0, builder.built);
+  tlib_pass_if_int_equal("bad params not seen", 0,
+                         nr_analytics_events_number_seen(events));
+
+  /*
+   * A failed build is seen but not saved.
+   */
+  builder.json = NULL;
+  nr_analytics_events_add_event_built(events, test_event_build, &builder, rnd);
+  tlib_pass_if_int_equal("failed build seen", 1,
+                         nr_analytics_events_number_seen(events));
+  tlib_pass_if_int_equal("failed build not saved", 0,
+                         nr_analytics_events_number_saved(events));
+
+  /*
+   * Events are built until the pool is full, and then only when the
+   * sampling algorithm keeps them.
+   */
+  builder.built = 0;
+  builder.json = "[{\"X\":1},{},{}]";
+  for (i = 0; i < max; i++) {
+    nr_analytics_events_add_event_built(events, test_event_build, &builder,
+                                        rnd);
+  }
+  tlib_pass_if_int_equal("events built until full", max, builder.built);
+  tlib_pass_if_int_equal("events saved until full", max,
+                         nr_analytics_events_number_saved(events));
+
+  builder.built = 0;
+  for (i = 0; i < 100 * max; i++) {
+    nr_analytics_events_add_event_built(events, test_event_build, &builder,
+                                        rnd);
+  }
+  tlib_pass_if_int_equal("all events seen", 1 + 101 * max,
+                         nr_analytics_events_number_seen(events));
+  tlib_pass_if_int_equal("saved events capped", max,
+                         nr_analytics_events_number_saved(events));
+  tlib_pass_if_true("most sampled events not built",
+                    builder.built > 0 && builder.built < 10 * max,
+                    "built=%d", builder.built);
+
+  nr_analytics_events_destroy(&events);
+  nr_random_destroy(&rnd);
+}
+
 static void test_events_destroy_bad_params(void) {
   nr_analytics_events_t* null_events = 0;
 
@@ -472,6 +583,8 @@ void test_main(void* p NRUNUSED) {
   test_events_add_event_failure();
   test_max_observed();
   test_reservoir_replacement();
+  test_event_create_deferred();
+  test_events_add_event_built();
   test_events_destroy_bad_params();
   test_max_events_bad_param();
   test_is_sampling_bad_param();
@@ -335,6 +335,76 @@ static void test_find_or_add_app(void) {
   nr_applist_destroy(&applist);
 }
 
+#define TEST_FIND_OR_ADD_APP_THREADS 8
+#define TEST_FIND_OR_ADD_APP_LOOKUPS 200
+
+typedef struct _test_find_or_add_app_thread_t {
+  nrapplist_t* applist;
+  const nr_app_info_t* info;
+  nrapp_t* apps[TEST_FIND_OR_ADD_APP_LOOKUPS];
+} test_find_or_add_app_thread_t;
+
+static void* test_find_or_add_app_thread(void* vp) {
+  test_find_or_add_app_thread_t* t = (test_find_or_add_app_thread_t*)vp;
+  int i;
+
+  for (i = 0; i < TEST_FIND_OR_ADD_APP_LOOKUPS; i++) {
+    t->apps[i] = nr_app_find_or_add_app(t->applist, t->info);
+    if (t->apps[i]) {
+      nrt_mutex_unlock(&t->apps[i]->app_lock);
+    }
+  }
+
+  return NULL;
+}
+
+static void test_find_or_add_app_threads(void) {
+  nrapplist_t* applist = nr_applist_create();
+  nr_app_info_t info;
+  nrthread_t threads[TEST_FIND_OR_ADD_APP_THREADS];
+  test_find_or_add_app_thread_t* states;
+  nrapp_t* app;
+  int i;
+  int j;
+
+  nr_memset(&info, 0, sizeof(info));
+  info.license = nr_strdup(TEST_LICENSE);
+  info.appname = nr_strdup("threaded-app");
+  info.version = nr_strdup("my_version");
+  info.lang = nr_strdup("my_language");
+  info.environment = nro_create_from_json("[\"my_environment\"]");
+  info.redirect_collector = nr_strdup("collector.newrelic.com");
+
+  states = (test_find_or_add_app_thread_t*)nr_calloc(
+      TEST_FIND_OR_ADD_APP_THREADS, sizeof(test_find_or_add_app_thread_t));
+
+  /*
+   * Test : Concurrent lookups of the same application add it exactly once.
+   */
+  for (i = 0; i < TEST_FIND_OR_ADD_APP_THREADS; i++) {
+    states[i].applist = applist;
+    states[i].info = &info;
+    nrt_create(&threads[i], NULL, test_find_or_add_app_thread, &states[i]);
+  }
+  for (i = 0; i < TEST_FIND_OR_ADD_APP_THREADS; i++) {
+    nrt_join(threads[i], NULL);
+  }
+
+  tlib_pass_if_int_equal("one app", 1, applist->num_apps);
+  app = applist->apps[0];
+  for (i = 0; i < TEST_FIND_OR_ADD_APP_THREADS; i++) {
+    for (j = 0; j < TEST_FIND_OR_ADD_APP_LOOKUPS; j++) {
+      if (app != states[i].apps[j]) {
+        tlib_pass_if_ptr_equal("same app", app, states[i].apps[j]);
+      }
+    }
+  }
+
+  nr_free(states);
+  nr_app_info_destroy_fields(&info);
+  nr_applist_destroy(&applist);
+}
+
 static void test_find_or_add_app_high_security_mismatch(void) {
   nrapp_t* app;
   nr_app_info_t info;
@@ -1028,6 +1098,7 @@ void test_main(void* p NRUNUSED) {
 
   test_app_match();
   test_find_or_add_app();
+  test_find_or_add_app_threads();
   test_find_or_add_app_high_security_mismatch();
   test_agent_should_do_app_daemon_query();
   test_agent_find_or_add_app();
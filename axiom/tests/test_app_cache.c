@@ -0,0 +1,605 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "nr_agent.h"
+#include "nr_app_cache.h"
+#include "nr_commands.h"
+#include "nr_commands_private.h"
+#include "nr_rules.h"
+#include "util_flatbuffers.h"
+#include "util_memory.h"
+#include "util_strings.h"
+
+#include "tlib_main.h"
+
+#define TEST_NOW ((time_t)1700000000)
+
+static nr_app_info_t test_info(char* license, char* appname) {
+  nr_app_info_t info;
+
+  nr_memset(&info, 0, sizeof(info));
+  info.license = license;
+  info.appname = appname;
+
+  return info;
+}
+
+static nr_app_cache_entry_t test_entry(const char* agent_run_id,
+                                       const char* connect_reply) {
+  nr_app_cache_entry_t entry;
+
+  nr_memset(&entry, 0, sizeof(entry));
+  entry.agent_run_id = agent_run_id;
+  entry.connect_reply = connect_reply;
+  entry.connect_reply_len = nr_strlen(connect_reply);
+  entry.security_policies = "{\"record_sql\":{\"enabled\":true}}";
+  entry.security_policies_len = nr_strlen(entry.security_policies);
+  entry.connect_timestamp = 123 * NR_TIME_DIVISOR;
+  entry.harvest_frequency = 60 * NR_TIME_DIVISOR;
+  entry.sampling_target = 10;
+
+  return entry;
+}
+
+static nr_flatbuffer_t* create_app_reply(const char* agent_run_id,
+                                         int8_t status,
+                                         const char* connect_json) {
+  nr_flatbuffer_t* fb;
+  uint32_t body;
+  uint32_t agent_run_id_offset = 0;
+  uint32_t connect_json_offset = 0;
+  uint32_t security_policies_offset;
+
+  fb = nr_flatbuffers_create(0);
+  security_policies_offset
+      = nr_flatbuffers_prepend_string(fb, "{\"record_sql\":false}");
+  if (connect_json) {
+    connect_json_offset = nr_flatbuffers_prepend_string(fb, connect_json);
+  }
+
+  nr_flatbuffers_object_begin(fb, APP_REPLY_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_i8(fb, APP_REPLY_FIELD_STATUS, status, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, APP_REPLY_FIELD_CONNECT_REPLY,
+                                        connect_json_offset, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, APP_REPLY_FIELD_SECURITY_POLICIES,
+                                        security_policies_offset, 0);
+  nr_flatbuffers_object_prepend_u64(fb, APP_REPLY_FIELD_CONNECT_TIMESTAMP,
+                                    1000, 0);
+  nr_flatbuffers_object_prepend_u16(fb, APP_REPLY_FIELD_HARVEST_FREQUENCY, 60,
+                                    0);
+  nr_flatbuffers_object_prepend_u16(fb, APP_REPLY_FIELD_SAMPLING_TARGET, 10,
+                                    0);
+  body = nr_flatbuffers_object_end(fb);
+
+  if (agent_run_id) {
+    agent_run_id_offset = nr_flatbuffers_prepend_string(fb, agent_run_id);
+  }
+
+  nr_flatbuffers_object_begin(fb, MESSAGE_NUM_FIELDS);
+  nr_flatbuffers_object_prepend_uoffset(fb, MESSAGE_FIELD_DATA, body, 0);
+  nr_flatbuffers_object_prepend_u8(fb, MESSAGE_FIELD_DATA_TYPE,
+                                   MESSAGE_BODY_APP_REPLY, 0);
+  nr_flatbuffers_object_prepend_uoffset(fb, MESSAGE_FIELD_AGENT_RUN_ID,
+                                        agent_run_id_offset, 0);
+  nr_flatbuffers_finish(fb, nr_flatbuffers_object_end(fb));
+
+  return fb;
+}
+
+static void test_app_init(nrapp_t* app) {
+  nr_memset(app, 0, sizeof(*app));
+  app->info.license = "license";
+  app->info.appname = "app";
+  app->state = NR_APP_UNKNOWN;
+}
+
+static void test_app_deinit(nrapp_t* app) {
+  nr_free(app->agent_run_id);
+  nr_free(app->entity_guid);
+  nro_delete(app->connect_reply);
+  nro_delete(app->security_policies);
+  nr_rules_destroy(&app->url_rules);
+  nr_rules_destroy(&app->txn_rules);
+  nr_segment_terms_destroy(&app->segment_terms);
+}
+
+static nr_status_t test_process_reply(nrapp_t* app,
+                                      const char* agent_run_id,
+                                      int8_t status,
+                                      const char* connect_json) {
+  nr_flatbuffer_t* reply = create_app_reply(agent_run_id, status, connect_json);
+  nr_status_t st = nr_cmd_appinfo_process_reply(
+      nr_flatbuffers_data(reply), nr_flatbuffers_len(reply), app);
+
+  nr_flatbuffers_destroy(&reply);
+  return st;
+}
+
+/*
+ * Test that APPINFO replies are shared through nr_agent_app_cache, and that
+ * nr_cmd_appinfo_tx() uses them instead of querying the daemon.
+ */
+static void test_appinfo(void) {
+  nrapp_t connected;
+  nrapp_t worker;
+  nr_status_t st;
+  const char* connect_json
+      = "{\"agent_run_id\":\"12345\",\"entity_guid\":\"guid\","
+        "\"url_rules\":[{\"match_expression\":\"^a$\",\"replacement\":\"b\"}],"
+        "\"event_harvest_config\":{\"report_period_ms\":60000,"
+        "\"harvest_limits\":{\"analytic_event_data\":833}}}";
+
+  nr_agent_app_cache = nr_app_cache_create();
+  tlib_pass_if_not_null(__func__, nr_agent_app_cache);
+
+  /*
+   * Without a cached application, the daemon must be queried.
+   */
+  test_app_init(&worker);
+  st = nr_cmd_appinfo_tx(-1, &worker);
+  tlib_pass_if_status_failure(__func__, st);
+  tlib_pass_if_int_equal(__func__, (int)NR_APP_UNKNOWN, (int)worker.state);
+
+  test_app_init(&connected);
+  connected.last_daemon_query = time(0);
+  st = test_process_reply(&connected, "12345", APP_STATUS_CONNECTED,
+                          connect_json);
+  tlib_pass_if_status_success(__func__, st);
+
+  st = nr_cmd_appinfo_tx(-1, &worker);
+  tlib_pass_if_status_success(__func__, st);
+  tlib_pass_if_int_equal(__func__, (int)NR_APP_OK, (int)worker.state);
+  tlib_pass_if_str_equal(__func__, "12345", worker.agent_run_id);
+  tlib_pass_if_str_equal(__func__, "guid", worker.entity_guid);
+  tlib_pass_if_not_null(__func__, worker.connect_reply);
+  tlib_pass_if_not_null(__func__, worker.url_rules);
+  tlib_pass_if_int_equal(
+      __func__, 0,
+      nro_get_hash_boolean(worker.security_policies, "record_sql", NULL));
+  tlib_pass_if_int_equal(__func__, 833, worker.limits.analytics_events);
+  tlib_pass_if_uint64_t_equal(__func__, connected.harvest.connect_timestamp,
+                              worker.harvest.connect_timestamp);
+  tlib_pass_if_uint64_t_equal(__func__, connected.harvest.frequency,
+                              worker.harvest.frequency);
+  tlib_pass_if_uint64_t_equal(__func__,
+                              connected.harvest.target_transactions_per_cycle,
+                              worker.harvest.target_transactions_per_cycle);
+  tlib_pass_if_true(__func__, 0 != worker.last_daemon_query,
+                    "last_daemon_query=%ld", (long)worker.last_daemon_query);
+  test_app_deinit(&worker);
+
+  /*
+   * Once the daemon no longer knows the application, other processes must
+   * query it again.
+   */
+  connected.last_daemon_query = time(0) + 1;
+  st = test_process_reply(&connected, NULL, APP_STATUS_UNKNOWN, NULL);
+  tlib_pass_if_status_success(__func__, st);
+
+  test_app_init(&worker);
+  st = nr_cmd_appinfo_tx(-1, &worker);
+  tlib_pass_if_status_failure(__func__, st);
+  tlib_pass_if_int_equal(__func__, (int)NR_APP_UNKNOWN, (int)worker.state);
+
+  /*
+   * The daemon confirming the agent run ID makes it available again.
+   */
+  st = test_process_reply(&connected, NULL, APP_STATUS_STILL_VALID, NULL);
+  tlib_pass_if_status_success(__func__, st);
+
+  st = nr_cmd_appinfo_tx(-1, &worker);
+  tlib_pass_if_status_success(__func__, st);
+  tlib_pass_if_str_equal(__func__, "12345", worker.agent_run_id);
+  test_app_deinit(&worker);
+
+  test_app_deinit(&connected);
+  nr_app_cache_destroy(&nr_agent_app_cache);
+}
+
+static void test_bad_params(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_info_t no_license = test_info(NULL, "app");
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+
+  nr_app_cache_destroy(NULL);
+
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_publish(NULL, &info, &entry, TEST_NOW),
+                     "cache=NULL");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_publish(cache, NULL, &entry, TEST_NOW),
+                     "info=NULL");
+  tlib_pass_if_false(
+      __func__, nr_app_cache_publish(cache, &no_license, &entry, TEST_NOW),
+      "license=NULL");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_publish(cache, &info, NULL, TEST_NOW),
+                     "entry=NULL");
+  entry.agent_run_id = NULL;
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_publish(cache, &info, &entry, TEST_NOW),
+                     "agent_run_id=NULL");
+
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(NULL, &info, TEST_NOW, &found),
+                     "cache=NULL");
+  tlib_pass_if_null(__func__, found.buffer);
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, NULL, TEST_NOW, &found),
+                     "info=NULL");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, TEST_NOW, NULL),
+                     "entry=NULL");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, TEST_NOW, &found),
+                     "empty cache");
+
+  nr_app_cache_validate(NULL, &info, "run", TEST_NOW);
+  nr_app_cache_validate(cache, NULL, "run", TEST_NOW);
+  nr_app_cache_validate(cache, &info, NULL, TEST_NOW);
+  nr_app_cache_invalidate(NULL, &info, TEST_NOW);
+  nr_app_cache_invalidate(cache, NULL, TEST_NOW);
+  nr_app_cache_entry_deinit(NULL);
+
+  nr_app_cache_destroy(&cache);
+  tlib_pass_if_null(__func__, cache);
+}
+
+static void test_publish_lookup(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_cache_entry_t entry
+      = test_entry("run1", "{\"agent_run_id\":\"run1\"}");
+  nr_app_cache_entry_t found;
+
+  tlib_pass_if_not_null(__func__, cache);
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_publish(cache, &info, &entry, TEST_NOW),
+                    "publish");
+
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW + 1, &found),
+                    "lookup");
+  tlib_pass_if_str_equal(__func__, "run1", found.agent_run_id);
+  tlib_pass_if_str_equal(__func__, entry.connect_reply, found.connect_reply);
+  tlib_pass_if_size_t_equal(__func__, entry.connect_reply_len,
+                            found.connect_reply_len);
+  tlib_pass_if_str_equal(__func__, entry.security_policies,
+                         found.security_policies);
+  tlib_pass_if_size_t_equal(__func__, entry.security_policies_len,
+                            found.security_policies_len);
+  tlib_pass_if_uint64_t_equal(__func__, entry.connect_timestamp,
+                              found.connect_timestamp);
+  tlib_pass_if_uint64_t_equal(__func__, entry.harvest_frequency,
+                              found.harvest_frequency);
+  tlib_pass_if_uint_equal(__func__, 10, found.sampling_target);
+  tlib_pass_if_true(__func__, TEST_NOW == found.validated, "validated=%ld",
+                    (long)found.validated);
+  nr_app_cache_entry_deinit(&found);
+  tlib_pass_if_null(__func__, found.buffer);
+
+  /*
+   * Publishing the application again replaces its entry.
+   */
+  entry = test_entry("run2", "{\"agent_run_id\":\"run2\"}");
+  entry.security_policies = NULL;
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_publish(cache, &info, &entry, TEST_NOW + 2),
+                    "republish");
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW + 2, &found),
+                    "lookup");
+  tlib_pass_if_str_equal(__func__, "run2", found.agent_run_id);
+  tlib_pass_if_str_equal(__func__, "", found.security_policies);
+  tlib_pass_if_size_t_equal(__func__, 0, found.security_policies_len);
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_key(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_info_t other;
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+
+  nr_app_cache_publish(cache, &info, &entry, TEST_NOW);
+
+  other = test_info("license", "other app");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                     "different appname");
+
+  other = test_info("other license", "app");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                     "different license");
+
+  other = test_info("license", "app");
+  other.high_security = 1;
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                     "different high security");
+
+  other = test_info("license", "app");
+  other.security_policies_token = "token";
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                     "different security policies token");
+
+  other = test_info("license", "app");
+  other.trace_observer_host = "trace-observer";
+  other.trace_observer_port = 443;
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                     "different trace observer");
+
+  /*
+   * Settings that are not part of the key are ignored.
+   */
+  other = test_info("license", "app");
+  other.host_display_name = "host";
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &other, TEST_NOW, &found),
+                    "same key");
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_full(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+  nr_app_info_t info;
+  char* appname;
+  int i;
+
+  /*
+   * Each application is confirmed one second after the previous one, so the
+   * first is replaced once the cache is full.
+   */
+  for (i = 0; i <= NR_APP_CACHE_SLOTS; i++) {
+    appname = nr_formatf("app %d", i);
+    info = test_info("license", appname);
+    tlib_pass_if_true(__func__,
+                      nr_app_cache_publish(cache, &info, &entry, TEST_NOW + i),
+                      "i=%d", i);
+    nr_free(appname);
+  }
+
+  info = test_info("license", "app 0");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, TEST_NOW + i, &found),
+                     "oldest application replaced");
+
+  for (i = 1; i <= NR_APP_CACHE_SLOTS; i++) {
+    appname = nr_formatf("app %d", i);
+    info = test_info("license", appname);
+    tlib_pass_if_true(__func__,
+                      nr_app_cache_lookup(cache, &info, TEST_NOW + i, &found),
+                      "i=%d", i);
+    nr_app_cache_entry_deinit(&found);
+    nr_free(appname);
+  }
+
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_too_large(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+  char* connect_reply;
+
+  connect_reply = (char*)nr_malloc(NR_APP_CACHE_SLOT_DATA_SIZE + 1);
+  nr_memset(connect_reply, ' ', NR_APP_CACHE_SLOT_DATA_SIZE);
+  connect_reply[NR_APP_CACHE_SLOT_DATA_SIZE] = '\0';
+  entry.connect_reply = connect_reply;
+  entry.connect_reply_len = NR_APP_CACHE_SLOT_DATA_SIZE;
+
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_publish(cache, &info, &entry, TEST_NOW),
+                     "too large");
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, TEST_NOW, &found),
+                     "not cached");
+
+  nr_free(connect_reply);
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_staleness(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+  time_t stale = TEST_NOW + NR_APP_CACHE_MAX_AGE_SECONDS + 1;
+
+  nr_app_cache_publish(cache, &info, &entry, TEST_NOW);
+
+  tlib_pass_if_true(
+      __func__,
+      nr_app_cache_lookup(cache, &info,
+                          TEST_NOW + NR_APP_CACHE_MAX_AGE_SECONDS, &found),
+      "fresh");
+  nr_app_cache_entry_deinit(&found);
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, stale, &found),
+                     "stale");
+
+  /*
+   * Confirming a different agent run ID doesn't refresh the entry.
+   */
+  nr_app_cache_validate(cache, &info, "other run", stale);
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, stale, &found),
+                     "different run");
+
+  nr_app_cache_validate(cache, &info, "run", stale);
+  tlib_pass_if_true(__func__, nr_app_cache_lookup(cache, &info, stale, &found),
+                    "validated");
+  tlib_pass_if_true(__func__, stale == found.validated, "validated=%ld",
+                    (long)found.validated);
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_invalidate(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_info_t other = test_info("license", "other app");
+  nr_app_cache_entry_t entry = test_entry("run", "{}");
+  nr_app_cache_entry_t found;
+
+  nr_app_cache_publish(cache, &info, &entry, TEST_NOW);
+  nr_app_cache_publish(cache, &other, &entry, TEST_NOW);
+
+  /*
+   * An entry confirmed at or after the query was made is kept.
+   */
+  nr_app_cache_invalidate(cache, &info, TEST_NOW);
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW, &found),
+                    "confirmed during the query");
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_invalidate(cache, &info, TEST_NOW + 1);
+  tlib_pass_if_false(__func__,
+                     nr_app_cache_lookup(cache, &info, TEST_NOW + 1, &found),
+                     "invalidated");
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &other, TEST_NOW + 1, &found),
+                    "other application kept");
+  nr_app_cache_entry_deinit(&found);
+
+  /*
+   * The daemon confirming the agent run ID again revives the entry.
+   */
+  nr_app_cache_validate(cache, &info, "run", TEST_NOW + 2);
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW + 2, &found),
+                    "validated");
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+static void test_fork(void) {
+  nr_app_cache_t* cache = nr_app_cache_create();
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_cache_entry_t entry = test_entry("child run", "{}");
+  nr_app_cache_entry_t found;
+  pid_t pid;
+  int status = 0;
+
+  pid = fork();
+  if (0 == pid) {
+    _exit(nr_app_cache_publish(cache, &info, &entry, TEST_NOW) ? 0 : 1);
+  }
+  tlib_pass_if_true(__func__, pid > 0, "pid=%d", (int)pid);
+  if (pid <= 0) {
+    nr_app_cache_destroy(&cache);
+    return;
+  }
+
+  waitpid(pid, &status, 0);
+  tlib_pass_if_true(__func__, WIFEXITED(status) && (0 == WEXITSTATUS(status)),
+                    "status=%d", status);
+
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW, &found),
+                    "published by the child");
+  tlib_pass_if_str_equal(__func__, "child run", found.agent_run_id);
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+/*
+ * Test that entries published by a process running as another user are not
+ * used, so that PHP-FPM pools running as different users do not adopt each
+ * other's connect replies.
+ */
+static void test_other_user(void) {
+  nr_app_cache_t* cache;
+  nr_app_info_t info = test_info("license", "app");
+  nr_app_cache_entry_t entry = test_entry("other run", "{}");
+  nr_app_cache_entry_t found;
+  pid_t pid;
+  int status = 0;
+
+  if (0 != geteuid()) {
+    /* Switching users needs root. */
+    return;
+  }
+
+  cache = nr_app_cache_create();
+  entry.agent_run_id = "root run";
+  nr_app_cache_publish(cache, &info, &entry, TEST_NOW);
+
+  pid = fork();
+  if (0 == pid) {
+    bool found_root;
+
+    if (0 != seteuid(65534)) {
+      _exit(2);
+    }
+    found_root = nr_app_cache_lookup(cache, &info, TEST_NOW, &found);
+    entry.agent_run_id = "other run";
+    if (found_root || !nr_app_cache_publish(cache, &info, &entry, TEST_NOW)) {
+      _exit(1);
+    }
+    _exit(0);
+  }
+  tlib_pass_if_true(__func__, pid > 0, "pid=%d", (int)pid);
+  if (pid <= 0) {
+    nr_app_cache_destroy(&cache);
+    return;
+  }
+
+  waitpid(pid, &status, 0);
+  tlib_pass_if_true(__func__, WIFEXITED(status) && (0 == WEXITSTATUS(status)),
+                    "status=%d", status);
+
+  tlib_pass_if_true(__func__,
+                    nr_app_cache_lookup(cache, &info, TEST_NOW, &found),
+                    "published by this user");
+  tlib_pass_if_str_equal(__func__, "root run", found.agent_run_id);
+  nr_app_cache_entry_deinit(&found);
+
+  nr_app_cache_destroy(&cache);
+}
+
+/*
+ * The tests fork and use nr_agent_app_cache, so they must not run in
+ * parallel.
+ */
+tlib_parallel_info_t parallel_info
+    = {.suggested_nthreads = -1, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_bad_params();
+  test_publish_lookup();
+  test_key();
+  test_full();
+  test_too_large();
+  test_staleness();
+  test_invalidate();
+  test_fork();
+  test_other_user();
+  test_appinfo();
+}
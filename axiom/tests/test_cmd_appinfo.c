@@ -68,6 +68,10 @@ static void test_create_empty_query(void) {
   tlib_pass_if_uint64_t_equal(
       __func__, 0, nr_flatbuffers_table_read_u64(&app, APP_SPAN_QUEUE_SIZE, 0));
 
+  tlib_pass_if_uint16_t_equal(
+      __func__, 0,
+      nr_flatbuffers_table_read_u16(&app, APP_SPAN_STREAM_COUNT, 0));
+
   tlib_pass_if_uint64_t_equal(__func__, 0,
                               nr_flatbuffers_table_read_u64(
                                   &app, APP_SPAN_EVENTS_MAX_SAMPLES_STORED, 0));
@@ -106,6 +110,7 @@ static void test_create_query(void) {
   info.trace_observer_host = nr_strdup("my_trace_observer");
   info.trace_observer_port = 443;
   info.span_queue_size = 10000;
+  info.span_stream_count = 4;
   info.span_events_max_samples_stored = 1234;
   info.log_events_max_samples_stored = 2345;
   info.custom_events_max_samples_stored = 345;
@@ -161,6 +166,9 @@ static void test_create_query(void) {
   tlib_pass_if_uint64_t_equal(
       __func__, info.span_queue_size,
       nr_flatbuffers_table_read_u16(&app, APP_SPAN_QUEUE_SIZE, 0));
+  tlib_pass_if_uint16_t_equal(
+      __func__, info.span_stream_count,
+      nr_flatbuffers_table_read_u16(&app, APP_SPAN_STREAM_COUNT, 0));
   tlib_pass_if_uint64_t_equal(__func__, info.span_events_max_samples_stored,
                               nr_flatbuffers_table_read_u16(
                                   &app, APP_SPAN_EVENTS_MAX_SAMPLES_STORED, 0));
@@ -683,9 +691,13 @@ static void test_process_connected_app(void) {
 
   /*
    * Perform same test again to make sure that populated fields are freed
-   * before assignment.
+   * before assignment. Names cached under the previous rules must be
+   * forgotten.
    */
   app.state = NR_APP_UNKNOWN;
+  app.txn_name_cache = nr_txn_name_cache_create(4);
+  nr_txn_name_cache_set(app.txn_name_cache, "1:0:p/a", 7, "b",
+                        "WebTransaction/Uri/b", false);
   st = nr_cmd_appinfo_process_reply(nr_flatbuffers_data(reply),
                                     nr_flatbuffers_len(reply), &app);
   tlib_pass_if_status_success(__func__, st);
@@ -695,6 +707,8 @@ static void test_process_connected_app(void) {
   tlib_pass_if_not_null(__func__, app.url_rules);
   tlib_pass_if_not_null(__func__, app.txn_rules);
   tlib_pass_if_not_null(__func__, app.segment_terms);
+  tlib_pass_if_size_t_equal(__func__, 0,
+                            nr_txn_name_cache_size(app.txn_name_cache));
 
   nr_free(app.agent_run_id);
   nr_free(app.entity_guid);
@@ -702,6 +716,7 @@ static void test_process_connected_app(void) {
   nr_rules_destroy(&app.url_rules);
   nr_rules_destroy(&app.txn_rules);
   nr_segment_terms_destroy(&app.segment_terms);
+  nr_txn_name_cache_destroy(&app.txn_name_cache);
   nr_flatbuffers_destroy(&reply);
 }
 
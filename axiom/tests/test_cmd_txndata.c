@@ -4,6 +4,7 @@
  */
 
 #include "cmd_txndata_transmit.c"
+#include "cmd_txndata_batch_transmit.c"
 #include "nr_axiom.h"
 #include "nr_agent.h"
 #include "nr_analytics_events.h"
@@ -40,9 +41,14 @@
 /* This is defined only to satisfy link requirements, and is not shared amongst
  * threads. */
 nrapplist_t* nr_agent_applist = 0;
+nr_app_cache_t* nr_agent_app_cache = NULL;
 
 void nr_agent_close_daemon_connection(void) {}
 
+nr_metric_names_t* nr_agent_get_metric_names(void) {
+  return NULL;
+}
+
 nr_status_t nr_agent_lock_daemon_mutex(void) {
   return NR_SUCCESS;
 }
@@ -55,6 +61,8 @@ int nr_get_daemon_fd(void) {
   return 0;
 }
 
+void nr_agent_set_txn_batch_size(uint32_t size NRUNUSED) {}
+
 static void test_encode_errors(void) {
   nrtxn_t txn;
   nr_flatbuffers_table_t tbl;
@@ -1173,13 +1181,155 @@ done:
   nr_txn_destroy_fields(&txn);
 }
 
+/*
+ * Reads the PHP packages JSON from an encoded transaction, or returns NULL if
+ * the transaction has no PHP packages.
+ */
+static char* test_encode_read_php_packages(const nrtxn_t* txn) {
+  nr_flatbuffers_table_t tbl;
+  nr_flatbuffer_t* fb;
+  char* json = NULL;
+
+  fb = nr_txndata_encode(txn);
+  nr_flatbuffers_table_init_root(&tbl, nr_flatbuffers_data(fb),
+                                 nr_flatbuffers_len(fb));
+  if (nr_flatbuffers_table_read_union(&tbl, &tbl, MESSAGE_FIELD_DATA)
+      && nr_flatbuffers_table_read_union(&tbl, &tbl,
+                                         TRANSACTION_FIELD_PHP_PACKAGES)) {
+    json = nr_strndup(
+        (const char*)nr_flatbuffers_table_read_bytes(&tbl, EVENT_FIELD_DATA),
+        nr_flatbuffers_table_read_vector_len(&tbl, EVENT_FIELD_DATA));
+  }
+
+  nr_flatbuffers_destroy(&fb);
+  return json;
+}
+
+static void test_encode_php_packages_reported(void) {
+  nrtxn_t txn;
+  char* json;
+
+  nr_memset(&txn, 0, sizeof(txn));
+  txn.status.recording = 1;
+  txn.php_packages = nr_php_packages_create();
+  nr_txn_add_php_package_from_source(&txn, "TEST_PACKAGE_1", "1.2.3",
+                                     NR_PHP_PACKAGE_SOURCE_COMPOSER);
+
+  /*
+   * Composer packages are sent until the inventory has been reported.
+   */
+  json = test_encode_read_php_packages(&txn);
+  tlib_pass_if_str_equal(__func__, "[[\"TEST_PACKAGE_1\",\"1.2.3\",{}]]",
+                         json);
+  nr_free(json);
+
+  txn.composer_info.packages_reported = true;
+  json = test_encode_read_php_packages(&txn);
+  tlib_pass_if_null(__func__, json);
+  nr_free(json);
+
+  /*
+   * Packages from other sources are still sent.
+   */
+  nr_txn_add_php_package(&txn, "TEST_PACKAGE_2", "4.5.6");
+  json = test_encode_read_php_packages(&txn);
+  tlib_pass_if_str_equal(__func__, "[[\"TEST_PACKAGE_2\",\"4.5.6\",{}]]",
+                         json);
+  nr_free(json);
+
+  nr_txn_destroy_fields(&txn);
+}
+
+static void test_encode_metric_names_read(nr_flatbuffer_t* fb,
+                                          uint32_t i,
+                                          const char** name,
+                                          uint32_t* name_id) {
+  nr_flatbuffers_table_t tbl;
+  nr_aoffset_t metrics;
+
+  nr_flatbuffers_table_init_root(&tbl, nr_flatbuffers_data(fb),
+                                 nr_flatbuffers_len(fb));
+  nr_flatbuffers_table_read_union(&tbl, &tbl, MESSAGE_FIELD_DATA);
+  metrics = nr_flatbuffers_table_read_vector(&tbl, TRANSACTION_FIELD_METRICS);
+  metrics.offset += i * sizeof(uint32_t);
+  nr_flatbuffers_table_init(
+      &tbl, tbl.data, tbl.length,
+      nr_flatbuffers_read_indirect(tbl.data, metrics).offset);
+
+  *name = nr_flatbuffers_table_read_str(&tbl, METRIC_FIELD_NAME);
+  *name_id = nr_flatbuffers_table_read_u32(&tbl, METRIC_FIELD_NAME_ID, 0);
+}
+
+static void test_encode_metric_names(void) {
+  nrtxn_t txn;
+  nr_flatbuffer_t* fb;
+  nr_metric_names_t names = NR_METRIC_NAMES_INITIALIZER;
+  nr_vector_t defined;
+  const char* name;
+  uint32_t name_id;
+
+  nr_memset(&txn, 0, sizeof(txn));
+  txn.status.recording = 1;
+  txn.name = nr_strdup("my_txn_name");
+  txn.scoped_metrics = nrm_table_create(10);
+  txn.unscoped_metrics = nrm_table_create(10);
+  nrm_add(txn.scoped_metrics, "scoped", 1 * NR_TIME_DIVISOR);
+  nrm_add(txn.unscoped_metrics, "unscoped", 2 * NR_TIME_DIVISOR);
+  nr_vector_init(&defined, 2, NULL, NULL);
+
+  /*
+   * Test : A disabled dictionary sends names only.
+   */
+  fb = nr_txndata_encode_metric_names(&txn, &names, &defined);
+  test_encode_metric_names_read(fb, 0, &name, &name_id);
+  tlib_pass_if_str_equal("disabled name", "scoped", name);
+  tlib_pass_if_uint32_t_equal("disabled id", 0, name_id);
+  tlib_pass_if_size_t_equal("disabled defined", 0, nr_vector_size(&defined));
+  nr_flatbuffers_destroy(&fb);
+
+  /*
+   * Test : The first message defines ids, up to the daemon's capacity.
+   */
+  nr_metric_names_enable(&names, 1);
+  fb = nr_txndata_encode_metric_names(&txn, &names, &defined);
+  test_encode_metric_names_read(fb, 0, &name, &name_id);
+  tlib_pass_if_str_equal("defining name", "scoped", name);
+  tlib_pass_if_uint32_t_equal("defining id", 0, name_id);
+  test_encode_metric_names_read(fb, 1, &name, &name_id);
+  tlib_pass_if_str_equal("defining name", "unscoped", name);
+  tlib_pass_if_uint32_t_equal("defining id", 1, name_id);
+  tlib_pass_if_size_t_equal("defined", 1, nr_vector_size(&defined));
+  nr_flatbuffers_destroy(&fb);
+
+  /*
+   * Test : Once committed, known names are sent by id alone.
+   */
+  nr_metric_names_commit(&names, &defined);
+  nr_vector_deinit(&defined);
+  nr_vector_init(&defined, 2, NULL, NULL);
+
+  fb = nr_txndata_encode_metric_names(&txn, &names, &defined);
+  test_encode_metric_names_read(fb, 0, &name, &name_id);
+  tlib_pass_if_str_equal("full dictionary name", "scoped", name);
+  tlib_pass_if_uint32_t_equal("full dictionary id", 0, name_id);
+  test_encode_metric_names_read(fb, 1, &name, &name_id);
+  tlib_pass_if_null("referenced name", name);
+  tlib_pass_if_uint32_t_equal("referenced id", 1, name_id);
+  tlib_pass_if_size_t_equal("nothing defined", 0, nr_vector_size(&defined));
+  nr_flatbuffers_destroy(&fb);
+
+  nr_vector_deinit(&defined);
+  nr_metric_names_reset(&names);
+  nr_txn_destroy_fields(&txn);
+}
+
 static void test_bad_daemon_fd(void) {
   nrtxn_t txn;
   nr_status_t st;
 
   nr_memset(&txn, 0, sizeof(txn));
 
-  st = nr_cmd_txndata_tx(-1, &txn);
+  st = nr_cmd_txndata_tx(-1, &txn, NULL, NULL);
   tlib_pass_if_status_failure(__func__, st);
 }
 
@@ -1188,7 +1338,7 @@ static void test_null_txn(void) {
   nr_status_t st;
 
   nbsockpair(socks);
-  st = nr_cmd_txndata_tx(socks[0], NULL);
+  st = nr_cmd_txndata_tx(socks[0], NULL, NULL, NULL);
   tlib_pass_if_status_failure(__func__, st);
 
   nr_close(socks[0]);
@@ -1202,19 +1352,26 @@ static void test_empty_txn(void) {
   nr_flatbuffers_table_t tbl;
   nr_status_t st;
   nr_aoffset_t absolute;
+  nr_overhead_t overhead;
 
   nbsockpair(socks);
   nr_memset(&txn, 0, sizeof(txn));
+  nr_overhead_reset(&overhead);
 
   /*
    * Don't blow up!
    */
-  st = nr_cmd_txndata_tx(socks[0], &txn);
+  st = nr_cmd_txndata_tx(socks[0], &txn, NULL, &overhead);
   if (0 != tlib_pass_if_status_success(__func__, st)) {
     /* send failed, cannot continue */
     goto done;
   }
 
+  tlib_pass_if_uint64_t_equal(
+      __func__, 1, overhead.timers[NR_OVERHEAD_TXNDATA_ENCODE].count);
+  tlib_pass_if_uint64_t_equal(__func__, 1,
+                              overhead.timers[NR_OVERHEAD_TXNDATA_TX].count);
+
   buf = nr_network_receive(socks[1], 100 /* msecs */);
   if (0 != tlib_pass_if_true(__func__, NULL != buf, "buf=%p", buf)) {
     /* receive failure, cannot continue */
@@ -1268,12 +1425,367 @@ done:
   nr_close(socks[1]);
 }
 
+static void test_batch_txn_init(nrtxn_t* txn,
+                                const char* agent_run_id,
+                                const char* name) {
+  nr_memset(txn, 0, sizeof(*txn));
+  txn->status.recording = 1;
+  txn->agent_run_id = nr_strdup(agent_run_id);
+  txn->name = nr_strdup(name);
+  txn->scoped_metrics = nrm_table_create(10);
+  txn->unscoped_metrics = nrm_table_create(10);
+  nrm_add(txn->scoped_metrics, "Datastore/statement/MySQL/users/select",
+          1 * NR_TIME_DIVISOR);
+  nrm_add(txn->unscoped_metrics, "Datastore/all", 2 * NR_TIME_DIVISOR);
+}
+
+static void test_encoder_send(nr_txndata_encoder_t* encoder,
+                              const nrtxn_t* txn,
+                              int socks[2]) {
+  nr_flatbuffer_t* expected = nr_txndata_encode(txn);
+  nrbuf_t* buf;
+  nr_status_t st;
+
+  st = nr_cmd_txndata_tx(socks[0], txn, encoder, NULL);
+  tlib_pass_if_status_success(__func__, st);
+
+  buf = nr_network_receive(socks[1], 100 /* msecs */);
+  tlib_pass_if_true(__func__, NULL != buf, "buf=%p", buf);
+  tlib_pass_if_bytes_equal(__func__, nr_flatbuffers_data(expected),
+                           nr_flatbuffers_len(expected),
+                           (const uint8_t*)nr_buffer_cptr(buf),
+                           nr_buffer_len(buf));
+
+  nr_buffer_destroy(&buf);
+  nr_flatbuffers_destroy(&expected);
+}
+
+static void test_encoder(void) {
+  nr_txndata_encoder_t* encoder;
+  nr_txndata_encoder_stats_t stats;
+  nrtxn_t small;
+  nrtxn_t large;
+  char* large_name;
+  size_t large_capacity;
+  int socks[2];
+  int i;
+
+  /*
+   * Test : Bad parameters.
+   */
+  encoder = nr_txndata_encoder_create();
+  tlib_pass_if_false("NULL encoder",
+                     nr_txndata_encoder_take_stats(NULL, &stats),
+                     "expected false");
+  tlib_pass_if_false("NULL stats", nr_txndata_encoder_take_stats(encoder, NULL),
+                     "expected false");
+  nr_txndata_encoder_destroy(NULL);
+
+  nbsockpair(socks);
+  test_batch_txn_init(&small, "run", "small");
+  large_name = (char*)nr_malloc(100 * 1024);
+  nr_memset(large_name, 'x', 100 * 1024 - 1);
+  large_name[100 * 1024 - 1] = '\0';
+  test_batch_txn_init(&large, "run", large_name);
+  nr_free(large_name);
+
+  /*
+   * Test : Messages encoded with a reused buffer are identical to messages
+   *        encoded with a new one, and small messages never reallocate.
+   */
+  for (i = 0; i < 3; i++) {
+    test_encoder_send(encoder, &small, socks);
+  }
+  tlib_pass_if_true("stats", nr_txndata_encoder_take_stats(encoder, &stats),
+                    "expected true");
+  tlib_pass_if_uint64_t_equal("small messages", 3, stats.messages);
+  tlib_pass_if_uint64_t_equal("small reallocs", 0, stats.reallocs);
+  tlib_pass_if_size_t_equal("small capacity", 16 * 1024, stats.capacity);
+
+  nr_txndata_encoder_take_stats(encoder, &stats);
+  tlib_pass_if_uint64_t_equal("stats are reset", 0, stats.messages);
+
+  /*
+   * Test : A large message grows the buffer once, after which messages of the
+   *        same size don't reallocate.
+   */
+  test_encoder_send(encoder, &large, socks);
+  nr_txndata_encoder_take_stats(encoder, &stats);
+  tlib_fail_if_uint64_t_equal("large reallocs", 0, stats.reallocs);
+  large_capacity = stats.capacity;
+
+  test_encoder_send(encoder, &large, socks);
+  nr_txndata_encoder_take_stats(encoder, &stats);
+  tlib_pass_if_uint64_t_equal("repeated large reallocs", 0, stats.reallocs);
+  tlib_pass_if_size_t_equal("repeated large capacity", large_capacity,
+                            stats.capacity);
+
+  /*
+   * Test : Once only small messages are sent, the large buffer is given back.
+   */
+  for (i = 0; i < 20; i++) {
+    test_encoder_send(encoder, &small, socks);
+  }
+  nr_txndata_encoder_take_stats(encoder, &stats);
+  tlib_pass_if_true("capacity decays", stats.capacity < large_capacity,
+                    "capacity=%zu large_capacity=%zu", stats.capacity,
+                    large_capacity);
+  tlib_pass_if_uint64_t_equal("decayed reallocs", 0, stats.reallocs);
+
+  nr_txn_destroy_fields(&small);
+  nr_txn_destroy_fields(&large);
+  nr_close(socks[0]);
+  nr_close(socks[1]);
+  nr_txndata_encoder_destroy(&encoder);
+  tlib_pass_if_null("destroyed encoder", encoder);
+}
+
+static void test_batch_read_group(const nr_flatbuffers_table_t* batch,
+                                  uint32_t i,
+                                  nr_flatbuffers_table_t* group) {
+  nr_aoffset_t groups;
+
+  groups = nr_flatbuffers_table_read_vector(batch, TXN_BATCH_FIELD_METRICS);
+  groups.offset += i * sizeof(uint32_t);
+  nr_flatbuffers_table_init(
+      group, batch->data, batch->length,
+      nr_flatbuffers_read_indirect(batch->data, groups).offset);
+}
+
+static void test_batch_add(void) {
+  nr_txndata_batch_t* batch;
+  nrtxn_t txns[NR_TXNDATA_BATCH_MAX_SCOPES + 2];
+  char name[32];
+  int i;
+
+  for (i = 0; i < NR_TXNDATA_BATCH_MAX_SCOPES + 2; i++) {
+    snprintf(name, sizeof(name), "txn%d", i);
+    test_batch_txn_init(&txns[i], "run", name);
+  }
+  nr_free(txns[1].agent_run_id);
+  txns[1].agent_run_id = nr_strdup("other");
+
+  /*
+   * Test : Bad parameters.
+   */
+  tlib_pass_if_false("NULL batch", nr_txndata_batch_add(NULL, &txns[0], 0),
+                     "expected false");
+  tlib_pass_if_size_t_equal("NULL batch", 0, nr_txndata_batch_count(NULL));
+  tlib_pass_if_false("NULL batch", nr_txndata_batch_should_send(NULL, 1, 0),
+                     "expected false");
+  nr_txndata_batch_destroy(NULL);
+
+  batch = nr_txndata_batch_create(10 * NR_TIME_DIVISOR);
+  tlib_pass_if_false("NULL txn", nr_txndata_batch_add(batch, NULL, 0),
+                     "expected false");
+  tlib_pass_if_false("empty batch",
+                     nr_txndata_batch_should_send(batch, 1, 0),
+                     "expected false");
+
+  /*
+   * Test : Transactions from one agent run share a batch.
+   */
+  tlib_pass_if_true("add", nr_txndata_batch_add(batch, &txns[0], 0),
+                    "expected true");
+  tlib_pass_if_true("add same name", nr_txndata_batch_add(batch, &txns[0], 0),
+                    "expected true");
+  tlib_pass_if_size_t_equal("count", 2, nr_txndata_batch_count(batch));
+  tlib_pass_if_false("other run", nr_txndata_batch_add(batch, &txns[1], 0),
+                     "expected false");
+  tlib_pass_if_size_t_equal("count", 2, nr_txndata_batch_count(batch));
+
+  /*
+   * Test : The batch is sent when full or old enough.
+   */
+  tlib_pass_if_false("not due", nr_txndata_batch_should_send(batch, 3, 0),
+                     "expected false");
+  tlib_pass_if_true("count reached", nr_txndata_batch_should_send(batch, 2, 0),
+                    "expected true");
+  tlib_pass_if_true(
+      "age reached",
+      nr_txndata_batch_should_send(batch, 3, 10 * NR_TIME_DIVISOR),
+      "expected true");
+
+  /*
+   * Test : The number of distinct transaction names is capped.
+   */
+  for (i = 2; i < NR_TXNDATA_BATCH_MAX_SCOPES + 1; i++) {
+    tlib_pass_if_true("add scope", nr_txndata_batch_add(batch, &txns[i], 0),
+                      "i=%d", i);
+  }
+  tlib_pass_if_false("too many scopes",
+                     nr_txndata_batch_add(batch, &txns[i], 0), "i=%d", i);
+  tlib_pass_if_true("scopes full", nr_txndata_batch_should_send(batch, 100, 0),
+                    "expected true");
+
+  /*
+   * Test : A reset batch accepts any agent run.
+   */
+  nr_txndata_batch_reset(batch);
+  tlib_pass_if_size_t_equal("reset", 0, nr_txndata_batch_count(batch));
+  tlib_pass_if_true("other run", nr_txndata_batch_add(batch, &txns[1], 0),
+                    "expected true");
+
+  nr_txndata_batch_destroy(&batch);
+  tlib_pass_if_null("destroyed", batch);
+
+  for (i = 0; i < NR_TXNDATA_BATCH_MAX_SCOPES + 2; i++) {
+    nr_txn_destroy_fields(&txns[i]);
+  }
+}
+
+static void test_batch_encode(void) {
+  nr_txndata_batch_t* batch;
+  nrtxn_t a;
+  nrtxn_t b;
+  nr_flatbuffer_t* fb;
+  nr_flatbuffers_table_t msg;
+  nr_flatbuffers_table_t tbl;
+  nr_flatbuffers_table_t group;
+  nr_vector_t defined;
+  const nrmetric_t* metric;
+
+  batch = nr_txndata_batch_create(NR_TIME_DIVISOR);
+  tlib_pass_if_null("empty batch", nr_txndata_batch_encode(batch, NULL, NULL));
+
+  test_batch_txn_init(&a, "run", "txn_a");
+  test_batch_txn_init(&b, "run", "txn_b");
+  nr_txndata_batch_add(batch, &a, 0);
+  nr_txndata_batch_add(batch, &b, 0);
+  nr_txndata_batch_add(batch, &a, 0);
+
+  nr_vector_init(&defined, 2, NULL, NULL);
+  fb = nr_txndata_batch_encode(batch, NULL, &defined);
+  tlib_pass_if_not_null("encoded", fb);
+  tlib_pass_if_size_t_equal("batch emptied", 0, nr_txndata_batch_count(batch));
+  tlib_pass_if_size_t_equal("no dictionary", 0, nr_vector_size(&defined));
+
+  nr_flatbuffers_table_init_root(&msg, nr_flatbuffers_data(fb),
+                                 nr_flatbuffers_len(fb));
+  tlib_pass_if_int_equal("message type", MESSAGE_BODY_TXN_BATCH,
+                         nr_flatbuffers_table_read_i8(
+                             &msg, MESSAGE_FIELD_DATA_TYPE, MESSAGE_BODY_NONE));
+  tlib_pass_if_str_equal(
+      "agent run id", "run",
+      (const char*)nr_flatbuffers_table_read_bytes(&msg,
+                                                   MESSAGE_FIELD_AGENT_RUN_ID));
+
+  nr_flatbuffers_table_read_union(&tbl, &msg, MESSAGE_FIELD_DATA);
+  tlib_pass_if_uint32_t_equal(
+      "transactions", 3,
+      nr_flatbuffers_table_read_vector_len(&tbl, TXN_BATCH_FIELD_TRANSACTIONS));
+  tlib_pass_if_uint32_t_equal(
+      "metric groups", 3,
+      nr_flatbuffers_table_read_vector_len(&tbl, TXN_BATCH_FIELD_METRICS));
+
+  /*
+   * Test : Unscoped metrics are aggregated across the batch.
+   */
+  test_batch_read_group(&tbl, 0, &group);
+  tlib_pass_if_null("unscoped",
+                    nr_flatbuffers_table_read_bytes(&group,
+                                                    METRIC_GROUP_FIELD_SCOPE));
+  tlib_pass_if_uint32_t_equal(
+      "unscoped metrics", 1,
+      nr_flatbuffers_table_read_vector_len(&group, METRIC_GROUP_FIELD_METRICS));
+  metric = nrm_find(a.unscoped_metrics, "Datastore/all");
+  tlib_pass_if_uint64_t_equal("txn unchanged", 1, nrm_count(metric));
+
+  /*
+   * Test : Scoped metrics are aggregated per transaction name.
+   */
+  test_batch_read_group(&tbl, 1, &group);
+  tlib_pass_if_str_equal(
+      "scope", "txn_a",
+      (const char*)nr_flatbuffers_table_read_bytes(&group,
+                                                   METRIC_GROUP_FIELD_SCOPE));
+  test_batch_read_group(&tbl, 2, &group);
+  tlib_pass_if_str_equal(
+      "scope", "txn_b",
+      (const char*)nr_flatbuffers_table_read_bytes(&group,
+                                                   METRIC_GROUP_FIELD_SCOPE));
+
+  nr_flatbuffers_destroy(&fb);
+  nr_vector_deinit(&defined);
+  nr_txndata_batch_destroy(&batch);
+  nr_txn_destroy_fields(&a);
+  nr_txn_destroy_fields(&b);
+}
+
+static void test_batch_tx(void) {
+  nr_txndata_batch_t* batch;
+  nrtxn_t txn;
+  int socks[2];
+  nrbuf_t* buf = NULL;
+  nr_flatbuffers_table_t tbl;
+  nr_overhead_t overhead;
+  nr_status_t st;
+
+  batch = nr_txndata_batch_create(NR_TIME_DIVISOR);
+  test_batch_txn_init(&txn, "run", "txn");
+  nr_overhead_reset(&overhead);
+  nbsockpair(socks);
+
+  /*
+   * Test : An empty batch sends nothing.
+   */
+  st = nr_cmd_txndata_batch_tx(socks[0], batch, &overhead);
+  tlib_pass_if_status_success("empty batch", st);
+  tlib_pass_if_uint64_t_equal(
+      "empty batch", 0, overhead.timers[NR_OVERHEAD_TXNDATA_TX].count);
+
+  /*
+   * Test : A bad daemon fd discards the batch.
+   */
+  nr_txndata_batch_add(batch, &txn, 0);
+  st = nr_cmd_txndata_batch_tx(-1, batch, NULL);
+  tlib_pass_if_status_failure("bad daemon fd", st);
+  tlib_pass_if_size_t_equal("bad daemon fd", 0,
+                            nr_txndata_batch_count(batch));
+
+  /*
+   * Test : Normal operation.
+   */
+  nr_txndata_batch_add(batch, &txn, 0);
+  nr_txndata_batch_add(batch, &txn, 0);
+  st = nr_cmd_txndata_batch_tx(socks[0], batch, &overhead);
+  if (0 != tlib_pass_if_status_success("send", st)) {
+    goto done;
+  }
+  tlib_pass_if_size_t_equal("sent", 0, nr_txndata_batch_count(batch));
+  tlib_pass_if_uint64_t_equal("overhead", 1,
+                              overhead.timers[NR_OVERHEAD_TXNDATA_TX].count);
+
+  buf = nr_network_receive(socks[1], 100 /* msecs */);
+  if (0 != tlib_pass_if_true("receive", NULL != buf, "buf=%p", buf)) {
+    goto done;
+  }
+
+  nr_flatbuffers_table_init_root(&tbl, (const uint8_t*)nr_buffer_cptr(buf),
+                                 nr_buffer_len(buf));
+  tlib_pass_if_int_equal("message type", MESSAGE_BODY_TXN_BATCH,
+                         nr_flatbuffers_table_read_i8(
+                             &tbl, MESSAGE_FIELD_DATA_TYPE, MESSAGE_BODY_NONE));
+  nr_flatbuffers_table_read_union(&tbl, &tbl, MESSAGE_FIELD_DATA);
+  tlib_pass_if_uint32_t_equal(
+      "transactions", 2,
+      nr_flatbuffers_table_read_vector_len(&tbl, TXN_BATCH_FIELD_TRANSACTIONS));
+
+done:
+  nr_buffer_destroy(&buf);
+  nr_close(socks[0]);
+  nr_close(socks[1]);
+  nr_txndata_batch_destroy(&batch);
+  nr_txn_destroy_fields(&txn);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 4, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
   test_encode_custom_events();
   test_encode_errors();
   test_encode_metrics();
+  test_encode_metric_names();
   test_encode_error_events();
   test_encode_slowsqls();
   test_encode_span_events();
@@ -1281,8 +1793,14 @@ void test_main(void* p NRUNUSED) {
   test_encode_txn_event();
   test_encode_log_events();
   test_encode_php_packages();
+  test_encode_php_packages_reported();
 
   test_bad_daemon_fd();
   test_null_txn();
   test_empty_txn();
+  test_encoder();
+
+  test_batch_add();
+  test_batch_encode();
+  test_batch_tx();
 }
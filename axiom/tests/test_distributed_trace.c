@@ -9,6 +9,7 @@
 #include "nr_txn.h"
 #include "nr_distributed_trace_private.h"
 #include "util_memory.h"
+#include "util_text.h"
 #include <locale.h>
 
 static void test_distributed_trace_create_destroy(void) {
@@ -813,6 +814,218 @@ static void test_distributed_trace_payload_accept_inbound_payload(void) {
   nro_delete(obj_payload);
 }
 
+static void test_distributed_trace_parse_inbound_payload(void) {
+  nr_distributed_trace_inbound_payload_t inbound;
+  nr_distributed_trace_t* dt;
+  const char* error = NULL;
+
+  /*
+   * Test : Bad parameters
+   */
+  tlib_pass_if_false(
+      "NULL payload",
+      nr_distributed_trace_parse_inbound_payload(NULL, &inbound, &error),
+      "Expected false");
+  tlib_pass_if_str_equal(
+      "NULL payload",
+      "Supportability/DistributedTrace/AcceptPayload/Ignored/Null", error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+
+  error = "ZipZap";
+  tlib_pass_if_false(
+      "Non-null error",
+      nr_distributed_trace_parse_inbound_payload("{}", &inbound, &error),
+      "Expected false");
+  tlib_pass_if_str_equal("Non-null error", "ZipZap", error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+  error = NULL;
+
+  tlib_pass_if_false(
+      "Trailing data",
+      nr_distributed_trace_parse_inbound_payload(
+          "{\"v\":[0,1],\"d\":{\"ty\":\"App\",\"ac\":\"9123\",\"ap\":\"51424\","
+          "\"id\":\"5f474d64b9cc9b2a\",\"tr\":\"3221bf09aa0bcf0d\","
+          "\"ti\":1482959525577}} x",
+          &inbound, &error),
+      "Expected false");
+  tlib_pass_if_str_equal(
+      "Trailing data",
+      "Supportability/DistributedTrace/AcceptPayload/ParseException", error);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+  error = NULL;
+
+  /*
+   * Test : Fields are decoded, typed and unknown fields are skipped
+   */
+  tlib_pass_if_true(
+      "Valid payload",
+      nr_distributed_trace_parse_inbound_payload(
+          "{\"v\":[0,1,{\"future\":true}],\"x\":[1,{}],"
+          "\"d\":{\"ty\":\"App\",\"ac\":\"9123\",\"ap\":\"514\\u00324\","
+          "\"id\":\"5f474d64b9cc9b2a\",\"tx\":\"6789\","
+          "\"tr\":\"3221bf09aa0bcf0d\",\"tk\":\"1010\",\"pr\":0.1234,"
+          "\"sa\":true,\"ti\":1482959525577,\"unknown\":{\"a\":[]}}}",
+          &inbound, &error),
+      "error=%s", NRSAFESTR(error));
+  tlib_pass_if_null("Valid payload error", error);
+  tlib_pass_if_str_equal("Type", "App", inbound.type);
+  tlib_pass_if_str_equal("Account ID", "9123", inbound.account_id);
+  tlib_pass_if_str_equal("Application ID", "51424", inbound.app_id);
+  tlib_pass_if_str_equal("Guid", "5f474d64b9cc9b2a", inbound.guid);
+  tlib_pass_if_str_equal("Transaction ID", "6789", inbound.txn_id);
+  tlib_pass_if_str_equal("Trace ID", "3221bf09aa0bcf0d", inbound.trace_id);
+  tlib_pass_if_str_equal("Trusted key", "1010", inbound.trusted_key);
+  tlib_pass_if_true("Priority", inbound.has_priority, "has_priority=%d",
+                    inbound.has_priority);
+  tlib_pass_if_true("Sampled", inbound.has_sampled && inbound.sampled,
+                    "has_sampled=%d sampled=%d", inbound.has_sampled,
+                    inbound.sampled);
+  tlib_pass_if_true("Timestamp", 1482959525577 == inbound.timestamp,
+                    "timestamp=%" PRId64, inbound.timestamp);
+
+  dt = nr_distributed_trace_create();
+  tlib_pass_if_true("Accept parsed",
+                    nr_distributed_trace_accept_parsed_inbound_payload(
+                        dt, &inbound, "HTTP", &error),
+                    "error=%s", NRSAFESTR(error));
+  tlib_pass_if_null("Accept parsed error", error);
+  tlib_pass_if_null("Fields are moved", inbound.type);
+  tlib_pass_if_str_equal("Accepted type", "App",
+                         nr_distributed_trace_inbound_get_type(dt));
+  tlib_pass_if_str_equal("Accepted trace ID", "3221bf09aa0bcf0d",
+                         nr_distributed_trace_get_trace_id(dt));
+  tlib_pass_if_true("Accepted sampled", nr_distributed_trace_is_sampled(dt),
+                    "Expected true");
+  tlib_pass_if_str_equal("Accepted transport type", "HTTP",
+                         nr_distributed_trace_inbound_get_transport_type(dt));
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+  nr_distributed_trace_destroy(&dt);
+
+  /*
+   * Test : Fields of the wrong type are treated as missing
+   */
+  tlib_pass_if_true(
+      "Mistyped optional fields",
+      nr_distributed_trace_parse_inbound_payload(
+          "{\"v\":[0,1],\"d\":{\"ty\":\"App\",\"ac\":\"9123\",\"ap\":\"51424\","
+          "\"id\":5,\"tx\":\"6789\",\"tr\":\"3221bf09aa0bcf0d\",\"pr\":1,"
+          "\"sa\":\"true\",\"ti\":1482959525577}}",
+          &inbound, &error),
+      "error=%s", NRSAFESTR(error));
+  tlib_pass_if_null("Mistyped guid", inbound.guid);
+  tlib_pass_if_false("Mistyped priority", inbound.has_priority,
+                     "has_priority=%d", inbound.has_priority);
+  tlib_pass_if_false("Mistyped sampled", inbound.has_sampled,
+                     "has_sampled=%d", inbound.has_sampled);
+  nr_distributed_trace_inbound_payload_deinit(&inbound);
+
+  /*
+   * Test : Don't crash
+   */
+  nr_distributed_trace_inbound_payload_deinit(NULL);
+  tlib_pass_if_false("NULL inbound",
+                     nr_distributed_trace_accept_parsed_inbound_payload(
+                         NULL, NULL, "HTTP", &error),
+                     "Expected false");
+  error = NULL;
+}
+
+/*
+ * Every inbound payload in the cross agent tests must produce the same result
+ * whether it is accepted as an nrobj or parsed directly.
+ */
+static void test_distributed_trace_parse_inbound_payload_cross_agent(void) {
+  char* json;
+  nrobj_t* array;
+  int i;
+
+  json = nr_read_file_contents(
+      CROSS_AGENT_TESTS_DIR "/distributed_tracing/distributed_tracing.json",
+      10 * 1000 * 1000);
+  array = nro_create_from_json(json);
+  tlib_pass_if_not_null("tests valid", array);
+
+  for (i = 1; i <= nro_getsize(array); i++) {
+    const nrobj_t* test = nro_get_array_hash(array, i, NULL);
+    const char* name = nro_get_hash_string(test, "test_name", NULL);
+    const nrobj_t* payloads
+        = nro_get_hash_array(test, "inbound_payloads", NULL);
+    int j;
+
+    for (j = 1; j <= nro_getsize(payloads); j++) {
+      char* payload = nro_to_json(nro_get_array_value(payloads, j, NULL));
+      nr_distributed_trace_inbound_payload_t inbound;
+      nr_distributed_trace_t* dt_obj = nr_distributed_trace_create();
+      nr_distributed_trace_t* dt_parsed = nr_distributed_trace_create();
+      const char* error_obj = NULL;
+      const char* error_parsed = NULL;
+      nrobj_t* obj;
+      bool accepted_obj = false;
+      bool accepted_parsed = false;
+
+      obj = nr_distributed_trace_convert_payload_to_object(payload, &error_obj);
+      if (obj) {
+        accepted_obj = nr_distributed_trace_accept_inbound_payload(
+            dt_obj, obj, "HTTP", &error_obj);
+      }
+      if (nr_distributed_trace_parse_inbound_payload(payload, &inbound,
+                                                     &error_parsed)) {
+        accepted_parsed = nr_distributed_trace_accept_parsed_inbound_payload(
+            dt_parsed, &inbound, "HTTP", &error_parsed);
+      }
+
+      tlib_pass_if_true(name, accepted_obj == accepted_parsed,
+                        "accepted_obj=%d accepted_parsed=%d", accepted_obj,
+                        accepted_parsed);
+      tlib_pass_if_str_equal(name, error_obj, error_parsed);
+      tlib_pass_if_str_equal(
+          name, nr_distributed_trace_inbound_get_type(dt_obj),
+          nr_distributed_trace_inbound_get_type(dt_parsed));
+      tlib_pass_if_str_equal(
+          name, nr_distributed_trace_inbound_get_account_id(dt_obj),
+          nr_distributed_trace_inbound_get_account_id(dt_parsed));
+      tlib_pass_if_str_equal(
+          name, nr_distributed_trace_inbound_get_app_id(dt_obj),
+          nr_distributed_trace_inbound_get_app_id(dt_parsed));
+      tlib_pass_if_str_equal(
+          name, nr_distributed_trace_inbound_get_guid(dt_obj),
+          nr_distributed_trace_inbound_get_guid(dt_parsed));
+      tlib_pass_if_str_equal(
+          name, nr_distributed_trace_inbound_get_txn_id(dt_obj),
+          nr_distributed_trace_inbound_get_txn_id(dt_parsed));
+      tlib_pass_if_str_equal(name, nr_distributed_trace_get_trace_id(dt_obj),
+                             nr_distributed_trace_get_trace_id(dt_parsed));
+      tlib_pass_if_true(name,
+                        nr_distributed_trace_get_priority(dt_obj)
+                            == nr_distributed_trace_get_priority(dt_parsed),
+                        "priority_obj=%f priority_parsed=%f",
+                        nr_distributed_trace_get_priority(dt_obj),
+                        nr_distributed_trace_get_priority(dt_parsed));
+      tlib_pass_if_true(name,
+                        nr_distributed_trace_is_sampled(dt_obj)
+                            == nr_distributed_trace_is_sampled(dt_parsed),
+                        "sampled_obj=%d sampled_parsed=%d",
+                        nr_distributed_trace_is_sampled(dt_obj),
+                        nr_distributed_trace_is_sampled(dt_parsed));
+      tlib_pass_if_true(
+          name,
+          nr_distributed_trace_inbound_get_timestamp_delta(dt_obj, 0)
+              == nr_distributed_trace_inbound_get_timestamp_delta(dt_parsed,
+                                                                  0),
+          "Expected equal timestamps");
+
+      nr_distributed_trace_inbound_payload_deinit(&inbound);
+      nr_distributed_trace_destroy(&dt_obj);
+      nr_distributed_trace_destroy(&dt_parsed);
+      nro_delete(obj);
+      nr_free(payload);
+    }
+  }
+
+  nro_delete(array);
+  nr_free(json);
+}
+
 static void test_distributed_trace_payload_as_text(void) {
   nr_distributed_trace_t dt = {.priority = 0.5};
   nr_distributed_trace_payload_t payload
@@ -1737,6 +1950,8 @@ void test_main(void* p NRUNUSED) {
   test_distributed_trace_payload_create_destroy();
   test_distributed_trace_convert_payload_to_object();
   test_distributed_trace_payload_accept_inbound_payload();
+  test_distributed_trace_parse_inbound_payload();
+  test_distributed_trace_parse_inbound_payload_cross_agent();
   test_distributed_trace_payload_as_text();
 
   test_distributed_trace_convert_w3c_traceparent();
@@ -108,6 +108,73 @@ static void test_ensure(void) {
                           nr_exclusive_time_destroy(&et));
 }
 
+static void test_append_child(void) {
+  nr_exclusive_time_t* et = NULL;
+
+  tlib_pass_if_bool_equal("NULL address", false,
+                          nr_exclusive_time_append_child(NULL, 1, 2));
+
+  /*
+   * Appending to NULL creates the structure.
+   */
+  tlib_pass_if_bool_equal("append should succeed", true,
+                          nr_exclusive_time_append_child(&et, 10, 20));
+  tlib_pass_if_not_null("append should create the structure", et);
+  tlib_pass_if_time_equal("append should create with a 0 start time", 0,
+                          et->start_time);
+  tlib_pass_if_size_t_equal("append should add a child", 2,
+                            et->transitions.used);
+
+  /*
+   * Appending to a full structure grows it.
+   */
+  for (int i = 0; i < 9; i++) {
+    tlib_pass_if_bool_equal("append should succeed", true,
+                            nr_exclusive_time_append_child(&et, 30, 40));
+  }
+  tlib_pass_if_size_t_equal("append should add every child", 10 * 2,
+                            et->transitions.used);
+  tlib_pass_if_true("append should grow the structure",
+                    et->transitions.capacity >= et->transitions.used,
+                    "capacity=%zu used=%zu", et->transitions.capacity,
+                    et->transitions.used);
+
+  nr_exclusive_time_ensure(&et, 0, 0, 50);
+  tlib_pass_if_time_equal("appended children are used", 30,
+                          nr_exclusive_time_calculate(et));
+
+  nr_exclusive_time_destroy(&et);
+}
+
+static void test_add_children(void) {
+  nr_exclusive_time_t* et = nr_exclusive_time_create(1, 0, 50);
+  nr_exclusive_time_t* src = NULL;
+
+  tlib_pass_if_bool_equal("NULL address", false,
+                          nr_exclusive_time_add_children(NULL, src));
+  tlib_pass_if_bool_equal("NULL source", true,
+                          nr_exclusive_time_add_children(&et, NULL));
+
+  nr_exclusive_time_append_child(&src, 0, 10);
+  nr_exclusive_time_append_child(&src, 20, 30);
+  nr_exclusive_time_append_child(&src, 25, 35);
+  nr_exclusive_time_add_child(et, 40, 45);
+
+  tlib_pass_if_bool_equal("add children should succeed", true,
+                          nr_exclusive_time_add_children(&et, src));
+  tlib_pass_if_size_t_equal("add children should copy every transition", 4 * 2,
+                            et->transitions.used);
+  tlib_pass_if_time_equal("add children should keep the start time", 0,
+                          et->start_time);
+  tlib_pass_if_time_equal("add children should keep the stop time", 50,
+                          et->stop_time);
+  tlib_pass_if_time_equal("copied children are used", 20,
+                          nr_exclusive_time_calculate(et));
+
+  nr_exclusive_time_destroy(&et);
+  nr_exclusive_time_destroy(&src);
+}
+
 static void test_add_child(void) {
   nr_exclusive_time_t* et;
   nr_exclusive_time_transition_t* trans;
@@ -529,6 +596,8 @@ void test_main(void* p NRUNUSED) {
   test_create_destroy();
   test_ensure();
   test_add_child();
+  test_append_child();
+  test_add_children();
   test_calculate();
   test_compare();
 }
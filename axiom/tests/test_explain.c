@@ -173,6 +173,150 @@ static void test_row(void) {
   nr_explain_plan_destroy(&plan);
 }
 
+static nr_explain_plan_t* create_test_plan(int64_t value) {
+  nr_explain_plan_t* plan = nr_explain_plan_create();
+  nrobj_t* row = nro_new_array();
+
+  nr_explain_plan_add_column(plan, "id");
+  nro_set_array_long(row, 0, value);
+  nr_explain_plan_add_row(plan, row);
+  nro_delete(row);
+
+  return plan;
+}
+
+static void test_duplicate(void) {
+  nr_explain_plan_t* plan = create_test_plan(42);
+  nr_explain_plan_t* dup;
+  char* expected;
+  char* actual;
+
+  tlib_pass_if_null("NULL plan", nr_explain_plan_duplicate(NULL));
+
+  dup = nr_explain_plan_duplicate(plan);
+  tlib_pass_if_not_null("duplicate", dup);
+  tlib_pass_if_true("distinct", dup != plan, "dup=%p plan=%p", dup, plan);
+
+  expected = nr_explain_plan_to_json(plan);
+  nr_explain_plan_destroy(&plan);
+  actual = nr_explain_plan_to_json(dup);
+  tlib_pass_if_str_equal("duplicate json", expected, actual);
+
+  nr_free(expected);
+  nr_free(actual);
+  nr_explain_plan_destroy(&dup);
+}
+
+static void test_cache(void) {
+  nr_explain_cache_t* cache;
+  nr_explain_plan_t* plan = create_test_plan(1);
+  nr_explain_plan_t* other = create_test_plan(2);
+  nr_explain_plan_t* got;
+  nrtime_t ttl = 10 * NR_TIME_DIVISOR;
+  nrtime_t now = 1000 * NR_TIME_DIVISOR;
+
+  /*
+   * Test : Bad parameters.
+   */
+  tlib_pass_if_null("disabled", nr_explain_cache_create(10, 0, 0));
+  tlib_pass_if_null("no plans", nr_explain_cache_create(0, ttl, 0));
+  tlib_pass_if_null("NULL cache", nr_explain_cache_get(NULL, 1, now));
+  tlib_pass_if_true("NULL cache allows", nr_explain_cache_allow(NULL, now),
+                    "expected true");
+  nr_explain_cache_put(NULL, 1, plan, now);
+  nr_explain_cache_destroy(NULL);
+  tlib_pass_if_size_t_equal("NULL size", 0, nr_explain_cache_size(NULL));
+
+  cache = nr_explain_cache_create(2, ttl, 0);
+  nr_explain_cache_put(cache, 1, NULL, now);
+  tlib_pass_if_size_t_equal("NULL plan", 0, nr_explain_cache_size(cache));
+
+  /*
+   * Test : Plans are returned as copies until they expire.
+   */
+  tlib_pass_if_null("miss", nr_explain_cache_get(cache, 1, now));
+  nr_explain_cache_put(cache, 1, plan, now);
+
+  got = nr_explain_cache_get(cache, 1, now + ttl - 1);
+  tlib_pass_if_not_null("hit", got);
+  tlib_pass_if_true("copy", got != plan, "got=%p plan=%p", got, plan);
+  tlib_pass_if_int_equal("hit columns", 1, nr_explain_plan_column_count(got));
+  nr_explain_plan_destroy(&got);
+
+  tlib_pass_if_null("other id", nr_explain_cache_get(cache, 2, now));
+  tlib_pass_if_null("expired", nr_explain_cache_get(cache, 1, now + ttl));
+  tlib_pass_if_size_t_equal("expired removed", 0,
+                            nr_explain_cache_size(cache));
+
+  /*
+   * Test : A full cache only accepts new plans once older ones expire.
+   */
+  nr_explain_cache_put(cache, 1, plan, now);
+  nr_explain_cache_put(cache, 2, plan, now + 1);
+  nr_explain_cache_put(cache, 3, plan, now + 2);
+  tlib_pass_if_size_t_equal("full", 2, nr_explain_cache_size(cache));
+  tlib_pass_if_null("not added", nr_explain_cache_get(cache, 3, now + 2));
+
+  nr_explain_cache_put(cache, 3, other, now + ttl);
+  tlib_pass_if_size_t_equal("replaced expired", 2,
+                            nr_explain_cache_size(cache));
+  got = nr_explain_cache_get(cache, 3, now + ttl);
+  tlib_pass_if_not_null("added after expiry", got);
+  nr_explain_plan_destroy(&got);
+  tlib_pass_if_null("first expired",
+                    nr_explain_cache_get(cache, 1, now + ttl));
+
+  /*
+   * Test : Putting a known id replaces its plan.
+   */
+  nr_explain_cache_put(cache, 2, other, now + ttl);
+  got = nr_explain_cache_get(cache, 2, now + ttl + 1);
+  tlib_pass_if_not_null("replaced", got);
+  nr_explain_plan_destroy(&got);
+
+  /*
+   * Test : Without a budget, explain queries are always allowed.
+   */
+  tlib_pass_if_true("unlimited", nr_explain_cache_allow(cache, now),
+                    "expected true");
+
+  nr_explain_cache_destroy(&cache);
+  tlib_pass_if_null("destroyed", cache);
+
+  nr_explain_plan_destroy(&plan);
+  nr_explain_plan_destroy(&other);
+}
+
+static void test_cache_budget(void) {
+  nr_explain_cache_t* cache = nr_explain_cache_create(0, 0, 2);
+  nrtime_t now = 1000 * NR_TIME_DIVISOR;
+  nr_explain_plan_t* plan = create_test_plan(1);
+
+  tlib_pass_if_not_null("budget only", cache);
+
+  /*
+   * Test : Plans are not cached without a TTL.
+   */
+  nr_explain_cache_put(cache, 1, plan, now);
+  tlib_pass_if_size_t_equal("not cached", 0, nr_explain_cache_size(cache));
+
+  tlib_pass_if_true("first", nr_explain_cache_allow(cache, now),
+                    "expected true");
+  tlib_pass_if_true("second", nr_explain_cache_allow(cache, now + 1),
+                    "expected true");
+  tlib_pass_if_false("exhausted", nr_explain_cache_allow(cache, now + 2),
+                     "expected false");
+  tlib_pass_if_false("still exhausted",
+                     nr_explain_cache_allow(cache, now + 59 * NR_TIME_DIVISOR),
+                     "expected false");
+  tlib_pass_if_true("next minute",
+                    nr_explain_cache_allow(cache, now + 60 * NR_TIME_DIVISOR),
+                    "expected true");
+
+  nr_explain_cache_destroy(&cache);
+  nr_explain_plan_destroy(&plan);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
@@ -180,4 +324,7 @@ void test_main(void* p NRUNUSED) {
   test_destroy();
   test_export();
   test_row();
+  test_duplicate();
+  test_cache();
+  test_cache_budget();
 }
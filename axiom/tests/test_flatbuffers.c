@@ -792,6 +792,64 @@ static void test_vtable_deduplication(void) {
   nr_flatbuffers_destroy(&fb);
 }
 
+static uint32_t test_reset_build(nr_flatbuffer_t* fb) {
+  uint32_t str;
+  uint32_t obj;
+
+  str = nr_flatbuffers_prepend_string(fb, "a string long enough to grow");
+  nr_flatbuffers_object_begin(fb, 2);
+  nr_flatbuffers_object_prepend_uoffset(fb, 0, str, 0);
+  nr_flatbuffers_object_prepend_i32(fb, 1, 42, 0);
+  nr_flatbuffers_object_end(fb);
+
+  nr_flatbuffers_object_begin(fb, 2);
+  nr_flatbuffers_object_prepend_uoffset(fb, 0, str, 0);
+  nr_flatbuffers_object_prepend_i32(fb, 1, 43, 0);
+  obj = nr_flatbuffers_object_end(fb);
+  nr_flatbuffers_finish(fb, obj);
+
+  return obj;
+}
+
+static void test_reset(void) {
+  nr_flatbuffer_t* fb;
+  uint8_t* expected;
+  size_t expected_len;
+  size_t capacity;
+
+  /*
+   * Test : Bad parameters.
+   */
+  nr_flatbuffers_reset(NULL);
+  tlib_pass_if_size_t_equal(__func__, 0, nr_flatbuffers_capacity(NULL));
+  tlib_pass_if_size_t_equal(__func__, 0, nr_flatbuffers_grows(NULL));
+
+  /*
+   * Test : A reset buffer produces the same bytes as a new one, without
+   *        growing.
+   */
+  fb = nr_flatbuffers_create(0);
+  test_reset_build(fb);
+  tlib_fail_if_size_t_equal(__func__, 0, nr_flatbuffers_grows(fb));
+  expected_len = nr_flatbuffers_len(fb);
+  expected = (uint8_t*)nr_malloc(expected_len);
+  nr_memcpy(expected, nr_flatbuffers_data(fb), expected_len);
+  capacity = nr_flatbuffers_capacity(fb);
+
+  nr_flatbuffers_reset(fb);
+  tlib_pass_if_size_t_equal(__func__, 0, nr_flatbuffers_len(fb));
+  tlib_pass_if_size_t_equal(__func__, 0, nr_flatbuffers_grows(fb));
+  tlib_pass_if_size_t_equal(__func__, capacity, nr_flatbuffers_capacity(fb));
+
+  test_reset_build(fb);
+  test_bytes_equal(expected, expected_len, fb);
+  tlib_pass_if_size_t_equal(__func__, 0, nr_flatbuffers_grows(fb));
+  tlib_pass_if_size_t_equal(__func__, capacity, nr_flatbuffers_capacity(fb));
+
+  nr_free(expected);
+  nr_flatbuffers_destroy(&fb);
+}
+
 static void test_prepend_bytes(void) {
   int i;
   uint8_t expected[30];
@@ -1350,6 +1408,7 @@ void test_main(void* p NRUNUSED) {
   test_byte_layout_vtables();
   test_vtable_deduplication();
   test_prepend_bytes();
+  test_reset();
   test_read_indirect();
   test_read_struct();
   test_read_union();
@@ -7,6 +7,7 @@
 
 #include "nr_guid.h"
 #include "util_memory.h"
+#include "util_strings.h"
 
 #include "tlib_main.h"
 
@@ -21,18 +22,70 @@ static void test_create(void) {
   nr_free(guid);
 
   guid = nr_guid_create(rnd);
-  tlib_pass_if_str_equal("guid creation", guid, "078ad44c1960eab7");
+  tlib_pass_if_str_equal("guid creation", guid, "77785becb651a108");
   nr_free(guid);
 
   guid = nr_guid_create(rnd);
-  tlib_pass_if_str_equal("repeat guid creation", guid, "11da3087c4400533");
+  tlib_pass_if_str_equal("repeat guid creation", guid, "7ea2dd9449d67c47");
   nr_free(guid);
 
   nr_random_destroy(&rnd);
 }
 
+static void test_fill(void) {
+  static const char hex_digits[] = "0123456789abcdef";
+  char guid[NR_GUID_SIZE + 1];
+  char* created;
+  nr_random_t* rnd = nr_random_create();
+  int seen[16] = {0};
+  int i;
+  int j;
+
+  /*
+   * Test : Bad parameters.
+   */
+  nr_guid_fill(rnd, NULL);
+
+  nr_memset(guid, 'x', sizeof(guid));
+  nr_guid_fill(NULL, guid);
+  tlib_pass_if_str_equal("NULL random", "0000000000000000", guid);
+
+  /*
+   * Test : The inline and allocating variants agree for the same seed.
+   */
+  nr_random_seed(rnd, 345345);
+  nr_guid_fill(rnd, guid);
+  nr_random_seed(rnd, 345345);
+  created = nr_guid_create(rnd);
+  tlib_pass_if_str_equal("fill matches create", created, guid);
+  nr_free(created);
+
+  /*
+   * Test : Every hex digit is produced, and nothing else is.
+   */
+  for (i = 0; i < 100; i++) {
+    nr_guid_fill(rnd, guid);
+    tlib_pass_if_size_t_equal("guid length", NR_GUID_SIZE, nr_strlen(guid));
+    for (j = 0; j < NR_GUID_SIZE; j++) {
+      const char* digit = nr_strchr(hex_digits, guid[j]);
+
+      tlib_pass_if_true("guid character is a hex digit", NULL != digit,
+                        "guid=%s", guid);
+      if (NULL != digit) {
+        seen[digit - hex_digits] = 1;
+      }
+    }
+  }
+  for (i = 0; i < 16; i++) {
+    tlib_pass_if_int_equal("hex digit seen", 1, seen[i]);
+  }
+
+  nr_random_destroy(&rnd);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
   test_create();
+  test_fill();
 }
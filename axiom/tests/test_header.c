@@ -121,6 +121,10 @@ nrtime_t nr_txn_start_time(const nrtxn_t* txn NRUNUSED) {
   return 0;
 }
 
+size_t nr_txn_span_events_limit(const nrtxn_t* txn NRUNUSED) {
+  return 0;
+}
+
 #define test_metric_created(...) \
   test_header_test_metric_created_fn(__VA_ARGS__, __FILE__, __LINE__)
 
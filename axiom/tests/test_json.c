@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "util_json.h"
+#include "util_json_private.h"
 #include "util_memory.h"
 #include "util_strings.h"
 
@@ -335,8 +336,180 @@ static void test_json_worker(void) {
   nr_free(dest);
 }
 
+/*
+ * A clean span implementation that never finds a clean byte, so that every
+ * byte goes through the original byte at a time escaping code.
+ */
+static size_t test_clean_span_none(const char* str NRUNUSED,
+                                   size_t len NRUNUSED) {
+  return 0;
+}
+
+static uint32_t test_fuzz_next(uint32_t* state) {
+  /* xorshift32: deterministic, so that failures can be reproduced. */
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+/*
+ * Generate a string that is mostly clean, with runs long enough to exercise
+ * the vector code, and a mix of the bytes that need escaping: specials,
+ * control characters, valid and broken UTF-8 and stray high bytes.
+ */
+static size_t test_fuzz_string(char* buf, size_t max, uint32_t* state) {
+  static const char* interesting[] = {
+      "\"", "\\", "/", "\n", "\r", "\t", "\b", "\f", "\x01", "\x1f",
+      "\x7f", "\x80", "\xbf", "\xff", "\xc3\xa9", "\xe2\x82\xac",
+      "\xf0\x9f\x98\x82", "\xf8\x88\x80\x80\x80", "\xc3", "\xe2\x82",
+      "\xc3(", " ", "~",
+  };
+  size_t len = test_fuzz_next(state) % max;
+  size_t i = 0;
+
+  while (i < len) {
+    uint32_t r = test_fuzz_next(state);
+
+    if (0 == r % 8) {
+      const char* s = interesting[(r >> 8) % (sizeof(interesting)
+                                              / sizeof(interesting[0]))];
+      size_t slen = nr_strlen(s);
+
+      if (i + slen > len) {
+        break;
+      }
+      nr_memcpy(buf + i, s, slen);
+      i += slen;
+    } else {
+      buf[i] = (char)(0x20 + (r >> 8) % 0x5f);
+      i++;
+    }
+  }
+  buf[i] = '\0';
+
+  return i;
+}
+
+static void test_escape_fuzz_impl(const char* name,
+                                  nr_json_clean_span_t clean_span) {
+  char src[1025];
+  char expected[sizeof(src) * 6 + 3];
+  char actual[sizeof(src) * 6 + 3];
+  uint32_t state = 0x2545f491;
+  int failures = 0;
+  int i;
+
+  for (i = 0; i < 5000 && failures < 5; i++) {
+    size_t len = test_fuzz_string(src, 1 + (i % 2 ? 64 : sizeof(src) - 1),
+                                  &state);
+    size_t offset;
+    int expected_len;
+    int actual_len;
+
+    expected_len = nr_json_escape_with(expected, src, test_clean_span_none);
+    actual_len = nr_json_escape_with(actual, src, clean_span);
+    if (expected_len != actual_len || 0 != nr_strcmp(expected, actual)) {
+      tlib_pass_if_str_equal(name, expected, actual);
+      failures++;
+    }
+
+    /* Every implementation must find exactly the same spans. */
+    for (offset = 0; offset < len; offset++) {
+      size_t want = nr_json_clean_span_scalar(src + offset, len - offset);
+      size_t got = clean_span(src + offset, len - offset);
+
+      if (want != got) {
+        tlib_pass_if_size_t_equal(name, want, got);
+        failures++;
+        break;
+      }
+    }
+  }
+
+  tlib_pass_if_int_equal(name, 0, failures);
+}
+
+static void test_escape_fuzz(void) {
+  char dest[16];
+
+  /*
+   * Test : The dispatched implementation is used by nr_json_escape().
+   */
+  tlib_pass_if_true("best implementation", NULL != nr_json_clean_span_best(),
+                    "best=%p", (void*)nr_json_clean_span_best());
+  tlib_pass_if_int_equal("dispatched escape", 8,
+                         nr_json_escape(dest, "ab\"cd"));
+  tlib_pass_if_str_equal("dispatched escape", "\"ab\\\"cd\"", dest);
+
+  /*
+   * Test : Every implementation produces output identical to escaping byte
+   *        at a time.
+   */
+  test_escape_fuzz_impl("scalar", nr_json_clean_span_scalar);
+  test_escape_fuzz_impl("best", nr_json_clean_span_best());
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  test_escape_fuzz_impl("sse2", nr_json_clean_span_sse2);
+  if (__builtin_cpu_supports("avx2")) {
+    test_escape_fuzz_impl("avx2", nr_json_clean_span_avx2);
+  }
+#endif
+}
+
+static void test_unescape(void) {
+  char dest[64];
+  const char* escaped;
+  char* round_trip;
+
+  tlib_pass_if_size_t_equal("NULL dest", 0, nr_json_unescape(NULL, "a", 1));
+  tlib_pass_if_size_t_equal("NULL src", 0, nr_json_unescape(dest, NULL, 3));
+  tlib_pass_if_str_equal("NULL src", "", dest);
+  tlib_pass_if_size_t_equal("empty", 0, nr_json_unescape(dest, "", 0));
+  tlib_pass_if_str_equal("empty", "", dest);
+
+  tlib_pass_if_size_t_equal("plain", 5, nr_json_unescape(dest, "hello", 5));
+  tlib_pass_if_str_equal("plain", "hello", dest);
+
+  /* The length is respected: the source need not be terminated. */
+  tlib_pass_if_size_t_equal("length", 3, nr_json_unescape(dest, "hello", 3));
+  tlib_pass_if_str_equal("length", "hel", dest);
+
+  escaped = "a\\\"b\\\\c\\/d\\be\\ff\\ng\\rh\\ti";
+  tlib_pass_if_size_t_equal(
+      "escapes", 17, nr_json_unescape(dest, escaped, nr_strlen(escaped)));
+  tlib_pass_if_str_equal("escapes", "a\"b\\c/d\be\ff\ng\rh\ti", dest);
+
+  escaped = "\\u0041\\u00e9\\u20ac";
+  tlib_pass_if_size_t_equal(
+      "unicode", 6, nr_json_unescape(dest, escaped, nr_strlen(escaped)));
+  tlib_pass_if_str_equal("unicode", "A\xc3\xa9\xe2\x82\xac", dest);
+
+  /* Truncated and malformed escapes must not read past the source. */
+  tlib_pass_if_size_t_equal("truncated unicode", 1,
+                            nr_json_unescape(dest, "\\u4", 3));
+  tlib_pass_if_str_equal("truncated unicode", "\x04", dest);
+  tlib_pass_if_size_t_equal("trailing backslash", 1,
+                            nr_json_unescape(dest, "a\\", 2));
+  tlib_pass_if_str_equal("trailing backslash", "a", dest);
+  tlib_pass_if_size_t_equal("unknown escape", 2,
+                            nr_json_unescape(dest, "\\qz", 3));
+  tlib_pass_if_str_equal("unknown escape", "qz", dest);
+
+  /* Escaping and then unescaping is lossless. */
+  round_trip = (char*)nr_malloc(6 * 32 + 3);
+  nr_json_escape(round_trip, "tab\there \"quoted\" /path\\ \xc3\xa9");
+  tlib_pass_if_size_t_equal(
+      "round trip", 27,
+      nr_json_unescape(dest, round_trip + 1, nr_strlen(round_trip) - 2));
+  tlib_pass_if_str_equal("round trip",
+                         "tab\there \"quoted\" /path\\ \xc3\xa9", dest);
+  nr_free(round_trip);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 4, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
   test_json_worker();
+  test_escape_fuzz();
+  test_unescape();
 }
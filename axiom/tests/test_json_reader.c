@@ -0,0 +1,369 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util_json_reader.h"
+#include "util_memory.h"
+#include "util_object.h"
+#include "util_strings.h"
+#include "util_text.h"
+
+#include "tlib_main.h"
+
+/*
+ * Build an nrobj_t from the value at the reader's current position, so that
+ * the reader can be compared with nro_create_from_json().
+ */
+static nrobj_t* test_reader_build(nr_json_reader_t* reader) {
+  nrobj_t* obj = NULL;
+  nr_json_string_t str;
+  nr_json_number_t num;
+  bool b;
+  char* s;
+
+  switch (nr_json_reader_peek(reader)) {
+    case NR_JSON_NULL:
+      if (nr_json_reader_read_null(reader)) {
+        obj = nro_new_none();
+      }
+      break;
+
+    case NR_JSON_BOOLEAN:
+      if (nr_json_reader_read_boolean(reader, &b)) {
+        obj = nro_new_boolean(b);
+      }
+      break;
+
+    case NR_JSON_NUMBER:
+      if (nr_json_reader_read_number(reader, &num)) {
+        if (num.is_double) {
+          obj = nro_new_double(num.dval);
+        } else if ((num.lval <= INT_MIN) || (num.lval >= INT_MAX)) {
+          obj = nro_new_long(num.lval);
+        } else {
+          obj = nro_new_int((int)num.lval);
+        }
+      }
+      break;
+
+    case NR_JSON_STRING:
+      if (nr_json_reader_read_string(reader, &str)) {
+        s = nr_json_string_dup(&str);
+        obj = nro_new_string(s);
+        nr_free(s);
+      }
+      break;
+
+    case NR_JSON_OBJECT:
+      obj = nro_new_hash();
+      nr_json_reader_begin_object(reader);
+      while (nr_json_reader_next_member(reader, &str)) {
+        nrobj_t* value = test_reader_build(reader);
+
+        s = nr_json_string_dup(&str);
+        nro_set_hash(obj, s, value);
+        nr_free(s);
+        nro_delete(value);
+      }
+      break;
+
+    case NR_JSON_ARRAY:
+      obj = nro_new_array();
+      nr_json_reader_begin_array(reader);
+      while (nr_json_reader_next_element(reader)) {
+        nrobj_t* value = test_reader_build(reader);
+
+        nro_set_array(obj, 0, value);
+        nro_delete(value);
+      }
+      break;
+
+    case NR_JSON_INVALID:
+    default:
+      nr_json_reader_skip(reader);
+      break;
+  }
+
+  if (reader->failed) {
+    nro_delete(obj);
+  }
+  return obj;
+}
+
+static void test_scalars(void) {
+  nr_json_reader_t reader;
+  nr_json_string_t str;
+  nr_json_number_t num;
+  bool b = false;
+  char* s;
+
+  nr_json_reader_init(&reader, "  \"hello\"  ");
+  tlib_pass_if_int_equal("string type", NR_JSON_STRING,
+                         nr_json_reader_peek(&reader));
+  tlib_pass_if_true("string", nr_json_reader_read_string(&reader, &str),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_size_t_equal("string length", 5, str.len);
+  tlib_pass_if_false("string escaped", str.escaped, "escaped=%d",
+                     str.escaped);
+  tlib_pass_if_true("string equals", nr_json_string_equals(&str, "hello"),
+                    "len=%zu", str.len);
+  tlib_pass_if_false("string prefix", nr_json_string_equals(&str, "hell"),
+                     "len=%zu", str.len);
+  tlib_pass_if_true("string end", nr_json_reader_end(&reader), "failed=%d",
+                    reader.failed);
+
+  nr_json_reader_init(&reader, "\"a\\\"b\\u00e9\\n\"");
+  tlib_pass_if_true("escaped string",
+                    nr_json_reader_read_string(&reader, &str), "failed=%d",
+                    reader.failed);
+  tlib_pass_if_true("escaped string escaped", str.escaped, "escaped=%d",
+                    str.escaped);
+  s = nr_json_string_dup(&str);
+  tlib_pass_if_str_equal("escaped string dup", "a\"b\xc3\xa9\n", s);
+  tlib_pass_if_true("escaped string equals",
+                    nr_json_string_equals(&str, "a\"b\xc3\xa9\n"), "s=%s",
+                    s);
+  nr_free(s);
+
+  nr_json_reader_init(&reader, "-42");
+  tlib_pass_if_int_equal("integer type", NR_JSON_NUMBER,
+                         nr_json_reader_peek(&reader));
+  tlib_pass_if_true("integer", nr_json_reader_read_number(&reader, &num),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_false("integer is not double", num.is_double,
+                     "is_double=%d", num.is_double);
+  tlib_pass_if_true("integer value", -42 == num.lval, "lval=%" PRId64,
+                    num.lval);
+
+  nr_json_reader_init(&reader, "1560345600000");
+  tlib_pass_if_true("long", nr_json_reader_read_number(&reader, &num),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_true("long value", 1560345600000LL == num.lval,
+                    "lval=%" PRId64, num.lval);
+
+  nr_json_reader_init(&reader, "0.5e1");
+  tlib_pass_if_true("double", nr_json_reader_read_number(&reader, &num),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_true("double is double", num.is_double, "is_double=%d",
+                    num.is_double);
+  tlib_pass_if_true("double value", 5.0 == num.dval, "dval=%f", num.dval);
+
+  nr_json_reader_init(&reader, "true");
+  tlib_pass_if_true("true", nr_json_reader_read_boolean(&reader, &b),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_true("true value", b, "b=%d", b);
+
+  nr_json_reader_init(&reader, "false");
+  tlib_pass_if_true("false", nr_json_reader_read_boolean(&reader, &b),
+                    "failed=%d", reader.failed);
+  tlib_pass_if_false("false value", b, "b=%d", b);
+
+  nr_json_reader_init(&reader, "null");
+  tlib_pass_if_int_equal("null type", NR_JSON_NULL,
+                         nr_json_reader_peek(&reader));
+  tlib_pass_if_true("null", nr_json_reader_read_null(&reader), "failed=%d",
+                    reader.failed);
+  tlib_pass_if_true("null end", nr_json_reader_end(&reader), "failed=%d",
+                    reader.failed);
+}
+
+static void test_containers(void) {
+  nr_json_reader_t reader;
+  nr_json_string_t key;
+  nr_json_string_t str;
+  nr_json_number_t num;
+  int members = 0;
+  int elements = 0;
+
+  nr_json_reader_init(&reader,
+                      "{\"skip\":{\"a\":[1,{\"b\":null}],\"c\":\"}\"},"
+                      " \"want\" : \"value\" , \"list\":[1, 2.5, 3]}");
+  tlib_pass_if_true("begin object", nr_json_reader_begin_object(&reader),
+                    "failed=%d", reader.failed);
+  while (nr_json_reader_next_member(&reader, &key)) {
+    members++;
+    if (nr_json_string_equals(&key, "want")) {
+      tlib_pass_if_true("member value",
+                        nr_json_reader_read_string(&reader, &str),
+                        "failed=%d", reader.failed);
+      tlib_pass_if_true("member value equals",
+                        nr_json_string_equals(&str, "value"), "len=%zu",
+                        str.len);
+    } else if (nr_json_string_equals(&key, "list")) {
+      nr_json_reader_begin_array(&reader);
+      while (nr_json_reader_next_element(&reader)) {
+        nr_json_reader_read_number(&reader, &num);
+        elements++;
+      }
+    } else {
+      nr_json_reader_skip(&reader);
+    }
+  }
+  tlib_pass_if_int_equal("members", 3, members);
+  tlib_pass_if_int_equal("elements", 3, elements);
+  tlib_pass_if_true("object end", nr_json_reader_end(&reader), "failed=%d",
+                    reader.failed);
+
+  nr_json_reader_init(&reader, "{ } ");
+  nr_json_reader_begin_object(&reader);
+  tlib_pass_if_false("empty object",
+                     nr_json_reader_next_member(&reader, &key), "failed=%d",
+                     reader.failed);
+  tlib_pass_if_true("empty object end", nr_json_reader_end(&reader),
+                    "failed=%d", reader.failed);
+
+  nr_json_reader_init(&reader, "[]");
+  nr_json_reader_begin_array(&reader);
+  tlib_pass_if_false("empty array", nr_json_reader_next_element(&reader),
+                     "failed=%d", reader.failed);
+  tlib_pass_if_true("empty array end", nr_json_reader_end(&reader),
+                    "failed=%d", reader.failed);
+}
+
+static void test_errors(void) {
+  nr_json_reader_t reader;
+  nr_json_string_t str;
+  nr_json_number_t num;
+  size_t i;
+  const char* invalid[] = {
+      "",
+      "{",
+      "[",
+      "{\"a\"}",
+      "{\"a\":}",
+      "{\"a\":1,}",
+      "{\"a\":1 \"b\":2}",
+      "{1:2}",
+      "[1,]",
+      "[1 2]",
+      "\"unterminated",
+      "\"bad\\",
+      "\"control\x01\"",
+      "tru",
+      "nul",
+      "-",
+      "x",
+      "[1] 2",
+  };
+
+  for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    nr_json_reader_init(&reader, invalid[i]);
+    nr_json_reader_skip(&reader);
+    tlib_pass_if_false(invalid[i], nr_json_reader_end(&reader), "failed=%d",
+                       reader.failed);
+  }
+
+  /*
+   * Reading the wrong type fails the reader, and every subsequent read fails
+   * too.
+   */
+  nr_json_reader_init(&reader, "[1, \"a\"]");
+  nr_json_reader_begin_array(&reader);
+  nr_json_reader_next_element(&reader);
+  tlib_pass_if_false("wrong type", nr_json_reader_read_string(&reader, &str),
+                     "failed=%d", reader.failed);
+  tlib_pass_if_true("wrong type failed", reader.failed, "failed=%d",
+                    reader.failed);
+  tlib_pass_if_false("after failure",
+                     nr_json_reader_read_number(&reader, &num), "failed=%d",
+                     reader.failed);
+  tlib_pass_if_false("after failure next",
+                     nr_json_reader_next_element(&reader), "failed=%d",
+                     reader.failed);
+
+  /*
+   * Don't crash.
+   */
+  nr_json_reader_init(NULL, "{}");
+  tlib_pass_if_int_equal("NULL reader", NR_JSON_INVALID,
+                         nr_json_reader_peek(NULL));
+  tlib_pass_if_false("NULL reader skip", nr_json_reader_skip(NULL), "%d", 0);
+  tlib_pass_if_false("NULL reader end", nr_json_reader_end(NULL), "%d", 0);
+  tlib_pass_if_null("NULL string dup", nr_json_string_dup(NULL));
+  tlib_pass_if_false("NULL string equals",
+                     nr_json_string_equals(NULL, "a"), "%d", 0);
+
+  nr_json_reader_init(&reader, NULL);
+  tlib_pass_if_false("NULL json", nr_json_reader_skip(&reader), "failed=%d",
+                     reader.failed);
+}
+
+/*
+ * Every cross agent test file is read both by nro_create_from_json() and by
+ * the reader, and the results must be identical.
+ */
+static void test_cross_agent_equivalence(void) {
+  size_t i;
+  const char* files[] = {
+      "attribute_configuration.json",
+      "cat/cat_map.json",
+      "cat/path_hashing.json",
+      "collector_hostname.json",
+      "data_collection_server_configuration.json",
+      "datastores/datastore_api.json",
+      "datastores/datastore_instances.json",
+      "distributed_tracing/distributed_tracing.json",
+      "distributed_tracing/trace_context.json",
+      "labels.json",
+      "language_agents_security_policies.json",
+      "rules.json",
+      "rum_client_config.json",
+      "sql_parsing.json",
+      "synthetics/synthetics.json",
+      "transaction_segment_terms.json",
+      "url_clean.json",
+      "url_domain_extraction.json",
+      "utilization/utilization_json.json",
+  };
+
+  for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    char* path = nr_formatf("%s/%s", CROSS_AGENT_TESTS_DIR, files[i]);
+    char* json = nr_read_file_contents(path, 10 * 1000 * 1000);
+    nr_json_reader_t reader;
+    nrobj_t* expected;
+    nrobj_t* actual;
+    char* expected_json;
+    char* actual_json;
+
+    tlib_pass_if_not_null(files[i], json);
+    if (NULL == json) {
+      nr_free(path);
+      continue;
+    }
+
+    expected = nro_create_from_json(json);
+    nr_json_reader_init(&reader, json);
+    actual = test_reader_build(&reader);
+
+    tlib_pass_if_not_null(files[i], expected);
+    tlib_pass_if_true(files[i], nr_json_reader_end(&reader), "failed=%d",
+                      reader.failed);
+
+    expected_json = nro_to_json(expected);
+    actual_json = nro_to_json(actual);
+    tlib_pass_if_str_equal(files[i], expected_json, actual_json);
+
+    nr_free(expected_json);
+    nr_free(actual_json);
+    nro_delete(expected);
+    nro_delete(actual);
+    nr_free(json);
+    nr_free(path);
+  }
+}
+
+tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_scalars();
+  test_containers();
+  test_errors();
+  test_cross_agent_equivalence();
+}
@@ -291,6 +291,18 @@ static void test_log_event_message(void) {
   tlib_pass_if_str_equal("Another valid message set", "another test message",
                          event->message);
 
+  /*
+   * Test : Truncated message.
+   */
+  nr_log_event_set_message_truncated(event, "test message", 4);
+  tlib_pass_if_str_equal("Truncated message set", "test", event->message);
+  nr_log_event_set_message_truncated(event, "test message", 0);
+  tlib_pass_if_str_equal("Zero length is the default limit", "test message",
+                         event->message);
+  nr_log_event_set_message_truncated(event, NULL, 4);
+  tlib_pass_if_str_equal("NULL message ignored", "test message",
+                         event->message);
+
   nr_log_event_destroy(&event);
 }
 
@@ -316,11 +316,55 @@ static void test_events_null(void) {
   tlib_pass_if_null("events destroyed", events);
 }
 
+static void test_events_would_keep(void) {
+  nr_log_events_t* events = NULL;
+  nr_log_event_t* e = NULL;
+
+  tlib_pass_if_false("NULL pool", nr_log_events_would_keep(NULL, 0),
+                     "expected false");
+
+  events = nr_log_events_create(0);
+  tlib_pass_if_false("0 size pool", nr_log_events_would_keep(events, 100),
+                     "expected false");
+  nr_log_events_destroy(&events);
+
+  events = nr_log_events_create(2);
+  tlib_pass_if_true("empty pool", nr_log_events_would_keep(events, 0),
+                    "expected true");
+
+  e = create_sample_event(LOG_MESSAGE_0);
+  nr_log_event_set_priority(e, 5);
+  nr_log_events_add_event(events, e);
+  tlib_pass_if_true("pool with room", nr_log_events_would_keep(events, 0),
+                    "expected true");
+
+  e = create_sample_event(LOG_MESSAGE_1);
+  nr_log_event_set_priority(e, 10);
+  nr_log_events_add_event(events, e);
+  tlib_pass_if_false("full pool, lower priority",
+                     nr_log_events_would_keep(events, 4), "expected false");
+  tlib_pass_if_true("full pool, equal priority",
+                    nr_log_events_would_keep(events, 5), "expected true");
+  tlib_pass_if_true("full pool, higher priority",
+                    nr_log_events_would_keep(events, 6), "expected true");
+
+  /* Dropped events count as seen, but are not saved */
+  nr_log_events_add_dropped(events);
+  nr_log_events_add_dropped(NULL);
+  tlib_pass_if_int_equal("dropped event seen", 3,
+                         nr_log_events_number_seen(events));
+  tlib_pass_if_int_equal("dropped event not saved", 2,
+                         nr_log_events_number_saved(events));
+
+  nr_log_events_destroy(&events);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
   test_events_success();
   test_events_sample();
   test_events_null();
+  test_events_would_keep();
   test_log_event_comparator();
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "nr_metric_names.h"
+
+#include "tlib_main.h"
+
+static void test_disabled(void) {
+  nr_metric_names_t names = NR_METRIC_NAMES_INITIALIZER;
+  bool send_name = false;
+
+  /*
+   * Test : Bad parameters.
+   */
+  tlib_pass_if_uint32_t_equal("NULL names", 0,
+                              nr_metric_names_lookup(NULL, "a", &send_name));
+  tlib_pass_if_true("NULL names", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("NULL name", 0,
+                              nr_metric_names_lookup(&names, NULL, &send_name));
+  tlib_pass_if_uint32_t_equal("NULL size", 0, nr_metric_names_size(NULL));
+  nr_metric_names_enable(NULL, 10);
+  nr_metric_names_reset(NULL);
+  nr_metric_names_commit(NULL, NULL);
+
+  /*
+   * Test : A dictionary is disabled until the daemon advertises a capacity.
+   */
+  nr_metric_names_enable(&names, 0);
+  tlib_pass_if_uint32_t_equal("disabled", 0,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_true("disabled", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("disabled size", 0, nr_metric_names_size(&names));
+}
+
+static void test_lookup_commit(void) {
+  nr_metric_names_t names = NR_METRIC_NAMES_INITIALIZER;
+  nr_vector_t defined;
+  bool send_name = false;
+
+  nr_vector_init(&defined, 2, NULL, NULL);
+  nr_metric_names_enable(&names, 2);
+
+  /*
+   * Test : New names get sequential ids and must be sent until committed.
+   */
+  tlib_pass_if_uint32_t_equal("first id", 1,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_true("first id", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("second id", 2,
+                              nr_metric_names_lookup(&names, "b", &send_name));
+  tlib_pass_if_uint32_t_equal("pending id", 1,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_true("pending id", send_name, "send_name=%d", send_name);
+
+  /*
+   * Test : Names beyond the capacity are sent without an id.
+   */
+  tlib_pass_if_uint32_t_equal("full", 0,
+                              nr_metric_names_lookup(&names, "c", &send_name));
+  tlib_pass_if_true("full", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("size", 2, nr_metric_names_size(&names));
+
+  /*
+   * Test : Committed names are sent by id alone.
+   */
+  nr_vector_push_back(&defined, (void*)"a");
+  nr_metric_names_commit(&names, &defined);
+  tlib_pass_if_uint32_t_equal("committed", 1,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_false("committed", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("uncommitted", 2,
+                              nr_metric_names_lookup(&names, "b", &send_name));
+  tlib_pass_if_true("uncommitted", send_name, "send_name=%d", send_name);
+
+  /*
+   * Test : Enabling again keeps the dictionary.
+   */
+  nr_metric_names_enable(&names, 100);
+  tlib_pass_if_uint32_t_equal("enabled again", 1,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_false("enabled again", send_name, "send_name=%d", send_name);
+
+  /*
+   * Test : Resetting forgets all ids and disables the dictionary.
+   */
+  nr_metric_names_reset(&names);
+  tlib_pass_if_uint32_t_equal("reset", 0,
+                              nr_metric_names_lookup(&names, "a", &send_name));
+  tlib_pass_if_true("reset", send_name, "send_name=%d", send_name);
+  tlib_pass_if_uint32_t_equal("reset size", 0, nr_metric_names_size(&names));
+
+  nr_metric_names_enable(&names, 2);
+  tlib_pass_if_uint32_t_equal("ids restart", 1,
+                              nr_metric_names_lookup(&names, "b", &send_name));
+  tlib_pass_if_true("ids restart", send_name, "send_name=%d", send_name);
+
+  nr_metric_names_reset(&names);
+  nr_vector_deinit(&defined);
+}
+
+tlib_parallel_info_t parallel_info
+    = {.suggested_nthreads = -1, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_disabled();
+  test_lookup_commit();
+}
@@ -630,6 +630,40 @@ static void test_duplicate_metric(void) {
   nrm_table_destroy(&table);
 }
 
+static void test_table_merge(void) {
+  nrmtable_t* src = nrm_table_create(0);
+  nrmtable_t* dest = nrm_table_create(0);
+
+  nrm_add(src, "a", 2 * NR_TIME_DIVISOR);
+  nrm_force_add_ex(src, "b", 3 * NR_TIME_DIVISOR, 1 * NR_TIME_DIVISOR);
+  nrm_add_apdex(src, "apdex", 1, 2, 3, 4 * NR_TIME_DIVISOR);
+
+  /*
+   * Bad parameters
+   */
+  nrm_table_merge(NULL, src);
+  nrm_table_merge(dest, NULL);
+  nrm_table_merge(src, src);
+  tlib_pass_if_int_equal("bad parameters", 3, nrm_table_size(src));
+  tlib_pass_if_int_equal("bad parameters", 0, nrm_table_size(dest));
+
+  /*
+   * Success
+   */
+  nrm_add(dest, "a", 1 * NR_TIME_DIVISOR);
+  nrm_table_merge(dest, src);
+  nrm_table_merge(dest, src);
+  test_metric_json(
+      "merge success", dest,
+      "[{\"name\":\"a\",\"data\":[3,5.00000,5.00000,1.00000,2.00000,9.00000]},"
+      "{\"name\":\"b\",\"data\":[2,6.00000,2.00000,3.00000,3.00000,18.00000],"
+      "\"forced\":true},"
+      "{\"name\":\"apdex\",\"data\":[2,4,6,4.00000,4.00000,0]}]");
+
+  nrm_table_destroy(&src);
+  nrm_table_destroy(&dest);
+}
+
 static void test_metric_table_to_daemon_json(void) {
   nrmtable_t* table;
   char* json;
@@ -689,5 +723,6 @@ void test_main(void* p NRUNUSED) {
   test_add_bad_parameters();
 
   test_duplicate_metric();
+  test_table_merge();
   test_metric_table_to_daemon_json();
 }
@@ -2685,6 +2685,159 @@ static void test_to_json_buffer(void) {
   nro_delete(obj);
 }
 
+static void test_string_storage(void) {
+  /* Strings either side of the inline storage limit. */
+  const char* lengths[] = {
+      "",
+      "short",
+      "0123456789abcdefghijklm",
+      "0123456789abcdefghijklmn",
+      "0123456789abcdefghijklmnopqrstuvwxyz",
+  };
+  size_t i;
+
+  for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    nrobj_t* str = nro_new_string(lengths[i]);
+    nrobj_t* copy = nro_copy(str);
+    nrobj_t* hash = nro_new_hash();
+    nrobj_t* parsed;
+    char* json;
+
+    tlib_pass_if_str_equal("string", lengths[i], nro_get_string(str, NULL));
+    tlib_pass_if_str_equal("copy", lengths[i], nro_get_string(copy, NULL));
+    tlib_pass_if_true("copy has its own storage",
+                      nro_get_string(str, NULL) != nro_get_string(copy, NULL),
+                      "i=%zu", i);
+
+    nro_set_hash_string(hash, "value", lengths[i]);
+    if (lengths[i][0]) {
+      nro_set_hash_jstring(hash, lengths[i], "true");
+    }
+    json = nro_to_json(hash);
+    parsed = nro_create_from_json(json);
+    tlib_pass_if_str_equal("parsed value", lengths[i],
+                           nro_get_hash_string(parsed, "value", NULL));
+    if (lengths[i][0]) {
+      tlib_pass_if_int_equal("parsed key", 1,
+                             nro_get_hash_boolean(parsed, lengths[i], NULL));
+    }
+
+    nr_free(json);
+    nro_delete(parsed);
+    nro_delete(hash);
+    nro_delete(copy);
+    nro_delete(str);
+  }
+}
+
+static void test_interned_keys(void) {
+  nrobj_t* hash = nro_new_hash();
+  nrobj_t* copy;
+  nrobj_t* parsed;
+  const char* key = NULL;
+  char* json;
+  char type[] = "type";
+
+  /*
+   * Interned keys must behave exactly like any other key, regardless of
+   * whether the caller's key is a literal or a writable buffer.
+   */
+  nro_set_hash_string(hash, type, "Transaction");
+  type[0] = 'T';
+  nro_set_hash_string(hash, "name", "WebTransaction/Uri/foo");
+  nro_set_hash_int(hash, "custom", 1);
+  nro_set_hash_string(hash, "type", "Span");
+
+  tlib_pass_if_int_equal("size", 3, nro_getsize(hash));
+  tlib_pass_if_str_equal("replaced", "Span",
+                         nro_get_hash_string(hash, "type", NULL));
+  tlib_pass_if_null("key is not aliased to the caller",
+                    nro_get_hash_value(hash, "Type", NULL));
+  nro_get_hash_value_by_index(hash, 1, NULL, &key);
+  tlib_pass_if_str_equal("key", "type", key);
+
+  copy = nro_copy(hash);
+  nro_delete(hash);
+  json = nro_to_json(copy);
+  tlib_pass_if_str_equal(
+      "json", "{\"type\":\"Span\",\"name\":\"WebTransaction\\/Uri\\/foo\","
+      "\"custom\":1}",
+      json);
+
+  parsed = nro_create_from_json(json);
+  tlib_pass_if_str_equal("parsed", "WebTransaction/Uri/foo",
+                         nro_get_hash_string(parsed, "name", NULL));
+  tlib_pass_if_int_equal("parsed", 1, nro_get_hash_int(parsed, "custom", NULL));
+
+  nr_free(json);
+  nro_delete(parsed);
+  nro_delete(copy);
+}
+
+static void test_large_hash(void) {
+  nrobj_t* hash = nro_new_hash();
+  nrobj_t* copy;
+  nrobj_t* parsed;
+  const char* key = NULL;
+  char* json;
+  int i;
+
+  /* Large enough for the key index to be created and then grown. */
+  for (i = 0; i < 100; i++) {
+    char* name = nr_formatf("key%d", i);
+
+    tlib_pass_if_status_success("set", nro_set_hash_int(hash, name, i));
+    nr_free(name);
+  }
+  tlib_pass_if_int_equal("size", 100, nro_getsize(hash));
+
+  /* Replacing a value must not add a key or change the ordering. */
+  tlib_pass_if_status_success("replace", nro_set_hash_int(hash, "key50", -1));
+  tlib_pass_if_int_equal("size", 100, nro_getsize(hash));
+  nro_get_hash_value_by_index(hash, 51, NULL, &key);
+  tlib_pass_if_str_equal("order", "key50", key);
+
+  copy = nro_copy(hash);
+  for (i = 0; i < 100; i++) {
+    char* name = nr_formatf("key%d", i);
+    int expected = (50 == i) ? -1 : i;
+
+    tlib_pass_if_int_equal("get", expected, nro_get_hash_int(hash, name, NULL));
+    tlib_pass_if_int_equal("copy", expected,
+                           nro_get_hash_int(copy, name, NULL));
+    nr_free(name);
+  }
+  tlib_pass_if_null("missing", nro_get_hash_value(copy, "key100", NULL));
+
+  /* The copy's index must be independent of the original's. */
+  nro_set_hash_int(copy, "extra", 100);
+  tlib_pass_if_int_equal("copy extended", 101, nro_getsize(copy));
+  tlib_pass_if_null("original unchanged",
+                    nro_get_hash_value(hash, "extra", NULL));
+  tlib_pass_if_int_equal("copy extended", 100,
+                         nro_get_hash_int(copy, "extra", NULL));
+
+  json = nro_to_json(copy);
+  parsed = nro_create_from_json(json);
+  tlib_pass_if_int_equal("parsed size", 101, nro_getsize(parsed));
+  tlib_pass_if_int_equal("parsed", 99, nro_get_hash_int(parsed, "key99", NULL));
+  tlib_pass_if_int_equal("parsed", 100,
+                         nro_get_hash_int(parsed, "extra", NULL));
+  nr_free(json);
+  nro_delete(parsed);
+
+  /* Duplicate keys in JSON keep the last value, as with smaller hashes. */
+  parsed = nro_create_from_json(
+      "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,"
+      "\"h\":8,\"i\":9,\"j\":10,\"a\":11}");
+  tlib_pass_if_int_equal("duplicate size", 10, nro_getsize(parsed));
+  tlib_pass_if_int_equal("duplicate", 11, nro_get_hash_int(parsed, "a", NULL));
+  nro_delete(parsed);
+
+  nro_delete(copy);
+  nro_delete(hash);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* vp NRUNUSED) {
@@ -2720,4 +2873,8 @@ void test_main(void* vp NRUNUSED) {
 
   test_create_from_json_unterminated();
   test_to_json_buffer();
+
+  test_string_storage();
+  test_interned_keys();
+  test_large_hash();
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "nr_overhead.h"
+#include "util_memory.h"
+#include "util_metrics.h"
+
+#include "tlib_main.h"
+
+static void test_phase_name(void) {
+  int i;
+
+  for (i = 0; i < NR_OVERHEAD_PHASE_COUNT; i++) {
+    tlib_pass_if_not_null("valid phase", nr_overhead_phase_name(i));
+  }
+
+  tlib_pass_if_null("invalid phase",
+                    nr_overhead_phase_name(NR_OVERHEAD_PHASE_COUNT));
+  tlib_pass_if_str_equal("phase name", "TxnDataEncode",
+                         nr_overhead_phase_name(NR_OVERHEAD_TXNDATA_ENCODE));
+}
+
+static void test_add(void) {
+  nr_overhead_t overhead;
+  const nr_overhead_timer_t* timer
+      = &overhead.timers[NR_OVERHEAD_SEGMENT_FINALISE];
+
+  nr_overhead_reset(&overhead);
+
+  /*
+   * Test : Bad parameters.
+   */
+  nr_overhead_add(NULL, NR_OVERHEAD_TXN_BEGIN, 10);
+  nr_overhead_add(&overhead, NR_OVERHEAD_PHASE_COUNT, 10);
+  tlib_pass_if_uint64_t_equal("bad params", 0, nr_overhead_total(&overhead));
+  tlib_pass_if_uint64_t_equal("NULL total", 0, nr_overhead_total(NULL));
+
+  /*
+   * Test : Normal operation.
+   */
+  nr_overhead_add(&overhead, NR_OVERHEAD_SEGMENT_FINALISE, 20);
+  nr_overhead_add(&overhead, NR_OVERHEAD_SEGMENT_FINALISE, 5);
+  nr_overhead_add(&overhead, NR_OVERHEAD_SEGMENT_FINALISE, 50);
+  nr_overhead_add(&overhead, NR_OVERHEAD_TXN_BEGIN, 100);
+
+  tlib_pass_if_uint64_t_equal("count", 3, timer->count);
+  tlib_pass_if_uint64_t_equal("total", 75, timer->total);
+  tlib_pass_if_uint64_t_equal("min", 5, timer->min);
+  tlib_pass_if_uint64_t_equal("max", 50, timer->max);
+  tlib_pass_if_uint64_t_equal("sum of squares", 400 + 25 + 2500,
+                              timer->sum_of_squares);
+  tlib_pass_if_uint64_t_equal("summed total", 175,
+                              nr_overhead_total(&overhead));
+
+  nr_overhead_reset(&overhead);
+  tlib_pass_if_uint64_t_equal("reset", 0, nr_overhead_total(&overhead));
+  tlib_pass_if_uint64_t_equal("reset count", 0, timer->count);
+}
+
+static void test_add_sampled(void) {
+  nr_overhead_t overhead;
+  const nr_overhead_timer_t* timer = &overhead.timers[NR_OVERHEAD_EXECUTE];
+
+  nr_overhead_reset(&overhead);
+
+  /*
+   * Test : Bad parameters.
+   */
+  nr_overhead_add_sampled(NULL, NR_OVERHEAD_EXECUTE, 10, 4);
+  nr_overhead_add_sampled(&overhead, NR_OVERHEAD_PHASE_COUNT, 10, 4);
+  nr_overhead_add_sampled(&overhead, NR_OVERHEAD_EXECUTE, 10, 0);
+  tlib_pass_if_uint64_t_equal("bad params", 0, nr_overhead_total(&overhead));
+
+  /*
+   * Test : Each sample stands for weight occurrences.
+   */
+  nr_overhead_add_sampled(&overhead, NR_OVERHEAD_EXECUTE, 3, 64);
+  nr_overhead_add_sampled(&overhead, NR_OVERHEAD_EXECUTE, 5, 64);
+
+  tlib_pass_if_uint64_t_equal("count", 128, timer->count);
+  tlib_pass_if_uint64_t_equal("total", 512, timer->total);
+  tlib_pass_if_uint64_t_equal("min", 3, timer->min);
+  tlib_pass_if_uint64_t_equal("max", 5, timer->max);
+  tlib_pass_if_uint64_t_equal("sum of squares", (9 + 25) * 64,
+                              timer->sum_of_squares);
+}
+
+static void test_create_metrics(void) {
+  nr_overhead_t overhead;
+  nrmtable_t* metrics = nrm_table_create(0);
+  const nrmetric_t* metric;
+
+  nr_overhead_reset(&overhead);
+
+  /*
+   * Test : Bad parameters.
+   */
+  nr_overhead_create_metrics(NULL, metrics);
+  nr_overhead_create_metrics(&overhead, NULL);
+
+  /*
+   * Test : No metrics for phases that were never timed.
+   */
+  nr_overhead_create_metrics(&overhead, metrics);
+  tlib_pass_if_int_equal("no metrics", 0, nrm_table_size(metrics));
+
+  /*
+   * Test : Normal operation.
+   */
+  nr_overhead_add(&overhead, NR_OVERHEAD_TXNDATA_TX, 7);
+  nr_overhead_add(&overhead, NR_OVERHEAD_TXNDATA_TX, 3);
+  nr_overhead_add(&overhead, NR_OVERHEAD_RSHUTDOWN, 12);
+  nr_overhead_create_metrics(&overhead, metrics);
+  tlib_pass_if_int_equal("metric count", 2, nrm_table_size(metrics));
+
+  metric = nrm_find(metrics, "Supportability/PHP/Overhead/TxnDataTx");
+  tlib_pass_if_not_null("TxnDataTx metric", metric);
+  tlib_pass_if_uint64_t_equal("count", 2, nrm_count(metric));
+  tlib_pass_if_uint64_t_equal("total", 10, nrm_total(metric));
+  tlib_pass_if_uint64_t_equal("min", 3, nrm_min(metric));
+  tlib_pass_if_uint64_t_equal("max", 7, nrm_max(metric));
+
+  metric = nrm_find(metrics, "Supportability/PHP/Overhead/RequestShutdown");
+  tlib_pass_if_not_null("RequestShutdown metric", metric);
+  tlib_pass_if_uint64_t_equal("count", 1, nrm_count(metric));
+
+  /*
+   * Test : Metrics are aggregated across calls.
+   */
+  nr_overhead_reset(&overhead);
+  nr_overhead_add(&overhead, NR_OVERHEAD_TXNDATA_TX, 20);
+  nr_overhead_create_metrics(&overhead, metrics);
+
+  metric = nrm_find(metrics, "Supportability/PHP/Overhead/TxnDataTx");
+  tlib_pass_if_uint64_t_equal("aggregated count", 3, nrm_count(metric));
+  tlib_pass_if_uint64_t_equal("aggregated total", 30, nrm_total(metric));
+  tlib_pass_if_uint64_t_equal("aggregated min", 3, nrm_min(metric));
+  tlib_pass_if_uint64_t_equal("aggregated max", 20, nrm_max(metric));
+
+  nrm_table_destroy(&metrics);
+}
+
+tlib_parallel_info_t parallel_info
+    = {.suggested_nthreads = -1, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_phase_name();
+  test_add();
+  test_add_sampled();
+  test_create_metrics();
+}
@@ -148,6 +148,42 @@ static void test_php_packages_to_json(void) {
   nr_php_packages_destroy(&h);
 }
 
+static void test_php_packages_to_json_excluding_source(void) {
+  char* json;
+  nr_php_packages_t* h = nr_php_packages_create();
+
+  // Test: passing NULL does not crash
+  tlib_pass_if_null("NULL packages",
+                    nr_php_packages_to_json_excluding_source(
+                        NULL, NR_PHP_PACKAGE_SOURCE_COMPOSER));
+
+  nr_php_packages_add_package(
+      h, nr_php_package_create_with_source("Package One", "10.1.0",
+                                           NR_PHP_PACKAGE_SOURCE_COMPOSER));
+
+  // Test: no packages remain
+  tlib_pass_if_null("only excluded packages",
+                    nr_php_packages_to_json_excluding_source(
+                        h, NR_PHP_PACKAGE_SOURCE_COMPOSER));
+
+  // Test: packages from other sources remain
+  nr_php_packages_add_package(h,
+                              nr_php_package_create("Package Two", "11.2.0"));
+  json = nr_php_packages_to_json_excluding_source(
+      h, NR_PHP_PACKAGE_SOURCE_COMPOSER);
+  tlib_pass_if_str_equal("excluded source", "[[\"Package Two\",\"11.2.0\",{}]]",
+                         json);
+  nr_free(json);
+
+  json = nr_php_packages_to_json_excluding_source(
+      h, NR_PHP_PACKAGE_SOURCE_LEGACY);
+  tlib_pass_if_str_equal("other excluded source",
+                         "[[\"Package One\",\"10.1.0\",{}]]", json);
+  nr_free(json);
+
+  nr_php_packages_destroy(&h);
+}
+
 static void test_php_package_exists_in_hashmap(void) {
   nr_php_package_t* package1;
   nr_php_package_t* package2;
@@ -378,6 +414,7 @@ void test_main(void* p NRUNUSED) {
   test_php_package_to_json();
   test_php_packages_to_json_buffer();
   test_php_packages_to_json();
+  test_php_packages_to_json_excluding_source();
   test_php_package_exists_in_hashmap();
   test_php_package_without_version();
   test_php_package_priority();
@@ -93,10 +93,40 @@ static void test_real(void) {
   nr_random_destroy(&rnd);
 }
 
+static void test_u64(void) {
+  nr_random_t* rnd = nr_random_create();
+  uint64_t first;
+
+  tlib_pass_if_uint64_t_equal("NULL rnd", 0, nr_random_u64(NULL));
+
+  /*
+   * An unseeded generator starts from a zero state, which produces the
+   * SplitMix64 reference sequence.
+   */
+  tlib_pass_if_uint64_t_equal("first", 0xe220a8397b1dcdafULL,
+                              nr_random_u64(rnd));
+  tlib_pass_if_uint64_t_equal("second", 0x6e789e6aa1b965f4ULL,
+                              nr_random_u64(rnd));
+  tlib_pass_if_uint64_t_equal("third", 0x06c45d188009454fULL,
+                              nr_random_u64(rnd));
+
+  /*
+   * Seeding is deterministic.
+   */
+  nr_random_seed(rnd, 345345);
+  first = nr_random_u64(rnd);
+  tlib_fail_if_uint64_t_equal("next draw differs", first, nr_random_u64(rnd));
+  nr_random_seed(rnd, 345345);
+  tlib_pass_if_uint64_t_equal("reseeded", first, nr_random_u64(rnd));
+
+  nr_random_destroy(&rnd);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
   test_range_bad_params();
   test_range();
   test_real();
+  test_u64();
 }
@@ -362,6 +362,7 @@ static void test_cross_agent_rule_tests(void) {
   if (array && (NR_OBJECT_ARRAY == nro_type(array))) {
     for (i = 1; i <= nro_getsize(array); i++) {
       int j;
+      int pass;
       const nrobj_t* hash = nro_get_array_hash(array, i, 0);
       const char* testname = nro_get_hash_string(hash, "testname", 0);
       const nrobj_t* rules_obj = nro_get_hash_array(hash, "rules", 0);
@@ -374,17 +375,27 @@ static void test_cross_agent_rule_tests(void) {
       tlib_pass_if_true("tests valid", 0 != test_cases, "test_cases=%p",
                         test_cases);
 
-      if (test_cases && (NR_OBJECT_ARRAY == nro_type(test_cases))) {
-        for (j = 1; j <= nro_getsize(test_cases); j++) {
-          const nrobj_t* h = nro_get_array_hash(test_cases, j, 0);
-          const char* input = nro_get_hash_string(h, "input", 0);
-          const char* expected = nro_get_hash_string(h, "expected", 0);
+      /*
+       * Run each case with and without the prefilter: it must never change
+       * the outcome.
+       */
+      for (pass = 0; pass < 2; pass++) {
+        if (1 == pass && rules) {
+          nr_regex_destroy(&rules->prefilter);
+        }
+
+        if (test_cases && (NR_OBJECT_ARRAY == nro_type(test_cases))) {
+          for (j = 1; j <= nro_getsize(test_cases); j++) {
+            const nrobj_t* h = nro_get_array_hash(test_cases, j, 0);
+            const char* input = nro_get_hash_string(h, "input", 0);
+            const char* expected = nro_get_hash_string(h, "expected", 0);
 
-          tlib_pass_if_true("tests valid", 0 != h, "h=%p", h);
-          tlib_pass_if_true("tests valid", 0 != input, "input=%p", input);
+            tlib_pass_if_true("tests valid", 0 != h, "h=%p", h);
+            tlib_pass_if_true("tests valid", 0 != input, "input=%p", input);
 
-          rules_apply_testcase(testname ? testname : input, rules, input,
-                               expected);
+            rules_apply_testcase(testname ? testname : input, rules, input,
+                                 expected);
+          }
         }
       }
       nr_rules_destroy(&rules);
@@ -615,6 +626,79 @@ static void test_replace_string(void) {
   nr_regex_substrings_destroy(&ss);
 }
 
+static void test_prefilter(void) {
+  nrrules_t* rules;
+
+  /*
+   * Test : A single whole string rule gets no prefilter.
+   */
+  rules = build_rules(
+      "[{\"match_expression\":\"^/a$\",\"replacement\":\"/b\"}]");
+  tlib_pass_if_null("single rule", rules->prefilter);
+  rules_apply_testcase("single rule", rules, "/a", "/b");
+  nr_rules_destroy(&rules);
+
+  /*
+   * Test : Patterns that depend on group numbering get no prefilter.
+   */
+  rules = build_rules(
+      "[{\"match_expression\":\"^/(a)\\\\1$\",\"replacement\":\"/b\"},"
+      "{\"match_expression\":\"^/c$\",\"replacement\":\"/d\"}]");
+  tlib_pass_if_null("backreference", rules->prefilter);
+  rules_apply_testcase("backreference", rules, "/aa", "/b");
+  rules_apply_testcase("backreference", rules, "/c", "/d");
+  nr_rules_destroy(&rules);
+
+  /*
+   * Test : A later whole string rule still applies once a per segment rule
+   *        has changed the name, even though the prefilter did not match
+   *        the original name.
+   */
+  rules = build_rules(
+      "[{\"match_expression\":\"^[0-9]+$\",\"replacement\":\"*\","
+      "\"each_segment\":true,\"eval_order\":0},"
+      "{\"match_expression\":\"^/foo/\\\\*$\",\"replacement\":\"/foo/id\","
+      "\"eval_order\":1},"
+      "{\"match_expression\":\"^/never$\",\"ignore\":true,"
+      "\"eval_order\":2}]");
+  tlib_pass_if_not_null("prefilter built", rules->prefilter);
+  rules_apply_testcase("chained", rules, "/foo/123", "/foo/id");
+  rules_apply_testcase("unmatched", rules, "/foo/bar", "/foo/bar");
+  rules_apply_testcase("ignored", rules, "/never", NULL);
+  nr_rules_destroy(&rules);
+
+  /*
+   * Test : A per segment rule that matches nothing still replaces a leading
+   *        character other than '/', which later whole string rules see.
+   */
+  rules = build_rules(
+      "[{\"match_expression\":\"^zzz$\",\"replacement\":\"y\","
+      "\"each_segment\":true,\"eval_order\":0},"
+      "{\"match_expression\":\"^/bc$\",\"replacement\":\"/matched\","
+      "\"eval_order\":1},"
+      "{\"match_expression\":\"^/never$\",\"ignore\":true,"
+      "\"eval_order\":2}]");
+  tlib_pass_if_not_null("prefilter built", rules->prefilter);
+  rules_apply_testcase("leading character", rules, "abc", "/matched");
+  nr_rules_destroy(&rules);
+
+  /*
+   * Test : Adding a rule discards the prefilter until the rules are sorted.
+   */
+  rules = build_rules(
+      "[{\"match_expression\":\"^/a$\",\"replacement\":\"/b\"},"
+      "{\"match_expression\":\"^/c$\",\"replacement\":\"/d\"}]");
+  tlib_pass_if_not_null("prefilter built", rules->prefilter);
+  nr_rules_add(rules, 0, 5, "^/e$", "/f");
+  tlib_pass_if_null("prefilter discarded", rules->prefilter);
+  rules_apply_testcase("unsorted", rules, "/e", "/f");
+  nr_rules_sort(rules);
+  tlib_pass_if_not_null("prefilter rebuilt", rules->prefilter);
+  rules_apply_testcase("sorted", rules, "/e", "/f");
+  rules_apply_testcase("sorted", rules, "/x", "/x");
+  nr_rules_destroy(&rules);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
@@ -623,4 +707,5 @@ void test_main(void* p NRUNUSED) {
   test_create_from_obj_bad_params();
   test_cross_agent_rule_tests();
   test_replace_string();
+  test_prefilter();
 }
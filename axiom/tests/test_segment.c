@@ -1453,10 +1453,10 @@ static void test_segment_discard(void) {
   D = nr_segment_start(&txn, B, NULL);
 
   /* Allocate some fields, so we know those are getting destroyed. */
-  A->id = nr_strdup("A");
-  B->id = nr_strdup("B");
-  C->id = nr_strdup("C");
-  D->id = nr_strdup("D");
+  nr_strcpy(A->id, "A");
+  nr_strcpy(B->id, "B");
+  nr_strcpy(C->id, "C");
+  nr_strcpy(D->id, "D");
 
   /* Deleting the root node of a tree must not work.
    *
@@ -1583,11 +1583,11 @@ static void test_segment_discard_keep_metrics(void) {
   nr_segment_set_timing(E, 8000, 2000);
 
   /* Allocate some fields, so we know those are getting destroyed. */
-  A->id = nr_strdup("A");
-  B->id = nr_strdup("B");
-  C->id = nr_strdup("C");
-  D->id = nr_strdup("D");
-  E->id = nr_strdup("E");
+  nr_strcpy(A->id, "A");
+  nr_strcpy(B->id, "B");
+  nr_strcpy(C->id, "C");
+  nr_strcpy(D->id, "D");
+  nr_strcpy(E->id, "E");
 
   /* End segments */
   test_segment_end_and_keep(&E);
@@ -1654,10 +1654,10 @@ static void test_segment_discard_keep_metrics_while_running(void) {
   nr_segment_set_timing(D, 7000, 1000);
 
   /* Allocate some fields, so we know those are getting destroyed. */
-  A->id = nr_strdup("A");
-  B->id = nr_strdup("B");
-  C->id = nr_strdup("C");
-  D->id = nr_strdup("D");
+  nr_strcpy(A->id, "A");
+  nr_strcpy(B->id, "B");
+  nr_strcpy(C->id, "C");
+  nr_strcpy(D->id, "D");
 
   /*
    * Discard D.
@@ -1687,7 +1687,7 @@ static void test_segment_discard_keep_metrics_while_running(void) {
    *  metric d (1000, excl. 1000)
    */
   E = nr_segment_start(txn, B, NULL);
-  E->id = nr_strdup("E");
+  nr_strcpy(E->id, "E");
   nr_segment_add_metric(E, "e", true);
   nr_segment_set_timing(E, 8000, 2000);
 
@@ -1771,10 +1771,10 @@ static void test_segment_discard_keep_metrics_no_exclusive(void) {
   nr_segment_set_timing(D, 7000, 1000);
 
   /* Allocate some fields, so we know those are getting destroyed. */
-  A->id = nr_strdup("A");
-  B->id = nr_strdup("B");
-  C->id = nr_strdup("C");
-  D->id = nr_strdup("D");
+  nr_strcpy(A->id, "A");
+  nr_strcpy(B->id, "B");
+  nr_strcpy(C->id, "C");
+  nr_strcpy(D->id, "D");
 
   /*
    * Discard D.
@@ -1804,7 +1804,7 @@ static void test_segment_discard_keep_metrics_no_exclusive(void) {
    *  metric d (1000, excl. 0)
    */
   E = nr_segment_start(txn, B, NULL);
-  E->id = nr_strdup("E");
+  nr_strcpy(E->id, "E");
   nr_segment_add_metric(E, "e", true);
   nr_segment_set_timing(E, 8000, 2000);
 
@@ -2373,7 +2373,7 @@ static void test_segment_ensure_id(void) {
    */
   tlib_pass_if_str_equal("correct id is returned for the segment", segment_id,
                          nr_segment_ensure_id(segment, txn));
-  nr_free(segment->id);
+  segment->id[0] = '\0';
 
   /*
    * Test : NULL segment id when DT is disabled
@@ -2570,8 +2570,8 @@ static void test_segment_to_span_event(void) {
   segment->txn = NULL;
   tlib_pass_if_null("NULL transaction on segment",
                     nr_segment_to_span_event(segment));
-  tlib_pass_if_null("ensure no ID was created with a NULL transaction",
-                    segment->id);
+  tlib_pass_if_str_equal("ensure no ID was created with a NULL transaction",
+                         "", segment->id);
   segment->txn = txn;
 
   /*
@@ -2605,8 +2605,8 @@ static void test_segment_to_span_event(void) {
   txn->options.distributed_tracing_enabled = false;
   tlib_pass_if_null("distributed tracing is disabled",
                     nr_segment_to_span_event(segment));
-  tlib_pass_if_null(
-      "ensure no ID was created with distributed tracing disabled",
+  tlib_pass_if_str_equal(
+      "ensure no ID was created with distributed tracing disabled", "",
       segment->id);
   txn->options.distributed_tracing_enabled = true;
 
@@ -2616,8 +2616,8 @@ static void test_segment_to_span_event(void) {
   txn->options.span_events_enabled = false;
   tlib_pass_if_null("span events is disabled",
                     nr_segment_to_span_event(segment));
-  tlib_pass_if_null("ensure no ID was created with span events disabled",
-                    segment->id);
+  tlib_pass_if_str_equal("ensure no ID was created with span events disabled",
+                         "", segment->id);
   txn->options.span_events_enabled = true;
 
   /*
@@ -693,6 +693,91 @@ static void test_slowsql_raw_saved(void) {
   nr_txn_destroy(&txn);
 }
 
+static void test_sql_cache_used(void) {
+  const char* tname = "sql cache used";
+  nrtxn_t* txn = new_txn(0);
+  nrtime_t duration = 4 * NR_TIME_DIVISOR;
+  nr_segment_datastore_params_t params = sample_segment_sql_params();
+  nr_sql_cache_stats_t stats;
+  nr_segment_t* segment = NULL;
+  const nr_slowsql_t* slow;
+  int i;
+
+  txn->options.sql_cache = nr_sql_cache_create(10);
+  txn->options.tt_recordsql = NR_SQL_OBFUSCATED;
+  txn->options.tt_slowsql = 1;
+  txn->options.ep_threshold = 1;
+  txn->options.ss_threshold = 1;
+
+  for (i = 0; i < 2; i++) {
+    segment = nr_segment_start(txn, NULL, NULL);
+    segment->start_time = 1 * NR_TIME_DIVISOR;
+    segment->stop_time = 1 * NR_TIME_DIVISOR + duration;
+
+    test_segment_datastore_end_and_keep(&segment, &params);
+
+    test_datastore_segment(&segment->typed_attributes->datastore, tname,
+                           "MySQL", NULL,
+                           "SELECT * FROM table WHERE constant = ?", NULL,
+                           "[\"Zip\",\"Zap\"]", NULL, NULL, NULL, NULL);
+    test_segment_metric_created(tname, segment->metrics,
+                                "Datastore/statement/MySQL/table/select", true);
+  }
+
+  /*
+   * The operation and the obfuscated SQL are each looked up once per segment:
+   * computed for the first, and cached for the second.
+   */
+  tlib_pass_if_true(tname,
+                    nr_sql_cache_take_stats(txn->options.sql_cache, &stats),
+                    "expected stats");
+  tlib_pass_if_uint64_t_equal(tname, 2, stats.hits);
+  tlib_pass_if_uint64_t_equal(tname, 2, stats.misses);
+
+  slow = nr_slowsqls_at(txn->slowsqls, 0);
+  tlib_pass_if_uint32_t_equal(tname, nr_slowsql_id(slow), 3202261176);
+  tlib_pass_if_int_equal(tname, nr_slowsql_count(slow), 2);
+  tlib_pass_if_str_equal(tname, nr_slowsql_query(slow),
+                         "SELECT * FROM table WHERE constant = ?");
+
+  nr_sql_cache_destroy(&txn->options.sql_cache);
+  nr_txn_destroy(&txn);
+}
+
+static void test_sql_cache_operation_only(void) {
+  const char* tname = "sql cache operation only";
+  nrtxn_t* txn = new_txn(0);
+  nr_segment_datastore_params_t params = sample_segment_sql_params();
+  nr_sql_cache_stats_t stats;
+  nr_sql_analysis_t analysis;
+  nr_segment_t* segment = NULL;
+
+  txn->options.sql_cache = nr_sql_cache_create(10);
+  txn->options.tt_recordsql = NR_SQL_NONE;
+  txn->options.tt_slowsql = 0;
+
+  segment = nr_segment_start(txn, NULL, NULL);
+  test_segment_datastore_end_and_keep(&segment, &params);
+  test_segment_metric_created(tname, segment->metrics,
+                              "Datastore/statement/MySQL/table/select", true);
+
+  /*
+   * Without SQL recording or slow SQL, the SQL is not obfuscated: asking the
+   * cache for the obfuscated SQL afterwards is a miss.
+   */
+  nr_sql_cache_take_stats(txn->options.sql_cache, &stats);
+  tlib_pass_if_uint64_t_equal(tname, 1, stats.misses);
+  nr_sql_analyse(txn->options.sql_cache, params.sql.sql, 0,
+                 NR_SQL_ANALYSIS_OBFUSCATED, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  nr_sql_cache_take_stats(txn->options.sql_cache, &stats);
+  tlib_pass_if_uint64_t_equal(tname, 0, stats.hits);
+  tlib_pass_if_uint64_t_equal(tname, 1, stats.misses);
+
+  nr_sql_cache_destroy(&txn->options.sql_cache);
+  nr_txn_destroy(&txn);
+}
+
 static void test_table_not_found(void) {
   const char* tname = "table not found";
   const char* name;
@@ -1142,6 +1227,8 @@ void test_main(void* p NRUNUSED) {
   test_options_high_security_tt_recordsql_raw();
   test_stack_recorded();
   test_slowsql_raw_saved();
+  test_sql_cache_used();
+  test_sql_cache_operation_only();
   test_table_not_found();
   test_table_and_operation_not_found();
   test_input_query_raw();
@@ -453,13 +453,14 @@ static void test_destroy_fields(void) {
   nr_segment_t s = {0};
   char* test_string = "0123456789";
 
-  s.id = nr_strdup(test_string);
+  nr_strcpy(s.id, test_string);
   s.metrics = nr_vector_create(8, NULL, NULL);
   s.attributes = nr_attributes_create(NULL);
   s.type = NR_SEGMENT_CUSTOM;
   s.exclusive_time = nr_exclusive_time_create(0, 1, 2);
 
   nr_segment_destroy_fields(&s);
+  tlib_pass_if_str_equal("id is cleared", "", s.id);
 }
 
 static void test_destroy_metric(void) {
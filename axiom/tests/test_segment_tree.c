@@ -79,7 +79,7 @@ static void test_finalise_span_priority(void) {
   external->txn = &txn;
   external->start_time = 2000;
   external->stop_time = 8000;
-  external->id = nr_strdup("id");
+  nr_strcpy(external->id, "id");
 
   /* Mock up the custom segment */
   custom = nr_slab_next(txn.segment_slab);
@@ -534,6 +534,515 @@ static void test_finalise_total_time(void) {
   nr_slab_destroy(&txn.segment_slab);
 }
 
+static void test_finalise_incremental(void) {
+  nr_segment_t *a, *b, *c;
+  const nrmetric_t* metric;
+  test_finalise_callback_expected_t cb_userdata = {.call_count = 0};
+
+  nrtxn_t txn = {.abs_start_time = 1000};
+
+  size_t trace_limit = 10;
+  size_t span_limit = 0;
+
+  nrtxnfinal_t result;
+  nr_segment_t* root;
+
+  txn.segment_slab = nr_slab_create(sizeof(nr_segment_t), 0);
+  txn.trace_strings = nr_string_pool_create();
+  txn.scoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.options.tt_threshold = 0;
+  txn.options.incremental_finalise = true;
+  txn.status.recording = 1;
+
+  root = nr_slab_next(txn.segment_slab);
+  root->txn = &txn;
+  root->name = nr_string_add(txn.trace_strings, "WebTransaction/*");
+
+  txn.segment_root = root;
+
+  /*
+   * time (ms): 0    10    20    30    40    50
+   *            ROOT------------------------->
+   *            a---------------------->
+   *                 b---->
+   *                       c---->
+   *
+   * The exclusive times are ROOT 10 ms, a 20 ms, b 10 ms and c 10 ms, for a
+   * total time of 50 ms.
+   */
+  nr_segment_set_timing(root, 0, 50 * NR_TIME_DIVISOR_MS);
+
+  a = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_name(a, "a");
+  nr_segment_set_timing(a, 0, 40 * NR_TIME_DIVISOR_MS);
+  nr_segment_add_metric(a, "a", true);
+  b = nr_segment_start(&txn, a, NULL);
+  nr_segment_set_name(b, "b");
+  nr_segment_set_timing(b, 10 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+  nr_segment_add_metric(b, "b", false);
+  c = nr_segment_start(&txn, a, NULL);
+  nr_segment_set_name(c, "c");
+  nr_segment_set_timing(c, 20 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+
+  /*
+   * Test : Segments are folded into the transaction as they end.
+   */
+  nr_segment_end(&b);
+  nr_segment_end(&c);
+  tlib_pass_if_time_equal("folded total time", 20 * NR_TIME_DIVISOR_MS,
+                          txn.folded_total_time);
+  metric = nrm_find(txn.unscoped_metrics, "b");
+  tlib_pass_if_not_null("b metric is merged when b ends", metric);
+  tlib_pass_if_time_equal("b exclusive", 10 * NR_TIME_DIVISOR_MS,
+                          nrm_exclusive(metric));
+
+  tlib_pass_if_null("a metric is not merged before a ends",
+                    nrm_find(txn.scoped_metrics, "a"));
+  tlib_pass_if_false("a is not folded before it ends", a->folded, "a=%p",
+                     (void*)a);
+  tlib_pass_if_true("a is folded when it ends", nr_segment_end(&a), "a=%p",
+                    (void*)a);
+
+  metric = nrm_find(txn.scoped_metrics, "a");
+  tlib_pass_if_not_null("a metric is merged when a ends", metric);
+  tlib_pass_if_time_equal("a total", 40 * NR_TIME_DIVISOR_MS, nrm_total(metric));
+  tlib_pass_if_time_equal("a exclusive", 20 * NR_TIME_DIVISOR_MS,
+                          nrm_exclusive(metric));
+  tlib_pass_if_time_equal("folded total time", 40 * NR_TIME_DIVISOR_MS,
+                          txn.folded_total_time);
+
+  /*
+   * Test : The root segment is never folded.
+   */
+  nr_segment_end(&root);
+  tlib_pass_if_false("root is not folded", txn.segment_root->folded, "root=%p",
+                     (void*)txn.segment_root);
+
+  /*
+   * Test : Finalising accounts for folded segments exactly once.
+   */
+  cb_userdata.txn = &txn;
+  cb_userdata.total_time = 50 * NR_TIME_DIVISOR_MS;
+  result = nr_segment_tree_finalise(&txn, trace_limit, span_limit,
+                                    test_finalise_callback, &cb_userdata);
+  tlib_pass_if_size_t_equal("finalise callback", 1, cb_userdata.call_count);
+  tlib_pass_if_not_null("trace", result.trace_json);
+  tlib_pass_if_uint64_t_equal("a metric is merged once", 1,
+                              nrm_count(nrm_find(txn.scoped_metrics, "a")));
+  tlib_pass_if_uint64_t_equal("b metric is merged once", 1,
+                              nrm_count(nrm_find(txn.unscoped_metrics, "b")));
+  tlib_pass_if_time_equal(
+      "root exclusive", 10 * NR_TIME_DIVISOR_MS,
+      nr_exclusive_time_calculate(txn.segment_root->exclusive_time));
+
+  nr_txn_final_destroy_fields(&result);
+  nrm_table_destroy(&txn.scoped_metrics);
+  nrm_table_destroy(&txn.unscoped_metrics);
+  nr_string_pool_destroy(&txn.trace_strings);
+  nr_minmax_heap_set_destructor(txn.folded_trace_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_trace_heap);
+  nr_minmax_heap_set_destructor(txn.folded_span_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_span_heap);
+
+  nr_segment_destroy_tree(txn.segment_root);
+  nr_slab_destroy(&txn.segment_slab);
+}
+
+static void test_finalise_incremental_late_child(void) {
+  nr_segment_t *a, *b;
+  const nrmetric_t* metric;
+  test_finalise_callback_expected_t cb_userdata = {.call_count = 0};
+
+  nrtxn_t txn = {.abs_start_time = 1000};
+
+  nrtxnfinal_t result;
+  nr_segment_t* root;
+
+  txn.segment_slab = nr_slab_create(sizeof(nr_segment_t), 0);
+  txn.trace_strings = nr_string_pool_create();
+  txn.scoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.options.tt_threshold = 0;
+  txn.options.incremental_finalise = true;
+  txn.status.recording = 1;
+
+  root = nr_slab_next(txn.segment_slab);
+  root->txn = &txn;
+  root->name = nr_string_add(txn.trace_strings, "WebTransaction/*");
+
+  txn.segment_root = root;
+
+  /*
+   * time (ms): 0    10    20    30    40    50
+   *            ROOT------------------------->
+   *            a---------------->
+   *                       b---------->
+   *
+   * b is a child of a in the same context, and ends after a. The exclusive
+   * times are ROOT 20 ms, a 20 ms and b 20 ms, for a total time of 60 ms.
+   */
+  nr_segment_set_timing(root, 0, 50 * NR_TIME_DIVISOR_MS);
+
+  a = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_name(a, "a");
+  nr_segment_set_timing(a, 0, 30 * NR_TIME_DIVISOR_MS);
+  nr_segment_add_metric(a, "a", true);
+  b = nr_segment_start(&txn, a, NULL);
+  nr_segment_set_name(b, "b");
+  nr_segment_add_metric(b, "b", true);
+
+  /*
+   * Test : A segment is not folded while a child in its context is open.
+   */
+  tlib_pass_if_true("a ends", nr_segment_end(&a), "a=%p", (void*)a);
+  a = nr_segment_children_get(&root->children, 0);
+  tlib_pass_if_false("a waits for b", a->folded, "a=%p", (void*)a);
+  tlib_pass_if_null("a metric is not merged while b is open",
+                    nrm_find(txn.scoped_metrics, "a"));
+  tlib_pass_if_time_equal("nothing is folded", 0, txn.folded_total_time);
+
+  /*
+   * Test : Ending the child folds the child and then the parent.
+   */
+  nr_segment_set_timing(b, 20 * NR_TIME_DIVISOR_MS, 20 * NR_TIME_DIVISOR_MS);
+  nr_segment_end(&b);
+  tlib_pass_if_true("a is folded after b", a->folded, "a=%p", (void*)a);
+
+  metric = nrm_find(txn.scoped_metrics, "a");
+  tlib_pass_if_time_equal("a exclusive", 20 * NR_TIME_DIVISOR_MS,
+                          nrm_exclusive(metric));
+  metric = nrm_find(txn.scoped_metrics, "b");
+  tlib_pass_if_time_equal("b exclusive", 20 * NR_TIME_DIVISOR_MS,
+                          nrm_exclusive(metric));
+  tlib_pass_if_time_equal("folded total time", 40 * NR_TIME_DIVISOR_MS,
+                          txn.folded_total_time);
+
+  nr_segment_end(&root);
+
+  cb_userdata.txn = &txn;
+  cb_userdata.total_time = 60 * NR_TIME_DIVISOR_MS;
+  result = nr_segment_tree_finalise(&txn, 10, 0, test_finalise_callback,
+                                    &cb_userdata);
+  tlib_pass_if_size_t_equal("finalise callback", 1, cb_userdata.call_count);
+  tlib_pass_if_uint64_t_equal("a metric is merged once", 1,
+                              nrm_count(nrm_find(txn.scoped_metrics, "a")));
+  tlib_pass_if_time_equal(
+      "a exclusive is counted once", 20 * NR_TIME_DIVISOR_MS,
+      nrm_exclusive(nrm_find(txn.scoped_metrics, "a")));
+
+  nr_txn_final_destroy_fields(&result);
+  nrm_table_destroy(&txn.scoped_metrics);
+  nrm_table_destroy(&txn.unscoped_metrics);
+  nr_string_pool_destroy(&txn.trace_strings);
+  nr_minmax_heap_set_destructor(txn.folded_trace_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_trace_heap);
+  nr_minmax_heap_set_destructor(txn.folded_span_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_span_heap);
+
+  nr_segment_destroy_tree(txn.segment_root);
+  nr_slab_destroy(&txn.segment_slab);
+}
+
+static void test_finalise_incremental_prunes_folded(void) {
+  nr_segment_t *a, *a1, *a2, *b, *b1, *c;
+  test_finalise_callback_expected_t cb_userdata = {.call_count = 0};
+  nr_segment_tree_to_heap_metadata_t metadata = {
+      .trace_heap = NULL,
+      .span_heap = NULL,
+      .total_time = 0,
+      .main_context = NULL,
+  };
+
+  nrtxn_t txn = {.abs_start_time = 1000};
+
+  nrtxnfinal_t result;
+  nr_segment_t* root;
+
+  txn.segment_slab = nr_slab_create(sizeof(nr_segment_t), 0);
+  txn.trace_strings = nr_string_pool_create();
+  txn.scoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.options.tt_threshold = 0;
+  txn.options.incremental_finalise = true;
+  txn.options.discount_main_context_blocking = true;
+  txn.status.recording = 1;
+
+  root = nr_slab_next(txn.segment_slab);
+  root->txn = &txn;
+  root->name = nr_string_add(txn.trace_strings, "WebTransaction/*");
+
+  txn.segment_root = root;
+
+  /*
+   * time (ms): 0    10    20    30    40    50    60    70    80    90   100
+   *            ROOT--------------------------------------------------------->
+   *            a---------------------->
+   *            a1--->
+   *                 a2--->
+   *                                         b---------------------->
+   *                                              b1--->
+   *                                                             c (ctx c)-->
+   *
+   * b never ends, so only b and ROOT are left for finalising. The exclusive
+   * times are ROOT 20 ms, a 20 ms, a1 10 ms, a2 10 ms, b 30 ms, b1 10 ms and
+   * c 5 ms. Discounting the 5 ms that the main context was blocked by c gives
+   * a total time of 100 ms.
+   */
+  nr_segment_set_timing(root, 0, 100 * NR_TIME_DIVISOR_MS);
+
+  a = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_timing(a, 0, 40 * NR_TIME_DIVISOR_MS);
+  a1 = nr_segment_start(&txn, a, NULL);
+  nr_segment_set_timing(a1, 0, 10 * NR_TIME_DIVISOR_MS);
+  a2 = nr_segment_start(&txn, a, NULL);
+  nr_segment_set_timing(a2, 10 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+  b = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_timing(b, 50 * NR_TIME_DIVISOR_MS, 40 * NR_TIME_DIVISOR_MS);
+  b1 = nr_segment_start(&txn, b, NULL);
+  nr_segment_set_timing(b1, 60 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+  c = nr_segment_start(&txn, root, "c");
+  nr_segment_set_timing(c, 90 * NR_TIME_DIVISOR_MS, 5 * NR_TIME_DIVISOR_MS);
+
+  nr_segment_end(&a1);
+  nr_segment_end(&a2);
+  nr_segment_end(&a);
+  nr_segment_end(&b1);
+  nr_segment_end(&c);
+  nr_segment_end(&root);
+
+  /*
+   * Test : Folded segments are kept in the folded reservoirs as they fold.
+   */
+  tlib_pass_if_ssize_t_equal("folded trace reservoir", 5,
+                             nr_minmax_heap_size(txn.folded_trace_heap));
+  tlib_pass_if_ssize_t_equal("folded span reservoir", 5,
+                             nr_minmax_heap_size(txn.folded_span_heap));
+  metadata.main_context
+      = nr_exclusive_time_create(0, 0, 100 * NR_TIME_DIVISOR_MS);
+  nr_exclusive_time_add_children(&metadata.main_context,
+                                 txn.folded_main_context);
+  tlib_pass_if_time_equal("folded main context", 95 * NR_TIME_DIVISOR_MS,
+                          nr_exclusive_time_calculate(metadata.main_context));
+  nr_exclusive_time_destroy(&metadata.main_context);
+
+  /*
+   * Test : The first pass only visits the segments that were not folded.
+   */
+  metadata.trace_heap
+      = nr_segment_heap_create(10, nr_segment_wrapped_duration_comparator);
+  metadata.span_heap = nr_segment_heap_create(
+      10, nr_segment_wrapped_span_priority_comparator);
+  metadata.main_context
+      = nr_exclusive_time_create(10, 0, 100 * NR_TIME_DIVISOR_MS);
+  nr_segment_tree_to_heap(txn.segment_root, &metadata);
+  tlib_pass_if_ssize_t_equal("only ROOT and b are placed in the trace heap", 2,
+                             nr_minmax_heap_size(metadata.trace_heap));
+  tlib_pass_if_ssize_t_equal("only ROOT and b are placed in the span heap", 2,
+                             nr_minmax_heap_size(metadata.span_heap));
+  tlib_pass_if_time_equal("c is not added to the main context again",
+                          100 * NR_TIME_DIVISOR_MS,
+                          nr_exclusive_time_calculate(metadata.main_context));
+  tlib_pass_if_time_equal("only ROOT and b are added to the total time",
+                          50 * NR_TIME_DIVISOR_MS, metadata.total_time);
+  nr_minmax_heap_destroy(&metadata.trace_heap);
+  nr_minmax_heap_destroy(&metadata.span_heap);
+  nr_exclusive_time_destroy(&metadata.main_context);
+  nr_exclusive_time_destroy(&txn.segment_root->exclusive_time);
+
+  /*
+   * Test : Finalising with sampling takes the folded reservoirs into account.
+   */
+  cb_userdata.txn = &txn;
+  cb_userdata.total_time = 100 * NR_TIME_DIVISOR_MS;
+  result = nr_segment_tree_finalise(&txn, 3, 0, test_finalise_callback,
+                                    &cb_userdata);
+  tlib_pass_if_size_t_equal("finalise callback", 1, cb_userdata.call_count);
+  tlib_pass_if_not_null("trace", result.trace_json);
+
+  nr_txn_final_destroy_fields(&result);
+  nrm_table_destroy(&txn.scoped_metrics);
+  nrm_table_destroy(&txn.unscoped_metrics);
+  nr_string_pool_destroy(&txn.trace_strings);
+  nr_minmax_heap_set_destructor(txn.folded_trace_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_trace_heap);
+  nr_minmax_heap_set_destructor(txn.folded_span_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_span_heap);
+  nr_exclusive_time_destroy(&txn.folded_main_context);
+
+  nr_segment_destroy_tree(txn.segment_root);
+  nr_slab_destroy(&txn.segment_slab);
+}
+
+static void test_finalise_incremental_releases_folded(void) {
+  const size_t count = NR_MAX_SEGMENTS + 2;
+  nrtime_t shortest_kept = 10 * NR_TIME_DIVISOR_MS;
+  test_finalise_callback_expected_t cb_userdata = {.call_count = 0};
+
+  nrtxn_t txn = {.abs_start_time = 1000};
+
+  nrtxnfinal_t result;
+  nr_segment_t* root;
+
+  txn.segment_slab = nr_slab_create(sizeof(nr_segment_t), 0);
+  txn.trace_strings = nr_string_pool_create();
+  txn.scoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.options.tt_threshold = 0;
+  txn.options.incremental_finalise = true;
+  txn.options.span_events_max_samples_stored = 2;
+  txn.status.recording = 1;
+
+  root = nr_slab_next(txn.segment_slab);
+  root->txn = &txn;
+  root->name = nr_string_add(txn.trace_strings, "WebTransaction/*");
+
+  txn.segment_root = root;
+
+  /*
+   * ROOT lasts 10 ms and has NR_MAX_SEGMENTS + 2 children, all starting at 0.
+   * The n-th child lasts n microseconds. The trace reservoir keeps the
+   * NR_MAX_SEGMENTS longest children, and the span reservoir the longest two,
+   * so the two shortest children are released as soon as they fold.
+   */
+  nr_segment_set_timing(root, 0, 10 * NR_TIME_DIVISOR_MS);
+
+  for (size_t i = 1; i <= count; i++) {
+    nr_segment_t* segment = nr_segment_start(&txn, root, NULL);
+
+    nr_segment_set_timing(segment, 0, i);
+    nr_segment_add_metric(segment, "child", false);
+    nr_segment_end(&segment);
+  }
+
+  /*
+   * Test : Folded segments outside of both reservoirs are released.
+   */
+  tlib_pass_if_size_t_equal("released children", NR_MAX_SEGMENTS,
+                            nr_segment_children_size(&root->children));
+  for (size_t i = 0; i < nr_segment_children_size(&root->children); i++) {
+    const nr_segment_t* child = nr_segment_children_get(&root->children, i);
+
+    if (child->stop_time < shortest_kept) {
+      shortest_kept = child->stop_time;
+    }
+  }
+  tlib_pass_if_time_equal("the two shortest children are released", 3,
+                          shortest_kept);
+  tlib_pass_if_size_t_equal("released children are still counted", count,
+                            txn.segment_count);
+  tlib_pass_if_uint64_t_equal(
+      "released children keep their metrics", count,
+      nrm_count(nrm_find(txn.unscoped_metrics, "child")));
+
+  /*
+   * Test : Released segments are still part of the total time.
+   */
+  nr_segment_end(&root);
+  cb_userdata.txn = &txn;
+  cb_userdata.total_time
+      = (10 * NR_TIME_DIVISOR_MS - count) + (count * (count + 1)) / 2;
+  result = nr_segment_tree_finalise(&txn, NR_MAX_SEGMENTS, 0,
+                                    test_finalise_callback, &cb_userdata);
+  tlib_pass_if_size_t_equal("finalise callback", 1, cb_userdata.call_count);
+  tlib_pass_if_not_null("trace", result.trace_json);
+
+  nr_txn_final_destroy_fields(&result);
+  nrm_table_destroy(&txn.scoped_metrics);
+  nrm_table_destroy(&txn.unscoped_metrics);
+  nr_string_pool_destroy(&txn.trace_strings);
+  nr_minmax_heap_set_destructor(txn.folded_trace_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_trace_heap);
+  nr_minmax_heap_set_destructor(txn.folded_span_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.folded_span_heap);
+
+  nr_segment_destroy_tree(txn.segment_root);
+  nr_slab_destroy(&txn.segment_slab);
+}
+
+static void test_finalise_incremental_discard_dtor(nr_segment_t* segment,
+                                                   void* userdata NRUNUSED) {
+  nr_segment_discard(&segment);
+}
+
+static void test_finalise_incremental_segment_limit(void) {
+  nr_segment_t *p, *c, *d, *e;
+  const nrmetric_t* metric;
+
+  nrtxn_t txn = {.abs_start_time = 1000};
+
+  nr_segment_t* root;
+
+  txn.segment_slab = nr_slab_create(sizeof(nr_segment_t), 0);
+  txn.trace_strings = nr_string_pool_create();
+  txn.scoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.unscoped_metrics = nrm_table_create(NR_METRIC_DEFAULT_LIMIT);
+  txn.options.tt_threshold = 0;
+  txn.options.incremental_finalise = true;
+  txn.options.max_segments = 2;
+  txn.status.recording = 1;
+  txn.segment_heap = nr_minmax_heap_create(
+      2, nr_segment_wrapped_span_priority_comparator, NULL,
+      (nr_minmax_heap_dtor_t)test_finalise_incremental_discard_dtor, NULL);
+
+  root = nr_slab_next(txn.segment_slab);
+  root->txn = &txn;
+  root->name = nr_string_add(txn.trace_strings, "WebTransaction/*");
+
+  txn.segment_root = root;
+
+  /*
+   * time (ms): 0    10    20    30    40    50    60    70
+   *            ROOT------------------------------------->
+   *            p---------------------->
+   *                 c->
+   *                                    d---->
+   *                                          e---->
+   *
+   * The segment heap only keeps two segments. Ending e evicts the folded c
+   * before p has ended. The exclusive times are p 35 ms, c 5 ms, d 10 ms and
+   * e 10 ms.
+   */
+  nr_segment_set_timing(root, 0, 70 * NR_TIME_DIVISOR_MS);
+
+  p = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_timing(p, 0, 40 * NR_TIME_DIVISOR_MS);
+  nr_segment_add_metric(p, "p", true);
+  c = nr_segment_start(&txn, p, NULL);
+  nr_segment_set_timing(c, 10 * NR_TIME_DIVISOR_MS, 5 * NR_TIME_DIVISOR_MS);
+  d = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_timing(d, 40 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+  e = nr_segment_start(&txn, root, NULL);
+  nr_segment_set_timing(e, 50 * NR_TIME_DIVISOR_MS, 10 * NR_TIME_DIVISOR_MS);
+
+  nr_segment_end(&c);
+  nr_segment_end(&d);
+  nr_segment_end(&e);
+  tlib_pass_if_size_t_equal("c is discarded", 0,
+                            nr_segment_children_size(&p->children));
+
+  /*
+   * Test : A discarded folded child is taken off the exclusive time of its
+   *        parent, even with a segment limit.
+   */
+  nr_segment_end(&p);
+  metric = nrm_find(txn.scoped_metrics, "p");
+  tlib_pass_if_not_null("p metric is merged", metric);
+  tlib_pass_if_time_equal("p exclusive", 35 * NR_TIME_DIVISOR_MS,
+                          nrm_exclusive(metric));
+  tlib_pass_if_time_equal("folded total time", 60 * NR_TIME_DIVISOR_MS,
+                          txn.folded_total_time);
+
+  nrm_table_destroy(&txn.scoped_metrics);
+  nrm_table_destroy(&txn.unscoped_metrics);
+  nr_string_pool_destroy(&txn.trace_strings);
+  nr_minmax_heap_set_destructor(txn.segment_heap, NULL, NULL);
+  nr_minmax_heap_destroy(&txn.segment_heap);
+
+  nr_segment_destroy_tree(txn.segment_root);
+  nr_slab_destroy(&txn.segment_slab);
+}
+
 static void test_finalise_total_time_discounted_async(void) {
   nrobj_t* obj;
   nr_segment_t *a, *b, *c, *d;
@@ -1102,6 +1611,11 @@ void test_main(void* p NRUNUSED) {
   test_finalise_one_only_with_metrics();
   test_finalise();
   test_finalise_total_time();
+  test_finalise_incremental();
+  test_finalise_incremental_late_child();
+  test_finalise_incremental_prunes_folded();
+  test_finalise_incremental_segment_limit();
+  test_finalise_incremental_releases_folded();
   test_finalise_total_time_discounted_async();
   test_finalise_total_time_discounted_sync();
   test_finalise_with_sampling();
@@ -230,6 +230,84 @@ static void test_count(void) {
   nr_slab_destroy(&slab);
 }
 
+static void test_page_pool(void) {
+  nr_slab_page_pool_t* pool;
+  nr_slab_page_pool_stats_t stats;
+  nr_slab_t* slab;
+  nr_slab_page_t* page;
+  uint64_t* obj;
+  size_t page_size;
+  size_t i;
+
+  /*
+   * Test : Bad parameters.
+   */
+  tlib_pass_if_null("0 retained size", nr_slab_page_pool_create(0));
+  tlib_pass_if_bool_equal("NULL pool", false,
+                          nr_slab_page_pool_take_stats(NULL, &stats));
+  nr_slab_page_pool_destroy(NULL);
+
+  pool = nr_slab_page_pool_create(1024 * 1024);
+  tlib_pass_if_not_null("pool", pool);
+  tlib_pass_if_bool_equal("NULL stats", false,
+                          nr_slab_page_pool_take_stats(pool, NULL));
+
+  /*
+   * Test : A new slab misses the empty pool, and returns its page on destroy.
+   */
+  slab = nr_slab_create_pooled(sizeof(uint64_t), 0, pool);
+  page_size = slab->page_size;
+  page = slab->head;
+  for (i = 0; i < 10; i++) {
+    obj = nr_slab_next(slab);
+    *obj = 0xdeadbeef;
+  }
+  nr_slab_destroy(&slab);
+
+  tlib_pass_if_bool_equal("stats", true,
+                          nr_slab_page_pool_take_stats(pool, &stats));
+  tlib_pass_if_uint64_t_equal("miss", 1, stats.misses);
+  tlib_pass_if_uint64_t_equal("no hit", 0, stats.hits);
+  tlib_pass_if_size_t_equal("retained", page_size, stats.retained_bytes);
+
+  /*
+   * Test : The next slab reuses the page, which is zeroed again.
+   */
+  slab = nr_slab_create_pooled(sizeof(uint64_t), 0, pool);
+  tlib_pass_if_ptr_equal("page reused", page, slab->head);
+  tlib_pass_if_size_t_equal("page unused", 0, slab->head->used);
+  for (i = 0; i < 10; i++) {
+    obj = nr_slab_next(slab);
+    tlib_pass_if_uint64_t_equal("object zeroed", 0, *obj);
+  }
+
+  nr_slab_page_pool_take_stats(pool, &stats);
+  tlib_pass_if_uint64_t_equal("hit", 1, stats.hits);
+  tlib_pass_if_uint64_t_equal("stats reset", 0, stats.misses);
+  tlib_pass_if_size_t_equal("page borrowed", 0, stats.retained_bytes);
+  nr_slab_destroy(&slab);
+
+  /*
+   * Test : Pages beyond the retained size are freed.
+   */
+  nr_slab_page_pool_destroy(&pool);
+  tlib_pass_if_null("pool destroyed", pool);
+
+  pool = nr_slab_page_pool_create(page_size);
+  slab = nr_slab_create_pooled(sizeof(uint64_t), 0, pool);
+  while (slab->head->prev == NULL) {
+    nr_slab_next(slab);
+  }
+  nr_slab_destroy(&slab);
+
+  nr_slab_page_pool_take_stats(pool, &stats);
+  tlib_pass_if_uint64_t_equal("two pages allocated", 2, stats.misses);
+  tlib_pass_if_true("retained size limited", stats.retained_bytes <= page_size,
+                    "retained_bytes=%zu", stats.retained_bytes);
+
+  nr_slab_page_pool_destroy(&pool);
+}
+
 tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
 
 void test_main(void* p NRUNUSED) {
@@ -237,4 +315,5 @@ void test_main(void* p NRUNUSED) {
   test_next();
   test_release();
   test_count();
+  test_page_pool();
 }
@@ -207,6 +207,101 @@ static void test_batch(void) {
 }
 #pragma GCC diagnostic pop
 
+#define test_encoder_matches(M, ENCODER, SPANS, LEN)                          \
+  do {                                                                        \
+    nr_span_encoding_result_t _expected = NR_SPAN_ENCODING_RESULT_INIT;       \
+    nr_span_encoding_result_t _actual = NR_SPAN_ENCODING_RESULT_INIT;         \
+                                                                              \
+    tlib_pass_if_bool_equal(M " reference", true,                            \
+                            nr_span_encoding_batch_v1((SPANS), (LEN),         \
+                                                      &_expected));           \
+    tlib_pass_if_bool_equal(M " encoder", true,                              \
+                            nr_span_encoder_batch_v1((ENCODER), (SPANS),      \
+                                                     (LEN), &_actual));       \
+    tlib_pass_if_bool_equal(M " borrowed", true, _actual.borrowed);          \
+    tlib_pass_if_size_t_equal(M " span count", _expected.span_count,         \
+                              _actual.span_count);                            \
+    tlib_pass_if_size_t_equal(M " length", _expected.len, _actual.len);      \
+    if (_expected.len == _actual.len) {                                       \
+      tlib_pass_if_int_equal(M " bytes", 0,                                   \
+                             nr_memcmp(_expected.data, _actual.data,          \
+                                       _expected.len));                       \
+    }                                                                         \
+                                                                              \
+    nr_span_encoding_result_deinit(&_expected);                               \
+    nr_span_encoding_result_deinit(&_actual);                                 \
+    tlib_pass_if_null(M " deinit", _actual.data);                             \
+  } while (0)
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+static void test_encoder(void) {
+  nr_span_encoding_result_t result = NR_SPAN_ENCODING_RESULT_INIT;
+  nr_span_encoder_t* encoder = nr_span_encoder_create();
+  nr_span_event_t* spans[3] = {nr_span_event_create(), nr_span_event_create(),
+                               nr_span_event_create()};
+  const nr_span_event_t** events = (const nr_span_event_t**)spans;
+  const nr_span_event_t* null_events[1] = {NULL};
+  char* long_string;
+
+  /*
+   * Test : Bad parameters.
+   */
+  tlib_pass_if_bool_equal("NULL encoder", false,
+                          nr_span_encoder_batch_v1(NULL, events, 3, &result));
+  tlib_pass_if_bool_equal("NULL spans", false,
+                          nr_span_encoder_batch_v1(encoder, NULL, 3, &result));
+  tlib_pass_if_bool_equal("NULL result", false,
+                          nr_span_encoder_batch_v1(encoder, events, 3, NULL));
+  tlib_pass_if_bool_equal(
+      "NULL span", false,
+      nr_span_encoder_batch_v1(encoder, null_events, 1, &result));
+  nr_span_encoder_destroy(NULL);
+
+  /*
+   * Test : The encoder output is identical to the protobuf-c output.
+   */
+  test_encoder_matches("empty batch", encoder, events, 0);
+  test_encoder_matches("empty spans", encoder, events, 3);
+
+  nr_span_event_set_trace_id(spans[0], "abcdefgh");
+  nr_span_event_set_trace_id(spans[1], "01234567");
+  add_values(spans[1]->agent_attributes);
+  add_values(spans[1]->intrinsics);
+  add_values(spans[1]->user_attributes);
+  test_encoder_matches("normal batch", encoder, events, 3);
+
+  nro_set_hash_long(spans[2]->intrinsics, "negative", -1);
+  nro_set_hash_ulong(spans[2]->intrinsics, "ulong", UINT64_MAX);
+  nro_set_hash_int(spans[2]->intrinsics, "int", 300);
+  nro_set_hash_double(spans[2]->agent_attributes, "pi", 3.14159);
+  nro_set_hash_boolean(spans[2]->agent_attributes, "false", false);
+  nro_set_hash_string(spans[2]->user_attributes, "", "");
+  nro_set_hash_none(spans[2]->user_attributes, "none");
+  test_encoder_matches("all value types", encoder, events, 3);
+
+  /*
+   * Test : The buffer grows to fit larger batches, including length prefixes
+   *        that need multiple bytes.
+   */
+  long_string = (char*)nr_malloc(20000);
+  nr_memset(long_string, 'x', 19999);
+  long_string[19999] = '\0';
+  nro_set_hash_string(spans[0]->user_attributes, "long", long_string);
+  test_encoder_matches("large batch", encoder, events, 3);
+  test_encoder_matches("smaller batch after a large batch", encoder,
+                       events + 1, 2);
+  nr_free(long_string);
+
+  nr_span_encoder_destroy(&encoder);
+  tlib_pass_if_null("destroyed encoder", encoder);
+
+  nr_span_event_destroy(&spans[0]);
+  nr_span_event_destroy(&spans[1]);
+  nr_span_event_destroy(&spans[2]);
+}
+#pragma GCC diagnostic pop
+
 static void test_result_deinit(void) {
   nr_span_encoding_result_t result = NR_SPAN_ENCODING_RESULT_INIT;
 
@@ -228,6 +323,15 @@ static void test_result_deinit(void) {
   result.span_count = 1;
   nr_span_encoding_result_deinit(&result);
   tlib_pass_if_null("data pointer", result.data);
+
+  /*
+   * Test : Borrowed result.
+   */
+  result.data = (uint8_t*)&result;
+  result.borrowed = true;
+  nr_span_encoding_result_deinit(&result);
+  tlib_pass_if_null("borrowed data pointer", result.data);
+  tlib_pass_if_bool_equal("borrowed flag", false, result.borrowed);
 }
 
 #define test_encoded_attribute_value(M, OBJ, EXPECTED_TYPE, VALUE_MACRO, \
@@ -310,6 +414,7 @@ tlib_parallel_info_t parallel_info = {.suggested_nthreads = 8, .state_size = 0};
 void test_main(void* p NRUNUSED) {
   test_single();
   test_batch();
+  test_encoder();
   test_result_deinit();
   test_encode_attribute_value();
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "util_memory.h"
+#include "util_sql.h"
+#include "util_sql_cache.h"
+#include "util_strings.h"
+
+#include "tlib_main.h"
+
+#define TEST_SELECT "SELECT * FROM users WHERE id = 42"
+#define TEST_INSERT "INSERT INTO orders (id, total) VALUES (1, 'abc')"
+#define TEST_UPDATE "UPDATE carts SET total = 3 WHERE id = 7"
+
+static void assert_analysis(const char* testname,
+                            const char* sql,
+                            const nr_sql_analysis_t* analysis) {
+  char* obfuscated = nr_sql_obfuscate(sql);
+  const char* operation = NULL;
+  char* table = NULL;
+
+  nr_sql_get_operation_and_table(sql, &operation, &table, 0);
+
+  tlib_pass_if_str_equal(testname, obfuscated, analysis->obfuscated);
+  tlib_pass_if_str_equal(testname, operation, analysis->operation);
+  tlib_pass_if_str_equal(testname, table, analysis->table);
+  tlib_pass_if_uint32_t_equal(testname, nr_sql_normalized_id(obfuscated),
+                              analysis->normalized_id);
+
+  nr_free(obfuscated);
+  nr_free(table);
+}
+
+static void assert_stats(const char* testname,
+                         nr_sql_cache_t* cache,
+                         uint64_t hits,
+                         uint64_t misses,
+                         size_t size) {
+  nr_sql_cache_stats_t stats;
+
+  tlib_pass_if_true(testname, nr_sql_cache_take_stats(cache, &stats),
+                    "expected stats");
+  tlib_pass_if_uint64_t_equal(testname, hits, stats.hits);
+  tlib_pass_if_uint64_t_equal(testname, misses, stats.misses);
+  tlib_pass_if_size_t_equal(testname, size, stats.size);
+}
+
+static void test_bad_parameters(void) {
+  nr_sql_cache_t* cache = NULL;
+  nr_sql_analysis_t analysis;
+  nr_sql_cache_stats_t stats;
+
+  tlib_pass_if_null("zero size", nr_sql_cache_create(0));
+  nr_sql_cache_destroy(NULL);
+  nr_sql_cache_destroy(&cache);
+
+  cache = nr_sql_cache_create(4);
+  tlib_pass_if_false(
+      "NULL sql",
+      nr_sql_analyse(cache, NULL, 0, NR_SQL_ANALYSIS_ALL, &analysis),
+      "expected false");
+  tlib_pass_if_false("NULL analysis",
+                     nr_sql_analyse(cache, TEST_SELECT, 0,
+                                    NR_SQL_ANALYSIS_ALL, NULL),
+                     "expected false");
+  tlib_pass_if_false("NULL cache stats", nr_sql_cache_take_stats(NULL, &stats),
+                     "expected false");
+  tlib_pass_if_false("NULL stats", nr_sql_cache_take_stats(cache, NULL),
+                     "expected false");
+  nr_sql_analysis_deinit(NULL);
+
+  nr_sql_cache_destroy(&cache);
+  tlib_pass_if_null("destroyed", cache);
+}
+
+static void test_analyse_without_cache(void) {
+  nr_sql_analysis_t analysis;
+
+  tlib_pass_if_true(
+      "no cache",
+      nr_sql_analyse(NULL, TEST_SELECT, 0, NR_SQL_ANALYSIS_ALL, &analysis),
+      "expected true");
+  assert_analysis("no cache", TEST_SELECT, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  tlib_pass_if_null("deinit obfuscated", analysis.obfuscated);
+  tlib_pass_if_null("deinit table", analysis.table);
+}
+
+static void test_hits_and_misses(void) {
+  nr_sql_cache_t* cache = nr_sql_cache_create(4);
+  nr_sql_analysis_t analysis;
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    tlib_pass_if_true("select",
+                      nr_sql_analyse(cache, TEST_SELECT, 0,
+                                     NR_SQL_ANALYSIS_ALL, &analysis),
+                      "expected true");
+    assert_analysis("select", TEST_SELECT, &analysis);
+    nr_sql_analysis_deinit(&analysis);
+  }
+
+  tlib_pass_if_true(
+      "insert",
+      nr_sql_analyse(cache, TEST_INSERT, 0, NR_SQL_ANALYSIS_ALL, &analysis),
+      "expected true");
+  assert_analysis("insert", TEST_INSERT, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+
+  assert_stats("hits and misses", cache, 2, 2, 2);
+  assert_stats("stats are reset", cache, 0, 0, 2);
+
+  nr_sql_cache_destroy(&cache);
+}
+
+static void test_lru_eviction(void) {
+  nr_sql_cache_t* cache = nr_sql_cache_create(2);
+  nr_sql_analysis_t analysis;
+
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  nr_sql_analyse(cache, TEST_INSERT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+
+  /* Use the first statement again, so that the second is evicted. */
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  nr_sql_analyse(cache, TEST_UPDATE, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  assert_analysis("update", TEST_UPDATE, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("filled", cache, 1, 3, 2);
+
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  nr_sql_analyse(cache, TEST_UPDATE, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("retained", cache, 2, 0, 2);
+
+  nr_sql_analyse(cache, TEST_INSERT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  assert_analysis("evicted", TEST_INSERT, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("evicted", cache, 0, 1, 2);
+
+  nr_sql_cache_destroy(&cache);
+}
+
+static void test_long_sql(void) {
+  nr_sql_cache_t* cache = nr_sql_cache_create(4);
+  nr_sql_analysis_t analysis;
+  char* sql = (char*)nr_zalloc(NR_SQL_CACHE_MAX_SQL_LEN + 64);
+
+  nr_strcpy(sql, "SELECT * FROM big WHERE name = '");
+  nr_memset(sql + nr_strlen(sql), 'a', NR_SQL_CACHE_MAX_SQL_LEN);
+  nr_strcat(sql, "'");
+
+  tlib_pass_if_true(
+      "long", nr_sql_analyse(cache, sql, 0, NR_SQL_ANALYSIS_ALL, &analysis),
+      "expected true");
+  tlib_pass_if_str_equal("long obfuscated", "SELECT * FROM big WHERE name = ?",
+                         analysis.obfuscated);
+  tlib_pass_if_str_equal("long table", "big", analysis.table);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("long sql is not cached", cache, 0, 0, 0);
+
+  nr_free(sql);
+  nr_sql_cache_destroy(&cache);
+}
+
+static void test_parts(void) {
+  nr_sql_cache_t* cache = nr_sql_cache_create(4);
+  nr_sql_analysis_t analysis;
+
+  /*
+   * Only the operation and table are computed when only they are requested.
+   */
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_OPERATION, &analysis);
+  tlib_pass_if_int_equal("operation parts", NR_SQL_ANALYSIS_OPERATION,
+                         analysis.parts);
+  tlib_pass_if_str_equal("operation", "select", analysis.operation);
+  tlib_pass_if_str_equal("table", "users", analysis.table);
+  tlib_pass_if_null("not obfuscated", analysis.obfuscated);
+  nr_sql_analysis_deinit(&analysis);
+  tlib_pass_if_int_equal("deinit parts", 0, analysis.parts);
+
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_OPERATION, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("operation cached", cache, 1, 1, 1);
+
+  /*
+   * The obfuscated SQL is computed the first time it is requested, and added
+   * to the cached statement.
+   */
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_OBFUSCATED,
+                 &analysis);
+  tlib_pass_if_int_equal("obfuscated parts", NR_SQL_ANALYSIS_OBFUSCATED,
+                         analysis.parts);
+  tlib_pass_if_null("no operation", analysis.operation);
+  tlib_pass_if_str_equal("obfuscated", "SELECT * FROM users WHERE id = ?",
+                         analysis.obfuscated);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("obfuscated computed", cache, 0, 1, 1);
+
+  nr_sql_analyse(cache, TEST_SELECT, 0, NR_SQL_ANALYSIS_ALL, &analysis);
+  assert_analysis("all parts", TEST_SELECT, &analysis);
+  nr_sql_analysis_deinit(&analysis);
+  assert_stats("all parts cached", cache, 1, 0, 1);
+
+  nr_sql_cache_destroy(&cache);
+}
+
+tlib_parallel_info_t parallel_info
+    = {.suggested_nthreads = -1, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_bad_parameters();
+  test_analyse_without_cache();
+  test_hits_and_misses();
+  test_lru_eviction();
+  test_long_sql();
+  test_parts();
+}
@@ -80,6 +80,39 @@ static void test_static_mutex(test_threads_state_t* p) {
                     (int)rv);
 }
 
+static void test_rwlock(void) {
+  nrthread_rwlock_t rwlock;
+  nr_status_t rv;
+
+  rv = nrt_rwlock_init(NULL);
+  tlib_pass_if_status_failure("NULL rwlock init", rv);
+  rv = nrt_rwlock_rdlock(NULL);
+  tlib_pass_if_status_failure("NULL rwlock rdlock", rv);
+
+  rv = nrt_rwlock_init(&rwlock);
+  tlib_pass_if_status_success("rwlock init", rv);
+
+  /*
+   * Any number of readers may hold the lock at once.
+   */
+  rv = nrt_rwlock_rdlock(&rwlock);
+  tlib_pass_if_status_success("first reader", rv);
+  rv = nrt_rwlock_rdlock(&rwlock);
+  tlib_pass_if_status_success("second reader", rv);
+  rv = nrt_rwlock_unlock(&rwlock);
+  tlib_pass_if_status_success("second reader unlock", rv);
+  rv = nrt_rwlock_unlock(&rwlock);
+  tlib_pass_if_status_success("first reader unlock", rv);
+
+  rv = nrt_rwlock_wrlock(&rwlock);
+  tlib_pass_if_status_success("writer", rv);
+  rv = nrt_rwlock_unlock(&rwlock);
+  tlib_pass_if_status_success("writer unlock", rv);
+
+  rv = nrt_rwlock_destroy(&rwlock);
+  tlib_pass_if_status_success("rwlock destroy", rv);
+}
+
 /*
  * The test itself is crafted to test parallelism.
  *
@@ -106,6 +139,7 @@ void test_main(void* vp) {
   nrl_set_log_level("verbosedebug");
 
   test_static_mutex(p);
+  test_rwlock();
 
   /*
    * Test 3: initialize a mutex (will have deadlock avoidance)
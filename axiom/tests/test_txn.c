@@ -160,13 +160,18 @@ static void test_freeze_name_fn(const char* testname,
                                 const char* file,
                                 int line) {
   nr_status_t rv;
+  nr_status_t rv2;
   nrtxn_t txnv;
   nrtxn_t* txn = &txnv;
   nrapp_t appv = {.info = {0}};
   nrapp_t* app = &appv;
   test_txn_state_t* p = (test_txn_state_t*)tlib_getspecific();
+  char* first_path;
+  char* first_name;
+  int first_ignore;
 
   nrt_mutex_init(&app->app_lock, 0);
+  app->txn_name_cache = nr_txn_name_cache_create(NR_APP_TXN_NAME_CACHE_SIZE);
   txn->app_connect_reply = 0;
   p->txns_app = app;
 
@@ -230,11 +235,40 @@ static void test_freeze_name_fn(const char* testname,
                       NRSAFESTR(txn->name));
   }
 
+  /*
+   * Freezing the same path again must give the same result from the
+   * application's naming cache.
+   */
+  test_pass_if_true(testname, 1 == nr_txn_name_cache_size(app->txn_name_cache),
+                    "size=%zu", nr_txn_name_cache_size(app->txn_name_cache));
+  first_path = txn->path;
+  first_name = txn->name;
+  first_ignore = txn->status.ignore;
+  txn->path = nr_strdup(path);
+  txn->name = 0;
+  txn->status.ignore = 0;
+  txn->status.path_is_frozen = 0;
+
+  rv2 = nr_txn_freeze_name_update_apdex(txn);
+  test_pass_if_true(testname, rv == rv2, "rv=%d rv2=%d", (int)rv, (int)rv2);
+  test_pass_if_true(testname, first_ignore == txn->status.ignore,
+                    "first_ignore=%d ignore=%d", first_ignore,
+                    txn->status.ignore);
+  test_pass_if_true(testname, 0 == nr_strcmp(first_name, txn->name),
+                    "first_name=%s cached_name=%s", NRSAFESTR(first_name),
+                    NRSAFESTR(txn->name));
+  test_pass_if_true(testname, 0 == nr_strcmp(first_path, txn->path),
+                    "first_path=%s cached_path=%s", NRSAFESTR(first_path),
+                    NRSAFESTR(txn->path));
+
+  nr_free(first_path);
+  nr_free(first_name);
   nr_free(txn->path);
   nr_free(txn->name);
   nr_rules_destroy(&app->url_rules);
   nr_rules_destroy(&app->txn_rules);
   nr_segment_terms_destroy(&app->segment_terms);
+  nr_txn_name_cache_destroy(&app->txn_name_cache);
   nrt_mutex_destroy(&app->app_lock);
 }
 
@@ -2129,6 +2163,7 @@ static void test_end(void) {
   nrapp_t appv = {.info = {0}};
   nrapp_t* app = &appv;
   nrobj_t* rules_ob;
+  nrobj_t* obj;
   nrtime_t duration;
   test_txn_state_t* p = (test_txn_state_t*)tlib_getspecific();
 
@@ -2302,6 +2337,47 @@ static void test_end(void) {
   tlib_pass_if_time_equal("duration is manually retimed", duration, 1000000);
   nr_txn_destroy(&txn);
 
+  /*
+   * Test : Overhead metrics and attribute disabled
+   */
+  txn = create_full_txn_and_reset(app);
+  nr_txn_end(txn);
+  tlib_pass_if_uint64_t_equal(
+      "segment tree finalise timed", 1,
+      txn->overhead.timers[NR_OVERHEAD_SEGMENT_FINALISE].count);
+  tlib_pass_if_null("no overhead metric",
+                    nrm_find(txn->unscoped_metrics,
+                             "Supportability/PHP/Overhead/SegmentTreeFinalise"));
+  obj = nr_attributes_agent_to_obj(txn->attributes,
+                                   NR_ATTRIBUTE_DESTINATION_TXN_EVENT);
+  tlib_pass_if_null("no overhead attribute",
+                    nro_get_hash_value(obj, "agent.overheadMicros", NULL));
+  nro_delete(obj);
+  nr_txn_destroy(&txn);
+
+  /*
+   * Test : Overhead metrics and attribute enabled
+   */
+  txn = create_full_txn_and_reset(app);
+  txn->options.overhead_metrics_enabled = true;
+  txn->options.overhead_attribute_enabled = true;
+  nr_overhead_add(&txn->overhead, NR_OVERHEAD_TXN_BEGIN, 5);
+  nr_txn_end(txn);
+  tlib_pass_if_not_null("TxnBegin overhead metric",
+                        nrm_find(txn->unscoped_metrics,
+                                 "Supportability/PHP/Overhead/TxnBegin"));
+  tlib_pass_if_not_null(
+      "SegmentTreeFinalise overhead metric",
+      nrm_find(txn->unscoped_metrics,
+               "Supportability/PHP/Overhead/SegmentTreeFinalise"));
+  obj = nr_attributes_agent_to_obj(txn->attributes,
+                                   NR_ATTRIBUTE_DESTINATION_TXN_EVENT);
+  tlib_pass_if_long_equal(
+      "overhead attribute", (long)nr_overhead_total(&txn->overhead),
+      nro_get_hash_long(obj, "agent.overheadMicros", NULL));
+  nro_delete(obj);
+  nr_txn_destroy(&txn);
+
   nr_random_destroy(&app->rnd);
   nr_rules_destroy(&app->url_rules);
   nr_rules_destroy(&app->txn_rules);
@@ -4702,7 +4778,7 @@ static void test_txn_dt_cross_agent_testcase(nrapp_t* app,
   size = nro_getsize(outbound_payloads);
   for (int i = 1; i <= size; i++) {
     const nrobj_t* spec = nro_get_array_hash(outbound_payloads, i, NULL);
-    nr_segment_t segment = {.id = NULL, .txn = txn};
+    nr_segment_t segment = {.txn = txn};
     char* payload = nr_txn_create_distributed_trace_payload(txn, &segment);
     nrobj_t* json_payload = nro_create_from_json(payload);
     const nrobj_t* json_payload_d = nro_get_hash_value(json_payload, "d", NULL);
@@ -4716,7 +4792,6 @@ static void test_txn_dt_cross_agent_testcase(nrapp_t* app,
     test_txn_dt_cross_agent_intrinsics(testname, "outbound payload",
                                        json_payload, spec);
 
-    nr_free(segment.id);
     nro_delete(json_payload);
     nr_free(payload);
   }
@@ -4968,7 +5043,7 @@ static void test_txn_trace_context_cross_agent_testcase(nrapp_t* app,
   size = nro_getsize(outbound_payloads);
   for (int i = 1; i <= size; i++) {
     const nrobj_t* spec = nro_get_array_hash(outbound_payloads, i, NULL);
-    nr_segment_t segment = {.id = NULL, .txn = txn};
+    nr_segment_t segment = {.txn = txn};
     char* payload = nr_txn_create_distributed_trace_payload(txn, &segment);
     char* traceparent = nr_txn_create_w3c_traceparent_header(txn, &segment);
     char* tracestate = nr_txn_create_w3c_tracestate_header(txn, &segment);
@@ -4999,7 +5074,6 @@ static void test_txn_trace_context_cross_agent_testcase(nrapp_t* app,
     test_txn_dt_cross_agent_intrinsics(testname, "outbound payload",
                                        json_payload, spec);
 
-    nr_free(segment.id);
     nro_delete(nr_payload);
     nro_delete(json_payload);
     nro_delete(w3c_payload);
@@ -5791,8 +5865,8 @@ static void test_create_distributed_trace_payload(void) {
   test_txn_metric_is("success", txn.unscoped_metrics, MET_FORCED,
                      "Supportability/DistributedTrace/CreatePayload/Success", 2,
                      0, 0, 0, 0, 0);
-  tlib_pass_if_null("The guid should be empty when dt sampled is off",
-                    current_segment->id);
+  tlib_pass_if_str_equal("The guid should be empty when dt sampled is off",
+                         "", current_segment->id);
   nr_free(text);
 
   /*
@@ -5801,8 +5875,8 @@ static void test_create_distributed_trace_payload(void) {
   txn.distributed_trace->sampled = true;
 
   text = nr_txn_create_distributed_trace_payload(&txn, current_segment);
-  tlib_fail_if_null("The segment ID should be set when DT sampled is on",
-                    current_segment->id);
+  tlib_pass_if_int_equal("The segment ID should be set when DT sampled is on",
+                         NR_GUID_SIZE, nr_strlen(current_segment->id));
   tlib_pass_if_true("The segment priority should be set  when DT sampled is on",
                     current_segment->priority & NR_SEGMENT_PRIORITY_DT,
                     "priority=0x%08x", current_segment->priority);
@@ -5885,7 +5959,7 @@ static void test_create_w3c_tracestate_header(void) {
    * Test : valid segment NULL transaction
    */
   segment = nr_malloc(sizeof(nr_segment_t));
-  segment->id = NULL;
+  segment->id[0] = '\0';
   tlib_pass_if_null("txn is null",
                     nr_txn_create_w3c_tracestate_header(NULL, segment));
 
@@ -5907,7 +5981,7 @@ static void test_create_w3c_tracestate_header(void) {
   txn.distributed_trace->priority = .77;
 
   txn.distributed_trace->txn_id = nr_strdup("txnId");
-  segment->id = "spanId";
+  nr_strcpy(segment->id, "spanId");
 
   /*
    * Test : analytics events off
@@ -5933,7 +6007,7 @@ static void test_create_w3c_tracestate_header(void) {
    * Test : NULL spanId and txnId
    */
   txn.options.span_events_enabled = true;
-  segment->id = NULL;
+  segment->id[0] = '\0';
   nr_free(txn.distributed_trace->txn_id);
   txn.distributed_trace->txn_id = NULL;
   actual = nr_txn_create_w3c_tracestate_header(&txn, segment);
@@ -5958,7 +6032,7 @@ static void test_create_w3c_traceparent_header(void) {
                     nr_txn_create_w3c_traceparent_header(NULL, segment));
 
   segment = nr_malloc(sizeof(nr_segment_t));
-  segment->id = NULL;
+  segment->id[0] = '\0';
 
   /*
    * Test : No txn and valid span
@@ -6016,7 +6090,7 @@ static void test_create_w3c_traceparent_header(void) {
   /*
    * Test : valid string span guid
    */
-  segment->id = nr_strdup("currentspan");
+  nr_strcpy(segment->id, "currentspan");
   actual = nr_txn_create_w3c_traceparent_header(&txn, segment);
   expected = "00-0000000000000000000000meatballs!-currentspan-01";
   tlib_pass_if_str_equal("currentspan guid true flag", expected, actual);
@@ -6037,7 +6111,6 @@ static void test_create_w3c_traceparent_header(void) {
                      0, 0);
   nr_free(actual);
 
-  nr_free(segment->id);
   nr_free(segment);
   nr_random_destroy(&txn.rnd);
   nr_txn_destroy_fields(&txn);
@@ -7341,6 +7414,27 @@ static void test_should_create_span_events(void) {
   nr_span_queue_destroy(&queue);
 }
 
+static void test_span_events_limit(void) {
+  nrtxn_t txn = {.options = {.span_events_max_samples_stored = 0}};
+
+  tlib_pass_if_size_t_equal("NULL txn",
+                            NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED,
+                            nr_txn_span_events_limit(NULL));
+  tlib_pass_if_size_t_equal("unset option",
+                            NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED,
+                            nr_txn_span_events_limit(&txn));
+
+  txn.options.span_events_max_samples_stored = 500;
+  tlib_pass_if_size_t_equal("option in range", 500,
+                            nr_txn_span_events_limit(&txn));
+
+  txn.options.span_events_max_samples_stored
+      = NR_MAX_SPAN_EVENTS_MAX_SAMPLES_STORED + 1;
+  tlib_pass_if_size_t_equal("option out of range",
+                            NR_DEFAULT_SPAN_EVENTS_MAX_SAMPLES_STORED,
+                            nr_txn_span_events_limit(&txn));
+}
+
 static void test_txn_accept_distributed_trace_payload_optionals(void) {
   char* json_payload_missing
       = "{ \
@@ -8469,6 +8563,108 @@ static void test_record_log_event(void) {
   nr_txn_destroy(&txn);
 }
 
+static void test_record_log_event_admission(void) {
+  nrapp_t appv = {.host_name = APP_HOST_NAME, .entity_guid = APP_ENTITY_GUID};
+  nrtxn_t* txn = NULL;
+  nr_log_event_t* e = NULL;
+  nr_vector_t* vector;
+  void* test_e;
+  char* log_event_json = NULL;
+
+  /*
+   * Admission check
+   */
+  tlib_pass_if_false("NULL txn not kept",
+                     nr_txn_log_forwarding_would_keep(NULL, LOG_LEVEL),
+                     "expected false");
+
+  txn = new_txn_for_record_log_event_test(APP_ENTITY_NAME);
+  tlib_pass_if_true("empty pool keeps",
+                    nr_txn_log_forwarding_would_keep(txn, LOG_LEVEL),
+                    "expected true");
+  tlib_pass_if_false("filtered log level not kept",
+                     nr_txn_log_forwarding_would_keep(txn, LL_DEBU_STR),
+                     "expected false");
+
+  /* fill the pool with events that outrank anything the txn can create */
+  for (int i = 0, max_events = nr_log_events_max_events(txn->log_events);
+       i < max_events; i++) {
+    e = nr_log_event_create();
+    nr_log_event_set_message(e, LOG_MESSAGE);
+    nr_log_event_set_priority(e, NR_SEGMENT_PRIORITY_ROOT << 1);
+    nr_log_events_add_event(txn->log_events, e);
+  }
+  tlib_pass_if_false("full pool of higher priority events not kept",
+                     nr_txn_log_forwarding_would_keep(txn, LOG_LEVEL),
+                     "expected false");
+
+  /* an empty message is ignored, even when it would be rejected */
+  nr_txn_record_log_event(txn, LOG_LEVEL, NULL, 0, NULL, &appv);
+  tlib_pass_if_size_t_equal("empty message not seen",
+                            nr_log_events_max_events(txn->log_events),
+                            nr_log_events_number_seen(txn->log_events));
+
+  /* a rejected event is seen and dropped without being built */
+  nr_txn_record_log_event(txn, LOG_LEVEL, LOG_MESSAGE, 0, NULL, &appv);
+  tlib_pass_if_true(
+      "rejected event flags the segment",
+      nr_segment_get_priority_flag(nr_txn_get_current_segment(txn, NULL))
+          & NR_SEGMENT_PRIORITY_LOG,
+      "priority=%d",
+      nr_segment_get_priority_flag(nr_txn_get_current_segment(txn, NULL)));
+  tlib_pass_if_size_t_equal(
+      "rejected event seen",
+      nr_log_events_max_events(txn->log_events) + 1,
+      nr_log_events_number_seen(txn->log_events));
+  tlib_pass_if_size_t_equal("rejected event not saved",
+                            nr_log_events_max_events(txn->log_events),
+                            nr_log_events_number_saved(txn->log_events));
+  test_txn_metric_is("rejected event dropped", txn->unscoped_metrics,
+                     MET_FORCED, "Logging/Forwarding/Dropped", 1, 0, 0, 0, 0,
+                     0);
+  nr_txn_destroy(&txn);
+
+  /*
+   * Per-request cap
+   */
+  txn = new_txn_for_record_log_event_test(APP_ENTITY_NAME);
+  txn->options.log_forwarding_max_per_request = 3;
+  for (int i = 0; i < 5; i++) {
+    nr_txn_record_log_event(txn, LOG_EVENT_PARAMS, NULL, &appv);
+  }
+  tlib_pass_if_false("capped txn not kept",
+                     nr_txn_log_forwarding_would_keep(txn, LOG_LEVEL),
+                     "expected false");
+  tlib_pass_if_size_t_equal("capped events seen", 5,
+                            nr_log_events_number_seen(txn->log_events));
+  tlib_pass_if_size_t_equal("capped events saved", 3,
+                            nr_log_events_number_saved(txn->log_events));
+  test_txn_metric_is("capped events dropped", txn->unscoped_metrics,
+                     MET_FORCED, "Logging/Forwarding/Dropped", 2, 0, 0, 0, 0,
+                     0);
+  nr_txn_destroy(&txn);
+
+  /*
+   * Message truncation
+   */
+  txn = new_txn_for_record_log_event_test(APP_ENTITY_NAME);
+  txn->options.log_forwarding_max_message_length = 6;
+  nr_txn_record_log_event(txn, LOG_LEVEL, LOG_MESSAGE, 0, NULL, NULL);
+
+  vector = nr_vector_create(10, NULL, NULL);
+  nr_log_events_to_vector(txn->log_events, vector);
+  tlib_pass_if_true("retrieved log element from vector OK",
+                    nr_vector_get_element(vector, 0, &test_e),
+                    "expected TRUE");
+  log_event_json = nr_log_event_to_json((nr_log_event_t*)test_e);
+  tlib_pass_if_not_null("truncated message, json", log_event_json);
+  tlib_pass_if_not_null("truncated message",
+                        nr_strstr(log_event_json, "\"message\":\"Sample\","));
+  nr_free(log_event_json);
+  nr_vector_destroy(&vector);
+  nr_txn_destroy(&txn);
+}
+
 static void test_txn_log_configuration(void) {
   // clang-format off
   nrtxn_t txnv;
@@ -8860,6 +9056,7 @@ void test_main(void* p NRUNUSED) {
   test_default_trace_id();
   test_root_segment_priority();
   test_should_create_span_events();
+  test_span_events_limit();
   test_parent_stacks();
   test_force_current_segment();
   test_txn_is_sampled();
@@ -8879,6 +9076,7 @@ void test_main(void* p NRUNUSED) {
   test_segment_record_error();
   test_log_level_verify();
   test_record_log_event();
+  test_record_log_event_admission();
   test_txn_log_configuration();
   test_nr_txn_add_php_package();
   test_nr_txn_add_php_package_from_source();
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "nr_txn_name_cache.h"
+#include "util_memory.h"
+#include "util_strings.h"
+
+#include "tlib_main.h"
+
+#define KEY(S) (S), nr_strlen(S)
+
+static void test_bad_parameters(void) {
+  nr_txn_name_cache_t* cache = NULL;
+  const char* path = NULL;
+  const char* name = NULL;
+  bool ignore = false;
+
+  tlib_pass_if_null("zero size", nr_txn_name_cache_create(0));
+  nr_txn_name_cache_destroy(NULL);
+  nr_txn_name_cache_destroy(&cache);
+  nr_txn_name_cache_clear(NULL);
+  nr_txn_name_cache_set(NULL, KEY("k"), "p", "n", false);
+  tlib_pass_if_false("NULL cache",
+                     nr_txn_name_cache_get(NULL, KEY("k"), &path, &name,
+                                           &ignore),
+                     "expected false");
+  tlib_pass_if_size_t_equal("NULL cache", 0, nr_txn_name_cache_size(NULL));
+
+  cache = nr_txn_name_cache_create(4);
+  nr_txn_name_cache_set(cache, NULL, 0, "p", "n", false);
+  tlib_pass_if_size_t_equal("NULL key", 0, nr_txn_name_cache_size(cache));
+  nr_txn_name_cache_set(cache, KEY("k"), "p", "n", false);
+  tlib_pass_if_false("NULL key",
+                     nr_txn_name_cache_get(cache, NULL, 0, &path, &name,
+                                           &ignore),
+                     "expected false");
+  tlib_pass_if_false("NULL path",
+                     nr_txn_name_cache_get(cache, KEY("k"), NULL, &name,
+                                           &ignore),
+                     "expected false");
+  tlib_pass_if_false("NULL name",
+                     nr_txn_name_cache_get(cache, KEY("k"), &path, NULL,
+                                           &ignore),
+                     "expected false");
+  tlib_pass_if_false("NULL ignore",
+                     nr_txn_name_cache_get(cache, KEY("k"), &path, &name,
+                                           NULL),
+                     "expected false");
+
+  nr_txn_name_cache_destroy(&cache);
+  tlib_pass_if_null("destroyed", cache);
+}
+
+static void test_get_set(void) {
+  nr_txn_name_cache_t* cache = nr_txn_name_cache_create(4);
+  char long_key[NR_TXN_NAME_CACHE_MAX_KEY_LEN + 2];
+  const char* path = NULL;
+  const char* name = NULL;
+  bool ignore = false;
+
+  tlib_pass_if_false("miss",
+                     nr_txn_name_cache_get(cache, KEY("1:0:p/foo"), &path,
+                                           &name, &ignore),
+                     "expected false");
+
+  nr_txn_name_cache_set(cache, KEY("1:0:p/foo"), "foo",
+                        "WebTransaction/Uri/foo", false);
+  tlib_pass_if_true("hit",
+                    nr_txn_name_cache_get(cache, KEY("1:0:p/foo"), &path,
+                                          &name, &ignore),
+                    "expected true");
+  tlib_pass_if_str_equal("hit path", "foo", path);
+  tlib_pass_if_str_equal("hit name", "WebTransaction/Uri/foo", name);
+  tlib_pass_if_false("hit ignore", ignore, "expected false");
+
+  /*
+   * Keys are compared in full, not as prefixes.
+   */
+  tlib_pass_if_false("prefix",
+                     nr_txn_name_cache_get(cache, KEY("1:0:p/fo"), &path,
+                                           &name, &ignore),
+                     "expected false");
+
+  /*
+   * NULL strings and ignored transactions are remembered as such.
+   */
+  nr_txn_name_cache_set(cache, KEY("0:1:n"), NULL, NULL, true);
+  tlib_pass_if_true("ignored",
+                    nr_txn_name_cache_get(cache, KEY("0:1:n"), &path, &name,
+                                          &ignore),
+                    "expected true");
+  tlib_pass_if_null("ignored path", path);
+  tlib_pass_if_null("ignored name", name);
+  tlib_pass_if_true("ignored", ignore, "expected true");
+
+  /*
+   * Setting an existing key replaces its result.
+   */
+  nr_txn_name_cache_set(cache, KEY("1:0:p/foo"), "bar",
+                        "WebTransaction/Uri/bar", false);
+  tlib_pass_if_size_t_equal("replaced", 2, nr_txn_name_cache_size(cache));
+  nr_txn_name_cache_get(cache, KEY("1:0:p/foo"), &path, &name, &ignore);
+  tlib_pass_if_str_equal("replaced", "WebTransaction/Uri/bar", name);
+
+  /*
+   * Overly long keys are not cached.
+   */
+  nr_memset(long_key, 'x', sizeof(long_key));
+  long_key[sizeof(long_key) - 1] = '\0';
+  nr_txn_name_cache_set(cache, KEY(long_key), "p", "n", false);
+  tlib_pass_if_size_t_equal("long key", 2, nr_txn_name_cache_size(cache));
+
+  nr_txn_name_cache_clear(cache);
+  tlib_pass_if_size_t_equal("cleared", 0, nr_txn_name_cache_size(cache));
+  tlib_pass_if_false("cleared",
+                     nr_txn_name_cache_get(cache, KEY("1:0:p/foo"), &path,
+                                           &name, &ignore),
+                     "expected false");
+
+  nr_txn_name_cache_destroy(&cache);
+}
+
+static void test_eviction(void) {
+  nr_txn_name_cache_t* cache = nr_txn_name_cache_create(2);
+  const char* path = NULL;
+  const char* name = NULL;
+  bool ignore = false;
+
+  nr_txn_name_cache_set(cache, KEY("a"), "a", "A", false);
+  nr_txn_name_cache_set(cache, KEY("b"), "b", "B", false);
+
+  /*
+   * Using "a" makes "b" the least recently used.
+   */
+  nr_txn_name_cache_get(cache, KEY("a"), &path, &name, &ignore);
+  nr_txn_name_cache_set(cache, KEY("c"), "c", "C", false);
+
+  tlib_pass_if_size_t_equal("bounded", 2, nr_txn_name_cache_size(cache));
+  tlib_pass_if_true("a kept",
+                    nr_txn_name_cache_get(cache, KEY("a"), &path, &name,
+                                          &ignore),
+                    "expected true");
+  tlib_pass_if_false("b evicted",
+                     nr_txn_name_cache_get(cache, KEY("b"), &path, &name,
+                                           &ignore),
+                     "expected false");
+  tlib_pass_if_true("c kept",
+                    nr_txn_name_cache_get(cache, KEY("c"), &path, &name,
+                                          &ignore),
+                    "expected true");
+
+  nr_txn_name_cache_destroy(&cache);
+}
+
+tlib_parallel_info_t parallel_info = {.suggested_nthreads = 2, .state_size = 0};
+
+void test_main(void* p NRUNUSED) {
+  test_bad_parameters();
+  test_get_set();
+  test_eviction();
+}
@@ -57,6 +57,8 @@ struct _nr_flatbuffer_t {
   uint32_t* vtables;
   int vtables_len;
   int vtables_cap;
+
+  size_t grows; /* Times the contents were reallocated since the last reset */
 };
 
 /* Number of metadata fields in each vtable. */
@@ -94,6 +96,41 @@ size_t nr_flatbuffers_len(const nr_flatbuffer_t* fb) {
   return 0;
 }
 
+size_t nr_flatbuffers_capacity(const nr_flatbuffer_t* fb) {
+  if (fb) {
+    return (size_t)(fb->back - fb->front);
+  }
+  return 0;
+}
+
+size_t nr_flatbuffers_grows(const nr_flatbuffer_t* fb) {
+  if (fb) {
+    return fb->grows;
+  }
+  return 0;
+}
+
+void nr_flatbuffers_reset(nr_flatbuffer_t* fb) {
+  if (NULL == fb) {
+    return;
+  }
+
+  /*
+   * Space that has never been written is zeroed, so clear what has been
+   * written to return the buffer to the state of a new one.
+   */
+  if (fb->pos) {
+    nr_memset(fb->pos, 0, nr_flatbuffers_len(fb));
+  }
+  fb->pos = fb->back;
+  fb->min_align = 1;
+  fb->inside_object = 0;
+  fb->object_end = 0;
+  fb->vtable_len = 0;
+  fb->vtables_len = 0;
+  fb->grows = 0;
+}
+
 void nr_flatbuffers_destroy(nr_flatbuffer_t** fb_ptr) {
   nr_flatbuffer_t* fb;
 
@@ -297,6 +334,7 @@ static void nr_flatbuffers_grow(nr_flatbuffer_t* fb) {
   fb->front = new_front;
   fb->back = fb->front + new_size;
   fb->pos = fb->back - used;
+  fb->grows++;
 }
 
 void nr_flatbuffers_prep(nr_flatbuffer_t* fb,
@@ -38,7 +38,9 @@ typedef struct {
 /*
  * Purpose : Returns a new buffer with the given initial capacity.
  *
- * Params  : 1. The initial capacity in bytes.
+ * Params  : 1. The initial capacity in bytes. Contents are aligned relative
+ *              to the end of the buffer's memory, so this must be zero or a
+ *              power of two.
  *
  * Returns : A new, empty buffer.
  */
@@ -62,6 +64,25 @@ extern const uint8_t* nr_flatbuffers_data(const nr_flatbuffer_t* fb);
  */
 extern size_t nr_flatbuffers_len(const nr_flatbuffer_t* fb);
 
+/*
+ * Purpose : Returns the number of bytes allocated for the buffer.
+ */
+extern size_t nr_flatbuffers_capacity(const nr_flatbuffer_t* fb);
+
+/*
+ * Purpose : Returns the number of times the buffer has been reallocated to
+ *           make room for its contents since it was created or last reset.
+ */
+extern size_t nr_flatbuffers_grows(const nr_flatbuffer_t* fb);
+
+/*
+ * Purpose : Empties a buffer so that it can be reused, keeping the memory
+ *           allocated for it.
+ *
+ * Params  : 1. The flatbuffer.
+ */
+extern void nr_flatbuffers_reset(nr_flatbuffer_t* fb);
+
 /*
  * Purpose : Prepares to write an element of `size` bytes after
  *           `additional_bytes` have been written. If all you need to do
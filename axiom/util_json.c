@@ -8,9 +8,134 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define NR_JSON_ESCAPE_X86 1
+#endif
+
 #include "util_json.h"
+#include "util_json_private.h"
+#include "util_memory.h"
+#include "util_strings.h"
+
+/*
+ * Bytes that are copied to escaped JSON unchanged: printable ASCII other than
+ * the quote, backslash and slash.
+ */
+static const uint8_t nr_json_clean_bytes[256] = {
+    [0x20 ... 0x21] = 1,
+    [0x23 ... 0x2e] = 1,
+    [0x30 ... 0x5b] = 1,
+    [0x5d ... 0x7e] = 1,
+};
+
+size_t nr_json_clean_span_scalar(const char* str, size_t len) {
+  const unsigned char* s = (const unsigned char*)str;
+  size_t i = 0;
+
+  while (i < len && nr_json_clean_bytes[s[i]]) {
+    i++;
+  }
+
+  return i;
+}
+
+#ifdef NR_JSON_ESCAPE_X86
+/*
+ * The vector versions compare signed bytes: a byte is clean if it is greater
+ * than 0x1f and less than 0x7f, which excludes control characters and every
+ * byte with the high bit set, and is not one of the three special characters.
+ */
+size_t nr_json_clean_span_sse2(const char* str, size_t len) {
+  const __m128i low = _mm_set1_epi8(0x1f);
+  const __m128i high = _mm_set1_epi8(0x7f);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i slash = _mm_set1_epi8('/');
+  size_t i;
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+    __m128i clean
+        = _mm_and_si128(_mm_cmpgt_epi8(v, low), _mm_cmplt_epi8(v, high));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+        _mm_cmpeq_epi8(v, slash));
+    unsigned int mask
+        = (unsigned int)_mm_movemask_epi8(_mm_andnot_si128(special, clean));
+
+    if (0xffff != mask) {
+      return i + (size_t)__builtin_ctz(~mask);
+    }
+  }
+
+  return i + nr_json_clean_span_scalar(str + i, len - i);
+}
+
+__attribute__((target("avx2"))) size_t nr_json_clean_span_avx2(
+    const char* str,
+    size_t len) {
+  const __m256i low = _mm256_set1_epi8(0x1f);
+  const __m256i high = _mm256_set1_epi8(0x7f);
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i slash = _mm256_set1_epi8('/');
+  size_t i;
+
+  for (i = 0; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(str + i));
+    __m256i clean = _mm256_and_si256(_mm256_cmpgt_epi8(v, low),
+                                     _mm256_cmpgt_epi8(high, v));
+    __m256i special = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                        _mm256_cmpeq_epi8(v, backslash)),
+        _mm256_cmpeq_epi8(v, slash));
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+        _mm256_andnot_si256(special, clean));
+
+    if (0xffffffff != mask) {
+      return i + (size_t)__builtin_ctz(~mask);
+    }
+  }
+
+  return i + nr_json_clean_span_sse2(str + i, len - i);
+}
+#endif /* NR_JSON_ESCAPE_X86 */
+
+nr_json_clean_span_t nr_json_clean_span_best(void) {
+#ifdef NR_JSON_ESCAPE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return nr_json_clean_span_avx2;
+  }
+  return nr_json_clean_span_sse2;
+#else
+  return nr_json_clean_span_scalar;
+#endif
+}
+
+/*
+ * The implementation is chosen on first use. Threads racing to do so will
+ * all store the same value.
+ */
+static size_t nr_json_clean_span_resolve(const char* str, size_t len);
+
+static nr_json_clean_span_t nr_json_clean_span = nr_json_clean_span_resolve;
+
+static size_t nr_json_clean_span_resolve(const char* str, size_t len) {
+  nr_json_clean_span = nr_json_clean_span_best();
+
+  return nr_json_clean_span(str, len);
+}
 
 int nr_json_escape(char* dest, const char* json) {
+  return nr_json_escape_with(dest, json, nr_json_clean_span);
+}
+
+int nr_json_escape_with(char* dest,
+                        const char* json,
+                        nr_json_clean_span_t clean_span) {
+  const char* end;
   char* ep;
 
   if (0 == json) {
@@ -25,7 +150,20 @@ int nr_json_escape(char* dest, const char* json) {
   *ep = '"';
   ep++;
 
+  end = json + nr_strlen(json);
   while (*json) {
+    size_t clean = clean_span(json, (size_t)(end - json));
+
+    /* Copy runs of bytes that need no escaping in bulk. */
+    if (clean) {
+      nr_memcpy(ep, json, clean);
+      ep += clean;
+      json += clean;
+      if (0 == *json) {
+        break;
+      }
+    }
+
     switch (*json) {
       case '"':
         *ep = '\\';
@@ -217,3 +355,101 @@ int nr_json_escape(char* dest, const char* json) {
 
   return ep - dest;
 }
+
+static unsigned nr_json_hex_digit(char c) {
+  if ((c >= '0') && (c <= '9')) {
+    return (unsigned)(c - '0');
+  }
+  if ((c >= 'a') && (c <= 'f')) {
+    return (unsigned)(c - 'a' + 10);
+  }
+  if ((c >= 'A') && (c <= 'F')) {
+    return (unsigned)(c - 'A' + 10);
+  }
+  return 16;
+}
+
+size_t nr_json_unescape(char* dest, const char* src, size_t len) {
+  const char* end = src + len;
+  char* dp = dest;
+
+  if (NULL == dest) {
+    return 0;
+  }
+  if (NULL == src) {
+    *dest = 0;
+    return 0;
+  }
+
+  while (src < end) {
+    const char* escape = (const char*)nr_memchr(src, '\\', end - src);
+    unsigned uc = 0;
+    int i;
+
+    if (NULL == escape) {
+      escape = end;
+    }
+
+    /* Copy runs of bytes that need no decoding in bulk. */
+    nr_memcpy(dp, src, escape - src);
+    dp += escape - src;
+    src = escape + 1;
+    if (src >= end) {
+      break;
+    }
+
+    switch (*src) {
+      case 'b':
+        *dp++ = '\b';
+        break;
+
+      case 'f':
+        *dp++ = '\f';
+        break;
+
+      case 'n':
+        *dp++ = '\n';
+        break;
+
+      case 'r':
+        *dp++ = '\r';
+        break;
+
+      case 't':
+        *dp++ = '\t';
+        break;
+
+      case 'u':
+        /* Transcode UTF-16 to UTF-8, one code unit at a time. */
+        for (i = 0; (i < 4) && (src + 1 < end); i++) {
+          unsigned digit = nr_json_hex_digit(src[1]);
+
+          if (digit > 15) {
+            break;
+          }
+          uc = (uc << 4) | digit;
+          src++;
+        }
+        if (uc < 0x80) {
+          *dp++ = (char)uc;
+        } else if (uc < 0x800) {
+          *dp++ = (char)(0xC0 | (uc >> 6));
+          *dp++ = (char)(0x80 | (uc & 0x3F));
+        } else {
+          *dp++ = (char)(0xE0 | (uc >> 12));
+          *dp++ = (char)(0x80 | ((uc >> 6) & 0x3F));
+          *dp++ = (char)(0x80 | (uc & 0x3F));
+        }
+        break;
+
+      default:
+        /* Quotes, backslashes, slashes, and anything unexpected. */
+        *dp++ = *src;
+        break;
+    }
+    src++;
+  }
+
+  *dp = 0;
+  return dp - dest;
+}
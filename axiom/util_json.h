@@ -4,11 +4,14 @@
  */
 
 /*
- * This file contains a function to format an escaped JSON string.
+ * This file contains functions to format an escaped JSON string, and to
+ * decode one.
  */
 #ifndef UTIL_JSON_HDR
 #define UTIL_JSON_HDR
 
+#include <stddef.h>
+
 /*
  * Purpose : Produce a well-formed JSON string that is correctly escaped. The
  *           DEST must be large enough to accommodate the full string (so it
@@ -23,4 +26,20 @@
  */
 extern int nr_json_escape(char* dest, const char* json);
 
+/*
+ * Purpose : Decode the contents of a JSON string, replacing escape sequences
+ *           with the characters they represent. \u escapes are transcoded to
+ *           UTF-8; surrogate pairs are not combined. The DEST must be at least
+ *           one byte longer than the source, as decoding never lengthens a
+ *           string. A NUL terminator is written to the end of the result.
+ *
+ * Returns : The number of characters written to DEST, NOT including the NUL
+ *           terminator.
+ *
+ * Params  : 1. The destination buffer.
+ *           2. The string contents, without the surrounding quotes.
+ *           3. The length of the string contents.
+ */
+extern size_t nr_json_unescape(char* dest, const char* src, size_t len);
+
 #endif /* UTIL_JSON_HDR */
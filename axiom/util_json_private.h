@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains the building blocks of JSON string escaping, exposed for
+ * testing.
+ */
+#ifndef UTIL_JSON_PRIVATE_HDR
+#define UTIL_JSON_PRIVATE_HDR
+
+#include <stddef.h>
+
+/*
+ * A function that returns the length of the prefix of a string, of the given
+ * length, that can be copied into escaped JSON unchanged.
+ */
+typedef size_t (*nr_json_clean_span_t)(const char* str, size_t len);
+
+extern size_t nr_json_clean_span_scalar(const char* str, size_t len);
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+extern size_t nr_json_clean_span_sse2(const char* str, size_t len);
+extern size_t nr_json_clean_span_avx2(const char* str, size_t len);
+#endif
+
+/*
+ * Purpose : Return the fastest clean span implementation supported by the
+ *           CPU.
+ */
+extern nr_json_clean_span_t nr_json_clean_span_best(void);
+
+/*
+ * Purpose : Escape a JSON string as nr_json_escape() does, using the given
+ *           clean span implementation.
+ */
+extern int nr_json_escape_with(char* dest,
+                               const char* json,
+                               nr_json_clean_span_t clean_span);
+
+#endif /* UTIL_JSON_PRIVATE_HDR */
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "util_json.h"
+#include "util_json_reader.h"
+#include "util_memory.h"
+#include "util_number_converter.h"
+#include "util_strings.h"
+
+static bool nr_json_reader_fail(nr_json_reader_t* reader) {
+  reader->failed = true;
+  return false;
+}
+
+/*
+ * Skip whitespace, which, as in nro_create_from_json(), is any control
+ * character or space.
+ */
+static void nr_json_reader_skip_space(nr_json_reader_t* reader) {
+  while (*reader->pos && ((unsigned char)*reader->pos <= 32)) {
+    reader->pos++;
+  }
+}
+
+/*
+ * Prepare to read a value: returns false if the reader has already failed.
+ */
+static bool nr_json_reader_value_start(nr_json_reader_t* reader) {
+  if (NULL == reader || reader->failed) {
+    return false;
+  }
+  nr_json_reader_skip_space(reader);
+  return true;
+}
+
+static bool nr_json_reader_read_literal(nr_json_reader_t* reader,
+                                        const char* literal,
+                                        size_t len) {
+  if (0 != nr_strncmp(reader->pos, literal, len)) {
+    return nr_json_reader_fail(reader);
+  }
+  reader->pos += len;
+  return true;
+}
+
+/*
+ * Advance past the separator before the next member or element of a
+ * container, or past its closing character.
+ *
+ * Returns : true if there is another member or element.
+ */
+static bool nr_json_reader_next(nr_json_reader_t* reader, char close) {
+  if ((NULL == reader) || reader->failed) {
+    return false;
+  }
+
+  nr_json_reader_skip_space(reader);
+  if (close == *reader->pos) {
+    reader->pos++;
+    reader->first = false;
+    return false;
+  }
+
+  if (reader->first) {
+    reader->first = false;
+  } else if (',' == *reader->pos) {
+    reader->pos++;
+  } else {
+    return nr_json_reader_fail(reader);
+  }
+
+  return true;
+}
+
+void nr_json_reader_init(nr_json_reader_t* reader, const char* json) {
+  if (NULL == reader) {
+    return;
+  }
+
+  reader->pos = json ? json : "";
+  reader->first = false;
+  reader->failed = false;
+}
+
+nr_json_type_t nr_json_reader_peek(nr_json_reader_t* reader) {
+  if (!nr_json_reader_value_start(reader)) {
+    return NR_JSON_INVALID;
+  }
+
+  switch (*reader->pos) {
+    case 'n':
+      return NR_JSON_NULL;
+
+    case 't':
+    case 'f':
+      return NR_JSON_BOOLEAN;
+
+    case '"':
+      return NR_JSON_STRING;
+
+    case '{':
+      return NR_JSON_OBJECT;
+
+    case '[':
+      return NR_JSON_ARRAY;
+
+    default:
+      if (('-' == *reader->pos) || nr_isdigit(*reader->pos)) {
+        return NR_JSON_NUMBER;
+      }
+      return NR_JSON_INVALID;
+  }
+}
+
+bool nr_json_reader_begin_object(nr_json_reader_t* reader) {
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+  if ('{' != *reader->pos) {
+    return nr_json_reader_fail(reader);
+  }
+
+  reader->pos++;
+  reader->first = true;
+  return true;
+}
+
+bool nr_json_reader_next_member(nr_json_reader_t* reader,
+                                nr_json_string_t* key) {
+  if (!nr_json_reader_next(reader, '}')) {
+    return false;
+  }
+
+  if (!nr_json_reader_read_string(reader, key)) {
+    return false;
+  }
+
+  nr_json_reader_skip_space(reader);
+  if (':' != *reader->pos) {
+    return nr_json_reader_fail(reader);
+  }
+  reader->pos++;
+
+  return true;
+}
+
+bool nr_json_reader_begin_array(nr_json_reader_t* reader) {
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+  if ('[' != *reader->pos) {
+    return nr_json_reader_fail(reader);
+  }
+
+  reader->pos++;
+  reader->first = true;
+  return true;
+}
+
+bool nr_json_reader_next_element(nr_json_reader_t* reader) {
+  return nr_json_reader_next(reader, ']');
+}
+
+bool nr_json_reader_read_string(nr_json_reader_t* reader,
+                                nr_json_string_t* str) {
+  const char* ptr;
+  bool escaped = false;
+
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+  if ('"' != *reader->pos) {
+    return nr_json_reader_fail(reader);
+  }
+
+  for (ptr = reader->pos + 1; '"' != *ptr; ptr++) {
+    if ('\\' == *ptr) {
+      escaped = true;
+      ptr++;
+      if (0 == *ptr) {
+        return nr_json_reader_fail(reader);
+      }
+    } else if ((unsigned char)*ptr < 32) {
+      return nr_json_reader_fail(reader);
+    }
+  }
+
+  if (str) {
+    str->ptr = reader->pos + 1;
+    str->len = (size_t)(ptr - str->ptr);
+    str->escaped = escaped;
+  }
+  reader->pos = ptr + 1;
+
+  return true;
+}
+
+bool nr_json_reader_read_number(nr_json_reader_t* reader,
+                                nr_json_number_t* num) {
+  nr_json_number_t value = {.is_double = false, .lval = 0, .dval = 0.0};
+  const char* start;
+  char* end = NULL;
+
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+
+  start = reader->pos;
+  if (('-' != *start) && !nr_isdigit(*start)) {
+    return nr_json_reader_fail(reader);
+  }
+
+  /*
+   * This follows parse_number() in util_object.c, so that a number read here
+   * has the same type and value as it would have in an nrobj_t.
+   */
+  value.lval = (int64_t)strtoll(start, &end, 0);
+  if (end && (('.' == *end) || ('e' == *end) || ('E' == *end))) {
+    double d = nr_strtod(start, &end);
+
+    if ((HUGE_VAL == d) || (-HUGE_VAL == d)) {
+      value.lval = (int64_t)strtoll(start, &end, 0);
+    } else {
+      value.is_double = true;
+      value.dval = d;
+    }
+  }
+
+  if ((NULL == end) || (end == start)) {
+    return nr_json_reader_fail(reader);
+  }
+
+  if (num) {
+    *num = value;
+  }
+  reader->pos = end;
+
+  return true;
+}
+
+bool nr_json_reader_read_boolean(nr_json_reader_t* reader, bool* value) {
+  bool b;
+
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+
+  if ('t' == *reader->pos) {
+    if (!nr_json_reader_read_literal(reader, NR_PSTR("true"))) {
+      return false;
+    }
+    b = true;
+  } else {
+    if (!nr_json_reader_read_literal(reader, NR_PSTR("false"))) {
+      return false;
+    }
+    b = false;
+  }
+
+  if (value) {
+    *value = b;
+  }
+  return true;
+}
+
+bool nr_json_reader_read_null(nr_json_reader_t* reader) {
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+
+  return nr_json_reader_read_literal(reader, NR_PSTR("null"));
+}
+
+bool nr_json_reader_skip(nr_json_reader_t* reader) {
+  switch (nr_json_reader_peek(reader)) {
+    case NR_JSON_NULL:
+      return nr_json_reader_read_null(reader);
+
+    case NR_JSON_BOOLEAN:
+      return nr_json_reader_read_boolean(reader, NULL);
+
+    case NR_JSON_NUMBER:
+      return nr_json_reader_read_number(reader, NULL);
+
+    case NR_JSON_STRING:
+      return nr_json_reader_read_string(reader, NULL);
+
+    case NR_JSON_OBJECT:
+      nr_json_reader_begin_object(reader);
+      while (nr_json_reader_next_member(reader, NULL)) {
+        nr_json_reader_skip(reader);
+      }
+      return !reader->failed;
+
+    case NR_JSON_ARRAY:
+      nr_json_reader_begin_array(reader);
+      while (nr_json_reader_next_element(reader)) {
+        nr_json_reader_skip(reader);
+      }
+      return !reader->failed;
+
+    case NR_JSON_INVALID:
+    default:
+      if (NULL == reader) {
+        return false;
+      }
+      return nr_json_reader_fail(reader);
+  }
+}
+
+bool nr_json_reader_end(nr_json_reader_t* reader) {
+  if (!nr_json_reader_value_start(reader)) {
+    return false;
+  }
+
+  return (0 == *reader->pos);
+}
+
+bool nr_json_string_equals(const nr_json_string_t* str, const char* value) {
+  char* decoded;
+  bool equal;
+
+  if ((NULL == str) || (NULL == str->ptr) || (NULL == value)) {
+    return false;
+  }
+
+  if (!str->escaped) {
+    return (str->len == (size_t)nr_strlen(value))
+           && (0 == nr_strncmp(str->ptr, value, str->len));
+  }
+
+  decoded = nr_json_string_dup(str);
+  equal = (0 == nr_strcmp(decoded, value));
+  nr_free(decoded);
+
+  return equal;
+}
+
+char* nr_json_string_dup(const nr_json_string_t* str) {
+  char* dup;
+
+  if ((NULL == str) || (NULL == str->ptr)) {
+    return NULL;
+  }
+
+  dup = (char*)nr_malloc(str->len + 1);
+  if (str->escaped) {
+    nr_json_unescape(dup, str->ptr, str->len);
+  } else {
+    nr_memcpy(dup, str->ptr, str->len);
+    dup[str->len] = 0;
+  }
+
+  return dup;
+}
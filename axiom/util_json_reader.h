@@ -0,0 +1,162 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains a pull parser for JSON documents.
+ *
+ * nro_create_from_json() builds an nrobj_t tree for the whole document, which
+ * costs several allocations per value. Where the caller only needs a handful
+ * of known fields, the reader lets it walk the document in place instead:
+ * keys are compared against the source text, values that are not needed are
+ * skipped without being decoded, and only the strings the caller keeps are
+ * copied.
+ *
+ * A typical loop over an object looks like:
+ *
+ *   nr_json_reader_t reader;
+ *   nr_json_string_t key;
+ *
+ *   nr_json_reader_init(&reader, json);
+ *   nr_json_reader_begin_object(&reader);
+ *   while (nr_json_reader_next_member(&reader, &key)) {
+ *     if (nr_json_string_equals(&key, "name")) {
+ *       nr_json_reader_read_string(&reader, &name);
+ *     } else {
+ *       nr_json_reader_skip(&reader);
+ *     }
+ *   }
+ *   if (!nr_json_reader_end(&reader)) {
+ *     ...the document was malformed...
+ *   }
+ *
+ * The grammar accepted matches nro_create_from_json(). Any syntax error, or
+ * reading a value as the wrong type, puts the reader into a failed state in
+ * which every further call returns false.
+ */
+#ifndef UTIL_JSON_READER_HDR
+#define UTIL_JSON_READER_HDR
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum _nr_json_type_t {
+  NR_JSON_INVALID = 0,
+  NR_JSON_NULL,
+  NR_JSON_BOOLEAN,
+  NR_JSON_NUMBER,
+  NR_JSON_STRING,
+  NR_JSON_OBJECT,
+  NR_JSON_ARRAY,
+} nr_json_type_t;
+
+typedef struct _nr_json_reader_t {
+  const char* pos; /* The next unread character */
+  bool first;      /* True before the first member or element is read */
+  bool failed;
+} nr_json_reader_t;
+
+/*
+ * A string within the document being read. The string is not NUL terminated,
+ * and is still escaped if escaped is true.
+ */
+typedef struct _nr_json_string_t {
+  const char* ptr;
+  size_t len;
+  bool escaped;
+} nr_json_string_t;
+
+/*
+ * A number, classified the same way as by nro_create_from_json(): numbers
+ * with a fraction or an exponent are doubles, and all others are integers.
+ */
+typedef struct _nr_json_number_t {
+  bool is_double;
+  int64_t lval;
+  double dval;
+} nr_json_number_t;
+
+/*
+ * Purpose : Initialise a reader. The JSON must be NUL terminated, and must
+ *           outlive the reader and any nr_json_string_t read from it.
+ */
+extern void nr_json_reader_init(nr_json_reader_t* reader, const char* json);
+
+/*
+ * Purpose : Return the type of the next value without consuming it, or
+ *           NR_JSON_INVALID if there is no valid value at the current
+ *           position.
+ */
+extern nr_json_type_t nr_json_reader_peek(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Consume the opening brace of an object.
+ */
+extern bool nr_json_reader_begin_object(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Advance to the next member of the current object, consuming its
+ *           key. The caller must then consume the member's value with one of
+ *           the read functions or nr_json_reader_skip().
+ *
+ * Returns : true if there is another member. false when the closing brace
+ *           has been consumed, or on error.
+ */
+extern bool nr_json_reader_next_member(nr_json_reader_t* reader,
+                                       nr_json_string_t* key);
+
+/*
+ * Purpose : Consume the opening bracket of an array.
+ */
+extern bool nr_json_reader_begin_array(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Advance to the next element of the current array. The caller
+ *           must then consume the element.
+ *
+ * Returns : true if there is another element. false when the closing bracket
+ *           has been consumed, or on error.
+ */
+extern bool nr_json_reader_next_element(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Read a scalar value of the given type.
+ *
+ * Returns : true on success. false if the next value is of a different type
+ *           or is malformed, in which case the reader has failed.
+ */
+extern bool nr_json_reader_read_string(nr_json_reader_t* reader,
+                                       nr_json_string_t* str);
+extern bool nr_json_reader_read_number(nr_json_reader_t* reader,
+                                       nr_json_number_t* num);
+extern bool nr_json_reader_read_boolean(nr_json_reader_t* reader, bool* value);
+extern bool nr_json_reader_read_null(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Consume the next value of any type, including nested objects and
+ *           arrays, validating it but keeping none of it.
+ */
+extern bool nr_json_reader_skip(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Check that the whole document has been read successfully, and
+ *           that nothing but whitespace follows the last value.
+ */
+extern bool nr_json_reader_end(nr_json_reader_t* reader);
+
+/*
+ * Purpose : Compare a string within the document with a NUL terminated
+ *           string, decoding any escape sequences first.
+ */
+extern bool nr_json_string_equals(const nr_json_string_t* str,
+                                  const char* value);
+
+/*
+ * Purpose : Return a newly allocated, NUL terminated and decoded copy of a
+ *           string within the document. The caller must free it.
+ */
+extern char* nr_json_string_dup(const nr_json_string_t* str);
+
+#endif /* UTIL_JSON_READER_HDR */
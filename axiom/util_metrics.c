@@ -502,6 +502,31 @@ void nrm_duplicate_metric(nrmtable_t* table,
                    nrm_sumsquares(metric));
 }
 
+void nrm_table_merge(nrmtable_t* dest, const nrmtable_t* src) {
+  int i;
+
+  if ((NULL == dest) || (NULL == src) || (dest == src)) {
+    return;
+  }
+
+  for (i = 0; i < src->number; i++) {
+    const nrmetric_t* metric = &src->metrics[i];
+    const char* name = nrm_get_name(src, metric);
+    int force = nrm_is_forced(metric);
+
+    if (nrm_is_apdex(metric)) {
+      nrm_add_apdex_internal(force, dest, name, nrm_satisfying(metric),
+                             nrm_tolerating(metric), nrm_failing(metric),
+                             nrm_min(metric), nrm_max(metric));
+    } else {
+      nrm_add_internal(force, dest, name, nrm_count(metric),
+                       nrm_total(metric), nrm_exclusive(metric),
+                       nrm_min(metric), nrm_max(metric),
+                       nrm_sumsquares(metric));
+    }
+  }
+}
+
 static void nr_metric_to_daemon_json_buffer(nrbuf_t* buf,
                                             const nrmetric_t* metric,
                                             const nrmtable_t* table) {
@@ -111,6 +111,13 @@ extern void nrm_duplicate_metric(nrmtable_t* table,
                                  const char* current_name,
                                  const char* new_name);
 
+/*
+ * Purpose : Add every metric in the source table to the destination table,
+ *           as if it had been added to the destination directly. The source
+ *           table is unmodified.
+ */
+extern void nrm_table_merge(nrmtable_t* dest, const nrmtable_t* src);
+
 /*
  * Purpose : Get the current table size.
  */
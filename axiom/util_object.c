@@ -10,10 +10,13 @@
 #include <math.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "util_buffer.h"
+#include "util_hash.h"
+#include "util_json.h"
 #include "util_memory.h"
 #include "util_number_converter.h"
 #include "util_object.h"
@@ -25,6 +28,27 @@
  */
 #define NRO_CHUNK_SIZE 8
 
+/*
+ * Strings shorter than this (including the terminating NUL) are stored inside
+ * the object itself rather than in a separate allocation. The size is chosen
+ * so that the string member of the union is no larger than the hash member,
+ * which keeps objects at 32 bytes on 64-bit platforms.
+ */
+#define NRO_INLINE_STRING_SIZE 16
+
+/*
+ * Hashes with more keys than this maintain an index from key hash to
+ * position, so that lookups do not have to compare against every key. For
+ * smaller hashes a linear scan is cheaper than hashing the key.
+ */
+#define NRO_HASH_INDEX_THRESHOLD 8
+
+/*
+ * The size of each entry in the interned key table below, including the
+ * terminating NUL.
+ */
+#define NRO_INTERNED_KEY_SIZE 32
+
 /*
  * This file implements the generic object. Unlike its use in the php agent
  * where the internals of this type are visible to all, in this implementation
@@ -37,10 +61,32 @@
  * In order to shorten the function names and to increase legibility, we use
  * the prefix nro_ for all functions, which stands for "New Relic Object".
  */
+typedef struct _nrohashslot_t {
+  uint32_t hash;
+  int pos; /* Position of the key plus one, or 0 if the slot is empty */
+} nrohashslot_t;
+
+typedef struct _nrohashindex_t {
+  uint32_t mask; /* Number of slots minus one; the number is a power of 2 */
+  nrohashslot_t slots[];
+} nrohashindex_t;
+
+/*
+ * The keys of a hash. The index shares their allocation, rather than being a
+ * member of nrohash_t, so that it doesn't make every object larger.
+ */
+typedef struct _nrohashkeys_t {
+  nrohashindex_t* index; /* NULL until size exceeds NRO_HASH_INDEX_THRESHOLD */
+  char* names[];
+} nrohashkeys_t;
+
+#define NRO_HASH_KEYS_SIZE(n) \
+  (sizeof(nrohashkeys_t) + (size_t)(n) * sizeof(char*))
+
 typedef struct _nrohash_t {
   int size;
   int allocated;
-  char** keys;
+  nrohashkeys_t* keys;
   struct _nrintobj_t** data;
 } nrohash_t;
 
@@ -50,19 +96,49 @@ typedef struct _nrarray_t {
   struct _nrintobj_t** data;
 } nrarray_t;
 
+typedef struct _nrostring_t {
+  char* ptr; /* Either buf, or a heap allocation for longer strings */
+  char buf[NRO_INLINE_STRING_SIZE];
+} nrostring_t;
+
 typedef struct _nrintobj_t {
   nrotype_t type;
   union {
-    int ival;       /* int */
-    int64_t lval;   /* long */
-    uint64_t ulval; /* ulong */
-    double dval;    /* double */
-    char* sval;     /* string (strdup'ed) */
-    nrohash_t hval; /* hash */
-    nrarray_t aval; /* array */
+    int ival;         /* int */
+    int64_t lval;     /* long */
+    uint64_t ulval;   /* ulong */
+    double dval;      /* double */
+    nrostring_t sval; /* string */
+    nrohash_t hval;   /* hash */
+    nrarray_t aval;   /* array */
   } u;
 } nrintobj_t;
 
+/*
+ * Keys that appear in most of the hashes the agent builds, copies and
+ * serializes: event and span intrinsics, and the distributed trace payload
+ * fields. Hashes point into this table instead of duplicating these keys,
+ * which saves an allocation per key and lets an interned key be recognised by
+ * its address alone.
+ *
+ * The table must stay sorted in strcmp order, as it is searched with bsearch.
+ * It is never written to; it is not const only so that its entries can be
+ * stored in the keys array of a hash without casting away the qualifier.
+ */
+static char nro_interned_keys[][NRO_INTERNED_KEY_SIZE] = {
+    "ac", "agentAttributes", "ap", "category", "component", "d",
+    "databaseCallCount", "databaseDuration", "duration", "error", "error.class",
+    "error.message", "externalCallCount", "externalDuration", "guid", "id",
+    "intrinsics", "name", "nr.apdexPerfZone", "nr.entryPoint", "nr.guid",
+    "nr.pathHash", "nr.referringTransactionGuid", "nr.syntheticsJobId",
+    "nr.syntheticsMonitorId", "nr.syntheticsResourceId", "nr.tripId",
+    "parent.account", "parent.app", "parent.transportDuration",
+    "parent.transportType", "parent.type", "parentId", "pr", "priority",
+    "queueDuration", "sa", "sampled", "span.kind", "ti", "timestamp", "tk",
+    "totalTime", "tr", "traceId", "transactionId", "transactionName", "tx",
+    "ty", "type", "userAttributes", "v", "value", "version",
+};
+
 static nr_status_t nro_internal_setvalue_array(nrintobj_t* op,
                                                int idx,
                                                nrobj_t* nobj);
@@ -101,6 +177,165 @@ static const nrobj_t* nro_cassert(const nrobj_t* obj, nrotype_t type) {
   return NULL;
 }
 
+static int nro_interned_key_compare(const void* a, const void* b) {
+  return nr_strcmp((const char*)a, (const char*)b);
+}
+
+static int nro_key_is_interned(const char* key) {
+  uintptr_t addr = (uintptr_t)key;
+  uintptr_t table = (uintptr_t)nro_interned_keys;
+
+  return (addr >= table) && (addr < table + sizeof(nro_interned_keys));
+}
+
+/*
+ * Return the storage for a new hash key: the interned copy if there is one,
+ * or a newly allocated copy otherwise.
+ */
+static char* nro_key_create(const char* key) {
+  char* interned = (char*)bsearch(
+      key, nro_interned_keys,
+      sizeof(nro_interned_keys) / sizeof(nro_interned_keys[0]),
+      NRO_INTERNED_KEY_SIZE, nro_interned_key_compare);
+
+  if (interned) {
+    return interned;
+  }
+  return nr_strdup(key);
+}
+
+static char* nro_key_copy(char* key) {
+  if (nro_key_is_interned(key)) {
+    return key;
+  }
+  return nr_strdup(key);
+}
+
+static void nro_key_destroy(char** key_ptr) {
+  if (!nro_key_is_interned(*key_ptr)) {
+    nr_free(*key_ptr);
+  }
+  *key_ptr = NULL;
+}
+
+/*
+ * Return a buffer of at least len + 1 bytes in which to store a string,
+ * using the inline buffer where it is large enough.
+ */
+static char* nro_string_alloc(nrostring_t* str, size_t len) {
+  if (len < NRO_INLINE_STRING_SIZE) {
+    str->ptr = str->buf;
+  } else {
+    str->ptr = (char*)nr_malloc(len + 1);
+  }
+  return str->ptr;
+}
+
+static void nro_string_set(nrostring_t* str, const char* value) {
+  size_t len;
+
+  if (NULL == value) {
+    value = "";
+  }
+  len = (size_t)nr_strlen(value);
+  nr_memcpy(nro_string_alloc(str, len), value, len + 1);
+}
+
+static void nro_string_release(nrostring_t* str) {
+  if (str->ptr != str->buf) {
+    nr_free(str->ptr);
+  }
+  str->ptr = NULL;
+}
+
+static void nro_hash_index_insert(nrohashindex_t* index,
+                                  uint32_t hash,
+                                  int pos) {
+  uint32_t i = hash & index->mask;
+
+  while (0 != index->slots[i].pos) {
+    i = (i + 1) & index->mask;
+  }
+  index->slots[i].hash = hash;
+  index->slots[i].pos = pos + 1;
+}
+
+/*
+ * Build an index for every key in the hash. The index is sized to be at most
+ * a quarter full when built, and is rebuilt by nro_hash_index_add once it is
+ * half full.
+ */
+static nrohashindex_t* nro_hash_index_create(const nrohash_t* hval) {
+  nrohashindex_t* index;
+  uint32_t nslots = 2 * NRO_HASH_INDEX_THRESHOLD;
+  int i;
+
+  while (nslots < 4 * (uint32_t)hval->size) {
+    nslots *= 2;
+  }
+
+  index = (nrohashindex_t*)nr_zalloc(sizeof(nrohashindex_t)
+                                     + nslots * sizeof(nrohashslot_t));
+  index->mask = nslots - 1;
+  for (i = 0; i < hval->size; i++) {
+    nro_hash_index_insert(index, nr_mkhash(hval->keys->names[i], NULL), i);
+  }
+
+  return index;
+}
+
+static nrohashindex_t* nro_hash_index_copy(const nrohashindex_t* index) {
+  nrohashindex_t* copy;
+  size_t len;
+
+  if (NULL == index) {
+    return NULL;
+  }
+
+  len = sizeof(nrohashindex_t) + (index->mask + 1) * sizeof(nrohashslot_t);
+  copy = (nrohashindex_t*)nr_malloc(len);
+  nr_memcpy(copy, index, len);
+  return copy;
+}
+
+/*
+ * Update the index of a hash after a key has been appended at position pos,
+ * creating the index once the hash grows beyond NRO_HASH_INDEX_THRESHOLD.
+ */
+static void nro_hash_index_add(nrohash_t* hval, int pos) {
+  if (hval->size <= NRO_HASH_INDEX_THRESHOLD) {
+    return;
+  }
+
+  if ((NULL == hval->keys->index)
+      || (2 * (uint32_t)hval->size > hval->keys->index->mask + 1)) {
+    nr_free(hval->keys->index);
+    hval->keys->index = nro_hash_index_create(hval);
+    return;
+  }
+
+  nro_hash_index_insert(hval->keys->index,
+                        nr_mkhash(hval->keys->names[pos], NULL), pos);
+}
+
+static int nro_hash_index_find(const nrohash_t* hval, const char* key) {
+  const nrohashindex_t* index = hval->keys->index;
+  uint32_t hash = nr_mkhash(key, NULL);
+  uint32_t i = hash & index->mask;
+
+  while (0 != index->slots[i].pos) {
+    int pos = index->slots[i].pos - 1;
+
+    if ((hash == index->slots[i].hash)
+        && (0 == nr_strcmp(hval->keys->names[pos], key))) {
+      return pos;
+    }
+    i = (i + 1) & index->mask;
+  }
+
+  return -2;
+}
+
 static void nro_internal_new(nrintobj_t* op) {
   switch (op->type) {
     case NR_OBJECT_INVALID:
@@ -117,7 +352,8 @@ static void nro_internal_new(nrintobj_t* op) {
 
     case NR_OBJECT_HASH:
       op->u.hval.allocated = NRO_CHUNK_SIZE;
-      op->u.hval.keys = (char**)nr_calloc(NRO_CHUNK_SIZE, sizeof(char*));
+      op->u.hval.keys
+          = (nrohashkeys_t*)nr_zalloc(NRO_HASH_KEYS_SIZE(NRO_CHUNK_SIZE));
       op->u.hval.data
           = (nrintobj_t**)nr_calloc(NRO_CHUNK_SIZE, sizeof(nrintobj_t*));
       break;
@@ -200,14 +436,14 @@ nrobj_t* nro_new_double(double x) {
 nrobj_t* nro_new_string(const char* x) {
   nrobj_t* obj = nro_internal_new_and_construct(NR_OBJECT_STRING);
 
-  obj->u.sval = nr_strdup(x);
+  nro_string_set(&obj->u.sval, x);
   return obj;
 }
 
 nrobj_t* nro_new_jstring(const char* x) {
   nrobj_t* obj = nro_internal_new_and_construct(NR_OBJECT_JSTRING);
 
-  obj->u.sval = nr_strdup(x);
+  nro_string_set(&obj->u.sval, x);
   return obj;
 }
 
@@ -243,17 +479,18 @@ static void nro_internal_delete(nrintobj_t* op, int freebase) {
 
     case NR_OBJECT_STRING:
     case NR_OBJECT_JSTRING:
-      nr_free(op->u.sval);
-      op->u.sval = 0;
+      nro_string_release(&op->u.sval);
       break;
 
     case NR_OBJECT_HASH:
       for (i = 0; i < op->u.hval.size; i++) {
-        nr_free(op->u.hval.keys[i]);
+        nro_key_destroy(&op->u.hval.keys->names[i]);
         nro_internal_delete(op->u.hval.data[i], 1);
-        op->u.hval.keys[i] = 0;
         op->u.hval.data[i] = 0;
       }
+      if (op->u.hval.keys) {
+        nr_free(op->u.hval.keys->index);
+      }
       nr_free(op->u.hval.keys);
       nr_free(op->u.hval.data);
       op->u.hval.size = 0;
@@ -314,8 +551,12 @@ static int nro_find_key_in_hash(const nrintobj_t* op, const char* key) {
     return -2;
   }
 
+  if (NULL != op->u.hval.keys->index) {
+    return nro_hash_index_find(&op->u.hval, key);
+  }
+
   for (i = 0; i < op->u.hval.size; i++) {
-    if (0 == nr_strcmp(op->u.hval.keys[i], key)) {
+    if (0 == nr_strcmp(op->u.hval.keys->names[i], key)) {
       return i;
     }
   }
@@ -435,19 +676,20 @@ static nr_status_t nro_internal_setvalue_hash(nrintobj_t* op,
     idx = op->u.hval.size;
     if (idx == op->u.hval.allocated) {
       op->u.hval.allocated += NRO_CHUNK_SIZE;
-      op->u.hval.keys = (char**)nr_realloc(
-          op->u.hval.keys, op->u.hval.allocated * sizeof(char*));
+      op->u.hval.keys = (nrohashkeys_t*)nr_realloc(
+          op->u.hval.keys, NRO_HASH_KEYS_SIZE(op->u.hval.allocated));
       op->u.hval.data = (nrintobj_t**)nr_realloc(
           op->u.hval.data, op->u.hval.allocated * sizeof(nrintobj_t*));
 
       /* Set the newly allocated memory to 0 */
       for (i = op->u.hval.size; i < op->u.hval.allocated; i++) {
-        op->u.hval.keys[i] = 0;
+        op->u.hval.keys->names[i] = 0;
         op->u.hval.data[i] = 0;
       }
     }
     op->u.hval.size++;
-    op->u.hval.keys[idx] = nr_strdup(key);
+    op->u.hval.keys->names[idx] = nro_key_create(key);
+    nro_hash_index_add(&op->u.hval, idx);
   }
   op->u.hval.data[idx] = nobj;
   return NR_SUCCESS;
@@ -779,7 +1021,7 @@ void nro_iteratehash(const nrobj_t* obj, nrhashiter_t func, void* ptr) {
   }
 
   for (i = 0; i < op->u.hval.size; i++) {
-    nr_status_t rv = func(op->u.hval.keys[i], op->u.hval.data[i], ptr);
+    nr_status_t rv = func(op->u.hval.keys->names[i], op->u.hval.data[i], ptr);
     if (NR_FAILURE == rv) {
       return;
     }
@@ -838,19 +1080,21 @@ nrobj_t* nro_copy(const nrobj_t* obj) {
 
     case NR_OBJECT_STRING:
     case NR_OBJECT_JSTRING:
-      np->u.sval = nr_strdup(op->u.sval);
+      nro_string_set(&np->u.sval, op->u.sval.ptr);
       break;
 
     case NR_OBJECT_HASH:
       np->u.hval.size = op->u.hval.size;
       np->u.hval.allocated = np->u.hval.size;
-      np->u.hval.keys = (char**)nr_calloc(np->u.hval.size, sizeof(char*));
+      np->u.hval.keys
+          = (nrohashkeys_t*)nr_zalloc(NRO_HASH_KEYS_SIZE(np->u.hval.size));
       np->u.hval.data
           = (nrintobj_t**)nr_calloc(np->u.hval.size, sizeof(nrintobj_t*));
       for (i = 0; i < np->u.hval.size; i++) {
-        np->u.hval.keys[i] = nr_strdup(op->u.hval.keys[i]);
+        np->u.hval.keys->names[i] = nro_key_copy(op->u.hval.keys->names[i]);
         np->u.hval.data[i] = nro_copy(op->u.hval.data[i]);
       }
+      np->u.hval.keys->index = nro_hash_index_copy(op->u.hval.keys->index);
       break;
 
     case NR_OBJECT_ARRAY:
@@ -1053,7 +1297,7 @@ const char* nro_get_string(const nrobj_t* obj, nr_status_t* errp) {
     *errp = NR_SUCCESS;
   }
 
-  return (op->u.sval);
+  return (op->u.sval.ptr);
 
 error:
   if (0 != errp) {
@@ -1077,7 +1321,7 @@ const char* nro_get_jstring(const nrobj_t* obj, nr_status_t* errp) {
     *errp = NR_SUCCESS;
   }
 
-  return (op->u.sval);
+  return (op->u.sval.ptr);
 
 error:
   if (0 != errp) {
@@ -1148,7 +1392,7 @@ const nrobj_t* nro_get_hash_value_by_index(const nrobj_t* obj,
   }
 
   if (keyp) {
-    *keyp = op->u.hval.keys[idx];
+    *keyp = op->u.hval.keys->names[idx];
   }
 
   return (op->u.hval.data[idx]);
@@ -1258,19 +1502,19 @@ static void recursive_obj_to_json(const nrintobj_t* op, nrbuf_t* buf) {
       break;
 
     case NR_OBJECT_STRING:
-      nr_buffer_add_escape_json(buf, op->u.sval);
+      nr_buffer_add_escape_json(buf, op->u.sval.ptr);
       break;
 
     case NR_OBJECT_JSTRING:
-      l = nr_strlen(op->u.sval);
-      nr_buffer_add(buf, op->u.sval, l);
+      l = nr_strlen(op->u.sval.ptr);
+      nr_buffer_add(buf, op->u.sval.ptr, l);
       break;
 
     case NR_OBJECT_HASH:
       nr_buffer_add(buf, "{", 1);
 
       for (i = 0; i < op->u.hval.size; i++) {
-        nr_buffer_add_escape_json(buf, op->u.hval.keys[i]);
+        nr_buffer_add_escape_json(buf, op->u.hval.keys->names[i]);
         nr_buffer_add(buf, ":", 1);
         recursive_obj_to_json(op->u.hval.data[i], buf);
 
@@ -1377,15 +1621,15 @@ static const char* parse_number(nrintobj_t* item, const char* num) {
   return num;
 }
 
-static const unsigned char firstByteMark[7]
-    = {0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
-
-static const char* parse_string(nrintobj_t* item, const char* str) {
-  const char* ptr = str + 1;
-  char* ptr2;
-  char* out;
-  int len = 0;
-  unsigned uc;
+/*
+ * Decode a JSON string into out, which is only modified on success. The
+ * string is decoded directly into its final storage: the decoded string is
+ * never longer than the encoded one, so the encoded length is enough to
+ * decide whether it fits inline.
+ */
+static const char* parse_string_into(nrostring_t* out, const char* str) {
+  const char* ptr;
+  size_t len;
 
   if (0 == str) {
     return 0;
@@ -1395,96 +1639,30 @@ static const char* parse_string(nrintobj_t* item, const char* str) {
     return 0; /* not a string! */
   }
 
-  for (len = 0; *ptr != '\"'; len++, ptr++) {
+  for (ptr = str + 1; *ptr != '\"'; ptr++) {
     if ('\\' == *ptr) {
       ptr++; /* Skip escaped quotes. */
+      if (0 == *ptr) {
+        return 0; /* Not a valid string! */
+      }
     } else if ((unsigned char)*ptr < 32) {
       return 0; /* Not a valid string! */
     }
   }
 
-  out = (char*)nr_malloc(
-      len + 1); /* This is how long we need for the string, roughly. */
+  len = (size_t)(ptr - (str + 1));
+  nr_json_unescape(nro_string_alloc(out, len), str + 1, len);
 
-  ptr = str + 1;
-  ptr2 = out;
-  while (*ptr != '\"' && (unsigned char)*ptr > 31) {
-    if (*ptr != '\\') {
-      *ptr2++ = *ptr++;
-    } else {
-      ptr++;
-      switch (*ptr) {
-        case 'b':
-          *ptr2++ = '\b';
-          break;
-
-        case 'f':
-          *ptr2++ = '\f';
-          break;
-
-        case 'n':
-          *ptr2++ = '\n';
-          break;
-
-        case 'r':
-          *ptr2++ = '\r';
-          break;
-
-        case 't':
-          *ptr2++ = '\t';
-          break;
-
-        case '/':
-          *ptr2++ = '/';
-          break;
-
-        case 'u': /* transcode utf16 to utf8. DOES NOT SUPPORT SURROGATE PAIRS
-                     CORRECTLY. */
-          sscanf(ptr + 1, "%4x", &uc); /* get the unicode char. */
-          len = 3;
-          if (uc < 0x80) {
-            len = 1;
-          } else if (uc < 0x800) {
-            len = 2;
-          }
-          ptr2 += len;
-
-          switch (len) {
-            case 3:
-              *--ptr2 = ((uc | 0x80) & 0xBF);
-              uc >>= 6;
-              /*FALLTHROUGH*/
-
-            case 2:
-              *--ptr2 = ((uc | 0x80) & 0xBF);
-              uc >>= 6;
-              /*FALLTHROUGH*/
-
-            case 1:
-              *--ptr2 = (uc | firstByteMark[len]);
-              break;
-          }
-          ptr2 += len;
-          ptr += 4;
-          break;
-
-        default:
-          *ptr2++ = *ptr;
-          break;
-      }
-      ptr++;
-    }
-  }
+  return ptr + 1;
+}
 
-  *ptr2 = 0;
-  if (*ptr == '\"') {
-    ptr++;
-  }
+static const char* parse_string(nrintobj_t* item, const char* str) {
+  const char* next = parse_string_into(&item->u.sval, str);
 
-  item->type = NR_OBJECT_STRING;
-  item->u.sval = nr_strdup(out);
-  nr_free(out);
-  return ptr;
+  if (next) {
+    item->type = NR_OBJECT_STRING;
+  }
+  return next;
 }
 
 /* Predeclare these prototypes. */
@@ -1642,10 +1820,42 @@ static const char* parse_array(nrintobj_t* item, const char* value) {
   return 0; /* malformed. */
 }
 
-static const char* parse_object(nrintobj_t* item, const char* value) {
+/*
+ * Parse a "key":value pair into the hash. Keys are decoded into a temporary
+ * string on the stack, so that short keys and interned keys are stored
+ * without any intermediate allocation.
+ */
+static const char* parse_object_member(nrintobj_t* item, const char* value) {
   nrintobj_t* child;
-  char* key;
+  nrostring_t key;
 
+  value = json_skip(parse_string_into(&key, json_skip(value)));
+  if (!value) {
+    return 0;
+  }
+
+  if (*value != ':') {
+    nro_string_release(&key);
+    return 0; /* fail! */
+  }
+
+  child = (nrintobj_t*)nr_zalloc(sizeof(nrintobj_t));
+  value = json_skip(parse_value(
+      child, json_skip(value + 1))); /* Skip any spacing, get the value. */
+  if (!value) {
+    nro_string_release(&key);
+    nro_internal_delete(child, 1);
+    return 0;
+  }
+
+  if (NR_SUCCESS != nro_internal_setvalue_hash(item, key.ptr, child)) {
+    nro_internal_delete(child, 1);
+  }
+  nro_string_release(&key);
+  return value;
+}
+
+static const char* parse_object(nrintobj_t* item, const char* value) {
   if (!value) {
     return 0;
   }
@@ -1665,71 +1875,25 @@ static const char* parse_object(nrintobj_t* item, const char* value) {
   }
   item->u.hval.data
       = (nrintobj_t**)nr_calloc(item->u.aval.allocated, sizeof(nrintobj_t*));
-  item->u.hval.keys = (char**)nr_calloc(item->u.aval.allocated, sizeof(char*));
+  item->u.hval.keys = (nrohashkeys_t*)nr_zalloc(
+      NRO_HASH_KEYS_SIZE(item->u.hval.allocated));
 
   if (*value == '}') {
     return value + 1; /* empty array. */
   }
 
-  child = (nrintobj_t*)nr_zalloc(sizeof(nrintobj_t));
-  value = json_skip(parse_string(child, json_skip(value)));
-  if (!value) {
-    nro_internal_delete(item, 0);
-    nro_internal_delete(child, 1);
-    return 0;
-  }
-  child->type = NR_OBJECT_NONE;
-  key = child->u.sval;
-  child->u.sval = 0;
-
-  if (*value != ':') {
-    nr_free(key);
-    nr_free(child);
-    nro_internal_delete(item, 0);
-    return 0; /* fail! */
-  }
-
-  value = json_skip(parse_value(
-      child, json_skip(value + 1))); /* Skip any spacing, get the value. */
+  value = parse_object_member(item, value);
   if (!value) {
-    nr_free(key);
     nro_internal_delete(item, 0);
-    nro_internal_delete(child, 1);
     return 0;
   }
-  nro_internal_setvalue_hash(item, key, child);
-  nr_free(key);
 
   while (*value == ',') {
-    child = (nrintobj_t*)nr_zalloc(sizeof(nrintobj_t));
-
-    value = json_skip(parse_string(child, json_skip(value + 1)));
+    value = parse_object_member(item, value + 1);
     if (!value) {
       nro_internal_delete(item, 0);
-      nro_internal_delete(child, 1);
-      return 0;
-    }
-    key = child->u.sval;
-    child->type = NR_OBJECT_NONE;
-
-    if (*value != ':') {
-      nr_free(key);
-      nr_free(child);
-      nro_internal_delete(item, 0);
-      return 0; /* fail! */
-    }
-
-    value = json_skip(parse_value(
-        child,
-        json_skip(value + 1))); /* json_skip any spacing, get the value. */
-    if (!value) {
-      nr_free(key);
-      nro_internal_delete(item, 0);
-      nro_internal_delete(child, 1);
       return 0;
     }
-    nro_internal_setvalue_hash(item, key, child);
-    nr_free(key);
   }
 
   if (*value == '}') {
@@ -1830,13 +1994,13 @@ static void nro_dump_internal(const nrobj_t* obj, int level, char* retstr) {
 
     case NR_OBJECT_STRING:
       snprintf(tmpstr, sizeof(tmpstr), "STRING: >>>%.900s<<<\n",
-               op->u.sval ? op->u.sval : "(NULL)");
+               op->u.sval.ptr ? op->u.sval.ptr : "(NULL)");
       nr_strcat(retstr, tmpstr);
       break;
 
     case NR_OBJECT_JSTRING:
       snprintf(tmpstr, sizeof(tmpstr), "JSTRING: >>>%.900s<<<\n",
-               op->u.sval ? op->u.sval : "(NULL)");
+               op->u.sval.ptr ? op->u.sval.ptr : "(NULL)");
       nr_strcat(retstr, tmpstr);
       break;
 
@@ -1877,7 +2041,7 @@ static void nro_dump_internal(const nrobj_t* obj, int level, char* retstr) {
           nr_strcat(retstr, tmpstr);
         }
         snprintf(tmpstr, sizeof(tmpstr), "['%.900s'] = {\n",
-                 op->u.hval.keys[i]);
+                 op->u.hval.keys->names[i]);
         nr_strcat(retstr, tmpstr);
         nro_dump_internal(op->u.hval.data[i], level + 1, retstr);
         snprintf(tmpstr, sizeof(tmpstr), "  ");
@@ -21,9 +21,13 @@
 /*
  * Common state for uniform random number generators based on
  * the POSIX *rand48() family of linear congruential generators.
+ *
+ * Identifiers want 64 random bits at a time, which would take three rand48
+ * draws, so they use a separate SplitMix64 counter seeded alongside it.
  */
 struct _nr_random_t {
   unsigned short xsubi[3];
+  uint64_t state;
 };
 
 nr_random_t* nr_random_create(void) {
@@ -33,6 +37,7 @@ nr_random_t* nr_random_create(void) {
   rnd->xsubi[0] = 0;
   rnd->xsubi[1] = 0;
   rnd->xsubi[2] = 0;
+  rnd->state = 0;
 
   return rnd;
 }
@@ -54,6 +59,7 @@ void nr_random_seed(nr_random_t* rnd, uint64_t seed) {
   rnd->xsubi[2] = (seed & 0xffffffffl) >> 16;
   rnd->xsubi[1] = seed & 0xffffl;
   rnd->xsubi[0] = 0x330e;
+  rnd->state = seed;
 }
 
 nr_random_t* nr_random_create_from_seed(uint64_t seed) {
@@ -117,3 +123,25 @@ double nr_random_real(nr_random_t* rnd) {
 
   return erand48(rnd->xsubi);
 }
+
+uint64_t nr_random_u64(nr_random_t* rnd) {
+  uint64_t z;
+
+  if (0 == rnd) {
+    return 0;
+  }
+
+  /*
+   * SplitMix64: a Weyl sequence run through a 64-bit finalizer. Every state
+   * value, including zero, yields a full period of 2^64.
+   *
+   * Please see:
+   * https://prng.di.unimi.it/splitmix64.c
+   */
+  rnd->state += 0x9e3779b97f4a7c15ULL;
+  z = rnd->state;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+  return z ^ (z >> 31);
+}
@@ -25,7 +25,8 @@ extern void nr_random_destroy(nr_random_t** rnd_ptr);
  *           used for deterministic testing.
  *
  * Params  : 1. The URNG to seed.
- *           2. The seed value. Only the lowest 32-bits are used.
+ *           2. The seed value. Only the lowest 32-bits are used by the
+ *              rand48 generator; nr_random_u64() uses all 64.
  */
 extern void nr_random_seed(nr_random_t* rnd, uint64_t seed);
 
@@ -57,4 +58,14 @@ extern unsigned long nr_random_range(nr_random_t* rnd,
  */
 extern double nr_random_real(nr_random_t* rnd);
 
+/*
+ * Purpose : Generate 64 uniformly distributed random bits in a single draw.
+ *           This is much cheaper than assembling the same bits from
+ *           nr_random_range(), and is intended for identifiers rather than
+ *           sampling decisions.
+ *
+ * Returns : A random 64-bit value, or 0 if rnd is NULL.
+ */
+extern uint64_t nr_random_u64(nr_random_t* rnd);
+
 #endif /* UTIL_RANDOM_HDR */
@@ -11,9 +11,67 @@
 #include "util_memory.h"
 #include "util_slab_private.h"
 
+static nr_slab_page_t* nr_slab_page_pool_get(nr_slab_page_pool_t* pool,
+                                             size_t page_size) {
+  nr_slab_page_t* page = NULL;
+  nr_slab_page_t** link;
+
+  nrt_mutex_lock(&pool->lock);
+  for (link = &pool->pages; NULL != *link; link = &(*link)->prev) {
+    if ((*link)->capacity + sizeof(nr_slab_page_t) == page_size) {
+      page = *link;
+      *link = page->prev;
+      pool->retained -= page_size;
+      break;
+    }
+  }
+
+  if (page) {
+    pool->hits += 1;
+  } else {
+    pool->misses += 1;
+  }
+  nrt_mutex_unlock(&pool->lock);
+
+  /*
+   * Pages are zeroed lazily: only the part that was used by the previous
+   * owner needs to be cleared, as the remainder is still zero from the
+   * original allocation.
+   */
+  if (page) {
+    memset(page->data, 0, page->used);
+  }
+
+  return page;
+}
+
+static void nr_slab_page_pool_put(nr_slab_page_pool_t* pool,
+                                  nr_slab_page_t* page) {
+  size_t page_size = page->capacity + sizeof(nr_slab_page_t);
+  bool retained = false;
+
+  nrt_mutex_lock(&pool->lock);
+  if (pool->retained + page_size <= pool->max_retained) {
+    page->prev = pool->pages;
+    pool->pages = page;
+    pool->retained += page_size;
+    retained = true;
+  }
+  nrt_mutex_unlock(&pool->lock);
+
+  if (!retained) {
+    nr_free(page);
+  }
+}
+
 static nr_slab_page_t* nr_slab_page_create(size_t page_size,
-                                           nr_slab_page_t* prev) {
-  nr_slab_page_t* page;
+                                           nr_slab_page_t* prev,
+                                           nr_slab_page_pool_t* pool) {
+  nr_slab_page_t* page = NULL;
+
+  if (pool) {
+    page = nr_slab_page_pool_get(pool, page_size);
+  }
 
   /*
    * Traditionally, one would implement this kind of allocator on top of
@@ -30,7 +88,9 @@ static nr_slab_page_t* nr_slab_page_create(size_t page_size,
    * Technically, we're going to use nr_zalloc() to zero the page. This matches
    * the behaviour of mmap().
    */
-  page = nr_zalloc(page_size);
+  if (NULL == page) {
+    page = nr_zalloc(page_size);
+  }
 
   if (nrunlikely(NULL == page)) {
     return NULL;
@@ -46,6 +106,12 @@ static nr_slab_page_t* nr_slab_page_create(size_t page_size,
 }
 
 nr_slab_t* nr_slab_create(size_t object_size, size_t page_size) {
+  return nr_slab_create_pooled(object_size, page_size, NULL);
+}
+
+nr_slab_t* nr_slab_create_pooled(size_t object_size,
+                                 size_t page_size,
+                                 nr_slab_page_pool_t* pool) {
   nr_slab_t* slab;
   long sys_page_size;
 
@@ -112,7 +178,8 @@ nr_slab_t* nr_slab_create(size_t object_size, size_t page_size) {
   /*
    * Create the first page.
    */
-  slab->head = nr_slab_page_create(slab->page_size, NULL);
+  slab->pool = pool;
+  slab->head = nr_slab_page_create(slab->page_size, NULL, pool);
 
   /*
    * Set up the free list. The default 128 capacity was cargo culted from the
@@ -144,7 +211,11 @@ void nr_slab_destroy(nr_slab_t** slab_ptr) {
   while (head) {
     nr_slab_page_t* prev = head->prev;
 
-    nr_free(head);
+    if (slab->pool) {
+      nr_slab_page_pool_put(slab->pool, head);
+    } else {
+      nr_free(head);
+    }
     head = prev;
   }
 
@@ -190,7 +261,7 @@ void* nr_slab_next(nr_slab_t* slab) {
       slab->page_size *= 2;
     }
 
-    new_page = nr_slab_page_create(slab->page_size, slab->head);
+    new_page = nr_slab_page_create(slab->page_size, slab->head, slab->pool);
     if (nrunlikely(NULL == new_page)) {
       return NULL;
     }
@@ -231,3 +302,56 @@ size_t nr_slab_count(const nr_slab_t* slab) {
     return 0;
   }
 }
+
+nr_slab_page_pool_t* nr_slab_page_pool_create(size_t max_retained) {
+  nr_slab_page_pool_t* pool;
+
+  if (0 == max_retained) {
+    return NULL;
+  }
+
+  pool = nr_zalloc(sizeof(nr_slab_page_pool_t));
+  nrt_mutex_init(&pool->lock, 0);
+  pool->max_retained = max_retained;
+
+  return pool;
+}
+
+void nr_slab_page_pool_destroy(nr_slab_page_pool_t** pool_ptr) {
+  nr_slab_page_pool_t* pool;
+  nr_slab_page_t* head;
+
+  if (nrunlikely(NULL == pool_ptr || NULL == *pool_ptr)) {
+    return;
+  }
+
+  pool = *pool_ptr;
+
+  head = pool->pages;
+  while (head) {
+    nr_slab_page_t* prev = head->prev;
+
+    nr_free(head);
+    head = prev;
+  }
+
+  nrt_mutex_destroy(&pool->lock);
+  nr_realfree((void**)pool_ptr);
+}
+
+bool nr_slab_page_pool_take_stats(nr_slab_page_pool_t* pool,
+                                  nr_slab_page_pool_stats_t* stats) {
+  if (NULL == pool || NULL == stats) {
+    return false;
+  }
+
+  nrt_mutex_lock(&pool->lock);
+  stats->hits = pool->hits;
+  stats->misses = pool->misses;
+  stats->retained_bytes = pool->retained;
+  pool->hits = 0;
+  pool->misses = 0;
+  nrt_mutex_unlock(&pool->lock);
+
+  return true;
+}
@@ -11,9 +11,25 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct _nr_slab_t nr_slab_t;
 
+/*
+ * A pool of slab pages that can be shared between slab allocators, including
+ * across threads. Pages of destroyed slab allocators are retained in the pool
+ * up to a configured size, and handed out again to slab allocators created
+ * later, which avoids allocating and zeroing large pages for each short-lived
+ * slab allocator.
+ */
+typedef struct _nr_slab_page_pool_t nr_slab_page_pool_t;
+
+typedef struct _nr_slab_page_pool_stats_t {
+  uint64_t hits;         /* Pages handed out from the pool */
+  uint64_t misses;       /* Pages that had to be allocated */
+  size_t retained_bytes; /* Bytes currently retained by the pool */
+} nr_slab_page_pool_stats_t;
+
 /*
  * Purpose : Create a slab allocator for homogeneous objects.
  *
@@ -36,6 +52,23 @@ typedef struct _nr_slab_t nr_slab_t;
  */
 extern nr_slab_t* nr_slab_create(size_t object_size, size_t page_size);
 
+/*
+ * Purpose : Create a slab allocator for homogeneous objects that takes its
+ *           pages from a page pool, and returns them to it when destroyed.
+ *
+ * Params  : 1. The size of each object.
+ *           2. The default page size, or 0 to use a value calculated based on
+ *              the system page size and the object size.
+ *           3. The page pool. If NULL, this behaves like nr_slab_create().
+ *
+ * Returns : A slab allocator, or NULL if the object size is 0.
+ *
+ * Notes   : The page pool must outlive the slab allocator.
+ */
+extern nr_slab_t* nr_slab_create_pooled(size_t object_size,
+                                        size_t page_size,
+                                        nr_slab_page_pool_t* pool);
+
 /*
  * Purpose : Destroy a slab allocator.
  *
@@ -77,4 +110,32 @@ extern bool nr_slab_release(nr_slab_t* slab, void* obj);
  */
 extern size_t nr_slab_count(const nr_slab_t* slab);
 
+/*
+ * Purpose : Create a slab page pool.
+ *
+ * Params  : 1. The maximum number of bytes of pages retained by the pool.
+ *
+ * Returns : A page pool, or NULL if the maximum size is 0.
+ */
+extern nr_slab_page_pool_t* nr_slab_page_pool_create(size_t max_retained);
+
+/*
+ * Purpose : Destroy a slab page pool, freeing all retained pages.
+ *
+ * Params  : 1. A pointer to the page pool to destroy.
+ */
+extern void nr_slab_page_pool_destroy(nr_slab_page_pool_t** pool_ptr);
+
+/*
+ * Purpose : Get the statistics of a slab page pool.
+ *
+ * Params  : 1. The page pool.
+ *           2. The statistics to fill in. The hit and miss counts are those
+ *              since the previous call to this function, and are reset.
+ *
+ * Returns : True if the statistics were filled in; false otherwise.
+ */
+extern bool nr_slab_page_pool_take_stats(nr_slab_page_pool_t* pool,
+                                         nr_slab_page_pool_stats_t* stats);
+
 #endif /* UTIL_SLAB_HDR */
@@ -6,6 +6,7 @@
 #ifndef UTIL_SLAB_PRIVATE_HDR
 #define UTIL_SLAB_PRIVATE_HDR
 
+#include "util_threads.h"
 #include "util_vector.h"
 
 /*
@@ -40,6 +41,24 @@ struct _nr_slab_t {
   size_t object_size;
   size_t page_size;
   size_t count; /* The total number of objects returned from the slab. */
+  nr_slab_page_pool_t* pool; /* The page pool, or NULL. */
+};
+
+/*
+ * The page pool.
+ *
+ * Retained pages are kept in a single linked list through their prev
+ * pointers. The used field of a retained page is left untouched, so that only
+ * the part of the page that was actually used needs to be zeroed again when
+ * the page is handed out.
+ */
+struct _nr_slab_page_pool_t {
+  nrthread_mutex_t lock;
+  nr_slab_page_t* pages;
+  size_t max_retained;
+  size_t retained;
+  uint64_t hits;
+  uint64_t misses;
 };
 
 #endif /* UTIL_SLAB_PRIVATE_HDR */
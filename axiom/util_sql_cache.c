@@ -0,0 +1,271 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "nr_axiom.h"
+
+#include "util_hashmap.h"
+#include "util_memory.h"
+#include "util_sql.h"
+#include "util_sql_cache.h"
+#include "util_strings.h"
+#include "util_threads.h"
+
+typedef struct _nr_sql_cache_entry_t {
+  struct _nr_sql_cache_entry_t* prev; /* More recently used */
+  struct _nr_sql_cache_entry_t* next; /* Less recently used */
+  char* sql;
+  size_t sql_len;
+  nr_sql_analysis_t analysis;
+} nr_sql_cache_entry_t;
+
+struct _nr_sql_cache_t {
+  nrthread_mutex_t lock;
+  nr_hashmap_t* entries;       /* Raw SQL -> nr_sql_cache_entry_t */
+  nr_sql_cache_entry_t* head;  /* Most recently used entry */
+  nr_sql_cache_entry_t* tail;  /* Least recently used entry */
+  size_t max_entries;
+  uint64_t hits;
+  uint64_t misses;
+};
+
+/*
+ * Copy the given parts of src that dest does not have yet.
+ */
+static void nr_sql_analysis_copy(nr_sql_analysis_t* dest,
+                                 const nr_sql_analysis_t* src,
+                                 int parts) {
+  parts &= src->parts & ~dest->parts;
+
+  if (parts & NR_SQL_ANALYSIS_OPERATION) {
+    dest->operation = src->operation;
+    dest->table = nr_strdup(src->table);
+  }
+  if (parts & NR_SQL_ANALYSIS_OBFUSCATED) {
+    dest->obfuscated = nr_strdup(src->obfuscated);
+    dest->normalized_id = src->normalized_id;
+  }
+  dest->parts |= parts;
+}
+
+/*
+ * Compute the given parts that the analysis does not have yet.
+ */
+static void nr_sql_analysis_compute(const char* sql,
+                                    int show_sql_parsing,
+                                    int parts,
+                                    nr_sql_analysis_t* analysis) {
+  parts &= ~analysis->parts;
+
+  if (parts & NR_SQL_ANALYSIS_OPERATION) {
+    nr_sql_get_operation_and_table(sql, &analysis->operation,
+                                   &analysis->table, show_sql_parsing);
+  }
+  if (parts & NR_SQL_ANALYSIS_OBFUSCATED) {
+    analysis->obfuscated = nr_sql_obfuscate(sql);
+    analysis->normalized_id = nr_sql_normalized_id(analysis->obfuscated);
+  }
+  analysis->parts |= parts;
+}
+
+static void nr_sql_cache_entry_destroy(nr_sql_cache_entry_t* entry) {
+  nr_free(entry->sql);
+  nr_sql_analysis_deinit(&entry->analysis);
+  nr_free(entry);
+}
+
+/*
+ * The following list functions must be called with the cache lock held.
+ */
+static void nr_sql_cache_unlink(nr_sql_cache_t* cache,
+                                nr_sql_cache_entry_t* entry) {
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->head = entry->next;
+  }
+
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->tail = entry->prev;
+  }
+
+  entry->prev = NULL;
+  entry->next = NULL;
+}
+
+static void nr_sql_cache_push_front(nr_sql_cache_t* cache,
+                                    nr_sql_cache_entry_t* entry) {
+  entry->prev = NULL;
+  entry->next = cache->head;
+
+  if (cache->head) {
+    cache->head->prev = entry;
+  } else {
+    cache->tail = entry;
+  }
+  cache->head = entry;
+}
+
+nr_sql_cache_t* nr_sql_cache_create(size_t max_entries) {
+  nr_sql_cache_t* cache;
+
+  if (0 == max_entries) {
+    return NULL;
+  }
+
+  cache = (nr_sql_cache_t*)nr_zalloc(sizeof(nr_sql_cache_t));
+  nrt_mutex_init(&cache->lock, 0);
+  cache->entries = nr_hashmap_create(NULL);
+  cache->max_entries = max_entries;
+
+  return cache;
+}
+
+void nr_sql_cache_destroy(nr_sql_cache_t** cache_ptr) {
+  nr_sql_cache_t* cache;
+  nr_sql_cache_entry_t* entry;
+
+  if (NULL == cache_ptr || NULL == *cache_ptr) {
+    return;
+  }
+
+  cache = *cache_ptr;
+
+  entry = cache->head;
+  while (entry) {
+    nr_sql_cache_entry_t* next = entry->next;
+
+    nr_sql_cache_entry_destroy(entry);
+    entry = next;
+  }
+
+  nr_hashmap_destroy(&cache->entries);
+  nrt_mutex_destroy(&cache->lock);
+  nr_realfree((void**)cache_ptr);
+}
+
+bool nr_sql_analyse(nr_sql_cache_t* cache,
+                    const char* sql,
+                    int show_sql_parsing,
+                    int parts,
+                    nr_sql_analysis_t* analysis) {
+  nr_sql_cache_entry_t* entry = NULL;
+  nr_sql_cache_entry_t* added = NULL;
+  void* value = NULL;
+  size_t sql_len;
+
+  if (NULL == sql || NULL == analysis) {
+    return false;
+  }
+
+  nr_memset(analysis, 0, sizeof(*analysis));
+  parts &= NR_SQL_ANALYSIS_ALL;
+  sql_len = nr_strlen(sql);
+
+  if (NULL == cache || sql_len > NR_SQL_CACHE_MAX_SQL_LEN) {
+    nr_sql_analysis_compute(sql, show_sql_parsing, parts, analysis);
+    return true;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  if (nr_hashmap_get_into(cache->entries, sql, sql_len, &value)) {
+    entry = (nr_sql_cache_entry_t*)value;
+    nr_sql_cache_unlink(cache, entry);
+    nr_sql_cache_push_front(cache, entry);
+    nr_sql_analysis_copy(analysis, &entry->analysis, parts);
+  }
+  if (parts == analysis->parts) {
+    cache->hits += 1;
+  } else {
+    cache->misses += 1;
+  }
+  nrt_mutex_unlock(&cache->lock);
+
+  if (parts == analysis->parts) {
+    return true;
+  }
+
+  /*
+   * Statements are analysed without holding the lock, so that a miss does not
+   * block other threads.
+   */
+  nr_sql_analysis_compute(sql, show_sql_parsing, parts, analysis);
+
+  /*
+   * The entry found above, if any, is only used while the lock is held, as
+   * another thread may evict it.
+   */
+  if (NULL == entry) {
+    added = (nr_sql_cache_entry_t*)nr_zalloc(sizeof(nr_sql_cache_entry_t));
+    added->sql = nr_strndup(sql, sql_len);
+    added->sql_len = sql_len;
+    nr_sql_analysis_copy(&added->analysis, analysis, NR_SQL_ANALYSIS_ALL);
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  if (nr_hashmap_get_into(cache->entries, sql, sql_len, &value)) {
+    /*
+     * Add the parts just computed to the statement, which was cached without
+     * them, or was cached by another thread in the meantime.
+     */
+    entry = (nr_sql_cache_entry_t*)value;
+    nr_sql_analysis_copy(&entry->analysis, analysis, NR_SQL_ANALYSIS_ALL);
+    nrt_mutex_unlock(&cache->lock);
+    if (added) {
+      nr_sql_cache_entry_destroy(added);
+    }
+    return true;
+  }
+
+  if (NULL == added) {
+    /* The statement was evicted in the meantime. */
+    nrt_mutex_unlock(&cache->lock);
+    return true;
+  }
+
+  if (nr_hashmap_count(cache->entries) >= cache->max_entries) {
+    nr_sql_cache_entry_t* lru = cache->tail;
+
+    nr_sql_cache_unlink(cache, lru);
+    nr_hashmap_delete(cache->entries, lru->sql, lru->sql_len);
+    nr_sql_cache_entry_destroy(lru);
+  }
+
+  nr_hashmap_set(cache->entries, added->sql, added->sql_len, added);
+  nr_sql_cache_push_front(cache, added);
+  nrt_mutex_unlock(&cache->lock);
+
+  return true;
+}
+
+void nr_sql_analysis_deinit(nr_sql_analysis_t* analysis) {
+  if (NULL == analysis) {
+    return;
+  }
+
+  nr_free(analysis->obfuscated);
+  nr_free(analysis->table);
+  analysis->operation = NULL;
+  analysis->normalized_id = 0;
+  analysis->parts = 0;
+}
+
+bool nr_sql_cache_take_stats(nr_sql_cache_t* cache,
+                             nr_sql_cache_stats_t* stats) {
+  if (NULL == cache || NULL == stats) {
+    return false;
+  }
+
+  nrt_mutex_lock(&cache->lock);
+  stats->hits = cache->hits;
+  stats->misses = cache->misses;
+  stats->size = nr_hashmap_count(cache->entries);
+  cache->hits = 0;
+  cache->misses = 0;
+  nrt_mutex_unlock(&cache->lock);
+
+  return true;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 New Relic Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file contains a cache of SQL analysis results.
+ *
+ * Applications tend to issue the same few statements over and over again. The
+ * cache remembers the obfuscated form, operation, table and normalized id of
+ * recently seen raw SQL, so that they only need to be computed once per
+ * statement rather than once per query. Each part is only computed once a
+ * caller asks for it. The cache is intended to be shared by all transactions
+ * within a process, and is therefore protected by a mutex.
+ */
+#ifndef UTIL_SQL_CACHE_HDR
+#define UTIL_SQL_CACHE_HDR
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * SQL longer than this is analysed every time rather than cached.
+ */
+#define NR_SQL_CACHE_MAX_SQL_LEN 8192
+
+typedef struct _nr_sql_cache_t nr_sql_cache_t;
+
+/*
+ * The parts of an analysis, which are computed separately so that callers
+ * only pay for those they use. Obfuscation is by far the most expensive.
+ */
+#define NR_SQL_ANALYSIS_OPERATION 0x1  /* The operation and table */
+#define NR_SQL_ANALYSIS_OBFUSCATED 0x2 /* The obfuscated SQL and its id */
+#define NR_SQL_ANALYSIS_ALL \
+  (NR_SQL_ANALYSIS_OPERATION | NR_SQL_ANALYSIS_OBFUSCATED)
+
+/*
+ * The result of analysing a raw SQL statement. All strings are owned by the
+ * structure and are freed by nr_sql_analysis_deinit().
+ */
+typedef struct _nr_sql_analysis_t {
+  char* obfuscated;       /* As returned by nr_sql_obfuscate() */
+  const char* operation;  /* As returned by nr_sql_get_operation_and_table();
+                             this is a constant string */
+  char* table;            /* As returned by nr_sql_get_operation_and_table() */
+  uint32_t normalized_id; /* As returned by nr_sql_normalized_id() */
+  int parts;              /* The NR_SQL_ANALYSIS_* parts filled in */
+} nr_sql_analysis_t;
+
+typedef struct _nr_sql_cache_stats_t {
+  uint64_t hits;   /* Statements found in the cache */
+  uint64_t misses; /* Statements, or parts of them, that had to be analysed */
+  size_t size;     /* Statements currently cached */
+} nr_sql_cache_stats_t;
+
+/*
+ * Purpose : Create a SQL analysis cache.
+ *
+ * Params  : 1. The maximum number of statements to cache. When the cache is
+ *              full, the least recently used statement is evicted.
+ *
+ * Returns : A cache, or NULL if the maximum number of statements is 0.
+ */
+extern nr_sql_cache_t* nr_sql_cache_create(size_t max_entries);
+
+/*
+ * Purpose : Destroy a SQL analysis cache.
+ *
+ * Params  : 1. A pointer to the cache to destroy.
+ */
+extern void nr_sql_cache_destroy(nr_sql_cache_t** cache_ptr);
+
+/*
+ * Purpose : Analyse a raw SQL statement, using the cache if possible.
+ *
+ * Params  : 1. The cache. If this is NULL, the statement is always analysed.
+ *           2. The raw SQL.
+ *           3. Whether to log SQL parsing, as per the show_sql_parsing
+ *              special flag. This only affects statements not yet cached.
+ *           4. The NR_SQL_ANALYSIS_* parts to fill in. Parts that are not
+ *              cached yet are computed and added to the cache.
+ *           5. The analysis to fill in. Only the requested parts are set. It
+ *              must be deinitialised with nr_sql_analysis_deinit() once it is
+ *              no longer needed.
+ *
+ * Returns : True if the analysis was filled in; false otherwise.
+ */
+extern bool nr_sql_analyse(nr_sql_cache_t* cache,
+                           const char* sql,
+                           int show_sql_parsing,
+                           int parts,
+                           nr_sql_analysis_t* analysis);
+
+/*
+ * Purpose : Free the strings within an analysis.
+ */
+extern void nr_sql_analysis_deinit(nr_sql_analysis_t* analysis);
+
+/*
+ * Purpose : Get the statistics of a SQL analysis cache.
+ *
+ * Params  : 1. The cache.
+ *           2. The statistics to fill in. The hit and miss counts are those
+ *              since the previous call to this function, and are reset.
+ *
+ * Returns : True if the statistics were filled in; false otherwise.
+ */
+extern bool nr_sql_cache_take_stats(nr_sql_cache_t* cache,
+                                    nr_sql_cache_stats_t* stats);
+
+#endif /* UTIL_SQL_CACHE_HDR */
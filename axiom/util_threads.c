@@ -133,6 +133,101 @@ nr_status_t nrt_mutex_destroy_f(nrthread_mutex_t* mutex,
   return NR_SUCCESS;
 }
 
+nr_status_t nrt_rwlock_init_f(nrthread_rwlock_t* rwlock,
+                              const char* file,
+                              int line) {
+  int ret;
+
+  if (0 == rwlock) {
+    return NR_FAILURE;
+  }
+
+  ret = pthread_rwlock_init((pthread_rwlock_t*)rwlock, NULL);
+  if (0 != ret) {
+    nrl_error(NRL_THREADS, "nrt_rwlock_init failed: %.16s [%.150s:%d]",
+              nr_errno(ret), file, line);
+    return NR_FAILURE;
+  }
+
+  return NR_SUCCESS;
+}
+
+nr_status_t nrt_rwlock_destroy_f(nrthread_rwlock_t* rwlock,
+                                 const char* file,
+                                 int line) {
+  int ret;
+
+  if (0 == rwlock) {
+    return NR_FAILURE;
+  }
+
+  ret = pthread_rwlock_destroy((pthread_rwlock_t*)rwlock);
+  if (0 != ret) {
+    nrl_error(NRL_THREADS, "nrt_rwlock_destroy failed: %.16s [%.150s:%d]",
+              nr_errno(ret), file, line);
+    return NR_FAILURE;
+  }
+
+  return NR_SUCCESS;
+}
+
+nr_status_t nrt_rwlock_rdlock_f(nrthread_rwlock_t* rwlock,
+                                const char* file,
+                                int line) {
+  int ret;
+
+  if (0 == rwlock) {
+    return NR_FAILURE;
+  }
+
+  ret = pthread_rwlock_rdlock((pthread_rwlock_t*)rwlock);
+  if (0 != ret) {
+    nrl_error(NRL_THREADS, "nrt_rwlock_rdlock failed: %.16s [%.150s:%d]",
+              nr_errno(ret), file, line);
+    return NR_FAILURE;
+  }
+
+  return NR_SUCCESS;
+}
+
+nr_status_t nrt_rwlock_wrlock_f(nrthread_rwlock_t* rwlock,
+                                const char* file,
+                                int line) {
+  int ret;
+
+  if (0 == rwlock) {
+    return NR_FAILURE;
+  }
+
+  ret = pthread_rwlock_wrlock((pthread_rwlock_t*)rwlock);
+  if (0 != ret) {
+    nrl_error(NRL_THREADS, "nrt_rwlock_wrlock failed: %.16s [%.150s:%d]",
+              nr_errno(ret), file, line);
+    return NR_FAILURE;
+  }
+
+  return NR_SUCCESS;
+}
+
+nr_status_t nrt_rwlock_unlock_f(nrthread_rwlock_t* rwlock,
+                                const char* file,
+                                int line) {
+  int ret;
+
+  if (0 == rwlock) {
+    return NR_FAILURE;
+  }
+
+  ret = pthread_rwlock_unlock((pthread_rwlock_t*)rwlock);
+  if (0 != ret) {
+    nrl_error(NRL_THREADS, "nrt_rwlock_unlock failed: %.16s [%.150s:%d]",
+              nr_errno(ret), file, line);
+    return NR_FAILURE;
+  }
+
+  return NR_SUCCESS;
+}
+
 nr_status_t nrt_join_f(nrthread_t thread,
                        void** valptr,
                        const char* file,
@@ -20,6 +20,7 @@ typedef pthread_mutex_t nrthread_mutex_t;
 typedef pthread_t nrthread_t;
 typedef pthread_attr_t nrthread_attr_t;
 typedef pthread_mutexattr_t nrthread_mutexattr_t;
+typedef pthread_rwlock_t nrthread_rwlock_t;
 
 #define NRTHREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
 
@@ -66,6 +67,29 @@ extern nr_status_t nrt_mutex_unlock_f(nrthread_mutex_t* mutex,
                                       const char* file,
                                       int line);
 
+/*
+ * Purpose : Initialize, destroy, or acquire and release a reader-writer lock.
+ *           Any number of threads may hold the lock for reading at once.
+ * Returns : NR_SUCCESS or NR_FAILURE.
+ * See     :
+ * http://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_init.html
+ */
+extern nr_status_t nrt_rwlock_init_f(nrthread_rwlock_t* rwlock,
+                                     const char* file,
+                                     int line);
+extern nr_status_t nrt_rwlock_destroy_f(nrthread_rwlock_t* rwlock,
+                                        const char* file,
+                                        int line);
+extern nr_status_t nrt_rwlock_rdlock_f(nrthread_rwlock_t* rwlock,
+                                       const char* file,
+                                       int line);
+extern nr_status_t nrt_rwlock_wrlock_f(nrthread_rwlock_t* rwlock,
+                                       const char* file,
+                                       int line);
+extern nr_status_t nrt_rwlock_unlock_f(nrthread_rwlock_t* rwlock,
+                                       const char* file,
+                                       int line);
+
 /*
  * Purpose : Wait for thread termination.
  * Returns : NR_SUCCESS or NR_FAILURE.
@@ -84,6 +108,11 @@ extern nr_status_t nrt_join_f(nrthread_t thread,
 #define nrt_mutex_lock(T) nrt_mutex_lock_f((T), __FILE__, __LINE__)
 #define nrt_mutex_unlock(T) nrt_mutex_unlock_f((T), __FILE__, __LINE__)
 #define nrt_mutex_destroy(T) nrt_mutex_destroy_f((T), __FILE__, __LINE__)
+#define nrt_rwlock_init(T) nrt_rwlock_init_f((T), __FILE__, __LINE__)
+#define nrt_rwlock_destroy(T) nrt_rwlock_destroy_f((T), __FILE__, __LINE__)
+#define nrt_rwlock_rdlock(T) nrt_rwlock_rdlock_f((T), __FILE__, __LINE__)
+#define nrt_rwlock_wrlock(T) nrt_rwlock_wrlock_f((T), __FILE__, __LINE__)
+#define nrt_rwlock_unlock(T) nrt_rwlock_unlock_f((T), __FILE__, __LINE__)
 #define nrt_join(T, V) nrt_join_f((T), (V), __FILE__, __LINE__)
 
 /*
@@ -79,6 +79,7 @@ type Txn struct {
 
 type metric struct {
 	Name   string
+	NameID uint32
 	Data   [6]float64
 	Scoped bool
 	Forced bool
@@ -105,7 +106,73 @@ func (t *Txn) MarshalSpanBatchBinary(batchSize int, protoSpanBatch []byte) ([]by
 
 func (t *Txn) MarshalBinary() ([]byte, error) {
 	buf := flatbuffers.NewBuilder(0)
+	dataOffset := t.encode(buf)
 
+	id := buf.CreateString(t.RunID)
+	protocol.MessageStart(buf)
+	protocol.MessageAddAgentRunId(buf, id)
+	protocol.MessageAddDataType(buf, protocol.MessageBodyTransaction)
+	protocol.MessageAddData(buf, dataOffset)
+	buf.Finish(protocol.MessageEnd(buf))
+	return buf.Bytes[buf.Head():], nil
+}
+
+// metricGroup is a group of metrics aggregated across the transactions of a
+// batch.
+type metricGroup struct {
+	Scope   string
+	Metrics []metric
+}
+
+// marshalTxnBatch encodes a transaction batch message. The metrics of the
+// transactions are sent as given, normally none.
+func marshalTxnBatch(runID string, txns []*Txn, groups []metricGroup) ([]byte, error) {
+	buf := flatbuffers.NewBuilder(0)
+
+	txnOffsets := make([]flatbuffers.UOffsetT, len(txns))
+	for i, txn := range txns {
+		txnOffsets[i] = txn.encode(buf)
+	}
+
+	groupOffsets := make([]flatbuffers.UOffsetT, len(groups))
+	for i, group := range groups {
+		scope := buf.CreateString(group.Scope)
+		metrics := encodeMetrics(buf, group.Metrics)
+
+		protocol.MetricGroupStart(buf)
+		protocol.MetricGroupAddScope(buf, scope)
+		protocol.MetricGroupAddMetrics(buf, metrics)
+		groupOffsets[i] = protocol.MetricGroupEnd(buf)
+	}
+
+	protocol.TransactionBatchStartTransactionsVector(buf, len(txns))
+	for i := len(txns) - 1; i >= 0; i-- {
+		buf.PrependUOffsetT(txnOffsets[i])
+	}
+	transactions := buf.EndVector(len(txns))
+
+	protocol.TransactionBatchStartMetricsVector(buf, len(groups))
+	for i := len(groups) - 1; i >= 0; i-- {
+		buf.PrependUOffsetT(groupOffsets[i])
+	}
+	metrics := buf.EndVector(len(groups))
+
+	protocol.TransactionBatchStart(buf)
+	protocol.TransactionBatchAddTransactions(buf, transactions)
+	protocol.TransactionBatchAddMetrics(buf, metrics)
+	dataOffset := protocol.TransactionBatchEnd(buf)
+
+	id := buf.CreateString(runID)
+	protocol.MessageStart(buf)
+	protocol.MessageAddAgentRunId(buf, id)
+	protocol.MessageAddDataType(buf, protocol.MessageBodyTransactionBatch)
+	protocol.MessageAddData(buf, dataOffset)
+	buf.Finish(protocol.MessageEnd(buf))
+	return buf.Bytes[buf.Head():], nil
+}
+
+// encode prepends the transaction to the FlatBuffer and returns its offset.
+func (t *Txn) encode(buf *flatbuffers.Builder) flatbuffers.UOffsetT {
 	// Transaction Event
 	var analyticEvent flatbuffers.UOffsetT
 	if len(t.AnalyticEvent) > 0 {
@@ -151,23 +218,16 @@ func (t *Txn) MarshalBinary() ([]byte, error) {
 	protocol.TransactionAddErrorEvents(buf, errorEvents)
 	protocol.TransactionAddTrace(buf, trace)
 	protocol.TransactionAddSpanEvents(buf, spanEvents)
-	dataOffset := protocol.TransactionEnd(buf)
-
-	id := buf.CreateString(t.RunID)
-	protocol.MessageStart(buf)
-	protocol.MessageAddAgentRunId(buf, id)
-	protocol.MessageAddDataType(buf, protocol.MessageBodyTransaction)
-	protocol.MessageAddData(buf, dataOffset)
-	buf.Finish(protocol.MessageEnd(buf))
-	return buf.Bytes[buf.Head():], nil
+	return protocol.TransactionEnd(buf)
 }
 
 func encodeMetrics(b *flatbuffers.Builder, metrics []metric) flatbuffers.UOffsetT {
 	if n := len(metrics); n > 0 {
 		offsets := make([]flatbuffers.UOffsetT, n)
 		for i := n - 1; i >= 0; i-- {
-			offsets[i] = protocol.EncodeMetric(b, metrics[i].Name,
-				metrics[i].Data, metrics[i].Scoped, metrics[i].Forced)
+			offsets[i] = protocol.EncodeMetricID(b, metrics[i].Name,
+				metrics[i].NameID, metrics[i].Data, metrics[i].Scoped,
+				metrics[i].Forced)
 		}
 
 		protocol.TransactionStartMetricsVector(b, n)
@@ -7,6 +7,7 @@ package flatbuffersdata
 
 import (
 	"reflect"
+	"strings"
 	"testing"
 	"time"
 
@@ -219,3 +220,192 @@ func TestMinimumFlatbufferSize(t *testing.T) {
 		t.Fatalf("Unexpected minimum flatbuffer size: %d", minLen)
 	}
 }
+
+type txnRecorder struct {
+	samples []newrelic.AggregaterInto
+}
+
+func (r *txnRecorder) IncomingTxnData(id newrelic.AgentRunID, sample newrelic.AggregaterInto) {
+	r.samples = append(r.samples, sample)
+}
+
+func (r *txnRecorder) IncomingSpanBatch(batch newrelic.SpanBatch) {}
+
+func (r *txnRecorder) IncomingAppInfo(id *newrelic.AgentRunID, info *newrelic.AppInfo) newrelic.AppInfoReply {
+	return newrelic.AppInfoReply{}
+}
+
+func marshalTxnMetrics(t testing.TB, metrics []metric) []byte {
+	txn := Txn{RunID: "12345", Name: "heyo", Metrics: metrics}
+	data, err := txn.MarshalBinary()
+	if nil != err {
+		t.Fatal(err)
+	}
+	return data
+}
+
+func TestFlatbuffersTxnDataMetricNameIds(t *testing.T) {
+	recorder := &txnRecorder{}
+	conn := newrelic.CommandsHandler{Processor: recorder}.ForConnection()
+
+	messages := [][]byte{
+		marshalTxnMetrics(t, []metric{
+			{Name: "defined", NameID: 1, Data: [6]float64{1, 2, 3, 4, 5, 6}, Scoped: true},
+			{Name: "inline", Data: [6]float64{1, 2, 3, 4, 5, 6}},
+		}),
+		marshalTxnMetrics(t, []metric{
+			{NameID: 1, Data: [6]float64{1, 2, 3, 4, 5, 6}, Scoped: true},
+			{NameID: 2, Data: [6]float64{1, 2, 3, 4, 5, 6}},
+		}),
+	}
+	for _, data := range messages {
+		if _, err := conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: data}); nil != err {
+			t.Fatal(err)
+		}
+	}
+
+	if len(recorder.samples) != 2 {
+		t.Fatal(len(recorder.samples))
+	}
+
+	harvest := newrelic.NewHarvest(time.Now(), collector.NewHarvestLimits(nil))
+	for _, sample := range recorder.samples {
+		sample.AggregateInto(harvest)
+	}
+
+	for _, name := range []string{"defined", "inline", "Supportability/TxnData/UnknownMetricNameId"} {
+		if !harvest.Metrics.Has(name) {
+			t.Errorf("missing metric %q: %s", name, harvest.Metrics.DebugJSON())
+		}
+	}
+
+	// Ids are only known on the connection that defined them.
+	recorder.samples = nil
+	other := newrelic.CommandsHandler{Processor: recorder}.ForConnection()
+	other.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: messages[1]})
+
+	harvest = newrelic.NewHarvest(time.Now(), collector.NewHarvestLimits(nil))
+	recorder.samples[0].AggregateInto(harvest)
+	if harvest.Metrics.Has("defined") {
+		t.Error(harvest.Metrics.DebugJSON())
+	}
+}
+
+func BenchmarkAggregateTxnMetricNameIds(b *testing.B) {
+	defining := make([]metric, len(SampleMetrics))
+	referring := make([]metric, len(SampleMetrics))
+	for i, m := range SampleMetrics {
+		defining[i] = m
+		defining[i].NameID = uint32(i + 1)
+		referring[i] = defining[i]
+		referring[i].Name = ""
+	}
+
+	recorder := &txnRecorder{}
+	conn := newrelic.CommandsHandler{Processor: recorder}.ForConnection()
+	conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: marshalTxnMetrics(b, defining)})
+	conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: marshalTxnMetrics(b, referring)})
+
+	harvest := newrelic.NewHarvest(time.Now(), collector.NewHarvestLimits(nil))
+	ag := recorder.samples[1]
+
+	// Add the metrics, so we are only doing lookups in the loop
+	recorder.samples[0].AggregateInto(harvest)
+
+	b.ReportAllocs()
+	b.ResetTimer()
+
+	for i := 0; i < b.N; i++ {
+		ag.AggregateInto(harvest)
+	}
+}
+
+func TestFlatbuffersTxnBatch(t *testing.T) {
+	recorder := &txnRecorder{}
+	conn := newrelic.CommandsHandler{Processor: recorder}.ForConnection()
+
+	txns := []*Txn{
+		{RunID: "12345", Name: "WebTransaction/Uri/one", AnalyticEvent: SampleAnalyticEvent},
+		{RunID: "12345", Name: "WebTransaction/Uri/two", AnalyticEvent: SampleAnalyticEvent},
+	}
+	groups := []metricGroup{
+		{Metrics: []metric{
+			{Name: "WebTransaction", NameID: 1, Data: [6]float64{2, 3, 3, 1, 2, 5}, Forced: true},
+		}},
+		{Scope: "WebTransaction/Uri/one", Metrics: []metric{
+			{Name: "Datastore/all", NameID: 2, Data: [6]float64{3, 1, 1, 0.25, 0.5, 0.375}, Scoped: true},
+		}},
+	}
+
+	data, err := marshalTxnBatch("12345", txns, groups)
+	if nil != err {
+		t.Fatal(err)
+	}
+	if _, err := conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: data}); nil != err {
+		t.Fatal(err)
+	}
+
+	// Later batches may refer to the names by id alone.
+	groups[0].Metrics[0].Name = ""
+	groups[1].Metrics[0].Name = ""
+	data, err = marshalTxnBatch("12345", txns[:1], groups)
+	if nil != err {
+		t.Fatal(err)
+	}
+	if _, err := conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: data}); nil != err {
+		t.Fatal(err)
+	}
+
+	if len(recorder.samples) != 2 {
+		t.Fatal(len(recorder.samples))
+	}
+
+	harvest := newrelic.NewHarvest(time.Now(), collector.NewHarvestLimits(nil))
+	for _, sample := range recorder.samples {
+		sample.AggregateInto(harvest)
+	}
+
+	if seen := harvest.TxnEvents.NumSeen(); seen != 3 {
+		t.Errorf("txn events seen = %v, want 3", seen)
+	}
+
+	id := newrelic.AgentRunID("12345")
+	out, err := harvest.Metrics.CollectorJSONSorted(id, time.Unix(1417136520, 0))
+	if nil != err {
+		t.Fatal(err)
+	}
+	for _, expected := range []string{
+		`[{"name":"WebTransaction"},[4,6,6,1,2,10]]`,
+		`[{"name":"Datastore/all"},[6,2,2,0.25,0.5,0.75]]`,
+		`[{"name":"Datastore/all","scope":"WebTransaction/Uri/one"},[6,2,2,0.25,0.5,0.75]]`,
+		`[{"name":"Supportability/TxnData/BatchTransactions"},[2,3,0,1,2,5]]`,
+	} {
+		if !strings.Contains(string(out), expected) {
+			t.Errorf("missing %s in %s", expected, out)
+		}
+	}
+	if harvest.Metrics.Has("Supportability/TxnData/UnknownMetricNameId") {
+		t.Error(string(out))
+	}
+}
+
+func TestFlatbuffersTxnBatchTooLarge(t *testing.T) {
+	recorder := &txnRecorder{}
+	conn := newrelic.CommandsHandler{Processor: recorder}.ForConnection()
+
+	txns := make([]*Txn, limits.MaxTxnBatchSize+1)
+	for i := range txns {
+		txns[i] = &Txn{RunID: "12345", Name: "heyo"}
+	}
+
+	data, err := marshalTxnBatch("12345", txns, nil)
+	if nil != err {
+		t.Fatal(err)
+	}
+	if _, err := conn.HandleMessage(newrelic.RawMessage{Type: newrelic.MessageTypeBinary, Bytes: data}); nil == err {
+		t.Error("oversized batch accepted")
+	}
+	if len(recorder.samples) != 0 {
+		t.Error(len(recorder.samples))
+	}
+}
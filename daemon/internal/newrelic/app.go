@@ -73,6 +73,7 @@ type AppInfo struct {
 	TraceObserverHost         string
 	TraceObserverPort         uint16
 	SpanQueueSize             uint64
+	SpanStreamCount           uint16
 	AgentEventLimits          collector.EventConfigs
 	DockerId                  string
 }
@@ -141,6 +142,7 @@ type App struct {
 	samplingTarget      uint16
 	info                *AppInfo
 	connectReply        *ConnectReply
+	metricRules         *MetricRulesCache
 	RawSecurityPolicies []byte
 	RawConnectReply     []byte
 	HarvestTrigger      HarvestTriggerFunc
@@ -51,6 +51,8 @@ func NewAppHarvest(id AgentRunID, app *App, harvest *Harvest, ph chan ProcessorH
 			Secure:            true,
 			QueueSize:         app.info.SpanQueueSize,
 			RequestHeadersMap: app.connectReply.RequestHeadersMap,
+			Streams:           int(app.info.SpanStreamCount),
+			MaxBatchBytes:     infinite_tracing.DefaultMaxBatchBytes,
 		}
 		ah.TraceObserver = infinite_tracing.NewTraceObserver(cfg)
 	}
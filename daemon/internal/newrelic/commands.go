@@ -21,36 +21,96 @@ import (
 
 type CommandsHandler struct {
 	Processor AgentDataHandler
+
+	// metricNames holds the metric names sent by id on the connection this
+	// handler serves. It is nil for handlers not bound to a connection.
+	metricNames *metricNames
+
+	// runID is the agent run id of the last transaction received on the
+	// connection, which its statistics are reported to. It is nil for
+	// handlers not bound to a connection.
+	runID *AgentRunID
 }
 
-func aggregateMetrics(txn protocol.Transaction, h *Harvest, txnName string) {
+// ForConnection returns a handler for a single agent connection.
+func (h CommandsHandler) ForConnection() MessageHandler {
+	h.metricNames = &metricNames{}
+	h.runID = new(AgentRunID)
+	return h
+}
+
+// reportConnStats sends the statistics of the connection to the harvest of
+// the last application that sent a transaction over it.
+func (h CommandsHandler) reportConnStats(stats connStats) bool {
+	if nil == h.runID || "" == *h.runID {
+		return false
+	}
+	h.Processor.IncomingTxnData(*h.runID, stats)
+	return true
+}
+
+func aggregateMetrics(txn protocol.Transaction, h *Harvest, txnName string,
+	names []string) {
 	var m protocol.Metric
 	var data protocol.MetricData
-	var d [6]float64
 
 	n := txn.MetricsLength()
 	for i := 0; i < n; i++ {
 		txn.Metrics(&m, i)
-		m.Data(&data)
-
-		d[0] = data.Count()
-		d[1] = data.Total()
-		d[2] = data.Exclusive()
-		d[3] = data.Min()
-		d[4] = data.Max()
-		d[5] = data.SumSquares()
-
-		forced := Unforced
-		if data.Forced() != false {
-			forced = Forced
-		}
+		aggregateMetric(&m, &data, h, txnName, names)
+	}
+}
+
+// aggregateMetricGroup aggregates metrics pre-aggregated by the agent across
+// the transactions of a batch.
+func aggregateMetricGroup(group *protocol.MetricGroup, h *Harvest,
+	names []string) {
+	var m protocol.Metric
+	var data protocol.MetricData
 
-		metricName := m.Name()
-		h.Metrics.AddRaw(metricName, "", "", d, forced)
-		if data.Scoped() != false {
-			h.Metrics.AddRaw(metricName, "", txnName, d, forced)
+	scope := string(group.Scope())
+
+	n := group.MetricsLength()
+	for i := 0; i < n; i++ {
+		group.Metrics(&m, i)
+		aggregateMetric(&m, &data, h, scope, names)
+	}
+}
+
+func aggregateMetric(m *protocol.Metric, data *protocol.MetricData,
+	h *Harvest, scope string, names []string) {
+	var d [6]float64
+
+	m.Data(data)
+
+	d[0] = data.Count()
+	d[1] = data.Total()
+	d[2] = data.Exclusive()
+	d[3] = data.Min()
+	d[4] = data.Max()
+	d[5] = data.SumSquares()
+
+	forced := Unforced
+	if data.Forced() != false {
+		forced = Forced
+	}
+
+	// Names sent by id resolve to strings already held by the
+	// connection's dictionary, so no string is allocated for them.
+	var nameString string
+	metricName := m.Name()
+	if nil == metricName {
+		var ok bool
+		if nameString, ok = lookupMetricName(names, m.NameId()); !ok {
+			h.Metrics.AddCount("Supportability/TxnData/UnknownMetricNameId", "", 1, Forced)
+			return
 		}
 	}
+
+	h.Metrics.AddRaw(metricName, nameString, "", d, forced)
+	if data.Scoped() != false {
+		h.Metrics.AddRaw(metricName, nameString, scope, d, forced)
+	}
 }
 
 func copySlice(b []byte) []byte {
@@ -64,16 +124,69 @@ func copySlice(b []byte) []byte {
 
 type FlatTxn []byte
 
+// flatTxnWithNames is a FlatTxn whose metrics may refer to names defined by
+// earlier messages on the same connection.
+type flatTxnWithNames struct {
+	FlatTxn
+	names []string
+}
+
+func (t flatTxnWithNames) AggregateInto(h *Harvest) {
+	t.FlatTxn.aggregateInto(h, t.names)
+}
+
 func (t FlatTxn) AggregateInto(h *Harvest) {
+	t.aggregateInto(h, nil)
+}
+
+func (t FlatTxn) aggregateInto(h *Harvest, names []string) {
 	var tbl flatbuffers.Table
 	var txn protocol.Transaction
-	var syntheticsResourceID string
 
 	msg := protocol.GetRootAsMessage([]byte(t), 0)
 	msg.Data(&tbl)
 	txn.Init(tbl.Bytes, tbl.Pos)
 
 	h.Metrics.AddValue("Supportability/TxnData/Size", "", float64(len(t)), Forced)
+	aggregateTxn(&txn, h, names)
+}
+
+// flatTxnBatch is a message holding a batch of transactions, whose metrics
+// were aggregated by the agent.
+type flatTxnBatch struct {
+	data  []byte
+	names []string
+}
+
+func (b flatTxnBatch) AggregateInto(h *Harvest) {
+	var tbl flatbuffers.Table
+	var batch protocol.TransactionBatch
+	var txn protocol.Transaction
+	var group protocol.MetricGroup
+
+	msg := protocol.GetRootAsMessage(b.data, 0)
+	msg.Data(&tbl)
+	batch.Init(tbl.Bytes, tbl.Pos)
+
+	n := batch.TransactionsLength()
+	h.Metrics.AddValue("Supportability/TxnData/BatchSize", "", float64(len(b.data)), Forced)
+	h.Metrics.AddValue("Supportability/TxnData/BatchTransactions", "", float64(n), Forced)
+
+	for i := 0; i < n; i++ {
+		batch.Transactions(&txn, i)
+		aggregateTxn(&txn, h, b.names)
+	}
+
+	groups := batch.MetricsLength()
+	for i := 0; i < groups; i++ {
+		batch.Metrics(&group, i)
+		aggregateMetricGroup(&group, h, b.names)
+	}
+}
+
+func aggregateTxn(txn *protocol.Transaction, h *Harvest, names []string) {
+	var syntheticsResourceID string
+
 	h.Metrics.AddValue("Supportability/TxnData/CustomEvents", "", float64(txn.CustomEventsLength()), Forced)
 	h.Metrics.AddValue("Supportability/TxnData/Metrics", "", float64(txn.MetricsLength()), Forced)
 	h.Metrics.AddValue("Supportability/TxnData/SlowSQL", "", float64(txn.SlowSqlsLength()), Forced)
@@ -100,7 +213,7 @@ func (t FlatTxn) AggregateInto(h *Harvest) {
 		}
 	}
 
-	aggregateMetrics(txn, h, txnName)
+	aggregateMetrics(*txn, h, txnName, names)
 
 	if n := txn.ErrorsLength(); n > 0 {
 		var e protocol.Error
@@ -208,6 +321,8 @@ func MarshalAppInfoReply(reply AppInfoReply) []byte {
 	if reply.RunIDValid {
 		protocol.AppReplyStart(buf)
 		protocol.AppReplyAddStatus(buf, protocol.AppStatusStillValid)
+		protocol.AppReplyAddMetricNameIds(buf, limits.MaxMetricNameIds)
+		protocol.AppReplyAddTxnBatchSize(buf, limits.MaxTxnBatchSize)
 		dataOffset := protocol.AppReplyEnd(buf)
 
 		protocol.MessageStart(buf)
@@ -227,6 +342,8 @@ func MarshalAppInfoReply(reply AppInfoReply) []byte {
 		protocol.AppReplyAddConnectTimestamp(buf, reply.ConnectTimestamp)
 		protocol.AppReplyAddHarvestFrequency(buf, reply.HarvestFrequency)
 		protocol.AppReplyAddSamplingTarget(buf, reply.SamplingTarget)
+		protocol.AppReplyAddMetricNameIds(buf, limits.MaxMetricNameIds)
+		protocol.AppReplyAddTxnBatchSize(buf, limits.MaxTxnBatchSize)
 		dataOffset := protocol.AppReplyEnd(buf)
 
 		protocol.MessageStart(buf)
@@ -278,6 +395,7 @@ func UnmarshalAppInfo(tbl flatbuffers.Table) *AppInfo {
 		TraceObserverHost:         string(app.TraceObserverHost()),
 		TraceObserverPort:         app.TraceObserverPort(),
 		SpanQueueSize:             app.SpanQueueSize(),
+		SpanStreamCount:           app.SpanStreamCount(),
 		HighSecurity:              app.HighSecurity(),
 		DockerId:                  string(app.DockerId()),
 	}
@@ -294,7 +412,9 @@ func UnmarshalAppInfo(tbl flatbuffers.Table) *AppInfo {
 	return info
 }
 
-func processBinary(data []byte, handler AgentDataHandler) ([]byte, error) {
+func processBinary(raw RawMessage, handler AgentDataHandler, names *metricNames,
+	runID *AgentRunID) ([]byte, error) {
+	data := raw.Bytes
 	if len(data) == 0 {
 		log.Debugf("ignoring empty message")
 		return nil, nil
@@ -321,12 +441,60 @@ func processBinary(data []byte, handler AgentDataHandler) ([]byte, error) {
 
 		if id := msg.AgentRunId(); len(id) > 0 {
 			// Send the data directly to the processor without a
-			// copy because each message is in its own buffer.
+			// copy, keeping the buffer from being reused.
+			raw.Retain()
+
+			if nil != runID && string(*runID) != string(id) {
+				*runID = AgentRunID(id)
+			}
+
+			if nil != names {
+				var txn protocol.Transaction
+
+				txn.Init(tbl.Bytes, tbl.Pos)
+				if defined := names.define(&txn); len(defined) > 0 {
+					handler.IncomingTxnData(AgentRunID(id),
+						flatTxnWithNames{FlatTxn: FlatTxn(data), names: defined})
+					return nil, nil
+				}
+			}
 			handler.IncomingTxnData(AgentRunID(id), FlatTxn(data))
 			return nil, nil
 		}
 		return nil, errors.New("missing agent run id for txn data command")
 
+	case protocol.MessageBodyTransactionBatch:
+		var tbl flatbuffers.Table
+
+		if !msg.Data(&tbl) {
+			return nil, errors.New("transaction batch missing message body")
+		}
+
+		id := msg.AgentRunId()
+		if len(id) == 0 {
+			return nil, errors.New("missing agent run id for transaction batch command")
+		}
+
+		var batch protocol.TransactionBatch
+		batch.Init(tbl.Bytes, tbl.Pos)
+		if n := batch.TransactionsLength(); n > limits.MaxTxnBatchSize {
+			return nil, fmt.Errorf("transaction batch too large, %d > %d",
+				n, limits.MaxTxnBatchSize)
+		}
+
+		raw.Retain()
+
+		if nil != runID && string(*runID) != string(id) {
+			*runID = AgentRunID(id)
+		}
+
+		sample := flatTxnBatch{data: data}
+		if nil != names {
+			sample.names = names.defineBatch(&batch)
+		}
+		handler.IncomingTxnData(AgentRunID(id), sample)
+		return nil, nil
+
 	case protocol.MessageBodyApp:
 		var tbl flatbuffers.Table
 
@@ -361,6 +529,7 @@ func processBinary(data []byte, handler AgentDataHandler) ([]byte, error) {
 			return nil, errors.New("missing agent run id for span batch command")
 		}
 
+		raw.Retain()
 		spanBatch := SpanBatch{id: AgentRunID(id), count: batch.Count(), batch: batch.EncodedBytes()}
 
 		handler.IncomingSpanBatch(spanBatch)
@@ -383,7 +552,7 @@ func processBinary(data []byte, handler AgentDataHandler) ([]byte, error) {
 func (h CommandsHandler) HandleMessage(msg RawMessage) ([]byte, error) {
 	switch mt := msg.Type; mt {
 	case MessageTypeBinary:
-		return processBinary(msg.Bytes, h.Processor)
+		return processBinary(msg, h.Processor, h.metricNames, h.runID)
 
 	default:
 		return nil, fmt.Errorf("unsupported message encoding: %v", mt)
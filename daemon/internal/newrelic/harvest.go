@@ -54,6 +54,15 @@ func NewHarvest(now time.Time, hl collector.EventConfigs) *Harvest {
 	return nh
 }
 
+// NewHarvestWithRules returns a new harvest whose metrics are renamed using
+// rules as they are added.
+func NewHarvestWithRules(now time.Time, hl collector.EventConfigs,
+	rules *MetricRulesCache) *Harvest {
+	nh := NewHarvest(now, hl)
+	nh.Metrics.rules = rules
+	return nh
+}
+
 func (h *Harvest) empty() bool {
 	return len(h.pidSet) == 0 &&
 		h.CustomEvents.Empty() &&
@@ -7,6 +7,7 @@ package infinite_tracing
 
 import (
 	"errors"
+	"strconv"
 	"sync"
 	"time"
 
@@ -24,6 +25,19 @@ const (
 	supportabilityResponseErr = "Supportability/InfiniteTracing/Span/Response/Error"
 	supportabilityQueueDumped = "Supportability/InfiniteTracing/Span/AgentQueueDumped"
 	supportabilityDataUsage   = "Supportability/PHP/InfiniteTracing/Output/Bytes"
+	// per-stream supportability metrics, only created if more than one
+	// stream is configured
+	supportabilityStreamPrefix    = "Supportability/InfiniteTracing/Span/Stream/"
+	supportabilityStreamSent      = "/Sent"
+	supportabilityStreamDropped   = "/Dropped"
+	supportabilityStreamDataUsage = "/Output/Bytes"
+
+	// MaxStreams is the upper limit for the number of concurrent gRPC
+	// streams to a trace observer.
+	MaxStreams = 16
+	// DefaultMaxBatchBytes is the size up to which span batches received
+	// from agents are coalesced into a single gRPC message.
+	DefaultMaxBatchBytes = 1 << 20 /* 1 MB */
 )
 
 type spanBatch struct {
@@ -71,11 +85,8 @@ type spanBatchSender interface {
 }
 
 type TraceObserver struct {
-	// The span batch queue.
-	messages                  chan *spanBatch
-	closeMessagesOnce         sync.Once
-	messagesSent              chan uint64
-	messagesRemainingCapacity uint64
+	// The span batch queue, shared by all streams.
+	queue *spanBatchQueue
 
 	// Channels to send shutdown messages.
 	initiateShutdown        chan struct{}
@@ -84,17 +95,45 @@ type TraceObserver struct {
 	initiateAppShutdownOnce sync.Once
 	shutdownComplete        chan struct{}
 
-	// A channel that holds errors returned from gRPC.
-	responseError chan spanBatchSenderStatus
-
 	// Trace observer supportability metrics.
 	supportability *traceObserverSupportability
 
-	sender spanBatchSender
+	// The gRPC streams sending span batches off the queue.
+	streams []*traceObserverStream
 
 	Config
 }
 
+// A single gRPC stream to the trace observer. Each stream has its own
+// sender, and therefore its own connection, and runs on its own goroutine.
+type traceObserverStream struct {
+	sender spanBatchSender
+
+	// A channel that holds errors returned from gRPC.
+	responseError chan spanBatchSenderStatus
+
+	// Names of the per-stream supportability metrics. These are empty if
+	// only a single stream is used.
+	sentMetric      string
+	droppedMetric   string
+	dataUsageMetric string
+}
+
+// spanBatchQueue is a bounded FIFO queue of span batches. Its capacity is
+// measured in spans. When a new batch does not fit, the oldest batches are
+// dropped to make room for it.
+type spanBatchQueue struct {
+	sync.Mutex
+	batches  []*spanBatch
+	count    uint64
+	capacity uint64
+	closed   bool
+
+	// Signals that batches are available. This channel has a capacity of
+	// one, so that at most one waiting stream is woken per signal.
+	ready chan struct{}
+}
+
 type Config struct {
 	Host              string
 	Port              uint16
@@ -103,11 +142,18 @@ type Config struct {
 	RunId             string
 	QueueSize         uint64
 	RequestHeadersMap map[string]string
+	// The number of concurrent gRPC streams. Values below 1 are treated as
+	// 1, values above MaxStreams are capped.
+	Streams int
+	// The size in bytes up to which queued span batches are coalesced into
+	// a single gRPC message. If 0, span batches are sent as received.
+	MaxBatchBytes int
 }
 
 type metricIncrement struct {
 	name  string
 	count float64
+	bytes float64
 }
 
 type traceObserverSupportability struct {
@@ -117,50 +163,84 @@ type traceObserverSupportability struct {
 	dump          chan map[string][6]float64
 }
 
-func newTraceObserverWithWorker(cfg *Config) (*TraceObserver, func()) {
+func newTraceObserverWithWorker(cfg *Config) (*TraceObserver, func(senders ...spanBatchSender)) {
 	to := &TraceObserver{
-		messages:                  make(chan *spanBatch, cfg.QueueSize),
-		messagesSent:              make(chan uint64, cfg.QueueSize),
-		messagesRemainingCapacity: cfg.QueueSize,
-		initiateShutdown:          make(chan struct{}),
-		initiateAppShutdown:       make(chan struct{}),
-		shutdownComplete:          make(chan struct{}),
-		Config:                    *cfg,
-		supportability:            newTraceObserverSupportability(),
+		queue:               newSpanBatchQueue(cfg.QueueSize),
+		initiateShutdown:    make(chan struct{}),
+		initiateAppShutdown: make(chan struct{}),
+		shutdownComplete:    make(chan struct{}),
+		Config:              *cfg,
+		supportability:      newTraceObserverSupportability(),
+	}
+
+	if to.Streams < 1 {
+		to.Streams = 1
+	} else if to.Streams > MaxStreams {
+		to.Streams = MaxStreams
 	}
+
+	to.streams = make([]*traceObserverStream, to.Streams)
+	for i := range to.streams {
+		to.streams[i] = &traceObserverStream{}
+		if to.Streams > 1 {
+			prefix := supportabilityStreamPrefix + strconv.Itoa(i)
+			to.streams[i].sentMetric = prefix + supportabilityStreamSent
+			to.streams[i].droppedMetric = prefix + supportabilityStreamDropped
+			to.streams[i].dataUsageMetric = prefix + supportabilityStreamDataUsage
+		}
+	}
+
 	go to.handleSupportability()
-	worker := func() {
-		for {
-			to.responseError = to.sender.response()
-
-			status := to.doStreaming()
-
-			if status.code == statusShutdown {
-				to.initShutdown()
-				break
-			} else if status.code == statusRestart {
-				time.Sleep(recordSpanBackoff)
-			} else if status.code == statusReconnect {
-				to.sender.shutdown()
-
-				sender, err := to.sender.clone()
-				if err != nil {
-					log.Debugf("cannot clone sender: %v", err)
-					break
-				}
-				to.sender = sender
 
-				log.Debugf("sender cloned for reconnect attempt")
-			}
+	// The worker expects one sender per stream. It blocks until all streams
+	// have been shut down.
+	worker := func(senders ...spanBatchSender) {
+		var wg sync.WaitGroup
+
+		for i, stream := range to.streams {
+			stream.sender = senders[i]
+			wg.Add(1)
+			go func(s *traceObserverStream) {
+				to.runStream(s)
+				wg.Done()
+				s.sender.shutdown()
+			}(stream)
 		}
 
+		wg.Wait()
+		to.initShutdown()
 		to.completeShutdown()
-		to.sender.shutdown()
 	}
 
 	return to, worker
 }
 
+func (to *TraceObserver) runStream(s *traceObserverStream) {
+	for {
+		s.responseError = s.sender.response()
+
+		status := to.doStreaming(s)
+
+		if status.code == statusShutdown {
+			to.initShutdown()
+			return
+		} else if status.code == statusRestart {
+			time.Sleep(recordSpanBackoff)
+		} else if status.code == statusReconnect {
+			s.sender.shutdown()
+
+			sender, err := s.sender.clone()
+			if err != nil {
+				log.Debugf("cannot clone sender: %v", err)
+				return
+			}
+			s.sender = sender
+
+			log.Debugf("sender cloned for reconnect attempt")
+		}
+	}
+}
+
 // Initialize a connection to a trace observer. This function returns
 // immediately, while trying to establish a connection in the background.
 //
@@ -169,13 +249,20 @@ func newTraceObserverWithWorker(cfg *Config) (*TraceObserver, func()) {
 func NewTraceObserver(cfg *Config) *TraceObserver {
 	to, worker := newTraceObserverWithWorker(cfg)
 	go func() {
-		sender, err := newGrpcSpanBatchSender(cfg)
-		if err != nil {
-			return
+		senders := make([]spanBatchSender, len(to.streams))
+		for i := range senders {
+			sender, err := newGrpcSpanBatchSender(cfg)
+			if err != nil {
+				for _, s := range senders[:i] {
+					s.shutdown()
+				}
+				return
+			}
+			senders[i] = sender
 		}
 
-		to.sender = sender
-		worker()
+		log.Debugf("trace observer using %d stream(s)", len(senders))
+		worker(senders...)
 	}()
 
 	return to
@@ -183,8 +270,8 @@ func NewTraceObserver(cfg *Config) *TraceObserver {
 
 // Add a span batch to the queue.
 //
-// This should only be called on a single go routine. Concurrent calls might
-// case race conditions due to missing locking around the capacity counter.
+// If the queue is full, the oldest span batches are dropped to make room for
+// the new one.
 func (to *TraceObserver) QueueBatch(count uint64, batch []byte) {
 	if to.isShutdownInitiated() {
 		if !to.isShutdownComplete() {
@@ -193,19 +280,18 @@ func (to *TraceObserver) QueueBatch(count uint64, batch []byte) {
 		return
 	}
 
-	// If the queue is full, flush the whole queue. This increases the
-	// likelihood of sending complete traces.
-	if to.getRemainingQueueCapacity() < count {
-		to.emptyQueue()
-	}
-
-	b := &spanBatch{
+	dropped, ok := to.queue.push(&spanBatch{
 		count: count,
 		batch: batch,
-	}
+	})
+	if ok && dropped > 0 {
+		to.supportability.increment <- metricIncrement{
+			name:  supportabilityQueueDumped,
+			count: float64(dropped),
+		}
 
-	to.messages <- b
-	to.messagesRemainingCapacity -= count
+		log.Debugf("trace observer dropped %d spans due to backpressure", dropped)
+	}
 }
 
 // Shut down the trace observer connection. This blocks until the shutdown is
@@ -227,35 +313,109 @@ func (to *TraceObserver) Shutdown(timeout time.Duration) error {
 	return err
 }
 
-func (to *TraceObserver) emptyQueue() {
+func newSpanBatchQueue(capacity uint64) *spanBatchQueue {
+	return &spanBatchQueue{
+		capacity: capacity,
+		ready:    make(chan struct{}, 1),
+	}
+}
+
+// push adds a span batch to the end of the queue, dropping span batches from
+// the front of the queue until the new batch fits. It returns the number of
+// dropped spans, and false if the queue has already been closed.
+func (q *spanBatchQueue) push(b *spanBatch) (uint64, bool) {
 	var dropped uint64
-	for {
-		select {
-		case batch := <-to.messages:
-			dropped += batch.count
-		default:
-			to.messagesRemainingCapacity += dropped
-
-			to.supportability.increment <- metricIncrement{
-				name:  supportabilityQueueDumped,
-				count: float64(dropped),
-			}
 
-			log.Debugf("trace observer dropped %d spans due to backpressure", dropped)
-			return
-		}
+	q.Lock()
+	defer q.Unlock()
+
+	if q.closed {
+		return 0, false
 	}
+
+	for len(q.batches) > 0 && q.count+b.count > q.capacity {
+		dropped += q.batches[0].count
+		q.count -= q.batches[0].count
+		q.batches[0] = nil
+		q.batches = q.batches[1:]
+	}
+
+	q.batches = append(q.batches, b)
+	q.count += b.count
+	q.signal()
+
+	return dropped, true
 }
 
-func (to *TraceObserver) getRemainingQueueCapacity() uint64 {
-	for {
-		select {
-		case sent := <-to.messagesSent:
-			to.messagesRemainingCapacity += sent
-		default:
-			return to.messagesRemainingCapacity
+// pop removes the span batch at the front of the queue. Subsequent batches
+// are coalesced into it as long as the combined size does not exceed
+// maxBytes. Returns nil if the queue is empty.
+func (q *spanBatchQueue) pop(maxBytes int) *spanBatch {
+	q.Lock()
+	defer q.Unlock()
+
+	if len(q.batches) == 0 {
+		return nil
+	}
+
+	n := 1
+	size := len(q.batches[0].batch)
+	for n < len(q.batches) && size+len(q.batches[n].batch) <= maxBytes {
+		size += len(q.batches[n].batch)
+		n++
+	}
+
+	b := q.batches[0]
+	if n > 1 {
+		// Encoded SpanBatch messages only consist of the repeated spans
+		// field, so concatenating them yields a valid SpanBatch holding
+		// all spans.
+		b = &spanBatch{batch: make([]byte, 0, size)}
+		for _, queued := range q.batches[:n] {
+			b.count += queued.count
+			b.batch = append(b.batch, queued.batch...)
 		}
 	}
+
+	for i := 0; i < n; i++ {
+		q.batches[i] = nil
+	}
+	q.batches = q.batches[n:]
+	q.count -= b.count
+
+	// Wake up another stream if there's more to send.
+	if len(q.batches) > 0 {
+		q.signal()
+	}
+
+	return b
+}
+
+// len returns the number of spans in the queue.
+func (q *spanBatchQueue) len() uint64 {
+	q.Lock()
+	defer q.Unlock()
+
+	return q.count
+}
+
+// close drops all queued span batches and rejects further ones.
+func (q *spanBatchQueue) close() {
+	q.Lock()
+	defer q.Unlock()
+
+	q.closed = true
+	q.batches = nil
+	q.count = 0
+}
+
+// signal notifies a waiting stream that batches are available. It has to be
+// called with the queue locked.
+func (q *spanBatchQueue) signal() {
+	select {
+	case q.ready <- struct{}{}:
+	default:
+	}
 }
 
 func (to *TraceObserver) initShutdown() {
@@ -272,13 +432,7 @@ func (to *TraceObserver) closeInitiateAppShutdown() {
 }
 
 func (to *TraceObserver) closeMessages() {
-	to.closeMessagesOnce.Do(func() {
-		close(to.messages)
-
-		for range to.messages {
-			// drain the channel
-		}
-	})
+	to.queue.close()
 }
 
 func (to *TraceObserver) completeShutdown() {
@@ -290,8 +444,8 @@ func (to *TraceObserver) completeShutdown() {
 	log.Debugf("trace observer shutdown completed")
 }
 
-func (to *TraceObserver) doStreaming() spanBatchSenderStatus {
-	if err, status := to.sender.connect(); err != nil {
+func (to *TraceObserver) doStreaming(s *traceObserverStream) spanBatchSenderStatus {
+	if err, status := s.sender.connect(); err != nil {
 		to.supportabilityError(status)
 		log.Errorf("cannot establish stream to trace observer endpoint: %v", err)
 		return status
@@ -300,22 +454,29 @@ func (to *TraceObserver) doStreaming() spanBatchSenderStatus {
 	log.Debugf("established stream to trace observer endpoint")
 	for {
 		select {
-		case msg := <-to.messages:
+		case <-to.queue.ready:
+			msg := to.queue.pop(to.MaxBatchBytes)
+			if msg == nil {
+				// Another stream was faster.
+				continue
+			}
 			log.Debugf("trace observer sending span batch of size %d, %d of %d remaining in queue",
-				msg.count, to.messagesRemainingCapacity, to.QueueSize)
-			if err, status := to.sender.send(encodedSpanBatch(msg.batch)); err != nil {
-				to.messagesSent <- msg.count
+				msg.count, to.queue.len(), to.QueueSize)
+			if err, status := s.sender.send(encodedSpanBatch(msg.batch)); err != nil {
 				// Add 0 to dataUsage channel so that we successfully count the send attempt
 				to.supportability.dataUsage <- 0.0
+				to.supportabilityStream(s.droppedMetric, float64(msg.count), 0)
+				to.supportabilityStream(s.dataUsageMetric, 1, 0)
 				to.supportabilityError(status)
 				log.Errorf("trace observer error while sending span batch:  %v", err)
 				return status
 			} else {
-				to.messagesSent <- msg.count
 				to.supportability.incrementSent <- float64(msg.count)
 				to.supportability.dataUsage <- float64(len(msg.batch))
+				to.supportabilityStream(s.sentMetric, float64(msg.count), 0)
+				to.supportabilityStream(s.dataUsageMetric, 1, float64(len(msg.batch)))
 			}
-		case status := <-to.responseError:
+		case status := <-s.responseError:
 			to.supportabilityError(status)
 			log.Debugf("trace observer error response received: %v", status)
 			return status
@@ -368,6 +529,7 @@ func (to *TraceObserver) handleSupportability() {
 				v = newEmptyMetric()
 			}
 			v[0] += inc.count
+			v[1] += inc.bytes
 			metrics[inc.name] = v
 		case batchCount := <-to.supportability.incrementSent:
 			v, ok := metrics[supportabilitySent]
@@ -429,6 +591,19 @@ func (to *TraceObserver) DumpSupportabilityMetrics() map[string][6]float64 {
 	return <-to.supportability.dump
 }
 
+// supportabilityStream records a per-stream supportability metric. Nothing is
+// recorded if the metric name is empty, which is the case if only a single
+// stream is used.
+func (to *TraceObserver) supportabilityStream(name string, count float64, bytes float64) {
+	if name != "" {
+		to.supportability.increment <- metricIncrement{
+			name:  name,
+			count: count,
+			bytes: bytes,
+		}
+	}
+}
+
 func (to *TraceObserver) supportabilityError(status spanBatchSenderStatus) {
 	if status.metric != "" {
 		to.supportability.increment <- metricIncrement{
@@ -63,8 +63,7 @@ func TestConnectShutdownTrigger(t *testing.T) {
 	to, worker := newTraceObserverWithWorker(&Config{
 		QueueSize: 100,
 	})
-	to.sender = sender
-	worker()
+	worker(sender)
 
 	if to.isShutdownComplete() != true {
 		t.Errorf("unrecoverable connect error doesn't trigger a shutdown")
@@ -100,10 +99,7 @@ func TestSendShutdownTrigger(t *testing.T) {
 	to, worker := newTraceObserverWithWorker(&Config{
 		QueueSize: 100,
 	})
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 
 	if to.isShutdownComplete() != false {
 		t.Errorf("successful connect not registered")
@@ -154,10 +150,7 @@ func TestShutdown(t *testing.T) {
 	to, worker := newTraceObserverWithWorker(&Config{
 		QueueSize: 100,
 	})
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 
 	if to.isShutdownComplete() != false {
 		t.Errorf("successful connect not registered")
@@ -190,10 +183,7 @@ func TestSend(t *testing.T) {
 		QueueSize: 100,
 	})
 	defer to.Shutdown(10 * time.Millisecond)
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 	to.QueueBatch(1, []byte{1, 2, 3})
 	to.QueueBatch(1, []byte{4, 5, 6})
 	to.QueueBatch(1, []byte{7, 8, 9})
@@ -231,10 +221,7 @@ func TestSend(t *testing.T) {
 //		QueueSize: 10,
 //	})
 //	defer to.Shutdown(100 * time.Millisecond)
-//	go func() {
-//		to.sender = sender
-//		worker()
-//	}()
+//	go worker(sender)
 //
 //	// 5 batches of size two should be queued, the queue is full.
 //	for i := 0; i < 5; i++ {
@@ -278,10 +265,7 @@ func TestSentSpanMetrics(t *testing.T) {
 		QueueSize: 100,
 	})
 	defer to.Shutdown(10 * time.Millisecond)
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 
 	expectSupportabilityMetrics(t, to, map[string][6]float64{
 		"Supportability/InfiniteTracing/Span/Sent": [6]float64{0, 0, 0, 0, 0, 0},
@@ -329,10 +313,7 @@ func TestImmediateRestart(t *testing.T) {
 		QueueSize: 100,
 	})
 	defer to.Shutdown(10 * time.Millisecond)
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 
 	// Force an immediate restart
 	connectReturn <- spanBatchSenderStatus{code: statusImmediateRestart}
@@ -375,10 +356,7 @@ func TestReconnect(t *testing.T) {
 		QueueSize: 100,
 	})
 	defer to.Shutdown(10 * time.Millisecond)
-	go func() {
-		to.sender = sender
-		worker()
-	}()
+	go worker(sender)
 
 	// Force a reconnect
 	connectReturn <- spanBatchSenderStatus{code: statusReconnect}
@@ -401,3 +379,120 @@ func TestReconnect(t *testing.T) {
 		t.Errorf("expected 2 clone attempts, got %v", sender.cloneAttempts)
 	}
 }
+
+func TestQueueDropsOldest(t *testing.T) {
+	to, _ := newTraceObserverWithWorker(&Config{
+		QueueSize: 4,
+	})
+
+	// No worker is running, so nothing is taken off the queue.
+	to.QueueBatch(2, []byte{1})
+	to.QueueBatch(2, []byte{2})
+	to.QueueBatch(1, []byte{3})
+	to.QueueBatch(3, []byte{4})
+
+	if n := to.queue.len(); n != 4 {
+		t.Errorf("expected 4 queued spans, got %d", n)
+	}
+
+	for _, expected := range [][]byte{{3}, {4}} {
+		batch := to.queue.pop(0)
+		if batch == nil || !reflect.DeepEqual(batch.batch, expected) {
+			t.Errorf("expected batch %v, got %v", expected, batch)
+		}
+	}
+	if batch := to.queue.pop(0); batch != nil {
+		t.Errorf("expected empty queue, got %v", batch)
+	}
+
+	expectSupportabilityMetrics(t, to, map[string][6]float64{
+		"Supportability/InfiniteTracing/Span/Sent":             [6]float64{0, 0, 0, 0, 0, 0},
+		"Supportability/InfiniteTracing/Span/AgentQueueDumped": [6]float64{4, 0, 0, 0, 0, 0},
+	})
+}
+
+func TestQueueCoalesce(t *testing.T) {
+	q := newSpanBatchQueue(100)
+
+	q.push(&spanBatch{count: 1, batch: []byte{1, 2, 3}})
+	q.push(&spanBatch{count: 2, batch: []byte{4, 5, 6}})
+	q.push(&spanBatch{count: 3, batch: []byte{7, 8, 9}})
+
+	batch := q.pop(6)
+	if batch.count != 3 || !reflect.DeepEqual(batch.batch, []byte{1, 2, 3, 4, 5, 6}) {
+		t.Errorf("span batches not coalesced: %v", batch)
+	}
+
+	batch = q.pop(6)
+	if batch.count != 3 || !reflect.DeepEqual(batch.batch, []byte{7, 8, 9}) {
+		t.Errorf("unexpected span batch: %v", batch)
+	}
+
+	if n := q.len(); n != 0 {
+		t.Errorf("expected empty queue, got %d spans", n)
+	}
+}
+
+func TestQueueClosed(t *testing.T) {
+	q := newSpanBatchQueue(100)
+
+	q.push(&spanBatch{count: 1, batch: []byte{1, 2, 3}})
+	q.close()
+
+	if _, ok := q.push(&spanBatch{count: 1, batch: []byte{4, 5, 6}}); ok {
+		t.Errorf("closed queue accepted a span batch")
+	}
+	if batch := q.pop(0); batch != nil {
+		t.Errorf("closed queue returned a span batch: %v", batch)
+	}
+}
+
+func TestMultipleStreams(t *testing.T) {
+	block := make(chan struct{})
+	received := make(chan []byte, 10)
+	newSender := func() *mockSpanBatchSender {
+		return &mockSpanBatchSender{
+			cbConnect: func() (error, spanBatchSenderStatus) {
+				return nil, spanBatchSenderStatus{code: statusOk}
+			},
+			cbSend: func(batch encodedSpanBatch) (error, spanBatchSenderStatus) {
+				received <- batch
+				<-block
+				return nil, spanBatchSenderStatus{code: statusOk}
+			},
+			responseError: make(chan spanBatchSenderStatus, 10),
+		}
+	}
+
+	to, worker := newTraceObserverWithWorker(&Config{
+		QueueSize: 100,
+		Streams:   2,
+	})
+	defer to.Shutdown(10 * time.Millisecond)
+	go worker(newSender(), newSender())
+
+	// Both streams block while sending, so each batch has to be picked up
+	// by a different stream.
+	to.QueueBatch(1, []byte{1, 2, 3})
+	<-received
+	to.QueueBatch(2, []byte{4, 5, 6})
+	<-received
+	close(block)
+
+	time.Sleep(10 * time.Millisecond)
+
+	metrics := to.DumpSupportabilityMetrics()
+	if v := metrics["Supportability/InfiniteTracing/Span/Sent"]; v[0] != 3 {
+		t.Errorf("expected 3 spans sent, got %v", v)
+	}
+	stream0 := metrics["Supportability/InfiniteTracing/Span/Stream/0/Sent"]
+	stream1 := metrics["Supportability/InfiniteTracing/Span/Stream/1/Sent"]
+	if stream0[0] == 0 || stream1[0] == 0 || stream0[0]+stream1[0] != 3 {
+		t.Errorf("spans not sent on both streams: %v, %v", stream0, stream1)
+	}
+	bytes0 := metrics["Supportability/InfiniteTracing/Span/Stream/0/Output/Bytes"]
+	bytes1 := metrics["Supportability/InfiniteTracing/Span/Stream/1/Output/Bytes"]
+	if bytes0 != [6]float64{1, 3, 0, 0, 0, 0} || bytes1 != [6]float64{1, 3, 0, 0, 0, 0} {
+		t.Errorf("unexpected per-stream data usage: %v, %v", bytes0, bytes1)
+	}
+}
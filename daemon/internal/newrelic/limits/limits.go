@@ -33,6 +33,7 @@ const (
 	// Harvest Data Limits
 	DefaultReportPeriod          = 60 * time.Second
 	MaxMetrics                   = 2 * 1000
+	MaxMetricRulesCacheNames     = 20 * 1000
 	MaxTxnEvents                 = 10 * 1000
 	MaxCustomMaxEvents           = 100 * 1000
 	MaxErrorEvents               = 100
@@ -81,6 +82,15 @@ const (
 	// LabelNumberLimit is the maximum number of labels that will be sent.
 	LabelNumberLimit = 64
 
+	// MaxMetricNameIds is the maximum number of metric names an agent may
+	// send by id on a single connection. It bounds the memory used by the
+	// per-connection metric name dictionary.
+	MaxMetricNameIds = 10000
+
+	// MaxTxnBatchSize is the maximum number of transactions an agent may
+	// send in a single transaction batch.
+	MaxTxnBatchSize = 1000
+
 	// MinFlatbufferSize is the minimum size of a flatbuffers message (no agent
 	// run or message body). This should be updated when new fields are added.
 	MinFlatbufferSize = 12
@@ -6,14 +6,17 @@
 package newrelic
 
 import (
+	"bufio"
 	"encoding/binary"
 	"errors"
 	"fmt"
 	"io"
+	"math/bits"
 	"net"
 	"runtime"
 	"strconv"
 	"strings"
+	"sync"
 	"syscall"
 	"time"
 
@@ -31,6 +34,14 @@ import (
 const (
 	maxMessageSize = 2 << 20 /* 2 MB */
 	msgHeaderSize  = 8
+
+	// connReadBufferSize is the size of the buffer used to read from each
+	// agent connection. Most messages fit, so that a message usually takes a
+	// single read. Larger messages are read directly into their own buffer.
+	connReadBufferSize = 16 << 10 /* 16 KB */
+
+	// connStatsInterval is how often connection statistics are reported.
+	connStatsInterval = 10 * time.Second
 )
 
 // MessageType identifies the encoding for a message body.
@@ -120,10 +131,16 @@ func (l *Listener) Serve(h MessageHandler) error {
 // serve reads and responds to messages from the given connection until
 // an error occurs or the connection is closed.
 func serve(c net.Conn, h MessageHandler) {
+	if ch, ok := h.(ConnectionHandler); ok {
+		h = ch.ForConnection()
+	}
+
 	clientConn := conn{}
 	clientConn.rwc = c
+	clientConn.rd = bufio.NewReaderSize(c, connReadBufferSize)
 	clientConn.handler = h
 	clientConn.mw.W = c
+	clientConn.statsReported = time.Now()
 
 	defer func() {
 		if err := recover(); err != nil {
@@ -138,24 +155,94 @@ func serve(c net.Conn, h MessageHandler) {
 	clientConn.Serve()
 }
 
+// MessageHandler handles the messages read from agent connections. The bytes
+// of a message are reused once HandleMessage returns, unless the handler
+// calls Retain on the message.
 type MessageHandler interface {
 	HandleMessage(RawMessage) ([]byte, error)
 }
 
+// ConnectionHandler is implemented by message handlers that keep state for
+// each agent connection, such as the metric names sent by id.
+type ConnectionHandler interface {
+	ForConnection() MessageHandler
+}
+
+// connStatsReporter is implemented by message handlers that can report the
+// statistics of the connection they serve.
+type connStatsReporter interface {
+	// reportConnStats reports the given statistics, and returns false if
+	// they could not be reported yet.
+	reportConnStats(stats connStats) bool
+}
+
 // conn wraps a client connection.
 type conn struct {
-	rwc     net.Conn       // underlying connection
-	handler MessageHandler // routes messages to the processor
-	mw      MessageWriter  // writer for outgoing messages
-	stats   connStats      // not implemented yet
+	rwc           net.Conn       // underlying connection
+	rd            *bufio.Reader  // buffered reader for incoming messages
+	handler       MessageHandler // routes messages to the processor
+	mw            MessageWriter  // writer for outgoing messages
+	stats         connStats      // statistics since they were last reported
+	statsReported time.Time
 }
 
 type connStats struct {
-	count   int // number of messages consumed
-	drops   int // number of messages dropped
-	errors  int // number of messages failed
-	minSize int
-	maxSize int
+	count      int // number of messages consumed
+	drops      int // number of messages dropped
+	errors     int // number of messages failed
+	minSize    int
+	maxSize    int
+	totalSize  int
+	sumSquares float64
+}
+
+func (s *connStats) observe(size int) {
+	if 0 == s.count || size < s.minSize {
+		s.minSize = size
+	}
+	if size > s.maxSize {
+		s.maxSize = size
+	}
+	s.count++
+	s.totalSize += size
+	s.sumSquares += float64(size) * float64(size)
+}
+
+func (s connStats) empty() bool {
+	return 0 == s.count && 0 == s.drops && 0 == s.errors
+}
+
+// AggregateInto records the statistics as supportability metrics.
+func (s connStats) AggregateInto(h *Harvest) {
+	if s.count > 0 {
+		h.Metrics.AddRaw(nil, "Supportability/Listener/MessageSize", "",
+			[6]float64{float64(s.count), float64(s.totalSize), float64(s.totalSize),
+				float64(s.minSize), float64(s.maxSize), s.sumSquares}, Forced)
+	}
+	if s.drops > 0 {
+		h.Metrics.AddCount("Supportability/Listener/Dropped", "", float64(s.drops), Forced)
+	}
+	if s.errors > 0 {
+		h.Metrics.AddCount("Supportability/Listener/Errors", "", float64(s.errors), Forced)
+	}
+}
+
+// reportStats hands the connection statistics to the handler, at most once
+// per connStatsInterval unless the connection is closing.
+func (c *conn) reportStats(closing bool) {
+	if c.stats.empty() {
+		return
+	}
+
+	now := time.Now()
+	if !closing && now.Sub(c.statsReported) < connStatsInterval {
+		return
+	}
+	c.statsReported = now
+
+	if r, ok := c.handler.(connStatsReporter); ok && r.reportConnStats(c.stats) {
+		c.stats = connStats{}
+	}
 }
 
 // Close closes the connection.
@@ -166,10 +253,13 @@ func (c *conn) Close() error {
 
 // Serve pumps messages from c until EOF is reached or an error occurs.
 func (c *conn) Serve() {
+	defer c.reportStats(true)
+
 	for {
-		msg, err := ReadMessage(c.rwc)
+		msg, err := readMessage(c.rd, true)
 		if err != nil {
 			if err != io.EOF {
+				c.stats.drops++
 				if err == errLegacyAgent {
 					// Send the agent an empty message containing a newer protocol
 					// version to cause it log a version mismatch error and then
@@ -181,8 +271,12 @@ func (c *conn) Serve() {
 			return
 		}
 
+		c.stats.observe(len(msg.Bytes))
+
 		reply, perr := c.handler.HandleMessage(msg)
+		msg.release()
 		if nil != perr {
+			c.stats.errors++
 			log.Warnf("listener: protocol error: %v", perr)
 			// We do not close the connection here: As long
 			// as the messages are delineated, there is
@@ -201,6 +295,8 @@ func (c *conn) Serve() {
 				return
 			}
 		}
+
+		c.reportStats(false)
 	}
 }
 
@@ -237,7 +333,59 @@ func isLegacyAgent(p []byte) bool {
 
 var errLegacyAgent = errors.New("agent version is older than the newrelic-daemon, this may be due a software update - try restarting the agent")
 
+// messageBuffer is a pooled buffer holding the bytes of a message.
+type messageBuffer struct {
+	b        []byte
+	retained bool
+}
+
+const (
+	minMessageBufferShift = 10 /* 1 KB */
+	maxMessageBufferShift = 21 /* maxMessageSize */
+)
+
+// messageBufferPools hold buffers by size class: pool i holds buffers of
+// 1 << (minMessageBufferShift + i) bytes.
+var messageBufferPools [maxMessageBufferShift - minMessageBufferShift + 1]sync.Pool
+
+func messageBufferClass(size uint32) int {
+	shift := bits.Len32(size - 1)
+	if size <= 1 || shift < minMessageBufferShift {
+		return 0
+	}
+	return shift - minMessageBufferShift
+}
+
+func getMessageBuffer(size uint32) *messageBuffer {
+	class := messageBufferClass(size)
+
+	mb, _ := messageBufferPools[class].Get().(*messageBuffer)
+	if nil == mb {
+		mb = &messageBuffer{
+			b: make([]byte, 1<<uint(class+minMessageBufferShift)),
+		}
+	}
+	mb.b = mb.b[:size]
+	mb.retained = false
+	return mb
+}
+
+func putMessageBuffer(mb *messageBuffer) {
+	if nil == mb || mb.retained {
+		return
+	}
+	messageBufferPools[messageBufferClass(uint32(cap(mb.b)))].Put(mb)
+}
+
+// ReadMessage reads a single message from r into a newly allocated buffer.
 func ReadMessage(r io.Reader) (RawMessage, error) {
+	return readMessage(r, false)
+}
+
+// readMessage reads a single message from r. If pooled is true, the message
+// is read into a pooled buffer, which must be released once the message has
+// been handled.
+func readMessage(r io.Reader, pooled bool) (RawMessage, error) {
 	header := [msgHeaderSize]byte{}
 	_, err := io.ReadFull(r, header[:])
 	if nil != err {
@@ -262,15 +410,25 @@ func ReadMessage(r io.Reader) (RawMessage, error) {
 			dataSize, maxMessageSize)
 	}
 
-	msg := make([]byte, dataSize)
+	var buf *messageBuffer
+	var msg []byte
+	if pooled {
+		buf = getMessageBuffer(dataSize)
+		msg = buf.b
+	} else {
+		msg = make([]byte, dataSize)
+	}
+
 	_, err = io.ReadFull(r, msg)
 	if nil != err {
+		putMessageBuffer(buf)
 		return RawMessage{}, fmt.Errorf("unable to read full message: %v", err)
 	}
 
 	return RawMessage{
 		Type:  msgType,
 		Bytes: msg,
+		buf:   buf,
 	}, nil
 }
 
@@ -289,6 +447,23 @@ func OpenClientConnection(addr string) (net.Conn, error) {
 type RawMessage struct {
 	Type  MessageType
 	Bytes []byte
+
+	buf *messageBuffer // pooled buffer holding Bytes, if any
+}
+
+// Retain prevents the bytes of the message from being reused once it has
+// been handled. Handlers which keep a reference to the bytes, such as by
+// passing them to another goroutine, must call Retain.
+func (m RawMessage) Retain() {
+	if nil != m.buf {
+		m.buf.retained = true
+	}
+}
+
+// release returns the bytes of the message to the pool, unless the message
+// was retained.
+func (m RawMessage) release() {
+	putMessageBuffer(m.buf)
 }
 
 // The minimum number of bytes (not messages!) to buffer.
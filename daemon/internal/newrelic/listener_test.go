@@ -6,12 +6,18 @@
 package newrelic
 
 import (
+	"bufio"
 	"bytes"
 	"encoding/binary"
 	"encoding/hex"
+	"errors"
 	"io"
 	"runtime"
+	"strings"
 	"testing"
+	"time"
+
+	"github.com/newrelic/newrelic-php-agent/daemon/internal/newrelic/collector"
 )
 
 func TestDefaultListenSocket(t *testing.T) {
@@ -178,3 +184,139 @@ func TestLegacyProtocolDetection(t *testing.T) {
 		t.Error("ReadMessage failed to detect legacy header:", err)
 	}
 }
+
+func TestMessageBufferClass(t *testing.T) {
+	var testCases = []struct {
+		size uint32
+		want int
+	}{
+		{0, 0},
+		{1, 0},
+		{1024, 0},
+		{1025, 1},
+		{2048, 1},
+		{4096, 2},
+		{maxMessageSize, maxMessageBufferShift - minMessageBufferShift},
+	}
+
+	for _, tt := range testCases {
+		if got := messageBufferClass(tt.size); got != tt.want {
+			t.Errorf("messageBufferClass(%d) = %d, want %d", tt.size, got, tt.want)
+		}
+	}
+
+	for _, size := range []uint32{0, 1, 1000, 5000, maxMessageSize} {
+		if mb := getMessageBuffer(size); len(mb.b) != int(size) ||
+			messageBufferClass(uint32(cap(mb.b))) != messageBufferClass(size) {
+			t.Errorf("getMessageBuffer(%d): len=%d cap=%d", size, len(mb.b), cap(mb.b))
+		}
+	}
+}
+
+// recordingHandler records the bytes of the messages it handles, retaining
+// every other message.
+type recordingHandler struct {
+	msgs     [][]byte
+	retained []bool
+	reported []connStats
+}
+
+func (h *recordingHandler) HandleMessage(msg RawMessage) ([]byte, error) {
+	retain := len(h.msgs)%2 == 0
+	if retain {
+		msg.Retain()
+	}
+	h.msgs = append(h.msgs, msg.Bytes)
+	h.retained = append(h.retained, retain)
+
+	if "error" == string(msg.Bytes) {
+		return nil, errors.New("error")
+	}
+	return nil, nil
+}
+
+func (h *recordingHandler) reportConnStats(stats connStats) bool {
+	h.reported = append(h.reported, stats)
+	return true
+}
+
+func TestConnServe(t *testing.T) {
+	msgs := []string{"one", "", "error", "three", strings.Repeat("x", 40000)}
+
+	buf := bytes.Buffer{}
+	mw := MessageWriter{W: &buf, Type: MessageTypeRaw}
+	for _, s := range msgs {
+		mw.WriteString(s)
+	}
+
+	h := &recordingHandler{}
+	c := conn{rd: bufio.NewReader(&buf), handler: h, statsReported: time.Now()}
+	c.Serve()
+
+	if len(h.msgs) != len(msgs) {
+		t.Fatalf("handled %d messages, want %d", len(h.msgs), len(msgs))
+	}
+	for i := range msgs {
+		if h.retained[i] && string(h.msgs[i]) != msgs[i] {
+			t.Errorf("retained message %d was reused: %q", i, h.msgs[i])
+		}
+	}
+
+	if len(h.reported) != 1 {
+		t.Fatalf("stats reported %d times, want 1", len(h.reported))
+	}
+	want := connStats{
+		count:      5,
+		errors:     1,
+		minSize:    0,
+		maxSize:    40000,
+		totalSize:  3 + 5 + 5 + 40000,
+		sumSquares: 9 + 25 + 25 + 40000*40000,
+	}
+	if h.reported[0] != want {
+		t.Errorf("stats = %+v, want %+v", h.reported[0], want)
+	}
+	if !c.stats.empty() {
+		t.Errorf("stats not reset after reporting: %+v", c.stats)
+	}
+}
+
+func TestConnServeTruncated(t *testing.T) {
+	buf := bytes.Buffer{}
+	mw := MessageWriter{W: &buf, Type: MessageTypeRaw}
+	mw.WriteString("hello")
+	buf.Truncate(buf.Len() - 1)
+
+	h := &recordingHandler{}
+	c := conn{rd: bufio.NewReader(&buf), handler: h, statsReported: time.Now()}
+	c.Serve()
+
+	if len(h.msgs) != 0 {
+		t.Fatalf("handled %d messages, want 0", len(h.msgs))
+	}
+	if len(h.reported) != 1 || h.reported[0] != (connStats{drops: 1}) {
+		t.Errorf("stats = %+v", h.reported)
+	}
+}
+
+func TestConnStatsAggregateInto(t *testing.T) {
+	h := NewHarvest(start, collector.NewHarvestLimits(nil))
+
+	s := connStats{}
+	s.observe(10)
+	s.observe(2)
+	s.observe(6)
+	s.drops = 3
+	s.AggregateInto(h)
+
+	js, err := h.Metrics.CollectorJSONSorted(AgentRunID(`12345`), end)
+	if nil != err {
+		t.Fatal(err)
+	}
+	expected := `["12345",1417136460,1417136520,[` +
+		`[{"name":"Supportability/Listener/Dropped"},[3,0,0,0,0,0]],` +
+		`[{"name":"Supportability/Listener/MessageSize"},[3,18,18,2,10,140]]]]`
+	if string(js) != expected {
+		t.Errorf("got=%s\nexpected=%s", js, expected)
+	}
+}
@@ -0,0 +1,97 @@
+//
+// Copyright 2024 New Relic Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+package newrelic
+
+import (
+	"github.com/newrelic/newrelic-php-agent/daemon/internal/newrelic/limits"
+	"github.com/newrelic/newrelic-php-agent/daemon/internal/newrelic/protocol"
+)
+
+// metricNames is the dictionary of metric names an agent has sent by id on
+// a single connection. Ids start at 1.
+//
+// The dictionary is owned by the goroutine serving the connection, while
+// transactions referring to it are aggregated by the processor. Names are
+// only ever appended, so the slice handed to the processor with each
+// transaction remains valid as later messages define more names.
+type metricNames struct {
+	names []string
+}
+
+// define records the names defined by the metrics of txn and returns the
+// dictionary to resolve the ids in txn with.
+func (mn *metricNames) define(txn *protocol.Transaction) []string {
+	var m protocol.Metric
+
+	n := txn.MetricsLength()
+	for i := 0; i < n; i++ {
+		txn.Metrics(&m, i)
+		mn.defineMetric(&m)
+	}
+
+	return mn.names
+}
+
+// defineBatch records the names defined by the metric groups of batch and
+// returns the dictionary to resolve the ids in batch with.
+func (mn *metricNames) defineBatch(batch *protocol.TransactionBatch) []string {
+	var group protocol.MetricGroup
+	var m protocol.Metric
+
+	groups := batch.MetricsLength()
+	for g := 0; g < groups; g++ {
+		batch.Metrics(&group, g)
+
+		n := group.MetricsLength()
+		for i := 0; i < n; i++ {
+			group.Metrics(&m, i)
+			mn.defineMetric(&m)
+		}
+	}
+
+	return mn.names
+}
+
+func (mn *metricNames) defineMetric(m *protocol.Metric) {
+	id := int(m.NameId())
+	if id < 1 || id > limits.MaxMetricNameIds {
+		return
+	}
+
+	name := m.Name()
+	if nil == name {
+		return
+	}
+
+	idx := id - 1
+	if idx < len(mn.names) {
+		if "" == mn.names[idx] {
+			// The id was skipped by an earlier message. The processor
+			// may hold the current slice, so copy before filling it in.
+			cpy := make([]string, len(mn.names), cap(mn.names))
+			copy(cpy, mn.names)
+			cpy[idx] = string(name)
+			mn.names = cpy
+		}
+		return
+	}
+
+	// Threads within an agent process can define ids out of order.
+	for len(mn.names) < idx {
+		mn.names = append(mn.names, "")
+	}
+	mn.names = append(mn.names, string(name))
+}
+
+// lookupMetricName returns the name for a metric id, or false if the id is
+// unknown.
+func lookupMetricName(names []string, id uint32) (string, bool) {
+	if id < 1 || int(id) > len(names) {
+		return "", false
+	}
+	name := names[id-1]
+	return name, "" != name
+}
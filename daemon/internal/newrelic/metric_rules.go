@@ -11,6 +11,7 @@ import (
 
 	"sort"
 	"strings"
+	"sync"
 
 	"github.com/newrelic/newrelic-php-agent/daemon/internal/newrelic/log"
 )
@@ -172,3 +173,99 @@ func (rules MetricRules) Apply(s string) (MetricRuleResult, string) {
 	}
 	return RuleResultUnmatched, s
 }
+
+type metricRuleCacheEntry struct {
+	result MetricRuleResult
+	name   string // Only set if result is RuleResultMatched
+}
+
+// MetricRulesCache memoizes the result of applying a set of metric rename
+// rules to metric names. Agents report largely the same metric names every
+// harvest, so after the first harvest almost every name is a single map
+// lookup rather than a pass through every rule.
+//
+// A cache belongs to a single connect reply, and so is discarded when the
+// app reconnects and receives new rules. It is safe for concurrent use,
+// since final metrics are created by harvest goroutines while the processor
+// continues to add metrics to the next harvest.
+type MetricRulesCache struct {
+	rules    MetricRules
+	maxNames int
+
+	sync.RWMutex
+	names map[string]metricRuleCacheEntry
+}
+
+// NewMetricRulesCache returns a cache for the given rules which remembers the
+// results for at most maxNames names. When the cache is full, it is emptied
+// so that names that are no longer reported do not stay in it indefinitely.
+func NewMetricRulesCache(rules MetricRules, maxNames int) *MetricRulesCache {
+	return &MetricRulesCache{
+		rules:    rules,
+		maxNames: maxNames,
+		names:    make(map[string]metricRuleCacheEntry),
+	}
+}
+
+// Apply applies the cached rules to a metric name given either as a byte
+// slice or, if nameSlice is nil, as a string. The result is the same as that
+// of MetricRules.Apply, but the renamed metric is only returned if the result
+// is RuleResultMatched; otherwise the caller should keep the original name.
+func (c *MetricRulesCache) Apply(nameSlice []byte, nameString string) (MetricRuleResult, string) {
+	if nil == c || 0 == len(c.rules) {
+		return RuleResultUnmatched, ""
+	}
+
+	var (
+		entry metricRuleCacheEntry
+		ok    bool
+	)
+
+	// Indexing a map with a converted byte slice does not allocate.
+	c.RLock()
+	if nil == nameSlice {
+		entry, ok = c.names[nameString]
+	} else {
+		entry, ok = c.names[string(nameSlice)]
+	}
+	c.RUnlock()
+
+	if ok {
+		return entry.result, entry.name
+	}
+
+	name := nameString
+	if nil != nameSlice {
+		name = string(nameSlice)
+	}
+
+	entry.result, entry.name = c.rules.Apply(name)
+	switch entry.result {
+	case RuleResultMatched:
+		if entry.name != name {
+			log.Debugf("metric renamed by rules: '%s' -> '%s'", name,
+				entry.name)
+		}
+	case RuleResultIgnore:
+		log.Debugf("metric ignored by rules: '%s'", name)
+		entry.name = ""
+	case RuleResultUnmatched:
+		entry.name = ""
+	}
+
+	c.Lock()
+	if len(c.names) >= c.maxNames {
+		c.names = make(map[string]metricRuleCacheEntry)
+	}
+	c.names[name] = entry
+	c.Unlock()
+
+	return entry.result, entry.name
+}
+
+// Len returns the number of names whose results are cached.
+func (c *MetricRulesCache) Len() int {
+	c.RLock()
+	defer c.RUnlock()
+	return len(c.names)
+}
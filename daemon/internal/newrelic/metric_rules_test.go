@@ -92,3 +92,71 @@ func TestAmbiguousReplacement(t *testing.T) {
 		t.Fatal(rules)
 	}
 }
+
+func TestMetricRulesCache(t *testing.T) {
+	js := `[{
+		"match_expression":"^Custom/(.*)$",
+		"replacement":"Custom/\\1/Renamed",
+		"ignore":false,
+		"eval_order":0
+	},{
+		"match_expression":"^Ignored$",
+		"ignore":true,
+		"eval_order":1
+	}]`
+	rules := NewMetricRulesFromJSON([]byte(js))
+	if 2 != rules.Len() {
+		t.Fatal(rules)
+	}
+
+	cache := NewMetricRulesCache(rules, 3)
+
+	for i := 0; i < 2; i++ {
+		res, out := cache.Apply(nil, "Custom/foo")
+		if RuleResultMatched != res || "Custom/foo/Renamed" != out {
+			t.Fatal(res, out)
+		}
+		res, out = cache.Apply([]byte("Custom/foo"), "")
+		if RuleResultMatched != res || "Custom/foo/Renamed" != out {
+			t.Fatal(res, out)
+		}
+		res, out = cache.Apply(nil, "Ignored")
+		if RuleResultIgnore != res || "" != out {
+			t.Fatal(res, out)
+		}
+		res, out = cache.Apply([]byte("Other"), "")
+		if RuleResultUnmatched != res || "" != out {
+			t.Fatal(res, out)
+		}
+		if 3 != cache.Len() {
+			t.Fatal(cache.Len())
+		}
+	}
+
+	// A full cache is emptied before new names are added.
+	res, out := cache.Apply(nil, "Custom/bar")
+	if RuleResultMatched != res || "Custom/bar/Renamed" != out {
+		t.Fatal(res, out)
+	}
+	if 1 != cache.Len() {
+		t.Fatal(cache.Len())
+	}
+}
+
+func TestMetricRulesCacheEmpty(t *testing.T) {
+	var cache *MetricRulesCache
+
+	res, out := cache.Apply(nil, "hello")
+	if RuleResultUnmatched != res || "" != out {
+		t.Fatal(res, out)
+	}
+
+	cache = NewMetricRulesCache(nil, 10)
+	res, out = cache.Apply([]byte("hello"), "")
+	if RuleResultUnmatched != res || "" != out {
+		t.Fatal(res, out)
+	}
+	if 0 != cache.Len() {
+		t.Fatal(cache.Len())
+	}
+}
@@ -10,6 +10,7 @@ import (
 	"encoding/json"
 	"errors"
 	"fmt"
+	"hash/maphash"
 	"regexp"
 	"sort"
 	"strings"
@@ -56,6 +57,41 @@ type metric struct {
 	data   metricData
 }
 
+// metricEntry is a metric stored inline in a MetricTable. Its name and scope
+// are stored in the table's arena, so that entries contain no pointers for
+// the garbage collector to trace.
+type metricEntry struct {
+	hash     uint64
+	nameOff  uint32
+	nameLen  uint32
+	scopeOff uint32
+	scopeLen uint32
+	metric
+}
+
+// metricSeed is shared by all metric tables. Hashes are only ever compared
+// within a single table.
+var metricSeed = maphash.MakeSeed()
+
+// minMetricSlots is the initial size of a metric table's index. It must be a
+// power of two.
+const minMetricSlots = 64
+
+func hashMetric(nameSlice []byte, nameString, scope string) uint64 {
+	var h uint64
+	if nil == nameSlice {
+		h = maphash.String(metricSeed, nameString)
+	} else {
+		h = maphash.Bytes(metricSeed, nameSlice)
+	}
+	if "" != scope {
+		// Mix the scope in asymmetrically, so that swapping the name and
+		// scope does not give the same hash.
+		h = (h * 0x9e3779b97f4a7c15) ^ maphash.String(metricSeed, scope)
+	}
+	return h
+}
+
 // A MetricTable represents an aggregate of metrics reported by agents
 // during a harvest period. Each metric table enforces a limit on the
 // maximum number of unique metrics that can be recorded. However,
@@ -70,30 +106,108 @@ type MetricTable struct {
 	count      int // The total number of metrics stored
 	numDropped int // Number of unforced metrics dropped due to full
 	// table
-	// Metrics are uniquely identified by their name and scope.  Rather than
-	// use a map which is indexed by a struct containing the name and scope,
-	// we use a nested map approach to allow for looking up metrics without
-	// copying their names from a byte slice to a string.
+	// Metrics are uniquely identified by their name and scope. They are
+	// stored inline in entries, in the order they were added, and found
+	// through an open addressing index keyed by a hash of the name and
+	// scope. Names and scopes are appended to arena, which allows looking
+	// up metrics without copying their names from a byte slice to a
+	// string. None of these contain pointers, which keeps large tables
+	// cheap for the garbage collector.
 	//
-	// The first (outer) map is by name, second (inner) map is by scope.
-	// Unscoped metrics use an empty scope string.
-	metrics map[string]map[string]*metric
+	// Unscoped metrics use an empty scope.
+	arena   []byte
+	entries []metricEntry
+	slots   []int32 // Index into entries plus one, or 0 if the slot is empty
+
+	// Metric rename rules applied to each metric as it is added, if any.
+	// Metrics merged from another table have already been renamed.
+	rules *MetricRulesCache
 }
 
 // NewMetricTable returns a new metric table with capacity maxTableSize.
 func NewMetricTable(maxTableSize int, now time.Time) *MetricTable {
 	return &MetricTable{
 		metricPeriodStart: now,
-		metrics:           make(map[string]map[string]*metric),
 		maxTableSize:      maxTableSize,
 		failedHarvests:    0,
 	}
 }
 
+// NewMetricTableWithRules returns a new metric table with capacity
+// maxTableSize, which renames metrics using rules as they are added.
+func NewMetricTableWithRules(maxTableSize int, now time.Time,
+	rules *MetricRulesCache) *MetricTable {
+	mt := NewMetricTable(maxTableSize, now)
+	mt.rules = rules
+	return mt
+}
+
 func (mt *MetricTable) full() bool {
 	return mt.count >= mt.maxTableSize
 }
 
+func (mt *MetricTable) entryName(e *metricEntry) []byte {
+	return mt.arena[e.nameOff : e.nameOff+e.nameLen]
+}
+
+func (mt *MetricTable) entryScope(e *metricEntry) []byte {
+	return mt.arena[e.scopeOff : e.scopeOff+e.scopeLen]
+}
+
+// find returns the slot holding the given metric, or the empty slot where it
+// should be inserted.
+func (mt *MetricTable) find(hash uint64, nameSlice []byte, nameString,
+	scope string) int {
+	mask := uint64(len(mt.slots) - 1)
+	for i := hash & mask; ; i = (i + 1) & mask {
+		idx := mt.slots[i]
+		if 0 == idx {
+			return int(i)
+		}
+
+		e := &mt.entries[idx-1]
+		if e.hash != hash || string(mt.entryScope(e)) != scope {
+			continue
+		}
+		if nil == nameSlice {
+			if string(mt.entryName(e)) == nameString {
+				return int(i)
+			}
+		} else if string(mt.entryName(e)) == string(nameSlice) {
+			return int(i)
+		}
+	}
+}
+
+// grow doubles the size of the index, which is kept at most three quarters
+// full.
+func (mt *MetricTable) grow() {
+	n := 2 * len(mt.slots)
+	if n < minMetricSlots {
+		n = minMetricSlots
+	}
+
+	mt.slots = make([]int32, n)
+	mask := uint64(n - 1)
+	for idx := range mt.entries {
+		i := mt.entries[idx].hash & mask
+		for 0 != mt.slots[i] {
+			i = (i + 1) & mask
+		}
+		mt.slots[i] = int32(idx + 1)
+	}
+}
+
+func (mt *MetricTable) appendArena(nameSlice []byte, nameString string) (uint32, uint32) {
+	off := uint32(len(mt.arena))
+	if nil == nameSlice {
+		mt.arena = append(mt.arena, nameString...)
+	} else {
+		mt.arena = append(mt.arena, nameSlice...)
+	}
+	return off, uint32(len(mt.arena)) - off
+}
+
 func (data *metricData) aggregate(src *metricData) {
 	data.countSatisfied += src.countSatisfied
 	data.totalTolerated += src.totalTolerated
@@ -119,43 +233,30 @@ func (mt *MetricTable) NumFailedAttempts() float64 {
 
 func (mt *MetricTable) mergeMetric(nameSlice []byte, nameString, scope string,
 	m *metric) {
-	var s map[string]*metric
-	if nil == nameSlice {
-		s = mt.metrics[nameString]
-	} else {
-		// This lookup is optimized by Go to avoid a copy.
-		// See:  https://github.com/golang/go/issues/3512
-		s = mt.metrics[string(nameSlice)]
+	if 4*(len(mt.entries)+1) > 3*len(mt.slots) {
+		mt.grow()
 	}
 
-	var to *metric
-	if nil != s {
-		to = s[scope]
-	}
-
-	if nil == to {
-		if mt.full() && (Unforced == m.forced) {
-			mt.numDropped++
-			return
-		}
-
-		if nil == s {
-			if nil != nameSlice {
-				nameString = string(nameSlice)
-			}
+	hash := hashMetric(nameSlice, nameString, scope)
+	slot := mt.find(hash, nameSlice, nameString, scope)
 
-			s = make(map[string]*metric)
-			mt.metrics[nameString] = s
-		}
+	if idx := mt.slots[slot]; 0 != idx {
+		mt.entries[idx-1].data.aggregate(&m.data)
+		return
+	}
 
-		to = &metric{}
-		*to = *m
-		s[scope] = to
-		mt.count++
+	if mt.full() && (Unforced == m.forced) {
+		mt.numDropped++
 		return
 	}
 
-	to.data.aggregate(&m.data)
+	e := metricEntry{hash: hash, metric: *m}
+	e.nameOff, e.nameLen = mt.appendArena(nameSlice, nameString)
+	e.scopeOff, e.scopeLen = mt.appendArena(nil, scope)
+
+	mt.entries = append(mt.entries, e)
+	mt.slots[slot] = int32(len(mt.entries))
+	mt.count++
 }
 
 // MergeFailed merges the given metrics into mt after a failed
@@ -178,15 +279,22 @@ func (mt *MetricTable) MergeFailed(from *MetricTable) {
 
 // Merge merges the given metric table into mt.
 func (mt *MetricTable) Merge(from *MetricTable) {
-	for name, s := range from.metrics {
-		for scope, m := range s {
-			mt.mergeMetric(nil, name, scope, m)
-		}
+	for i := range from.entries {
+		e := &from.entries[i]
+		mt.mergeMetric(from.entryName(e), "", string(from.entryScope(e)),
+			&e.metric)
 	}
 }
 
 func (mt *MetricTable) add(nameSlice []byte, nameString, scope string,
 	data metricData, force MetricForce) {
+	switch res, out := mt.rules.Apply(nameSlice, nameString); res {
+	case RuleResultMatched:
+		nameSlice, nameString = nil, out
+	case RuleResultIgnore:
+		return
+	case RuleResultUnmatched:
+	}
 	mt.mergeMetric(nameSlice, nameString, scope,
 		&metric{data: data, forced: force})
 }
@@ -285,33 +393,32 @@ func (mt *MetricTable) CollectorJSON(id AgentRunID, now time.Time) ([]byte,
 	buf.WriteByte(',')
 
 	buf.WriteByte('[')
-	for name, scopes := range mt.metrics {
-		for scope, metric := range scopes {
-			buf.WriteByte('[')
-			buf.WriteByte('{')
-			buf.WriteString(`"name":`)
-			jsonx.AppendString(buf, name)
-			if scope != "" {
-				buf.WriteString(`,"scope":`)
-				jsonx.AppendString(buf, scope)
-			}
-			buf.WriteByte('}')
-			buf.WriteByte(',')
-
-			err := jsonx.AppendFloatArray(buf,
-				metric.data.countSatisfied,
-				metric.data.totalTolerated,
-				metric.data.exclusiveFailed,
-				metric.data.min,
-				metric.data.max,
-				metric.data.sumSquares)
-			if err != nil {
-				return nil, err
-			}
-
-			buf.WriteByte(']')
-			buf.WriteByte(',')
+	for i := range mt.entries {
+		metric := &mt.entries[i]
+		buf.WriteByte('[')
+		buf.WriteByte('{')
+		buf.WriteString(`"name":`)
+		jsonx.AppendString(buf, string(mt.entryName(metric)))
+		if metric.scopeLen != 0 {
+			buf.WriteString(`,"scope":`)
+			jsonx.AppendString(buf, string(mt.entryScope(metric)))
+		}
+		buf.WriteByte('}')
+		buf.WriteByte(',')
+
+		err := jsonx.AppendFloatArray(buf,
+			metric.data.countSatisfied,
+			metric.data.totalTolerated,
+			metric.data.exclusiveFailed,
+			metric.data.min,
+			metric.data.max,
+			metric.data.sumSquares)
+		if err != nil {
+			return nil, err
 		}
+
+		buf.WriteByte(']')
+		buf.WriteByte(',')
 	}
 	if mt.count > 0 {
 		// Strip trailing comma from final metric.
@@ -341,10 +448,14 @@ func (mt *MetricTable) Empty() bool {
 }
 
 // Has returns true if the given metric exists in the metric table (regardless
-// of scope).
+// of scope). This scans the whole table, and is intended for tests.
 func (mt *MetricTable) Has(name string) bool {
-	_, ok := mt.metrics[name]
-	return ok
+	for i := range mt.entries {
+		if string(mt.entryName(&mt.entries[i])) == name {
+			return true
+		}
+	}
+	return false
 }
 
 // Data marshals the collection to JSON according to the schema expected
@@ -371,32 +482,6 @@ func (mt *MetricTable) FailedHarvest(newHarvest *Harvest) {
 	newHarvest.Metrics.MergeFailed(mt)
 }
 
-// ApplyRules returns a new MetricTable containing the results of applying
-// the given metric rename rules to mt.
-func (mt *MetricTable) ApplyRules(rules MetricRules) *MetricTable {
-	if nil == rules {
-		return mt
-	}
-	if len(rules) == 0 {
-		return mt
-	}
-
-	applied := NewMetricTable(mt.maxTableSize, mt.metricPeriodStart)
-
-	for name, s := range mt.metrics {
-		_, out := rules.Apply(name)
-
-		if out != name {
-			log.Debugf("metric renamed by rules: '%s' -> '%s'", name, out)
-		}
-		for scope, metric := range s {
-			applied.mergeMetric(nil, out, scope, metric)
-		}
-	}
-
-	return applied
-}
-
 type debugMetric struct {
 	Name   string      `json:"name"`
 	Forced bool        `json:"forced"`
@@ -413,17 +498,15 @@ func (ds debugMetrics) Less(i, j int) bool { return ds[i].ID.Less(ds[j].ID) }
 // DebugJSON marshals the metrics to JSON in a format useful for debugging.
 func (mt *MetricTable) DebugJSON() string {
 	metrics := make(debugMetrics, mt.count)
-	i := 0
-	for name, s := range mt.metrics {
-		for scope, metric := range s {
-			metrics[i].ID = metricID{Name: name, Scope: scope}
-			metrics[i].Data = metric.data.collectorData()
-			if metric.forced == Forced {
-				metrics[i].Forced = true
-			}
-			metrics[i].Name = name
-			i++
+	for i := range mt.entries {
+		metric := &mt.entries[i]
+		name := string(mt.entryName(metric))
+		metrics[i].ID = metricID{Name: name, Scope: string(mt.entryScope(metric))}
+		metrics[i].Data = metric.data.collectorData()
+		if metric.forced == Forced {
+			metrics[i].Forced = true
 		}
+		metrics[i].Name = name
 	}
 	// sort metrics for easy and deterministic JSON comparison tests
 	sort.Sort(metrics)
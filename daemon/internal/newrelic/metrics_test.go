@@ -7,6 +7,7 @@ package newrelic
 
 import (
 	"encoding/json"
+	"runtime"
 	"strconv"
 	"testing"
 	"time"
@@ -62,26 +63,45 @@ func TestMetrics(t *testing.T) {
 	}
 }
 
-func TestApplyRules(t *testing.T) {
-	js := `[{"ignore":false,"each_segment":false,"terminate_chain":true,"replacement":"been_renamed","replace_all":false,"match_expression":"one$","eval_order":1}]`
-	rules := NewMetricRulesFromJSON([]byte(js))
+func TestMetricTableRules(t *testing.T) {
+	js := `[{"ignore":false,"each_segment":false,"terminate_chain":true,"replacement":"been_renamed","replace_all":false,"match_expression":"one$","eval_order":1},` +
+		`{"ignore":true,"each_segment":false,"terminate_chain":true,"replacement":"","replace_all":false,"match_expression":"^ignored$","eval_order":2}]`
+	rules := NewMetricRulesCache(NewMetricRulesFromJSON([]byte(js)), 100)
 
-	mt := NewMetricTable(20, start)
+	mt := NewMetricTableWithRules(20, start, rules)
 	addDuration(mt, "one", "", 2*time.Second, 1*time.Second, Unforced)
 	addDuration(mt, "one", "my_scope", 2*time.Second, 1*time.Second, Unforced)
+	mt.AddRaw([]byte("one"), "", "", [6]float64{1, 2, 1, 2, 2, 4}, Unforced)
+	addDuration(mt, "ignored", "", 2*time.Second, 1*time.Second, Unforced)
+	addDuration(mt, "two", "", 2*time.Second, 1*time.Second, Unforced)
 
-	applied := mt.ApplyRules(rules)
-	json, err := applied.CollectorJSONSorted(AgentRunID(`12345`), end)
+	json, err := mt.CollectorJSONSorted(AgentRunID(`12345`), end)
 	if nil != err {
 		t.Fatal(err)
 	}
 
-	expected := `["12345",1417136460,1417136520,[[{"name":"been_renamed"},[1,2,1,2,2,4]],` +
+	expected := `["12345",1417136460,1417136520,[[{"name":"been_renamed"},[2,4,2,2,2,8]],` +
+		`[{"name":"two"},[1,2,1,2,2,4]],` +
 		`[{"name":"been_renamed","scope":"my_scope"},[1,2,1,2,2,4]]]]`
 
 	if string(json) != expected {
 		t.Fatal(string(json))
 	}
+
+	// Metrics merged from another table have already been renamed, and
+	// must not be renamed again.
+	js = `[{"ignore":false,"each_segment":false,"terminate_chain":true,"replacement":"been_renamed","replace_all":false,"match_expression":"renamed$","eval_order":1}]`
+	rules = NewMetricRulesCache(NewMetricRulesFromJSON([]byte(js)), 100)
+	dest := NewMetricTableWithRules(20, start, rules)
+	dest.Merge(mt)
+
+	json, err = dest.CollectorJSONSorted(AgentRunID(`12345`), end)
+	if nil != err {
+		t.Fatal(err)
+	}
+	if string(json) != expected {
+		t.Fatal(string(json))
+	}
 }
 
 func TestForced(t *testing.T) {
@@ -319,3 +339,221 @@ func TestMetricTableHas(t *testing.T) {
 		t.Fatal("scoped metric is reported as missing")
 	}
 }
+
+func TestMetricTableGrow(t *testing.T) {
+	mt := NewMetricTable(5000, time.Now())
+
+	for i := 0; i < 1000; i++ {
+		name := "Custom/" + strconv.Itoa(i)
+		mt.AddCount(name, "", 1, Unforced)
+		mt.AddCount(name, "WebTransaction/"+strconv.Itoa(i%7), 1, Unforced)
+	}
+	for i := 0; i < 1000; i++ {
+		mt.AddCount("Custom/"+strconv.Itoa(i), "", 2, Unforced)
+	}
+
+	if mt.count != 2000 || len(mt.entries) != 2000 {
+		t.Fatalf("count=%d entries=%d", mt.count, len(mt.entries))
+	}
+
+	for i := 0; i < 1000; i++ {
+		name := "Custom/" + strconv.Itoa(i)
+
+		slot := mt.find(hashMetric(nil, name, ""), nil, name, "")
+		if idx := mt.slots[slot]; 0 == idx {
+			t.Fatalf("%s not found", name)
+		} else if c := mt.entries[idx-1].data.countSatisfied; c != 3 {
+			t.Errorf("%s count=%v", name, c)
+		}
+
+		scope := "WebTransaction/" + strconv.Itoa(i%7)
+		slot = mt.find(hashMetric([]byte(name), "", scope), []byte(name), "", scope)
+		if idx := mt.slots[slot]; 0 == idx {
+			t.Fatalf("%s scoped to %s not found", name, scope)
+		} else if c := mt.entries[idx-1].data.countSatisfied; c != 1 {
+			t.Errorf("%s scoped to %s count=%v", name, scope, c)
+		}
+	}
+}
+
+func TestMetricTableNameScopeDistinct(t *testing.T) {
+	mt := NewMetricTable(20, start)
+
+	mt.AddCount("a", "b", 1, Unforced)
+	mt.AddCount("b", "a", 2, Unforced)
+	mt.AddCount("ab", "", 3, Unforced)
+	mt.AddCount("", "ab", 4, Unforced)
+
+	if mt.count != 4 {
+		t.Fatalf("count=%d", mt.count)
+	}
+
+	js, err := mt.CollectorJSONSorted(AgentRunID(`12345`), end)
+	if nil != err {
+		t.Fatal(err)
+	}
+	expected := `["12345",1417136460,1417136520,[` +
+		`[{"name":"ab"},[3,0,0,0,0,0]],` +
+		`[{"name":"b","scope":"a"},[2,0,0,0,0,0]],` +
+		`[{"name":"","scope":"ab"},[4,0,0,0,0,0]],` +
+		`[{"name":"a","scope":"b"},[1,0,0,0,0,0]]]]`
+	if string(js) != expected {
+		t.Errorf("got=%s\nexpected=%s", js, expected)
+	}
+}
+
+// nestedMetricTable is the nested map design the metric table used before
+// it was flattened. It is kept here to compare against in benchmarks.
+type nestedMetricTable struct {
+	count   int
+	metrics map[string]map[string]*metric
+}
+
+func (mt *nestedMetricTable) mergeMetric(nameSlice []byte, scope string, m *metric) {
+	s := mt.metrics[string(nameSlice)]
+
+	var to *metric
+	if nil != s {
+		to = s[scope]
+	}
+
+	if nil == to {
+		if nil == s {
+			s = make(map[string]*metric)
+			mt.metrics[string(nameSlice)] = s
+		}
+		to = &metric{}
+		*to = *m
+		s[scope] = to
+		mt.count++
+		return
+	}
+
+	to.data.aggregate(&m.data)
+}
+
+// benchmarkMetricNames returns the unscoped and scoped metric names recorded
+// by a typical set of transactions.
+func benchmarkMetricNames() (names [][]byte, scopes []string) {
+	for i := 0; i < 50; i++ {
+		scope := "WebTransaction/Uri/myblog2/" + strconv.Itoa(i)
+		for j := 0; j < 40; j++ {
+			name := "Datastore/statement/MySQL/City" + strconv.Itoa(j) + "/insert"
+			names = append(names, []byte(name), []byte(name))
+			scopes = append(scopes, "", scope)
+		}
+	}
+	return names, scopes
+}
+
+func BenchmarkMetricTableMerge(b *testing.B) {
+	names, scopes := benchmarkMetricNames()
+	m := &metric{data: metricData{countSatisfied: 1}}
+
+	b.Run("flat", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			mt := NewMetricTable(limits.MaxMetrics, time.Now())
+			for k := 0; k < 4; k++ {
+				for n := range names {
+					mt.mergeMetric(names[n], "", scopes[n], m)
+				}
+			}
+		}
+	})
+
+	b.Run("nested", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			mt := &nestedMetricTable{metrics: make(map[string]map[string]*metric)}
+			for k := 0; k < 4; k++ {
+				for n := range names {
+					mt.mergeMetric(names[n], scopes[n], m)
+				}
+			}
+		}
+	})
+}
+
+// BenchmarkMetricTableGC reports the time taken by a full garbage collection
+// while a daemon's worth of metric tables is live.
+func BenchmarkMetricTableGC(b *testing.B) {
+	const tables = 200
+
+	names, scopes := benchmarkMetricNames()
+	m := &metric{data: metricData{countSatisfied: 1}}
+
+	measure := func(b *testing.B, live interface{}) {
+		runtime.GC()
+		b.ResetTimer()
+		start := time.Now()
+		for i := 0; i < b.N; i++ {
+			runtime.GC()
+		}
+		b.ReportMetric(float64(time.Since(start).Nanoseconds())/float64(b.N), "ns/gc")
+		runtime.KeepAlive(live)
+	}
+
+	b.Run("flat", func(b *testing.B) {
+		live := make([]*MetricTable, tables)
+		for t := range live {
+			live[t] = NewMetricTable(limits.MaxMetrics, time.Now())
+			for n := range names {
+				live[t].mergeMetric(names[n], "", scopes[n], m)
+			}
+		}
+		measure(b, live)
+	})
+
+	b.Run("nested", func(b *testing.B) {
+		live := make([]*nestedMetricTable, tables)
+		for t := range live {
+			live[t] = &nestedMetricTable{metrics: make(map[string]map[string]*metric)}
+			for n := range names {
+				live[t].mergeMetric(names[n], scopes[n], m)
+			}
+		}
+		measure(b, live)
+	})
+}
+
+func BenchmarkMetricTableRules(b *testing.B) {
+	js := `[{"match_expression":"^Datastore/statement/MySQL/City[0-9]+/","replacement":"Datastore/statement/MySQL/City*/","eval_order":1},` +
+		`{"match_expression":"^WebTransaction/Uri/.*$","replacement":"WebTransaction/Uri/*","eval_order":2}]`
+	rules := NewMetricRulesFromJSON([]byte(js))
+	names, scopes := benchmarkMetricNames()
+	data := [6]float64{1, 0, 0, 0, 0, 0}
+
+	b.Run("harvest", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			mt := NewMetricTable(limits.MaxMetrics, time.Now())
+			for n := range names {
+				mt.AddRaw(names[n], "", scopes[n], data, Unforced)
+			}
+			// Rename everything in a separate pass at harvest.
+			applied := NewMetricTable(mt.maxTableSize, mt.metricPeriodStart)
+			renamed := make(map[string]string)
+			for e := range mt.entries {
+				name := string(mt.entryName(&mt.entries[e]))
+				out, ok := renamed[name]
+				if !ok {
+					_, out = rules.Apply(name)
+					renamed[name] = out
+				}
+				applied.mergeMetric(nil, out, string(mt.entryScope(&mt.entries[e])), &mt.entries[e].metric)
+			}
+		}
+	})
+
+	b.Run("incremental", func(b *testing.B) {
+		cache := NewMetricRulesCache(rules, limits.MaxMetricRulesCacheNames)
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			mt := NewMetricTableWithRules(limits.MaxMetrics, time.Now(), cache)
+			for n := range names {
+				mt.AddRaw(names[n], "", scopes[n], data, Unforced)
+			}
+		}
+	})
+}
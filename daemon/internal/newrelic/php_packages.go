@@ -7,6 +7,7 @@ package newrelic
 
 import (
 	"bytes"
+	"encoding/json"
 	"fmt"
 	"time"
 
@@ -19,9 +20,13 @@ type PhpPackagesKey struct {
 }
 
 // phpPackages represents all detected packages reported by an agent.
+// Packages are kept as a set in the order they were first observed, and
+// only marshalled into a single list at harvest.
 type PhpPackages struct {
 	numSeen int
 	data    JSONString
+	keys    []PhpPackagesKey
+	pkgs    map[PhpPackagesKey]json.RawMessage
 }
 
 // NumSeen returns the total number PHP packages payloads stored.
@@ -47,7 +52,7 @@ func (packages *PhpPackages) SetPhpPackages(data []byte) error {
 	if nil == packages {
 		return fmt.Errorf("packages is nil!")
 	}
-	if nil != packages.data {
+	if nil != packages.data || 0 < len(packages.keys) {
 		log.Debugf("SetPhpPackages - data field was not nil |^%s| - overwriting data", packages.data)
 	}
 	if nil == data {
@@ -55,13 +60,96 @@ func (packages *PhpPackages) SetPhpPackages(data []byte) error {
 	}
 	packages.numSeen = 1
 	packages.data = data
+	packages.keys = nil
+	packages.pkgs = nil
 
 	return nil
 }
 
 // AddPhpPackagesFromData observes the PHP packages info from the agent.
+// The agent leaves packages that it has already reported in this agent run
+// out of later transactions, so each list is merged into those already
+// observed in this harvest rather than replacing them. Only the incoming
+// list is parsed; the packages already observed are not.
 func (packages *PhpPackages) AddPhpPackagesFromData(data []byte) error {
-	return packages.SetPhpPackages(data)
+	if nil == packages || nil == data {
+		return packages.SetPhpPackages(data)
+	}
+
+	var addedPkgs []json.RawMessage
+
+	if err := json.Unmarshal(data, &addedPkgs); nil != err {
+		if nil == packages.data && 0 == len(packages.keys) {
+			return packages.SetPhpPackages(data)
+		}
+		return fmt.Errorf("failed to unmarshal php package json: %s", err)
+	}
+
+	if nil != packages.data {
+		log.Debugf("AddPhpPackagesFromData - invalid stored data |^%s| - overwriting data", packages.data)
+		packages.data = nil
+	}
+	if nil == packages.pkgs {
+		packages.pkgs = make(map[PhpPackagesKey]json.RawMessage, len(addedPkgs))
+	}
+
+	for _, pkgJSON := range addedPkgs {
+		key, ok := phpPackageKey(pkgJSON)
+		if !ok {
+			log.Debugf("AddPhpPackagesFromData - ignoring invalid package |^%s|", pkgJSON)
+			continue
+		}
+		if _, ok := packages.pkgs[key]; ok {
+			continue
+		}
+		packages.pkgs[key] = pkgJSON
+		packages.keys = append(packages.keys, key)
+	}
+	packages.numSeen = 1
+
+	return nil
+}
+
+// phpPackageKey returns the name and version of a package in the JSON
+// format sent by the agent: ["package_name","version",{}]
+func phpPackageKey(pkgJSON json.RawMessage) (PhpPackagesKey, bool) {
+	var pkg []interface{}
+
+	if err := json.Unmarshal(pkgJSON, &pkg); nil != err || len(pkg) != 3 {
+		return PhpPackagesKey{}, false
+	}
+	name, nameOk := pkg[0].(string)
+	version, versionOk := pkg[1].(string)
+
+	return PhpPackagesKey{name, version}, nameOk && versionOk
+}
+
+// packagesJSON returns the observed packages as a single JSON list, or the
+// data stored by SetPhpPackages.
+func (packages *PhpPackages) packagesJSON() []byte {
+	if 0 == len(packages.keys) {
+		return packages.data
+	}
+
+	buf := &bytes.Buffer{}
+	buf.WriteByte('[')
+	for i, key := range packages.keys {
+		if i > 0 {
+			buf.WriteByte(',')
+		}
+		buf.Write(packages.pkgs[key])
+	}
+	buf.WriteByte(']')
+
+	return buf.Bytes()
+}
+
+// filter drops the packages that app has already reported during the
+// current connection. It is called by the processor once per harvest.
+func (packages *PhpPackages) filter(app *App) {
+	packages.data = app.filterPhpPackages(packages.packagesJSON())
+	packages.keys = nil
+	packages.pkgs = nil
 }
 
 // CollectorJSON marshals events to JSON according to the schema expected
@@ -78,7 +166,7 @@ func (packages *PhpPackages) CollectorJSON(id AgentRunID) ([]byte, error) {
 	buf.WriteByte('[')
 	buf.WriteString("\"Jars\",")
 	if 0 < packages.numSeen {
-		buf.Write(packages.data)
+		buf.Write(packages.packagesJSON())
 	}
 	buf.WriteByte(']')
 
@@ -94,7 +182,7 @@ func (packages *PhpPackages) FailedHarvest(newHarvest *Harvest) {
 
 // Empty returns true if the collection is empty.
 func (packages *PhpPackages) Empty() bool {
-	return nil == packages || nil == packages.data || 0 == packages.numSeen
+	return nil == packages || (nil == packages.data && 0 == len(packages.keys)) || 0 == packages.numSeen
 }
 
 // Data marshals the collection to JSON according to the schema expected
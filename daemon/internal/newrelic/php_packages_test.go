@@ -83,6 +83,48 @@ func TestAddPhpPackagesFromData(t *testing.T) {
 	}
 }
 
+func TestAddPhpPackagesFromDataMerges(t *testing.T) {
+	pkg := NewPhpPackages()
+
+	err := pkg.AddPhpPackagesFromData([]byte(`[["a","1.0",{}],["b","2.0",{}]]`))
+	if nil != err {
+		t.Fatalf("Expected nil error, got %s", err.Error())
+	}
+
+	// A later transaction leaving out packages that were already reported
+	// must not remove them.
+	err = pkg.AddPhpPackagesFromData([]byte(`[["c","3.0",{}],["a","1.0",{}]]`))
+	if nil != err {
+		t.Fatalf("Expected nil error, got %s", err.Error())
+	}
+	expected := `[["a","1.0",{}],["b","2.0",{}],["c","3.0",{}]]`
+	if expected != string(pkg.packagesJSON()) {
+		t.Fatalf("Expected '%s', got '%s'", expected, string(pkg.packagesJSON()))
+	}
+
+	// A different version of a package is a different package.
+	err = pkg.AddPhpPackagesFromData([]byte(`[["a","1.1",{}]]`))
+	if nil != err {
+		t.Fatalf("Expected nil error, got %s", err.Error())
+	}
+	expected = `[["a","1.0",{}],["b","2.0",{}],["c","3.0",{}],["a","1.1",{}]]`
+	if expected != string(pkg.packagesJSON()) {
+		t.Fatalf("Expected '%s', got '%s'", expected, string(pkg.packagesJSON()))
+	}
+
+	// Invalid data is rejected, and the packages already observed are kept.
+	err = pkg.AddPhpPackagesFromData([]byte(`hello`))
+	if nil == err {
+		t.Fatal("Expected error, got nil")
+	}
+	if expected != string(pkg.packagesJSON()) {
+		t.Fatalf("Expected '%s', got '%s'", expected, string(pkg.packagesJSON()))
+	}
+	if 1 != pkg.NumSaved() {
+		t.Fatalf("Expected 1, got %f", pkg.NumSaved())
+	}
+}
+
 func TestCollectorJSON(t *testing.T) {
 	// create nil pkgs for testing passing a nil receiver
 	var nilpkg *PhpPackages
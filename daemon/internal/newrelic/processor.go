@@ -443,6 +443,8 @@ func (p *Processor) processConnectAttempt(rep ConnectAttempt) {
 	}
 
 	app.connectReply = rep.Reply
+	app.metricRules = NewMetricRulesCache(app.connectReply.MetricRules,
+		limits.MaxMetricRulesCacheNames)
 	app.state = AppStateConnected
 	app.collector = rep.Collector
 	app.RawSecurityPolicies = rep.RawSecurityPolicies
@@ -471,7 +473,8 @@ func (p *Processor) processConnectAttempt(rep ConnectAttempt) {
 	log.Infof("app '%s' connected with run id '%s'", app, app.connectReply.ID)
 
 	p.harvests[*app.connectReply.ID] = NewAppHarvest(*app.connectReply.ID, app,
-		NewHarvest(time.Now(), app.connectReply.EventHarvestConfig.EventConfigs), p.processorHarvestChan)
+		NewHarvestWithRules(time.Now(), app.connectReply.EventHarvestConfig.EventConfigs, app.metricRules),
+		p.processorHarvestChan)
 }
 
 func processLogEventLimits(app *App) {
@@ -525,7 +528,7 @@ type harvestArgs struct {
 	collector           string
 	agentLanguage       string
 	agentVersion        string
-	rules               MetricRules
+	rules               *MetricRulesCache
 	harvestErrorChannel chan<- HarvestError
 	client              collector.Client
 	splitLargePayloads  bool
@@ -636,7 +639,6 @@ func harvestAll(harvest *Harvest, args *harvestArgs, harvestLimits collector.Eve
 	log.Debugf("harvesting %d commands processed", harvest.commandsProcessed)
 
 	harvest.createFinalMetrics(harvestLimits, to)
-	harvest.Metrics = harvest.Metrics.ApplyRules(args.rules)
 	duc := newDataUsageController(du_chan)
 	considerHarvestPayload(harvest.Metrics, args, duc)
 	considerHarvestPayload(harvest.CustomEvents, args, duc)
@@ -672,9 +674,9 @@ func harvestByType(ah *AppHarvest, args *harvestArgs, ht HarvestType, du_chan ch
 	//       at the same rate.
 	// In such cases, harvest all types and return.
 	if ht&HarvestAll == HarvestAll {
-		ah.Harvest = NewHarvest(time.Now(), ah.App.connectReply.EventHarvestConfig.EventConfigs)
+		ah.Harvest = NewHarvestWithRules(time.Now(), ah.App.connectReply.EventHarvestConfig.EventConfigs, args.rules)
 		// filter already seen php packages
-		harvest.PhpPackages.data = ah.App.filterPhpPackages(harvest.PhpPackages.data)
+		harvest.PhpPackages.filter(ah.App)
 		if args.blocking {
 			// Invoked primarily by CleanExit
 			harvestAll(harvest, args, ah.connectReply.EventHarvestConfig, ah.TraceObserver, du_chan)
@@ -693,16 +695,15 @@ func harvestByType(ah *AppHarvest, args *harvestArgs, ht HarvestType, du_chan ch
 		log.Debugf("harvesting %d commands processed", harvest.commandsProcessed)
 
 		harvest.createFinalMetrics(ah.connectReply.EventHarvestConfig, ah.TraceObserver)
-		harvest.Metrics = harvest.Metrics.ApplyRules(args.rules)
 
 		metrics := harvest.Metrics
 		errors := harvest.Errors
 		slowSQLs := harvest.SlowSQLs
 		txnTraces := harvest.TxnTraces
 		phpPackages := harvest.PhpPackages
-		phpPackages.data = ah.App.filterPhpPackages(phpPackages.data)
+		phpPackages.filter(ah.App)
 
-		harvest.Metrics = NewMetricTable(limits.MaxMetrics, time.Now())
+		harvest.Metrics = NewMetricTableWithRules(limits.MaxMetrics, time.Now(), args.rules)
 		harvest.Errors = NewErrorHeap(limits.MaxErrors)
 		harvest.SlowSQLs = NewSlowSQLs(limits.MaxSlowSQLs)
 		harvest.TxnTraces = NewTxnTraces()
@@ -809,14 +810,13 @@ func harvestDataUsage(args *harvestArgs, duc dataUsageController) {
 		}
 	}
 
-	metrics := NewMetricTable(limits.MaxMetrics, time.Now())
+	metrics := NewMetricTableWithRules(limits.MaxMetrics, time.Now(), args.rules)
 	for name, data := range dataUsageMap {
 		metrics.AddRaw([]byte("Supportability/"+strings.ToUpper(args.agentLanguage)+"/Collector/"+name+"/Output/Bytes"),
 			"", "", [6]float64{float64(data.attempts), float64(data.payloadSize), float64(data.responseSize), 0.0, 0.0, 0.0}, Forced)
 	}
 	metrics.AddRaw([]byte("Supportability/"+strings.ToUpper(args.agentLanguage)+"/Collector/Output/Bytes"),
 		"", "", [6]float64{float64(sumAttempts), float64(sumPayload), float64(sumResponse), 0.0, 0.0, 0.0}, Forced)
-	metrics = metrics.ApplyRules(args.rules)
 	considerHarvestPayload(metrics, args, duc)
 }
 
@@ -848,7 +848,7 @@ func (p *Processor) doHarvest(ph ProcessorHarvest) {
 		collector:           app.collector,
 		agentLanguage:       app.info.AgentLanguage,
 		agentVersion:        app.info.AgentVersion,
-		rules:               app.connectReply.MetricRules,
+		rules:               app.metricRules,
 		harvestErrorChannel: p.harvestErrorChannel,
 		client:              p.cfg.Client,
 		RequestHeadersMap:   app.connectReply.RequestHeadersMap,
@@ -229,8 +229,20 @@ func (rcv *App) DockerId() []byte {
 	return nil
 }
 
+func (rcv *App) SpanStreamCount() uint16 {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(46))
+	if o != 0 {
+		return rcv._tab.GetUint16(o + rcv._tab.Pos)
+	}
+	return 0
+}
+
+func (rcv *App) MutateSpanStreamCount(n uint16) bool {
+	return rcv._tab.MutateUint16Slot(46, n)
+}
+
 func AppStart(builder *flatbuffers.Builder) {
-	builder.StartObject(21)
+	builder.StartObject(22)
 }
 func AppAddLicense(builder *flatbuffers.Builder, license flatbuffers.UOffsetT) {
 	builder.PrependUOffsetTSlot(0, flatbuffers.UOffsetT(license), 0)
@@ -295,6 +307,9 @@ func AppAddCustomEventsMaxSamplesStored(builder *flatbuffers.Builder, customEven
 func AppAddDockerId(builder *flatbuffers.Builder, dockerId flatbuffers.UOffsetT) {
 	builder.PrependUOffsetTSlot(20, flatbuffers.UOffsetT(dockerId), 0)
 }
+func AppAddSpanStreamCount(builder *flatbuffers.Builder, spanStreamCount uint16) {
+	builder.PrependUint16Slot(21, spanStreamCount, 0)
+}
 func AppEnd(builder *flatbuffers.Builder) flatbuffers.UOffsetT {
 	return builder.EndObject()
 }
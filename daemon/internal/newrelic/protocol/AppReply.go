@@ -101,8 +101,32 @@ func (rcv *AppReply) MutateSamplingTarget(n uint16) bool {
 	return rcv._tab.MutateUint16Slot(14, n)
 }
 
+func (rcv *AppReply) MetricNameIds() uint32 {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(16))
+	if o != 0 {
+		return rcv._tab.GetUint32(o + rcv._tab.Pos)
+	}
+	return 0
+}
+
+func (rcv *AppReply) MutateMetricNameIds(n uint32) bool {
+	return rcv._tab.MutateUint32Slot(16, n)
+}
+
+func (rcv *AppReply) TxnBatchSize() uint32 {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(18))
+	if o != 0 {
+		return rcv._tab.GetUint32(o + rcv._tab.Pos)
+	}
+	return 0
+}
+
+func (rcv *AppReply) MutateTxnBatchSize(n uint32) bool {
+	return rcv._tab.MutateUint32Slot(18, n)
+}
+
 func AppReplyStart(builder *flatbuffers.Builder) {
-	builder.StartObject(6)
+	builder.StartObject(8)
 }
 func AppReplyAddStatus(builder *flatbuffers.Builder, status AppStatus) {
 	builder.PrependInt8Slot(0, int8(status), 0)
@@ -122,6 +146,12 @@ func AppReplyAddHarvestFrequency(builder *flatbuffers.Builder, harvestFrequency
 func AppReplyAddSamplingTarget(builder *flatbuffers.Builder, samplingTarget uint16) {
 	builder.PrependUint16Slot(5, samplingTarget, 0)
 }
+func AppReplyAddMetricNameIds(builder *flatbuffers.Builder, metricNameIds uint32) {
+	builder.PrependUint32Slot(6, metricNameIds, 0)
+}
+func AppReplyAddTxnBatchSize(builder *flatbuffers.Builder, txnBatchSize uint32) {
+	builder.PrependUint32Slot(7, txnBatchSize, 0)
+}
 func AppReplyEnd(builder *flatbuffers.Builder) flatbuffers.UOffsetT {
 	return builder.EndObject()
 }
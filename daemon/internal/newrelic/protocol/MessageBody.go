@@ -11,27 +11,30 @@ import "strconv"
 type MessageBody byte
 
 const (
-	MessageBodyNONE        MessageBody = 0
-	MessageBodyApp         MessageBody = 1
-	MessageBodyAppReply    MessageBody = 2
-	MessageBodyTransaction MessageBody = 3
-	MessageBodySpanBatch   MessageBody = 4
+	MessageBodyNONE             MessageBody = 0
+	MessageBodyApp              MessageBody = 1
+	MessageBodyAppReply         MessageBody = 2
+	MessageBodyTransaction      MessageBody = 3
+	MessageBodySpanBatch        MessageBody = 4
+	MessageBodyTransactionBatch MessageBody = 5
 )
 
 var EnumNamesMessageBody = map[MessageBody]string{
-	MessageBodyNONE:        "NONE",
-	MessageBodyApp:         "App",
-	MessageBodyAppReply:    "AppReply",
-	MessageBodyTransaction: "Transaction",
-	MessageBodySpanBatch:   "SpanBatch",
+	MessageBodyNONE:             "NONE",
+	MessageBodyApp:              "App",
+	MessageBodyAppReply:         "AppReply",
+	MessageBodyTransaction:      "Transaction",
+	MessageBodySpanBatch:        "SpanBatch",
+	MessageBodyTransactionBatch: "TransactionBatch",
 }
 
 var EnumValuesMessageBody = map[string]MessageBody{
-	"NONE":        MessageBodyNONE,
-	"App":         MessageBodyApp,
-	"AppReply":    MessageBodyAppReply,
-	"Transaction": MessageBodyTransaction,
-	"SpanBatch":   MessageBodySpanBatch,
+	"NONE":             MessageBodyNONE,
+	"App":              MessageBodyApp,
+	"AppReply":         MessageBodyAppReply,
+	"Transaction":      MessageBodyTransaction,
+	"SpanBatch":        MessageBodySpanBatch,
+	"TransactionBatch": MessageBodyTransactionBatch,
 }
 
 func (v MessageBody) String() string {
@@ -58,8 +58,20 @@ func (rcv *Metric) Data(obj *MetricData) *MetricData {
 	return nil
 }
 
+func (rcv *Metric) NameId() uint32 {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(8))
+	if o != 0 {
+		return rcv._tab.GetUint32(o + rcv._tab.Pos)
+	}
+	return 0
+}
+
+func (rcv *Metric) MutateNameId(n uint32) bool {
+	return rcv._tab.MutateUint32Slot(8, n)
+}
+
 func MetricStart(builder *flatbuffers.Builder) {
-	builder.StartObject(2)
+	builder.StartObject(3)
 }
 func MetricAddName(builder *flatbuffers.Builder, name flatbuffers.UOffsetT) {
 	builder.PrependUOffsetTSlot(0, flatbuffers.UOffsetT(name), 0)
@@ -67,6 +79,9 @@ func MetricAddName(builder *flatbuffers.Builder, name flatbuffers.UOffsetT) {
 func MetricAddData(builder *flatbuffers.Builder, data flatbuffers.UOffsetT) {
 	builder.PrependStructSlot(1, flatbuffers.UOffsetT(data), 0)
 }
+func MetricAddNameId(builder *flatbuffers.Builder, nameId uint32) {
+	builder.PrependUint32Slot(2, nameId, 0)
+}
 func MetricEnd(builder *flatbuffers.Builder) flatbuffers.UOffsetT {
 	return builder.EndObject()
 }
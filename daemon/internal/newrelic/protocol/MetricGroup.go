@@ -0,0 +1,82 @@
+//
+// Copyright 2024 New Relic Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Code generated by the FlatBuffers compiler. DO NOT EDIT.
+
+package protocol
+
+import (
+	flatbuffers "github.com/google/flatbuffers/go"
+)
+
+type MetricGroup struct {
+	_tab flatbuffers.Table
+}
+
+func GetRootAsMetricGroup(buf []byte, offset flatbuffers.UOffsetT) *MetricGroup {
+	n := flatbuffers.GetUOffsetT(buf[offset:])
+	x := &MetricGroup{}
+	x.Init(buf, n+offset)
+	return x
+}
+
+func GetSizePrefixedRootAsMetricGroup(buf []byte, offset flatbuffers.UOffsetT) *MetricGroup {
+	n := flatbuffers.GetUOffsetT(buf[offset+flatbuffers.SizeUint32:])
+	x := &MetricGroup{}
+	x.Init(buf, n+offset+flatbuffers.SizeUint32)
+	return x
+}
+
+func (rcv *MetricGroup) Init(buf []byte, i flatbuffers.UOffsetT) {
+	rcv._tab.Bytes = buf
+	rcv._tab.Pos = i
+}
+
+func (rcv *MetricGroup) Table() flatbuffers.Table {
+	return rcv._tab
+}
+
+func (rcv *MetricGroup) Scope() []byte {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(4))
+	if o != 0 {
+		return rcv._tab.ByteVector(o + rcv._tab.Pos)
+	}
+	return nil
+}
+
+func (rcv *MetricGroup) Metrics(obj *Metric, j int) bool {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(6))
+	if o != 0 {
+		x := rcv._tab.Vector(o)
+		x += flatbuffers.UOffsetT(j) * 4
+		x = rcv._tab.Indirect(x)
+		obj.Init(rcv._tab.Bytes, x)
+		return true
+	}
+	return false
+}
+
+func (rcv *MetricGroup) MetricsLength() int {
+	o := flatbuffers.UOffsetT(rcv._tab.Offset(6))
+	if o != 0 {
+		return rcv._tab.VectorLen(o)
+	}
+	return 0
+}
+
+func MetricGroupStart(builder *flatbuffers.Builder) {
+	builder.StartObject(2)
+}
+func MetricGroupAddScope(builder *flatbuffers.Builder, scope flatbuffers.UOffsetT) {
+	builder.PrependUOffsetTSlot(0, flatbuffers.UOffsetT(scope), 0)
+}
+func MetricGroupAddMetrics(builder *flatbuffers.Builder, metrics flatbuffers.UOffsetT) {
+	builder.PrependUOffsetTSlot(1, flatbuffers.UOffsetT(metrics), 0)
+}
+func MetricGroupStartMetricsVector(builder *flatbuffers.Builder, numElems int) flatbuffers.UOffsetT {
+	return builder.StartVector(4, numElems, 4)
+}
+func MetricGroupEnd(builder *flatbuffers.Builder) flatbuffers.UOffsetT {
+	return builder.EndObject()
+}
@@ -39,10 +39,25 @@ func EncodeError(b *flatbuffers.Builder, priority int32, data []byte) flatbuffer
 // its offset.
 func EncodeMetric(b *flatbuffers.Builder, name string, data [6]float64,
 	scoped, forced bool) flatbuffers.UOffsetT {
-	nameOffset := b.CreateString(name)
+	return EncodeMetricID(b, name, 0, data, scoped, forced)
+}
+
+// EncodeMetricID prepends a new Metric object with a name id to the
+// FlatBuffer and returns its offset. An empty name refers to a name defined
+// with the same id earlier on the connection.
+func EncodeMetricID(b *flatbuffers.Builder, name string, nameID uint32,
+	data [6]float64, scoped, forced bool) flatbuffers.UOffsetT {
+	var nameOffset flatbuffers.UOffsetT
+	sendName := "" != name || 0 == nameID
+	if sendName {
+		nameOffset = b.CreateString(name)
+	}
 
 	MetricStart(b)
-	MetricAddName(b, nameOffset)
+	if sendName {
+		MetricAddName(b, nameOffset)
+	}
+	MetricAddNameId(b, nameID)
 
 	var scopedBool bool
 	var forcedBool bool